@@ -0,0 +1,315 @@
+#include "AssetArchive.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	static_assert(std::is_trivially_copyable<ArchiveEntry>::value && sizeof(ArchiveEntry) == 32, "entries are read in place");
+	static_assert(std::is_trivially_copyable<ArchiveSubmesh>::value && sizeof(ArchiveSubmesh) == 40, "submeshes are read in place");
+	static_assert(alignof(ArchiveEntry) <= AssetArchive::BlobAlignment && alignof(ArchiveMeshHeader) <= AssetArchive::BlobAlignment,
+		"records must be aligned by the blob alignment");
+
+	uint64 AlignUp(uint64 offset)
+	{
+		return (offset + AssetArchive::BlobAlignment - 1) & ~(AssetArchive::BlobAlignment - 1);
+	}
+
+	bool InRange(uint64 offset, uint64 size, uint64 limit)
+	{
+		return offset <= limit && size <= limit - offset;
+	}
+
+	template<typename T>
+	void AppendBytes(std::vector<std::byte>& blob, uint64 offset, const T* data, std::size_t count)
+	{
+		if (count > 0)
+			std::memcpy(blob.data() + offset, data, count * sizeof(T));
+	}
+}
+
+AssetArchive::uint64 AssetArchive::HashName(std::string_view name)
+{
+	uint64 hash = 14695981039346656037ull;
+	for (char c : name)
+		hash = (hash ^ (unsigned char)c) * 1099511628211ull;
+	return hash;
+}
+
+bool AssetArchive::Open(const char* path)
+{
+	Close();
+	if (!mFile.Open(path))
+		return false;
+
+	const std::byte* data = reinterpret_cast<const std::byte*>(mFile.Data());
+	uint64 size = mFile.Size();
+	ArchiveHeader header;
+	if (size < sizeof(ArchiveHeader))
+	{
+		Close();
+		return false;
+	}
+	std::memcpy(&header, data, sizeof(ArchiveHeader));
+
+	if (header.Magic != FileMagic || header.Version != FileVersion || header.FileSize != size ||
+		header.TocOffset % BlobAlignment != 0 ||
+		!InRange(header.TocOffset, (uint64)header.EntryCount * sizeof(ArchiveEntry), size) ||
+		!InRange(header.NamesOffset, header.NamesSize, size) ||
+		(header.NamesSize > 0 && std::to_integer<char>(data[header.NamesOffset + header.NamesSize - 1]) != '\0'))
+	{
+		Close();
+		return false;
+	}
+
+	mEntries = std::span<const ArchiveEntry>(reinterpret_cast<const ArchiveEntry*>(data + header.TocOffset), header.EntryCount);
+	mNames = std::string_view(reinterpret_cast<const char*>(data + header.NamesOffset), (std::size_t)header.NamesSize);
+	for (const ArchiveEntry& entry : mEntries)
+	{
+		if (!InRange(entry.Offset, entry.Size, size) || entry.Offset % BlobAlignment != 0 || entry.NameOffset >= mNames.size())
+		{
+			Close();
+			return false;
+		}
+	}
+	return true;
+}
+
+void AssetArchive::Close()
+{
+	mFile.Close();
+	mEntries = {};
+	mNames = {};
+}
+
+std::span<const ArchiveEntry> AssetArchive::GetEntries() const
+{
+	return mEntries;
+}
+
+const ArchiveEntry* AssetArchive::Find(std::string_view name) const
+{
+	uint64 hash = HashName(name);
+	auto it = std::lower_bound(mEntries.begin(), mEntries.end(), hash,
+		[](const ArchiveEntry& entry, uint64 value) { return entry.NameHash < value; });
+	for (; it != mEntries.end() && it->NameHash == hash; ++it)
+	{
+		if (GetName(it->NameOffset) == name)
+			return &*it;
+	}
+	return nullptr;
+}
+
+std::string_view AssetArchive::GetName(uint32 nameOffset) const
+{
+	if (nameOffset >= mNames.size())
+		return {};
+	// The name table ends with a zero, checked by Open.
+	return std::string_view(mNames.data() + nameOffset);
+}
+
+bool AssetArchive::GetMesh(const ArchiveEntry& entry, MeshView& mesh) const
+{
+	std::span<const std::byte> blob = GetBlob(entry);
+	if (entry.Type != ArchiveAssetType::Mesh || blob.size() < sizeof(ArchiveMeshHeader))
+		return false;
+
+	const ArchiveMeshHeader* header = reinterpret_cast<const ArchiveMeshHeader*>(blob.data());
+	uint64 vertexBytes = (uint64)header->VertexCount * header->VertexByteStride;
+	uint64 indexBytes = (uint64)header->IndexCount * header->IndexByteStride;
+	uint64 submeshBytes = (uint64)header->SubmeshCount * sizeof(ArchiveSubmesh);
+	if ((header->IndexByteStride != 2 && header->IndexByteStride != 4) ||
+		!InRange(header->VerticesOffset, vertexBytes, blob.size()) ||
+		!InRange(header->IndicesOffset, indexBytes, blob.size()) ||
+		!InRange(header->SubmeshesOffset, submeshBytes, blob.size()) ||
+		header->SubmeshesOffset % BlobAlignment != 0)
+		return false;
+
+	// Submeshes must stay within the streams, so a bad archive can not make
+	// a draw read past them.
+	const ArchiveSubmesh* submeshes = reinterpret_cast<const ArchiveSubmesh*>(blob.data() + header->SubmeshesOffset);
+	for (uint32 s = 0; s < header->SubmeshCount; s++)
+	{
+		if ((uint64)submeshes[s].StartIndexLocation + submeshes[s].IndexCount > header->IndexCount ||
+			submeshes[s].BaseVertexLocation < 0 || (uint64)submeshes[s].BaseVertexLocation > header->VertexCount)
+			return false;
+	}
+
+	mesh.Header = header;
+	mesh.Vertices = blob.subspan((std::size_t)header->VerticesOffset, (std::size_t)vertexBytes);
+	mesh.Indices = blob.subspan((std::size_t)header->IndicesOffset, (std::size_t)indexBytes);
+	mesh.Submeshes = std::span<const ArchiveSubmesh>(submeshes, header->SubmeshCount);
+	return true;
+}
+
+std::span<const std::byte> AssetArchive::GetBlob(const ArchiveEntry& entry) const
+{
+	const std::byte* data = reinterpret_cast<const std::byte*>(mFile.Data());
+	return std::span<const std::byte>(data + entry.Offset, (std::size_t)entry.Size);
+}
+
+void AssetArchiveBuilder::AddMesh(const std::string& name, uint32 vertexByteStride, std::span<const std::byte> vertices,
+	uint32 indexByteStride, std::span<const std::byte> indices, const std::vector<Submesh>& submeshes)
+{
+	ArchiveMeshHeader header = {};
+	header.VertexByteStride = vertexByteStride;
+	header.VertexCount = vertexByteStride > 0 ? (uint32)(vertices.size() / vertexByteStride) : 0;
+	header.IndexByteStride = indexByteStride;
+	header.IndexCount = (uint32)(indices.size() / indexByteStride);
+	header.SubmeshCount = (uint32)submeshes.size();
+	header.VerticesOffset = AlignUp(sizeof(ArchiveMeshHeader));
+	header.IndicesOffset = AlignUp(header.VerticesOffset + vertices.size());
+	header.SubmeshesOffset = AlignUp(header.IndicesOffset + indices.size());
+
+	PendingEntry entry;
+	entry.Name = name;
+	entry.Type = ArchiveAssetType::Mesh;
+	entry.Blob.resize((std::size_t)(header.SubmeshesOffset + submeshes.size() * sizeof(ArchiveSubmesh)));
+	AppendBytes(entry.Blob, 0, &header, 1);
+	AppendBytes(entry.Blob, header.VerticesOffset, vertices.data(), vertices.size());
+	AppendBytes(entry.Blob, header.IndicesOffset, indices.data(), indices.size());
+
+	// NameOffset is filled by Write.
+	for (std::size_t s = 0; s < submeshes.size(); s++)
+	{
+		ArchiveSubmesh record = {};
+		record.IndexCount = submeshes[s].IndexCount;
+		record.StartIndexLocation = submeshes[s].StartIndexLocation;
+		record.BaseVertexLocation = submeshes[s].BaseVertexLocation;
+		std::copy(submeshes[s].BoundsCenter, submeshes[s].BoundsCenter + 3, record.BoundsCenter);
+		std::copy(submeshes[s].BoundsExtents, submeshes[s].BoundsExtents + 3, record.BoundsExtents);
+		AppendBytes(entry.Blob, header.SubmeshesOffset + s * sizeof(ArchiveSubmesh), &record, 1);
+		entry.SubmeshNames.push_back(submeshes[s].Name);
+	}
+
+	mBlobBytes += entry.Blob.size();
+	mEntries.push_back(std::move(entry));
+}
+
+void AssetArchiveBuilder::AddTexture(const std::string& name, std::span<const std::byte> dds)
+{
+	PendingEntry entry;
+	entry.Name = name;
+	entry.Type = ArchiveAssetType::Texture;
+	entry.Blob.assign(dds.begin(), dds.end());
+	mBlobBytes += entry.Blob.size();
+	mEntries.push_back(std::move(entry));
+}
+
+std::size_t AssetArchiveBuilder::GetEntryCount() const
+{
+	return mEntries.size();
+}
+
+std::size_t AssetArchiveBuilder::GetBlobBytes() const
+{
+	return mBlobBytes;
+}
+
+bool AssetArchiveBuilder::Write(const char* path) const
+{
+	// Table of contents in hash order, for the binary search of Find.
+	std::vector<uint32> order(mEntries.size());
+	for (uint32 i = 0; i < order.size(); i++)
+		order[i] = i;
+	std::vector<uint64> hashes(mEntries.size());
+	for (std::size_t i = 0; i < mEntries.size(); i++)
+		hashes[i] = AssetArchive::HashName(mEntries[i].Name);
+	std::sort(order.begin(), order.end(), [&](uint32 a, uint32 b)
+	{
+		return hashes[a] != hashes[b] ? hashes[a] < hashes[b] : mEntries[a].Name < mEntries[b].Name;
+	});
+	for (std::size_t i = 1; i < order.size(); i++)
+	{
+		if (mEntries[order[i]].Name == mEntries[order[i - 1]].Name)
+			return false;
+	}
+
+	// Name table: entry names, then the submesh names of every mesh.
+	std::string names;
+	std::vector<uint32> nameOffsets(mEntries.size());
+	std::vector<std::vector<uint32>> submeshNameOffsets(mEntries.size());
+	for (std::size_t i = 0; i < mEntries.size(); i++)
+	{
+		nameOffsets[i] = (uint32)names.size();
+		names.append(mEntries[i].Name).push_back('\0');
+		for (const std::string& submeshName : mEntries[i].SubmeshNames)
+		{
+			submeshNameOffsets[i].push_back((uint32)names.size());
+			names.append(submeshName).push_back('\0');
+		}
+	}
+
+	ArchiveHeader header = {};
+	header.Magic = AssetArchive::FileMagic;
+	header.Version = AssetArchive::FileVersion;
+	header.EntryCount = (uint32)mEntries.size();
+	header.TocOffset = AlignUp(sizeof(ArchiveHeader));
+	header.NamesOffset = header.TocOffset + mEntries.size() * sizeof(ArchiveEntry);
+	header.NamesSize = names.size();
+
+	std::vector<ArchiveEntry> toc(mEntries.size());
+	uint64 offset = AlignUp(header.NamesOffset + header.NamesSize);
+	for (std::size_t t = 0; t < order.size(); t++)
+	{
+		uint32 i = order[t];
+		toc[t].NameHash = hashes[i];
+		toc[t].NameOffset = nameOffsets[i];
+		toc[t].Type = mEntries[i].Type;
+		toc[t].Offset = offset;
+		toc[t].Size = mEntries[i].Blob.size();
+		offset = AlignUp(offset + toc[t].Size);
+	}
+	header.FileSize = offset;
+
+	std::string tempPath = std::string(path) + ".tmp";
+	{
+		std::ofstream fout(tempPath, std::ios::binary | std::ios::trunc);
+		const char padding[AssetArchive::BlobAlignment] = {};
+		auto pad = [&](uint64 to)
+		{
+			fout.write(padding, (std::streamsize)(to - (uint64)fout.tellp()));
+		};
+
+		fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		pad(header.TocOffset);
+		fout.write(reinterpret_cast<const char*>(toc.data()), (std::streamsize)(toc.size() * sizeof(ArchiveEntry)));
+		fout.write(names.data(), (std::streamsize)names.size());
+
+		std::vector<std::byte> blob;
+		for (std::size_t t = 0; t < order.size(); t++)
+		{
+			const PendingEntry& entry = mEntries[order[t]];
+			pad(toc[t].Offset);
+
+			// Mesh blobs get the final offsets of their submesh names.
+			const std::vector<std::byte>* bytes = &entry.Blob;
+			if (!entry.SubmeshNames.empty())
+			{
+				blob = entry.Blob;
+				ArchiveMeshHeader meshHeader;
+				std::memcpy(&meshHeader, blob.data(), sizeof(meshHeader));
+				for (std::size_t s = 0; s < entry.SubmeshNames.size(); s++)
+				{
+					uint32 nameOffset = submeshNameOffsets[order[t]][s];
+					std::memcpy(blob.data() + meshHeader.SubmeshesOffset + s * sizeof(ArchiveSubmesh) + offsetof(ArchiveSubmesh, NameOffset),
+						&nameOffset, sizeof(nameOffset));
+				}
+				bytes = &blob;
+			}
+			fout.write(reinterpret_cast<const char*>(bytes->data()), (std::streamsize)bytes->size());
+		}
+		pad(header.FileSize);
+		if (!fout)
+			return false;
+	}
+
+	// rename does not replace an existing file on Windows.
+	std::remove(path);
+	return std::rename(tempPath.c_str(), path) == 0;
+}
@@ -0,0 +1,165 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MappedFile.h"
+
+// Packed asset archive.  One file holds every mesh and texture, laid out so
+// the runtime maps it and reads it in place:
+//
+//   ArchiveHeader
+//   ArchiveEntry[EntryCount]       table of contents, sorted by NameHash
+//   names                          zero-terminated, entries and submeshes
+//   blobs                          each 16-byte aligned
+//
+// A mesh blob is an ArchiveMeshHeader followed by its vertex stream, index
+// stream and ArchiveSubmesh records, each 16-byte aligned within the blob.
+// A texture blob is the DDS file as is.  Offsets in the header and the
+// entries are from the start of the file, offsets in a mesh header from the
+// start of its blob.
+//
+// Archives are written offline by AssetArchiveBuilder (see AssetPacker) and
+// carry no checksum; Open only checks that the header, the table of contents
+// and every blob lie within the file, and GetMesh that the streams and the
+// submesh ranges lie within the blob.
+
+enum class ArchiveAssetType : std::uint32_t
+{
+	Mesh = 1,
+	Texture = 2
+};
+
+struct ArchiveHeader
+{
+	std::uint32_t Magic;
+	std::uint32_t Version;
+	std::uint32_t EntryCount;
+	std::uint32_t Reserved;
+	std::uint64_t TocOffset;
+	std::uint64_t NamesOffset;
+	std::uint64_t NamesSize;
+	std::uint64_t FileSize;
+};
+
+struct ArchiveEntry
+{
+	// FNV-1a of the name.
+	std::uint64_t NameHash;
+	std::uint32_t NameOffset;
+	ArchiveAssetType Type;
+	std::uint64_t Offset;
+	std::uint64_t Size;
+};
+
+struct ArchiveMeshHeader
+{
+	std::uint32_t VertexByteStride;
+	std::uint32_t VertexCount;
+	// 2 for R16_UINT, 4 for R32_UINT.
+	std::uint32_t IndexByteStride;
+	std::uint32_t IndexCount;
+	std::uint32_t SubmeshCount;
+	std::uint32_t Reserved;
+	std::uint64_t VerticesOffset;
+	std::uint64_t IndicesOffset;
+	std::uint64_t SubmeshesOffset;
+};
+
+// Same fields as SubmeshGeometry, bounds as a box center and extents.
+struct ArchiveSubmesh
+{
+	std::uint32_t NameOffset;
+	std::uint32_t IndexCount;
+	std::uint32_t StartIndexLocation;
+	std::int32_t BaseVertexLocation;
+	float BoundsCenter[3];
+	float BoundsExtents[3];
+};
+
+// Read side.  Every view points into the mapping and stays valid until
+// Close; nothing is copied or parsed.
+class AssetArchive
+{
+public:
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	struct MeshView
+	{
+		const ArchiveMeshHeader* Header = nullptr;
+		std::span<const std::byte> Vertices;
+		std::span<const std::byte> Indices;
+		std::span<const ArchiveSubmesh> Submeshes;
+	};
+
+	static constexpr uint32					FileMagic = 'A' | ('P' << 8) | ('A' << 16) | ('K' << 24);
+	static constexpr uint32					FileVersion = 1;
+	static constexpr uint64					BlobAlignment = 16;
+
+	static uint64							HashName(std::string_view name);
+
+	// Returns false if the file can not be mapped or is not a valid archive.
+	bool									Open(const char* path);
+	void									Close();
+
+	std::span<const ArchiveEntry>			GetEntries() const;
+	// nullptr when there is no asset of that name.
+	const ArchiveEntry*						Find(std::string_view name) const;
+	std::string_view						GetName(uint32 nameOffset) const;
+
+	// Returns false if entry is not a mesh or its blob is malformed.
+	bool									GetMesh(const ArchiveEntry& entry, MeshView& mesh) const;
+	// Bytes of the blob of any entry; the DDS file for a texture.
+	std::span<const std::byte>				GetBlob(const ArchiveEntry& entry) const;
+
+private:
+	MappedFile								mFile;
+	std::span<const ArchiveEntry>			mEntries;
+	std::string_view						mNames;
+};
+
+// Write side, used by the packer.  Assets are serialized into their blob
+// when added; Write lays them out and writes the file in one pass.
+class AssetArchiveBuilder
+{
+public:
+	using uint32 = std::uint32_t;
+
+	struct Submesh
+	{
+		std::string Name;
+		uint32 IndexCount = 0;
+		uint32 StartIndexLocation = 0;
+		std::int32_t BaseVertexLocation = 0;
+		float BoundsCenter[3] = {};
+		float BoundsExtents[3] = {};
+	};
+
+	// indexByteStride is 2 or 4.
+	void									AddMesh(const std::string& name, uint32 vertexByteStride, std::span<const std::byte> vertices,
+												uint32 indexByteStride, std::span<const std::byte> indices, const std::vector<Submesh>& submeshes);
+	void									AddTexture(const std::string& name, std::span<const std::byte> dds);
+
+	std::size_t								GetEntryCount() const;
+	std::size_t								GetBlobBytes() const;
+
+	// Writes to a temporary file renamed over path once complete.  Fails on
+	// duplicate names.
+	bool									Write(const char* path) const;
+
+private:
+	struct PendingEntry
+	{
+		std::string Name;
+		ArchiveAssetType Type;
+		std::vector<std::byte> Blob;
+		// Submesh names, patched into the blob once the name table is laid out.
+		std::vector<std::string> SubmeshNames;
+	};
+
+	std::vector<PendingEntry>				mEntries;
+	std::size_t								mBlobBytes = 0;
+};
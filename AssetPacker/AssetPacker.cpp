@@ -0,0 +1,406 @@
+// AssetPacker: builds the packed asset archives read by AssetArchive.
+//
+//   AssetPacker <archive> <file.obj|file.dds>...   pack files into archive
+//   AssetPacker --list <archive>                   print the table of contents
+//   AssetPacker --bench <archive> [megabytes]      write a synthetic archive of
+//                                                  that size (1024 by default)
+//                                                  and time its loading
+//
+// An asset is named after its file without directory and extension.  OBJ
+// files become one mesh with a submesh per group/material pair; DDS files
+// are stored as is.
+
+#include <algorithm>
+#include <cctype>
+#include <cfloat>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../AssetArchive.h"
+#include "../CreateGeometry.h"
+#include "../MappedFile.h"
+#include "../MeshPacker.h"
+#include "../ObjImporter.h"
+#include "../ThreadPool.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace DirectX;
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+	using Clock = std::chrono::steady_clock;
+
+	double MillisecondsSince(Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	template<typename T>
+	std::span<const std::byte> AsBytes(const std::vector<T>& v)
+	{
+		return std::as_bytes(std::span<const T>(v));
+	}
+
+	// Indices narrowed to 16 bits when every vertex fits, as MeshPacker does
+	// for its pages.
+	std::vector<std::byte> PackIndices(const std::vector<uint32>& indices, uint32 vertexCount, uint32& indexByteStride)
+	{
+		bool use32 = vertexCount > 0x10000;
+		indexByteStride = use32 ? 4 : 2;
+		std::vector<std::byte> bytes(indices.size() * indexByteStride);
+		if (!indices.empty())
+			MeshPacker::CopyIndices(indices.data(), (uint32)indices.size(), use32, bytes.data());
+		return bytes;
+	}
+
+	template<typename Format>
+	AssetArchiveBuilder::Submesh MakeSubmesh(const std::string& name, const CreateGeometry::BasicMeshData<Format>& mesh,
+		uint32 startIndexLocation, uint32 indexCount, int baseVertexLocation)
+	{
+		AssetArchiveBuilder::Submesh submesh;
+		submesh.Name = name;
+		submesh.IndexCount = indexCount;
+		submesh.StartIndexLocation = startIndexLocation;
+		submesh.BaseVertexLocation = baseVertexLocation;
+
+		XMFLOAT3 vMin(+FLT_MAX, +FLT_MAX, +FLT_MAX);
+		XMFLOAT3 vMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		for (uint32 i = startIndexLocation; i < startIndexLocation + indexCount; i++)
+		{
+			const XMFLOAT3& p = mesh.Vertices[mesh.Indices32[i] + baseVertexLocation].Position;
+			vMin = XMFLOAT3(std::min(vMin.x, p.x), std::min(vMin.y, p.y), std::min(vMin.z, p.z));
+			vMax = XMFLOAT3(std::max(vMax.x, p.x), std::max(vMax.y, p.y), std::max(vMax.z, p.z));
+		}
+		if (indexCount > 0)
+		{
+			submesh.BoundsCenter[0] = 0.5f * (vMin.x + vMax.x);
+			submesh.BoundsCenter[1] = 0.5f * (vMin.y + vMax.y);
+			submesh.BoundsCenter[2] = 0.5f * (vMin.z + vMax.z);
+			submesh.BoundsExtents[0] = 0.5f * (vMax.x - vMin.x);
+			submesh.BoundsExtents[1] = 0.5f * (vMax.y - vMin.y);
+			submesh.BoundsExtents[2] = 0.5f * (vMax.z - vMin.z);
+		}
+		return submesh;
+	}
+
+	bool AddObj(AssetArchiveBuilder& builder, const std::string& name, const char* path, ThreadPool& pool)
+	{
+		ObjModel<CreateGeometry::DefaultFormat> model;
+		ObjImporter::Stats stats;
+		if (!ObjImporter::Load(path, pool, model, CreateGeometry::DefaultFormat(), &stats))
+			return false;
+
+		std::vector<AssetArchiveBuilder::Submesh> submeshes;
+		for (const ObjSubmesh& objSubmesh : model.Submeshes)
+		{
+			std::string submeshName = objSubmesh.Group.empty() ? "default" : objSubmesh.Group;
+			if (!objSubmesh.Material.empty())
+				submeshName += "/" + objSubmesh.Material;
+			submeshes.push_back(MakeSubmesh(submeshName, model.Mesh, objSubmesh.StartIndexLocation, objSubmesh.IndexCount, 0));
+		}
+
+		uint32 indexByteStride;
+		std::vector<std::byte> indices = PackIndices(model.Mesh.Indices32, (uint32)model.Mesh.Vertices.size(), indexByteStride);
+		builder.AddMesh(name, sizeof(CreateGeometry::Vertex), AsBytes(model.Mesh.Vertices), indexByteStride, indices, submeshes);
+		std::printf("  %s: %u vertices, %u triangles, %zu submeshes (%.1f ms)\n", name.c_str(),
+			stats.Vertices, stats.Triangles, submeshes.size(), stats.TotalMilliseconds);
+		return true;
+	}
+
+	bool AddDds(AssetArchiveBuilder& builder, const std::string& name, const char* path)
+	{
+		MappedFile file;
+		if (!file.Open(path) || file.Size() < 4 || std::memcmp(file.Data(), "DDS ", 4) != 0)
+			return false;
+		builder.AddTexture(name, std::span<const std::byte>(reinterpret_cast<const std::byte*>(file.Data()), file.Size()));
+		std::printf("  %s: %zu bytes\n", name.c_str(), file.Size());
+		return true;
+	}
+
+	int Pack(const char* archivePath, int fileCount, char** files)
+	{
+		ThreadPool pool;
+		AssetArchiveBuilder builder;
+		for (int f = 0; f < fileCount; f++)
+		{
+			std::filesystem::path path(files[f]);
+			std::string extension = path.extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+			bool added = false;
+			if (extension == ".obj")
+				added = AddObj(builder, path.stem().string(), files[f], pool);
+			else if (extension == ".dds")
+				added = AddDds(builder, path.stem().string(), files[f]);
+			else
+				std::fprintf(stderr, "%s: unknown file type\n", files[f]);
+
+			if (!added)
+			{
+				std::fprintf(stderr, "%s: could not be packed\n", files[f]);
+				return 1;
+			}
+		}
+
+		if (!builder.Write(archivePath))
+		{
+			std::fprintf(stderr, "%s: could not be written (duplicate asset names?)\n", archivePath);
+			return 1;
+		}
+		std::printf("%s: %zu assets, %.1f MB\n", archivePath, builder.GetEntryCount(), builder.GetBlobBytes() / (1024.0 * 1024.0));
+		return 0;
+	}
+
+	int List(const char* archivePath)
+	{
+		AssetArchive archive;
+		if (!archive.Open(archivePath))
+		{
+			std::fprintf(stderr, "%s: not a valid archive\n", archivePath);
+			return 1;
+		}
+
+		for (const ArchiveEntry& entry : archive.GetEntries())
+		{
+			std::string name(archive.GetName(entry.NameOffset));
+			AssetArchive::MeshView mesh;
+			if (archive.GetMesh(entry, mesh))
+			{
+				std::printf("mesh     %-32s %10llu bytes  %u vertices  %u indices (R%u)\n", name.c_str(),
+					(unsigned long long)entry.Size, mesh.Header->VertexCount, mesh.Header->IndexCount, mesh.Header->IndexByteStride * 8);
+				for (const ArchiveSubmesh& submesh : mesh.Submeshes)
+				{
+					std::string submeshName(archive.GetName(submesh.NameOffset));
+					std::printf("           %-30s %u indices at %u, base vertex %d\n", submeshName.c_str(),
+						submesh.IndexCount, submesh.StartIndexLocation, submesh.BaseVertexLocation);
+				}
+			}
+			else
+			{
+				std::printf("%-8s %-32s %10llu bytes\n", entry.Type == ArchiveAssetType::Texture ? "texture" : "?",
+					name.c_str(), (unsigned long long)entry.Size);
+			}
+		}
+		return 0;
+	}
+
+	// A DDS file of an uncompressed RGBA8 texture with a full mip chain; the
+	// texels are noise, the loader only cares about the layout.
+	std::vector<std::byte> MakeDds(uint32 size, uint32 seed)
+	{
+		uint32 mipCount = 1;
+		uint64 texelBytes = 0;
+		for (uint32 s = size; ; s /= 2, mipCount++)
+		{
+			texelBytes += (uint64)s * s * 4;
+			if (s == 1)
+				break;
+		}
+
+		// DDS_HEADER with a DDS_PIXELFORMAT for A8B8G8R8.
+		uint32 header[32] = {};
+		header[0] = 'D' | ('D' << 8) | ('S' << 16) | (' ' << 24);
+		header[1] = 124;					// dwSize
+		header[2] = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x8;	// caps, height, width, pixel format, mip count, pitch
+		header[3] = size;					// dwHeight
+		header[4] = size;					// dwWidth
+		header[5] = size * 4;				// dwPitchOrLinearSize
+		header[7] = mipCount;				// dwMipMapCount
+		header[19] = 32;					// ddspf.dwSize
+		header[20] = 0x41;					// DDPF_RGB | DDPF_ALPHAPIXELS
+		header[22] = 32;					// dwRGBBitCount
+		header[23] = 0x000000ff;
+		header[24] = 0x0000ff00;
+		header[25] = 0x00ff0000;
+		header[26] = 0xff000000;
+		header[27] = 0x1000 | 0x400000 | 0x8;	// DDSCAPS_TEXTURE | DDSCAPS_MIPMAP | DDSCAPS_COMPLEX
+
+		std::vector<std::byte> dds(sizeof(header) + texelBytes);
+		std::memcpy(dds.data(), header, sizeof(header));
+		uint32 state = seed * 747796405u + 2891336453u;
+		for (std::size_t i = sizeof(header); i + 4 <= dds.size(); i += 4)
+		{
+			state = state * 1664525u + 1013904223u;
+			std::memcpy(&dds[i], &state, 4);
+		}
+		return dds;
+	}
+
+	// Evicts the file from the page cache so the next run reads it from
+	// disk.  Only done on POSIX; on Windows every run after the first is warm.
+	void EvictFromCache(const char* path)
+	{
+#ifndef _WIN32
+		int fd = open(path, O_RDONLY);
+		if (fd >= 0)
+		{
+			posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+			close(fd);
+		}
+#else
+		(void)path;
+#endif
+	}
+
+	// Half of the bytes in meshes from the procedural generators, half in
+	// 512x512 textures, as a level would be.
+	bool WriteSyntheticArchive(const char* archivePath, std::size_t targetBytes)
+	{
+		AssetArchiveBuilder builder;
+		CreateGeometry geoGen;
+		uint32 index = 0;
+		while (builder.GetBlobBytes() < targetBytes)
+		{
+			std::string name = "asset" + std::to_string(index);
+			if (index % 2 == 0)
+			{
+				builder.AddTexture(name, MakeDds(512, index));
+			}
+			else
+			{
+				uint32 slices = 32 + (index * 7) % 96;
+				CreateGeometry::MeshData sphere = geoGen.CreateSphere(1.0f, slices, slices);
+				CreateGeometry::MeshData grid = geoGen.CreateGrid(10.0f, 10.0f, slices, slices);
+
+				// Two submeshes in one vertex/index stream, as MeshPacker pages are.
+				CreateGeometry::MeshData mesh = sphere;
+				mesh.Vertices.insert(mesh.Vertices.end(), grid.Vertices.begin(), grid.Vertices.end());
+				mesh.Indices32.insert(mesh.Indices32.end(), grid.Indices32.begin(), grid.Indices32.end());
+				std::vector<AssetArchiveBuilder::Submesh> submeshes;
+				submeshes.push_back(MakeSubmesh("sphere", mesh, 0, (uint32)sphere.Indices32.size(), 0));
+				submeshes.push_back(MakeSubmesh("grid", mesh, (uint32)sphere.Indices32.size(), (uint32)grid.Indices32.size(), (int)sphere.Vertices.size()));
+
+				uint32 indexByteStride;
+				std::vector<std::byte> indices = PackIndices(mesh.Indices32, (uint32)mesh.Vertices.size(), indexByteStride);
+				builder.AddMesh(name, sizeof(CreateGeometry::Vertex), AsBytes(mesh.Vertices), indexByteStride, indices, submeshes);
+			}
+			index++;
+		}
+		return builder.Write(archivePath);
+	}
+
+	// Time-to-ready: from nothing open to every asset copied into a staging
+	// buffer, the last CPU step before the upload heap.  The staging buffer
+	// stands in for the mapped upload heap and is reused for every asset.
+	double LoadArchive(const char* archivePath, std::vector<std::byte>& staging, std::size_t& bytes)
+	{
+		auto start = Clock::now();
+		AssetArchive archive;
+		if (!archive.Open(archivePath))
+			return -1.0;
+
+		bytes = 0;
+		for (const ArchiveEntry& entry : archive.GetEntries())
+		{
+			AssetArchive::MeshView mesh;
+			if (archive.GetMesh(entry, mesh))
+			{
+				std::memcpy(staging.data(), mesh.Vertices.data(), mesh.Vertices.size());
+				std::memcpy(staging.data() + mesh.Vertices.size(), mesh.Indices.data(), mesh.Indices.size());
+				bytes += mesh.Vertices.size() + mesh.Indices.size();
+			}
+			else
+			{
+				std::span<const std::byte> blob = archive.GetBlob(entry);
+				std::memcpy(staging.data(), blob.data(), blob.size());
+				bytes += blob.size();
+			}
+		}
+		return MillisecondsSince(start);
+	}
+
+	// The path the archive replaces: every asset read into a buffer of its
+	// own, copied into the CPU-side blob MeshGeometry kept, then staged.
+	double LoadStreams(const char* archivePath, std::vector<std::byte>& staging, std::size_t& bytes)
+	{
+		AssetArchive toc;
+		if (!toc.Open(archivePath))
+			return -1.0;
+		std::vector<ArchiveEntry> entries(toc.GetEntries().begin(), toc.GetEntries().end());
+		toc.Close();
+
+		auto start = Clock::now();
+		std::ifstream fin(archivePath, std::ios::binary);
+		bytes = 0;
+		for (const ArchiveEntry& entry : entries)
+		{
+			std::vector<std::byte> file((std::size_t)entry.Size);
+			fin.seekg((std::streamoff)entry.Offset);
+			fin.read(reinterpret_cast<char*>(file.data()), (std::streamsize)file.size());
+			std::vector<std::byte> blob(file);
+			std::memcpy(staging.data(), blob.data(), blob.size());
+			bytes += blob.size();
+		}
+		return fin ? MillisecondsSince(start) : -1.0;
+	}
+
+	int Bench(const char* archivePath, std::size_t megabytes)
+	{
+		auto writeStart = Clock::now();
+		if (!WriteSyntheticArchive(archivePath, megabytes << 20))
+		{
+			std::fprintf(stderr, "%s: could not be written\n", archivePath);
+			return 1;
+		}
+		std::printf("wrote %s (%zu MB) in %.0f ms\n", archivePath, megabytes, MillisecondsSince(writeStart));
+
+		AssetArchive archive;
+		archive.Open(archivePath);
+		std::size_t largest = 0;
+		for (const ArchiveEntry& entry : archive.GetEntries())
+			largest = std::max(largest, (std::size_t)entry.Size);
+		std::printf("%zu assets, largest %zu KB\n", archive.GetEntries().size(), largest >> 10);
+		archive.Close();
+
+		std::vector<std::byte> staging(largest);
+		const int Runs = 3;
+		for (int cold = 1; cold >= 0; cold--)
+		{
+			double best[2] = { 1e30, 1e30 };
+			std::size_t bytes[2] = {};
+			for (int run = 0; run < Runs; run++)
+			{
+				if (cold)
+					EvictFromCache(archivePath);
+				best[0] = std::min(best[0], LoadArchive(archivePath, staging, bytes[0]));
+				if (cold)
+					EvictFromCache(archivePath);
+				best[1] = std::min(best[1], LoadStreams(archivePath, staging, bytes[1]));
+			}
+			const char* names[2] = { "archive (mapped views)", "per-asset reads + blob copy" };
+			for (int i = 0; i < 2; i++)
+			{
+				std::printf("%s %-28s %8.1f ms  %7.0f MB/s\n", cold ? "cold" : "warm", names[i], best[i],
+					bytes[i] / (1024.0 * 1024.0) / (best[i] / 1000.0));
+			}
+		}
+		return 0;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc >= 3 && std::strcmp(argv[1], "--list") == 0)
+		return List(argv[2]);
+	if (argc >= 3 && std::strcmp(argv[1], "--bench") == 0)
+		return Bench(argv[2], argc >= 4 ? (std::size_t)std::strtoull(argv[3], nullptr, 10) : 1024);
+	if (argc >= 3 && argv[1][0] != '-')
+		return Pack(argv[1], argc - 2, argv + 2);
+
+	std::fprintf(stderr,
+		"usage: AssetPacker <archive> <file.obj|file.dds>...\n"
+		"       AssetPacker --list <archive>\n"
+		"       AssetPacker --bench <archive> [megabytes]\n");
+	return 1;
+}
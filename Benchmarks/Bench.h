@@ -0,0 +1,60 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Shared helpers of the benchmark executables.  Each benchmark prints a
+// table; the numbers only compare runs on the same machine and build.
+namespace Bench
+{
+	using uint32 = std::uint32_t;
+	using Clock = std::chrono::steady_clock;
+
+	// Median wall time of one call of f over runs calls, in milliseconds.
+	template<typename F>
+	double MedianMilliseconds(uint32 runs, F&& f)
+	{
+		std::vector<double> times(runs);
+		for (uint32 r = 0; r < runs; r++)
+		{
+			Clock::time_point start = Clock::now();
+			f();
+			times[r] = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		}
+		std::sort(times.begin(), times.end());
+		return times[(runs - 1) / 2];
+	}
+
+	// Written by Consume.  A volatile store at namespace scope is never
+	// dropped, and unlike a function-local one it draws no set-but-unused
+	// warning.
+	inline volatile double Sink = 0.0;
+
+	// Keeps a result alive, so the work that produced it is not optimized away.
+	inline void Consume(double value)
+	{
+		Sink = value;
+	}
+
+	// "1000,10000" to { 1000, 10000 }.  False if any item is not a number.
+	inline bool ParseCounts(const char* text, std::vector<uint32>& counts)
+	{
+		counts.clear();
+		std::istringstream list(text);
+		std::string item;
+		while (std::getline(list, item, ','))
+		{
+			char* end = nullptr;
+			unsigned long count = std::strtoul(item.c_str(), &end, 10);
+			if (end == item.c_str() || *end != 0)
+				return false;
+			counts.push_back((uint32)count);
+		}
+		return !counts.empty();
+	}
+}
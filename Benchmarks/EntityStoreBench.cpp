@@ -0,0 +1,148 @@
+// EntityStoreBench: per-frame entity loops over EntityStore against the
+// layout it replaced, one heap-allocated RenderItem per entity.
+//
+//   EntityStoreBench [N[,N...]]    entity counts, 10000,100000 by default
+//
+// A frame is the three loops every entity goes through: movement by kind,
+// projectile timers, and copying the transform out for the GPU.  Nine
+// entities in ten are asteroids, the rest projectiles.
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Bench.h"
+#include "../EntityStore.h"
+
+using namespace DirectX;
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	const uint32 Runs = 51;
+	const float Step = 0.01f;
+
+	// The fields of the old RenderItem, in their old order; the Transform base
+	// had no data.  Each one owned an UploadBuffer, allocated right after it,
+	// that its world matrix was copied to every frame.
+	struct LegacyRenderItem
+	{
+		XMFLOAT4X4 World;
+		unsigned ObjCBIndex = 0;
+		std::string Type;
+		void* Geo = nullptr;
+		bool gameOver = false;
+		bool RemoveAsteroid = false;
+		bool dontMove = false;
+		float Timer = 0.0f;
+		int lifeTime = 0;
+		int PrimitiveType = 0;
+		std::unique_ptr<XMFLOAT4X4> mObjectCB;
+		unsigned IndexCount = 0;
+		unsigned StartIndexLocation = 0;
+		int BaseVertexLocation = 0;
+	};
+
+	struct InstanceData
+	{
+		XMFLOAT3 Position;
+		XMFLOAT4 Rotation;
+	};
+
+	bool IsProjectile(uint32 i)
+	{
+		return i % 10 == 9;
+	}
+
+	double LegacyFrame(std::vector<std::unique_ptr<LegacyRenderItem>>& items)
+	{
+		for (auto& item : items)
+		{
+			if (item->Type == "asteroid")
+				item->World._43 -= Step;
+			else if (item->Type == "projectile")
+				item->World._43 += Step;
+		}
+		for (auto& item : items)
+		{
+			if (item->Type == "projectile")
+				item->Timer += Step;
+		}
+		for (auto& item : items)
+			*item->mObjectCB = item->World;
+		return items.back()->mObjectCB->_43;
+	}
+
+	double StoreFrame(EntityStore& store, std::vector<InstanceData>& instances)
+	{
+		uint32 count = store.Size();
+		for (uint32 i = 0; i < count; i++)
+		{
+			if (store.Kind[i] == EntityKind::Asteroid)
+				store.Position[i].z -= Step;
+			else if (store.Kind[i] == EntityKind::Projectile)
+				store.Position[i].z += Step;
+		}
+		for (uint32 i = 0; i < count; i++)
+		{
+			if (store.Kind[i] == EntityKind::Projectile)
+				store.Timer[i] += Step;
+		}
+		for (uint32 i = 0; i < count; i++)
+		{
+			instances[i].Position = store.Position[i];
+			instances[i].Rotation = store.Rotation[i];
+		}
+		return instances[count - 1].Position.z;
+	}
+
+	void Run(uint32 count)
+	{
+		std::vector<std::unique_ptr<LegacyRenderItem>> items;
+		items.reserve(count);
+		for (uint32 i = 0; i < count; i++)
+		{
+			auto item = std::make_unique<LegacyRenderItem>();
+			XMStoreFloat4x4(&item->World, XMMatrixIdentity());
+			item->World._43 = (float)i;
+			item->Type = IsProjectile(i) ? "projectile" : "asteroid";
+			item->mObjectCB = std::make_unique<XMFLOAT4X4>();
+			items.push_back(std::move(item));
+		}
+
+		EntityStore store;
+		store.CreatePool(EntityKind::Asteroid, count);
+		store.CreatePool(EntityKind::Projectile, count);
+		for (uint32 i = 0; i < count; i++)
+		{
+			EntityKind kind = IsProjectile(i) ? EntityKind::Projectile : EntityKind::Asteroid;
+			store.Add(kind, 0, XMFLOAT3(0.0f, 0.0f, (float)i), XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+		}
+		std::vector<InstanceData> instances(count);
+
+		double legacy = Bench::MedianMilliseconds(Runs, [&]() { Bench::Consume(LegacyFrame(items)); });
+		double soa = Bench::MedianMilliseconds(Runs, [&]() { Bench::Consume(StoreFrame(store, instances)); });
+		printf("  %9u %12.3f %12.3f %9.1fx %10.1f %10.1f\n", count, legacy, soa, legacy / soa,
+			1e6 * legacy / count, 1e6 * soa / count);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<uint32> counts = { 10000, 100000 };
+	if (argc > 2 || (argc == 2 && !Bench::ParseCounts(argv[1], counts)))
+	{
+		fprintf(stderr, "usage: EntityStoreBench [N[,N...]]\n");
+		return 1;
+	}
+
+	printf("frame of move + timers + transform copy, median of %u runs\n", Runs);
+	printf("  %9s %12s %12s %10s %10s %10s\n", "entities", "legacy ms", "store ms", "speedup", "legacy ns", "store ns");
+	for (uint32 count : counts)
+	{
+		if (count > 0)
+			Run(count);
+	}
+	return 0;
+}
@@ -0,0 +1,98 @@
+// FrustumCullerBench: the culling kernel of BoxApp::BuildRenderQueue, four
+// spheres per XMVECTOR, against one sphere at a time in plain floats.
+//
+//   FrustumCullerBench [N[,N...]]    spheres, 10000,100000,1000000 by default
+//
+// Spheres are spread at random around and in front of the camera, so about
+// a third of them are visible and the visible list is part of the cost.
+// Both loops use the planes of FrustumCuller::ExtractPlanes.
+
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Bench.h"
+#include "../FrustumCuller.h"
+
+using namespace DirectX;
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	const uint32 Runs = 51;
+
+	void CullScalar(const FrustumCuller& culler, const XMFLOAT4 planes[6], std::vector<uint32>& visible)
+	{
+		for (uint32 i = 0; i < culler.Size(); i++)
+		{
+			bool inside = true;
+			for (int p = 0; p < 6; p++)
+			{
+				float distance = culler.CenterX[i] * planes[p].x + culler.CenterY[i] * planes[p].y
+					+ culler.CenterZ[i] * planes[p].z + planes[p].w;
+				inside = inside && distance >= -culler.Radius[i];
+			}
+			if (inside)
+				visible.push_back(i);
+		}
+	}
+
+	void Run(uint32 count)
+	{
+		std::mt19937 rng(count);
+		std::uniform_real_distribution<float> position(-400.0f, 400.0f);
+		std::uniform_real_distribution<float> radius(0.5f, 5.0f);
+		FrustumCuller culler;
+		culler.Resize(count);
+		for (uint32 i = 0; i < count; i++)
+		{
+			culler.CenterX[i] = position(rng);
+			culler.CenterY[i] = position(rng);
+			culler.CenterZ[i] = position(rng) + 400.0f;
+			culler.Radius[i] = radius(rng);
+		}
+
+		XMMATRIX viewProj = XMMatrixMultiply(XMMatrixTranslation(0.0f, 0.0f, 10.0f),
+			XMMatrixPerspectiveFovLH(0.25f * 3.1415926535f, 4.0f / 3.0f, 1.0f, 1000.0f));
+		XMFLOAT4 planes[6];
+		FrustumCuller::ExtractPlanes(viewProj, planes);
+
+		std::vector<uint32> visible;
+		visible.reserve(count);
+		double wide = Bench::MedianMilliseconds(Runs, [&]()
+		{
+			visible.clear();
+			culler.Cull(viewProj, visible);
+		});
+		size_t visibleCount = visible.size();
+		double scalar = Bench::MedianMilliseconds(Runs, [&]()
+		{
+			visible.clear();
+			CullScalar(culler, planes, visible);
+		});
+		if (visible.size() != visibleCount)
+			printf("  mismatch: %zu visible with the 4-wide loop, %zu with the scalar one\n", visibleCount, visible.size());
+
+		printf("  %9u %8.1f%% %10.3f %10.3f %13.2f %13.2f %8.2fx\n", count, 100.0 * visibleCount / count, wide, scalar,
+			1e6 * wide / count, 1e6 * scalar / count, scalar / wide);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<uint32> counts = { 10000, 100000, 1000000 };
+	if (argc > 2 || (argc == 2 && !Bench::ParseCounts(argv[1], counts)))
+	{
+		fprintf(stderr, "usage: FrustumCullerBench [N[,N...]]\n");
+		return 1;
+	}
+
+	printf("frustum culling, median of %u runs\n", Runs);
+	printf("  %9s %9s %10s %10s %13s %13s %9s\n", "spheres", "visible", "4-wide ms", "scalar ms", "4-wide ns/sph", "scalar ns/sph", "speedup");
+	for (uint32 count : counts)
+	{
+		if (count > 0)
+			Run(count);
+	}
+	return 0;
+}
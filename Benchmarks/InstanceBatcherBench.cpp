@@ -0,0 +1,87 @@
+// InstanceBatcherBench: the per-frame draw list build of BoxApp::Draw, fill
+// and radix sort the render queue then turn it into instanced batches.
+//
+//   InstanceBatcherBench [N[,N...]]  visible entities, 1000,10000,100000 by
+//                                    default
+//
+// Entities are spread at random over 16 submeshes and a depth range, with
+// sparse slots as after removals; the entity set and depths are fixed, so
+// every run sorts the same keys.  The draw count is the batch count.
+
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Bench.h"
+#include "../InstanceBatcher.h"
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	const uint32 Runs = 51;
+	const uint32 SubmeshCount = 16;
+	const float NearZ = 1.0f;
+	const float FarZ = 1000.0f;
+
+	void Run(uint32 count)
+	{
+		std::mt19937 rng(count);
+		std::vector<uint32> submeshes(count);
+		std::vector<float> depths(count);
+		std::vector<uint32> renderItems(count);
+		std::vector<uint32> slots(count);
+		for (uint32 i = 0; i < count; i++)
+		{
+			submeshes[i] = rng() % SubmeshCount;
+			depths[i] = NearZ + (FarZ - NearZ) * (float)(rng() % 65536) / 65536.0f;
+			renderItems[i] = submeshes[i];
+			slots[i] = (uint32)(((unsigned long long)i * 2654435761u) % (2ull * count));
+		}
+
+		RenderQueue queue;
+		queue.Reserve(count);
+		InstanceBatcher batcher;
+
+		double fill = Bench::MedianMilliseconds(Runs, [&]()
+		{
+			queue.Clear();
+			for (uint32 i = 0; i < count; i++)
+				queue.Push(RenderQueue::MakeKey(RenderLayer::Opaque, 0, 0, submeshes[i], depths[i], NearZ, FarZ), i);
+			Bench::Consume((double)queue.Size());
+		});
+		double sort = Bench::MedianMilliseconds(Runs, [&]()
+		{
+			queue.Clear();
+			for (uint32 i = 0; i < count; i++)
+				queue.Push(RenderQueue::MakeKey(RenderLayer::Opaque, 0, 0, submeshes[i], depths[i], NearZ, FarZ), i);
+			queue.Sort();
+		}) - fill;
+		double build = Bench::MedianMilliseconds(Runs, [&]()
+		{
+			batcher.Build(queue, renderItems, slots);
+			Bench::Consume((double)batcher.GetBatches().size());
+		});
+
+		printf("  %9u %10.3f %10.3f %10.3f %10.3f %12.1f %8zu\n", count, fill, sort, build, fill + sort + build,
+			1e6 * (fill + sort + build) / count, batcher.GetBatches().size());
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<uint32> counts = { 1000, 10000, 100000 };
+	if (argc > 2 || (argc == 2 && !Bench::ParseCounts(argv[1], counts)))
+	{
+		fprintf(stderr, "usage: InstanceBatcherBench [N[,N...]]\n");
+		return 1;
+	}
+
+	printf("one frame over %u submeshes, median of %u runs\n", SubmeshCount, Runs);
+	printf("  %9s %10s %10s %10s %10s %12s %8s\n", "entities", "fill ms", "sort ms", "build ms", "total ms", "ns/entity", "draws");
+	for (uint32 count : counts)
+	{
+		if (count > 0)
+			Run(count);
+	}
+	return 0;
+}
@@ -0,0 +1,143 @@
+// JobSystemBench: scaling of a synthetic per-tick entity update over
+// JobSystem::ParallelFor, from one thread to the machine's thread count.
+//
+//   JobSystemBench [T[,T...]]        thread counts, 1,2,4,... up to the
+//                                    hardware thread count by default
+//
+// 100k entities as struct-of-arrays: integrate velocity with drag, spin an
+// orientation quaternion and renormalize it, wrap the position into the
+// play area and count down a lifetime.  The update is run 10 times per
+// measurement, as 10 ticks, over a range split in grains of 256.  "plain
+// loop" is the same update without the job system.
+
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "Bench.h"
+#include "../JobSystem.h"
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	const uint32 Runs = 21;
+	const uint32 EntityCount = 100000;
+	const uint32 TicksPerRun = 10;
+	const uint32 GrainSize = 256;
+	const float Dt = 1.0f / 60.0f;
+	const float HalfExtent = 500.0f;
+
+	struct Entities
+	{
+		std::vector<float> X, Y, Z;
+		std::vector<float> VX, VY, VZ;
+		std::vector<float> QX, QY, QZ, QW;
+		std::vector<float> Life;
+
+		explicit Entities(uint32 count) :
+			X(count), Y(count), Z(count), VX(count), VY(count), VZ(count),
+			QX(count), QY(count), QZ(count), QW(count, 1.0f), Life(count)
+		{
+			for (uint32 i = 0; i < count; i++)
+			{
+				X[i] = (float)(i % 1000) - HalfExtent;
+				Y[i] = (float)(i % 7) * 10.0f;
+				Z[i] = (float)(i / 1000) * 5.0f - HalfExtent;
+				VX[i] = (float)(i % 13) - 6.0f;
+				VY[i] = (float)(i % 5) - 2.0f;
+				VZ[i] = (float)(i % 11) - 5.0f;
+				Life[i] = 1000.0f + (float)(i % 100);
+			}
+		}
+
+		void Update(uint32 begin, uint32 end)
+		{
+			const float drag = 1.0f - 0.1f * Dt;
+			for (uint32 i = begin; i < end; i++)
+			{
+				VX[i] *= drag;
+				VY[i] = VY[i] * drag - 9.8f * Dt;
+				VZ[i] *= drag;
+				X[i] += VX[i] * Dt;
+				Y[i] += VY[i] * Dt;
+				Z[i] += VZ[i] * Dt;
+
+				// Spin about y by an angle that depends on the speed.
+				float angle = 0.5f * Dt * std::sqrt(VX[i] * VX[i] + VZ[i] * VZ[i]);
+				float s = std::sin(angle);
+				float c = std::cos(angle);
+				float qx = c * QX[i] - s * QZ[i];
+				float qy = c * QY[i] + s * QW[i];
+				float qz = c * QZ[i] + s * QX[i];
+				float qw = c * QW[i] - s * QY[i];
+				float invLength = 1.0f / std::sqrt(qx * qx + qy * qy + qz * qz + qw * qw);
+				QX[i] = qx * invLength;
+				QY[i] = qy * invLength;
+				QZ[i] = qz * invLength;
+				QW[i] = qw * invLength;
+
+				if (X[i] < -HalfExtent) X[i] += 2.0f * HalfExtent;
+				if (X[i] > HalfExtent) X[i] -= 2.0f * HalfExtent;
+				if (Z[i] < -HalfExtent) Z[i] += 2.0f * HalfExtent;
+				if (Z[i] > HalfExtent) Z[i] -= 2.0f * HalfExtent;
+				if (Y[i] < 0.0f) { Y[i] = -Y[i]; VY[i] = -VY[i]; }
+				Life[i] -= Dt;
+			}
+		}
+	};
+}
+
+int main(int argc, char** argv)
+{
+	uint32 hardwareThreads = std::thread::hardware_concurrency();
+	if (hardwareThreads == 0)
+		hardwareThreads = 1;
+
+	std::vector<uint32> threadCounts;
+	for (uint32 threads = 1; threads < hardwareThreads; threads *= 2)
+		threadCounts.push_back(threads);
+	threadCounts.push_back(hardwareThreads);
+	if (argc > 2 || (argc == 2 && !Bench::ParseCounts(argv[1], threadCounts)))
+	{
+		fprintf(stderr, "usage: JobSystemBench [T[,T...]]\n");
+		return 1;
+	}
+
+	printf("%u entities, %u ticks per run, grain %u, %u hardware threads, median of %u runs\n",
+		EntityCount, TicksPerRun, GrainSize, hardwareThreads, Runs);
+	printf("  %-12s %10s %10s %9s %11s\n", "threads", "ms/tick", "ns/entity", "speedup", "efficiency");
+
+	Entities entities(EntityCount);
+	double plain = Bench::MedianMilliseconds(Runs, [&]()
+	{
+		for (uint32 tick = 0; tick < TicksPerRun; tick++)
+			entities.Update(0, EntityCount);
+	}) / TicksPerRun;
+	printf("  %-12s %10.3f %10.2f\n", "plain loop", plain, 1e6 * plain / EntityCount);
+
+	auto measure = [&](uint32 threads)
+	{
+		JobSystem jobs(threads);
+		auto update = [&](uint32 begin, uint32 end) { entities.Update(begin, end); };
+		return Bench::MedianMilliseconds(Runs, [&]()
+		{
+			for (uint32 tick = 0; tick < TicksPerRun; tick++)
+				jobs.ParallelFor(0, EntityCount, GrainSize, update);
+		}) / TicksPerRun;
+	};
+
+	// Speedup is against the job system on one thread.
+	double oneThread = measure(1);
+	for (uint32 threads : threadCounts)
+	{
+		if (threads == 0)
+			continue;
+
+		double ms = threads == 1 ? oneThread : measure(threads);
+		printf("  %-12u %10.3f %10.2f %8.2fx %10.0f%%\n", threads, ms, 1e6 * ms / EntityCount,
+			oneThread / ms, 100.0 * oneThread / ms / threads);
+	}
+	Bench::Consume(entities.Life[0]);
+	return 0;
+}
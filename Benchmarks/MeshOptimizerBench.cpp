@@ -0,0 +1,82 @@
+// MeshOptimizerBench: the three MeshOptimizer passes on generated meshes,
+// with the FIFO cache figures before and after.
+//
+//   MeshOptimizerBench [N[,N...]]    sphere slice and stack counts,
+//                                    64,256 by default
+//
+// Every count gives a sphere of N x N, plus the 380 x 250 projectile
+// cylinder and a 512 x 512 grid once.  Times are for the full pipeline of
+// MeshOptimizer::Optimize with overdraw ordering, split by pass, and
+// include restoring that pass's input (indices, and vertices for fetch).
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Bench.h"
+#include "../MeshOptimizer.h"
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using Mesh = CreateGeometry::MeshData;
+
+	const uint32 Runs = 11;
+
+	void Run(const char* name, const Mesh& source)
+	{
+		uint32 vertexCount = (uint32)source.Vertices.size();
+		MeshOptimizer::VertexCacheStats before = MeshOptimizer::AnalyzeVertexCache(source.Indices32, vertexCount);
+
+		Mesh mesh = source;
+		std::vector<uint32> clusters;
+		double cache = Bench::MedianMilliseconds(Runs, [&]()
+		{
+			mesh.Indices32 = source.Indices32;
+			MeshOptimizer::OptimizeVertexCache(mesh.Indices32, vertexCount, MeshOptimizer::DefaultCacheSize, &clusters);
+		});
+		std::vector<uint32> cacheOrder = mesh.Indices32;
+		double overdraw = Bench::MedianMilliseconds(Runs, [&]()
+		{
+			mesh.Indices32 = cacheOrder;
+			MeshOptimizer::OptimizeOverdraw(mesh.Indices32, clusters, &mesh.Vertices[0].Position, sizeof(CreateGeometry::Vertex), vertexCount);
+		});
+		std::vector<uint32> overdrawOrder = mesh.Indices32;
+		double fetch = Bench::MedianMilliseconds(Runs, [&]()
+		{
+			mesh.Vertices = source.Vertices;
+			mesh.Indices32 = overdrawOrder;
+			MeshOptimizer::OptimizeVertexFetch(mesh);
+		});
+		MeshOptimizer::VertexCacheStats after = MeshOptimizer::AnalyzeVertexCache(mesh.Indices32, (uint32)mesh.Vertices.size());
+
+		uint32 triangles = (uint32)source.Indices32.size() / 3;
+		printf("  %-18s %8u %6.3f %6.3f %6.3f %6.3f %9.3f %9.3f %9.3f %9.1f\n", name, triangles,
+			before.ACMR, after.ACMR, before.ATVR, after.ATVR, cache, overdraw, fetch, 1e6 * (cache + overdraw + fetch) / triangles);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<uint32> counts = { 64, 256 };
+	if (argc > 2 || (argc == 2 && !Bench::ParseCounts(argv[1], counts)))
+	{
+		fprintf(stderr, "usage: MeshOptimizerBench [N[,N...]]\n");
+		return 1;
+	}
+
+	printf("FIFO cache of %u, median of %u runs\n", MeshOptimizer::DefaultCacheSize, Runs);
+	printf("  %-18s %8s %6s %6s %6s %6s %9s %9s %9s %9s\n", "mesh", "tris", "ACMR", "->", "ATVR", "->",
+		"cache ms", "odraw ms", "fetch ms", "ns/tri");
+
+	CreateGeometry geometry;
+	for (uint32 count : counts)
+	{
+		if (count < 3)
+			continue;
+		std::string name = "sphere " + std::to_string(count);
+		Run(name.c_str(), geometry.CreateSphere(1.0f, count, count));
+	}
+	Run("cylinder 380x250", geometry.CreateCylinder(0.5f, 0.5f, 3.0f, 380, 250));
+	Run("grid 512", geometry.CreateGrid(100.0f, 100.0f, 512, 512));
+	return 0;
+}
@@ -0,0 +1,79 @@
+// MeshSimplifierBench: MeshSimplifier::Simplify on large generated meshes.
+//
+//   MeshSimplifierBench [N[,N...]]   approximate input triangle counts,
+//                                    100000,1000000 by default
+//
+// Every count gives a wavy grid (no flat regions, open border) and a sphere
+// (a UV seam and two poles), each reduced to 50% and 10% of its triangles
+// with no error bound.  The time includes copying the mesh in and the
+// vertex compaction of Simplify.
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "Bench.h"
+#include "../MeshSimplifier.h"
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using Mesh = CreateGeometry::MeshData;
+
+	const uint32 Runs = 3;
+	const float NoErrorBound = 1e30f;
+
+	void Run(const char* name, const Mesh& source)
+	{
+		uint32 triangles = (uint32)source.Indices32.size() / 3;
+		for (uint32 percent : { 50u, 10u })
+		{
+			uint32 target = (uint32)((unsigned long long)triangles * percent / 100);
+			MeshSimplifier::Result result;
+			double ms = Bench::MedianMilliseconds(Runs, [&]()
+			{
+				Mesh mesh = source;
+				result = MeshSimplifier::Simplify(mesh, target, NoErrorBound);
+			});
+			printf("  %-10s %9u %5u%% %9u %12.3g %10.1f %8.0f\n", name, triangles, percent, result.TriangleCount,
+				result.Error, ms, 1e6 * ms / triangles);
+		}
+	}
+
+	Mesh WavyGrid(uint32 triangles)
+	{
+		uint32 side = (uint32)std::sqrt(triangles / 2.0) + 1;
+		CreateGeometry geometry;
+		Mesh mesh = geometry.CreateGrid(100.0f, 100.0f, side, side);
+		for (CreateGeometry::Vertex& v : mesh.Vertices)
+			v.Position.y = 2.0f * std::sin(0.3f * v.Position.x) * std::cos(0.2f * v.Position.z);
+		return mesh;
+	}
+
+	Mesh Sphere(uint32 triangles)
+	{
+		uint32 side = (uint32)std::sqrt(triangles / 2.0) + 1;
+		CreateGeometry geometry;
+		return geometry.CreateSphere(1.0f, side, side);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<uint32> counts = { 100000, 1000000 };
+	if (argc > 2 || (argc == 2 && !Bench::ParseCounts(argv[1], counts)))
+	{
+		fprintf(stderr, "usage: MeshSimplifierBench [N[,N...]]\n");
+		return 1;
+	}
+
+	printf("quadric edge collapse, median of %u runs\n", Runs);
+	printf("  %-10s %9s %6s %9s %12s %10s %8s\n", "mesh", "tris", "target", "result", "error", "ms", "ns/tri");
+	for (uint32 count : counts)
+	{
+		if (count < 100)
+			continue;
+		Run("wavy grid", WavyGrid(count));
+		Run("sphere", Sphere(count));
+	}
+	return 0;
+}
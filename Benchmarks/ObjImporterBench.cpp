@@ -0,0 +1,132 @@
+// ObjImporterBench: throughput of ObjImporter::Load on a generated OBJ of
+// several million triangles, per ThreadPool worker count.
+//
+//   ObjImporterBench [W[,W...]]      worker counts, 1,2,4,... up to the
+//                                    hardware thread count by default
+//
+// The file is a 1400x1400 quad grid over a wavy height field, written the
+// way exporters usually do: every vertex has its own v, vt and vn line and
+// every quad is an "f v/t/n v/t/n v/t/n v/t/n" line, about 3.9M triangles
+// and 330 MB.  It is written once to the temporary directory and loaded
+// once before timing, so the runs read it from the page cache.  The thread
+// that calls Load waits on the pool and helps it, so W workers are W + 1
+// threads.  MB/s is the file size over the whole Load.
+
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Bench.h"
+#include "../ObjImporter.h"
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	const uint32 Runs = 5;
+	const uint32 GridQuads = 1400;
+
+	bool WriteObj(const std::string& path)
+	{
+		FILE* file = fopen(path.c_str(), "wb");
+		if (file == nullptr)
+			return false;
+
+		std::vector<char> buffer(1 << 20);
+		setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+		fprintf(file, "# ObjImporterBench grid\nmtllib grid.mtl\no grid\nusemtl ground\n");
+
+		const uint32 side = GridQuads + 1;
+		for (uint32 z = 0; z < side; z++)
+		{
+			for (uint32 x = 0; x < side; x++)
+			{
+				float px = (float)x * 0.1f;
+				float pz = (float)z * 0.1f;
+				float py = 0.5f * std::sin(px) * std::cos(pz);
+				float nx = -0.5f * std::cos(px) * std::cos(pz);
+				float nz = 0.5f * std::sin(px) * std::sin(pz);
+				float length = std::sqrt(nx * nx + 1.0f + nz * nz);
+				fprintf(file, "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n",
+					px, py, pz, (float)x / GridQuads, (float)z / GridQuads, nx / length, 1.0f / length, nz / length);
+			}
+		}
+		for (uint32 z = 0; z < GridQuads; z++)
+		{
+			for (uint32 x = 0; x < GridQuads; x++)
+			{
+				uint32 a = z * side + x + 1;
+				uint32 b = a + side;
+				fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, b + 1, b + 1, b + 1, a + 1, a + 1, a + 1);
+			}
+		}
+		return fclose(file) == 0;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	uint32 hardwareThreads = std::thread::hardware_concurrency();
+	if (hardwareThreads == 0)
+		hardwareThreads = 1;
+
+	std::vector<uint32> workerCounts;
+	for (uint32 workers = 1; workers < hardwareThreads; workers *= 2)
+		workerCounts.push_back(workers);
+	workerCounts.push_back(hardwareThreads);
+	if (argc > 2 || (argc == 2 && !Bench::ParseCounts(argv[1], workerCounts)))
+	{
+		fprintf(stderr, "usage: ObjImporterBench [W[,W...]]\n");
+		return 1;
+	}
+
+	std::string path = (std::filesystem::temp_directory_path() / "ObjImporterBench.obj").string();
+	if (!WriteObj(path))
+	{
+		fprintf(stderr, "could not write %s\n", path.c_str());
+		return 1;
+	}
+
+	ObjImporter::Stats stats;
+	{
+		ThreadPool pool(1);
+		ObjModel<CreateGeometry::DefaultFormat> model;
+		if (!ObjImporter::Load(path.c_str(), pool, model, CreateGeometry::DefaultFormat(), &stats))
+		{
+			fprintf(stderr, "could not load %s\n", path.c_str());
+			return 1;
+		}
+	}
+	double megabytes = (double)stats.Bytes / (1 << 20);
+	printf("%.0f MB, %u triangles, %u vertices, %u hardware threads, median of %u runs\n",
+		megabytes, stats.Triangles, stats.Vertices, hardwareThreads, Runs);
+	printf("  %-8s %7s %10s %10s %10s %9s %8s\n", "workers", "chunks", "parse ms", "dedup ms", "total ms", "MB/s", "speedup");
+
+	double first = 0.0;
+	for (uint32 workers : workerCounts)
+	{
+		if (workers == 0)
+			continue;
+
+		ThreadPool pool(workers);
+		double parse = 0.0;
+		double dedup = 0.0;
+		double total = Bench::MedianMilliseconds(Runs, [&]()
+		{
+			ObjModel<CreateGeometry::DefaultFormat> model;
+			ObjImporter::Load(path.c_str(), pool, model, CreateGeometry::DefaultFormat(), &stats);
+			parse += stats.ParseMilliseconds;
+			dedup += stats.DedupMilliseconds;
+			Bench::Consume((double)model.Mesh.Indices32.back());
+		});
+		if (first == 0.0)
+			first = total;
+		printf("  %-8u %7u %10.1f %10.1f %10.1f %9.0f %7.2fx\n", workers, stats.Chunks,
+			parse / Runs, dedup / Runs, total, megabytes / (total / 1000.0), first / total);
+	}
+
+	std::filesystem::remove(path);
+	return 0;
+}
@@ -0,0 +1,83 @@
+// ProfilerBench: cost of one PROFILE_SCOPE, split into its timestamp reads
+// and the recording into the thread ring.
+//
+//   ProfilerBench [N[,N...]]         scopes per run, 1000000 by default
+//
+// Every run records N empty scopes on the calling thread and collects
+// every 8192 of them, as D3DApp::Run does once a frame; collecting is part
+// of the cost.  "overhead" is a scope minus two Profiler::Now() calls,
+// which is what the profiler adds on top of the timer itself.
+
+#include <cstdio>
+#include <vector>
+#include "Bench.h"
+#include "../Profiler.h"
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	const uint32 Runs = 21;
+	const uint32 CollectInterval = 8192;
+
+	void Run(uint32 count)
+	{
+		uint64 sum = 0;
+		double now = Bench::MedianMilliseconds(Runs, [&]()
+		{
+			for (uint32 i = 0; i < count; i++)
+				sum += Profiler::Now();
+		});
+		Bench::Consume((double)sum);
+
+		double record = Bench::MedianMilliseconds(Runs, [&]()
+		{
+			for (uint32 i = 0; i < count; i++)
+			{
+				Profiler::Record("record", i, i + 1);
+				if ((i & (CollectInterval - 1)) == CollectInterval - 1)
+					Profiler::Collect();
+			}
+			Profiler::Collect();
+		});
+
+		double scope = Bench::MedianMilliseconds(Runs, [&]()
+		{
+			for (uint32 i = 0; i < count; i++)
+			{
+				{
+					PROFILE_SCOPE("scope");
+				}
+				if ((i & (CollectInterval - 1)) == CollectInterval - 1)
+					Profiler::Collect();
+			}
+			Profiler::Collect();
+		});
+
+		double perNow = 1e6 * now / count;
+		double perScope = 1e6 * scope / count;
+		printf("  %9u %10.1f %10.1f %10.1f %10.1f\n", count, perNow, 1e6 * record / count, perScope, perScope - 2.0 * perNow);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<uint32> counts = { 1000000 };
+	if (argc > 2 || (argc == 2 && !Bench::ParseCounts(argv[1], counts)))
+	{
+		fprintf(stderr, "usage: ProfilerBench [N[,N...]]\n");
+		return 1;
+	}
+
+	printf("one thread, collect every %u scopes, median of %u runs, ns per call\n", CollectInterval, Runs);
+	printf("  %9s %10s %10s %10s %10s\n", "scopes", "Now", "Record", "scope", "overhead");
+	for (uint32 count : counts)
+	{
+		if (count > 0)
+			Run(count);
+	}
+	if (Profiler::GetDroppedCount() != 0)
+		printf("  %llu scopes dropped\n", (unsigned long long)Profiler::GetDroppedCount());
+	return 0;
+}
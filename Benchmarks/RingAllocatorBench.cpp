@@ -0,0 +1,106 @@
+// RingAllocatorBench: per-frame constant suballocation from one ring, over a
+// block of host memory standing in for the mapped upload buffer.
+//
+//   RingAllocatorBench [N[,N...]]    slices per frame, 1000,10000,100000 by
+//                                    default
+//
+// Every frame retires the frame the "GPU" finished three frames ago, takes
+// N 256-byte aligned slices, optionally copies a 64-byte matrix into each
+// (what UploadRing::PushConstants does), and closes the frame with a fence.
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "Bench.h"
+#include "../RingAllocator.h"
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	const uint32 Runs = 51;
+	const uint32 FramesInFlight = 3;
+	// D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, and the size of one
+	// 64-byte ObjectConstants rounded up to it.
+	const uint64 SliceAlignment = 256;
+	const uint64 SliceSize = 256;
+
+	struct Matrix
+	{
+		float m[16];
+	};
+
+	class FrameLoop
+	{
+	public:
+		FrameLoop(uint32 slices) :
+			mRing(SliceSize * slices * (FramesInFlight + 1), FramesInFlight + 1),
+			mMemory(mRing.Capacity()),
+			mSlices(slices)
+		{
+			for (uint32 i = 0; i < 16; i++)
+				mSource.m[i] = (float)i;
+		}
+
+		// Returns the number of slices that did not fit, 0 unless the ring is too small.
+		uint32 Frame(bool copy)
+		{
+			mRing.Retire(mFence > FramesInFlight ? mFence - FramesInFlight : 0);
+			uint32 failed = 0;
+			for (uint32 i = 0; i < mSlices; i++)
+			{
+				uint64 offset = mRing.Allocate(SliceSize, SliceAlignment);
+				if (offset == RingAllocator::InvalidOffset)
+				{
+					failed++;
+					continue;
+				}
+				if (copy)
+					memcpy(&mMemory[offset], &mSource, sizeof(mSource));
+			}
+			mRing.FinishFrame(++mFence);
+			return failed;
+		}
+
+	private:
+		RingAllocator mRing;
+		std::vector<std::uint8_t> mMemory;
+		Matrix mSource;
+		uint32 mSlices;
+		uint64 mFence = 0;
+	};
+
+	void Run(uint32 slices)
+	{
+		FrameLoop allocateOnly(slices);
+		FrameLoop allocateAndCopy(slices);
+		uint32 failed = 0;
+
+		double allocate = Bench::MedianMilliseconds(Runs, [&]() { failed += allocateOnly.Frame(false); });
+		double copy = Bench::MedianMilliseconds(Runs, [&]() { failed += allocateAndCopy.Frame(true); });
+		printf("  %9u %12.3f %12.3f %14.1f %14.1f", slices, allocate, copy, 1e6 * allocate / slices, 1e6 * copy / slices);
+		if (failed != 0)
+			printf("   (%u slices did not fit)", failed);
+		printf("\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<uint32> counts = { 1000, 10000, 100000 };
+	if (argc > 2 || (argc == 2 && !Bench::ParseCounts(argv[1], counts)))
+	{
+		fprintf(stderr, "usage: RingAllocatorBench [N[,N...]]\n");
+		return 1;
+	}
+
+	printf("one frame of %llu-byte slices, %u frames in flight, median of %u runs\n", (unsigned long long)SliceSize, FramesInFlight, Runs);
+	printf("  %9s %12s %12s %14s %14s\n", "slices", "alloc ms", "+copy ms", "alloc ns/slice", "+copy ns/slice");
+	for (uint32 count : counts)
+	{
+		if (count > 0)
+			Run(count);
+	}
+	return 0;
+}
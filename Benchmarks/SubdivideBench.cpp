@@ -0,0 +1,94 @@
+// SubdivideBench: CreateGeometry::Subdivide per level, through CreateBox,
+// against the old routine that copied the mesh every level and gave each
+// triangle six fresh vertices.
+//
+//   SubdivideBench [N[,N...]]        subdivision levels, 1,2,3,4,5,6 by
+//                                    default (CreateBox stops at 6)
+//
+// Both start from the level 0 box and use the full vertex format.  The new
+// time includes building the 24-vertex box, a few hundred nanoseconds.
+
+#include <cstdio>
+#include <vector>
+#include "Bench.h"
+#include "../CreateGeometry.h"
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	const uint32 Runs = 21;
+	const float Size = 1.0f;
+
+	// Subdivide as it was before edge midpoints were welded, one level.
+	void SubdivideOld(CreateGeometry::MeshData& meshData, const CreateGeometry::DefaultFormat& format)
+	{
+		CreateGeometry::MeshData inputCopy = meshData;
+		meshData.Vertices.resize(0);
+		meshData.Indices32.resize(0);
+
+		uint32 numTris = (uint32)inputCopy.Indices32.size() / 3;
+		for (uint32 i = 0; i < numTris; ++i)
+		{
+			CreateGeometry::Vertex v0 = inputCopy.Vertices[inputCopy.Indices32[i * 3 + 0]];
+			CreateGeometry::Vertex v1 = inputCopy.Vertices[inputCopy.Indices32[i * 3 + 1]];
+			CreateGeometry::Vertex v2 = inputCopy.Vertices[inputCopy.Indices32[i * 3 + 2]];
+
+			meshData.Vertices.push_back(v0);
+			meshData.Vertices.push_back(v1);
+			meshData.Vertices.push_back(v2);
+			meshData.Vertices.push_back(format.MidPoint(v0, v1));
+			meshData.Vertices.push_back(format.MidPoint(v1, v2));
+			meshData.Vertices.push_back(format.MidPoint(v0, v2));
+
+			const uint32 corners[12] = { 0, 3, 5, 3, 4, 5, 5, 4, 2, 3, 1, 4 };
+			for (uint32 corner : corners)
+				meshData.Indices32.push_back(i * 6 + corner);
+		}
+	}
+
+	void Run(uint32 level)
+	{
+		CreateGeometry geometry;
+		CreateGeometry::DefaultFormat format;
+		CreateGeometry::MeshData base = geometry.CreateBox(Size, Size, Size, 0);
+
+		size_t oldVertices = 0;
+		size_t newVertices = 0;
+		size_t triangles = 0;
+		double oldMs = Bench::MedianMilliseconds(Runs, [&]()
+		{
+			CreateGeometry::MeshData mesh = base;
+			for (uint32 i = 0; i < level; i++)
+				SubdivideOld(mesh, format);
+			oldVertices = mesh.Vertices.size();
+		});
+		double newMs = Bench::MedianMilliseconds(Runs, [&]()
+		{
+			CreateGeometry::MeshData mesh = geometry.CreateBox(Size, Size, Size, level);
+			newVertices = mesh.Vertices.size();
+			triangles = mesh.Indices32.size() / 3;
+		});
+
+		printf("  %5u %9zu %10zu %10.3f %10zu %10.3f %8.2fx\n", level, triangles, oldVertices, oldMs, newVertices, newMs, oldMs / newMs);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<uint32> levels = { 1, 2, 3, 4, 5, 6 };
+	if (argc > 2 || (argc == 2 && !Bench::ParseCounts(argv[1], levels)))
+	{
+		fprintf(stderr, "usage: SubdivideBench [N[,N...]]\n");
+		return 1;
+	}
+
+	printf("subdivided box, median of %u runs\n", Runs);
+	printf("  %5s %9s %10s %10s %10s %10s %9s\n", "level", "triangles", "old verts", "old ms", "new verts", "new ms", "speedup");
+	for (uint32 level : levels)
+	{
+		if (level <= 6)
+			Run(level);
+	}
+	return 0;
+}
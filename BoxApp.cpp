@@ -23,32 +23,70 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE prevInstance,
 	}
 }
 
+namespace
+{
+	// Entities per job of the per-entity loops of Update.  Below this many
+	// entities a loop runs inline on the calling thread.
+	const UINT EntityGrainSize = 1024;
+
+	// Simulation ticks per second.  Rendering is not capped by it.
+	const float TickRate = 60.0f;
+
+	// Where entity i is drawn: alpha of the way from its previous tick to the last one.
+	XMVECTOR GetRenderPosition(const EntityStore& entities, UINT i, float alpha)
+	{
+		return XMVectorLerp(XMLoadFloat3(&entities.PrevPosition[i]), XMLoadFloat3(&entities.Position[i]), alpha);
+	}
+}
+
 BoxApp::BoxApp(HINSTANCE hInstance)
-	: D3DApp(hInstance)
+	: D3DApp(hInstance),
+	mStartupBegin(std::chrono::steady_clock::now())
 {
+	SetTickRate(TickRate);
 }
 
 BoxApp::~BoxApp()
 {
+	// Up to gNumFrameResources frames may still be in flight, reading the
+	// frame resources, the upload ring and the geometry that die with BoxApp,
+	// before ~D3DApp gets to flush.
+	if (mFence != nullptr)
+		FlushCommandQueue();
 }
 
 bool BoxApp::Initialize()
 {
+	// Building the meshes and compiling the shaders do not need the device,
+	// so they run on the pool while the window and the device are created.
+	mThreadPool.Submit(mStartupTasks, [this] { gameObject.BuildMeshes(mThreadPool); });
+	mThreadPool.Submit(mStartupTasks, [this] { BuildShadersAndInputLayout(); });
+
 	if (!D3DApp::Initialize())
+	{
+		mThreadPool.Wait(mStartupTasks);
 		return false;
+	}
 
 	// Reset the command list to prep for initialization commands.
 	ThrowIfFailed(mCommandList->Reset(mDirectCmdListAlloc.Get(), nullptr));
 
 	BuildRootSignature();
-	BuildShadersAndInputLayout();
+	mThreadPool.Wait(mStartupTasks);
 	gameObject.Init(mCommandList, md3dDevice);
-	gameObject.BuildRenderOpPyramide();
 
-	gameObject.BuildRenderOpCircle();
+	SimulationDesc simDesc;
+	simDesc.FrameResourceCount = gNumFrameResources;
+	simDesc.Seed = (std::uint32_t)time(nullptr);
+	mSimulation.Init(simDesc);
+	mSimulation.SpawnPlayer();
+	mSimulation.SpawnAsteroid();
 
-	BuildDescriptorHeaps();
-	BuildConstantBuffers();
+	mRenderQueue.Reserve(mSimulation.GetEntities().SlotCount());
+	mVisible.reserve(mSimulation.GetEntities().SlotCount());
+	mEntityRenderItem.reserve(mSimulation.GetEntities().SlotCount());
+
+	BuildFrameResources();
 	BuildPSO();
 
 	// Execute the initialization commands.
@@ -71,43 +109,29 @@ void BoxApp::OnResize()
 	XMStoreFloat4x4(&mProj, P);
 }
 
-void BoxApp::CameraInputs(const GameTimer& gt)
+SimInput BoxApp::ReadInput()
 {
 	float speed = 0.04f;
-	float swift = 0.05f;
 	int key = inputManager.GetKeyPressed();
+	SimInput input;
 
 	//RUN
 	if (key == VK_SHIFT)
-	{
-		moveDownPlayer = true;
-	}
-	if (key == VK_SPACE) {
-		moveUpPlayer = true;
-	}
+		input.MoveY = -1.0f;
+	if (key == VK_SPACE)
+		input.MoveY = 1.0f;
 	//Walk
 	if (key == 'Z')
-	{
-		moveBackForward += swift;
-		movePlayer = true;
-	}
+		input.MoveZ = 1.0f;
 	if (key == 'Q')
-	{
-		moveLeftRight -= swift;
-		movePlayer = true;
-
-	}
+		input.MoveX = -1.0f;
 	if (key == 'D')
-	{
-		moveLeftRight += swift;
-		movePlayer = true;
-
-	}
+		input.MoveX = 1.0f;
 	if (key == 'S')
-	{
-		moveBackForward -= swift;
-		movePlayer = true;
-	}
+		input.MoveZ = -1.0f;
+	//Shoot
+	if (key == 'R')
+		input.Shoot = true;
 	//ROTATE
 	//if (key == VK_UP)
 	//{
@@ -132,13 +156,16 @@ void BoxApp::CameraInputs(const GameTimer& gt)
 	//    rotatePlayer = true;
 
 	//}
+	return input;
 }
 
-void BoxApp::Camera(const GameTimer& gt)
+void BoxApp::MoveCamera(const SimInput& input, float dt)
 {
-	camRotationMatrix = XMMatrixRotationRollPitchYaw(camPitch, camYaw, 0);
-	camTarget = XMVector3TransformCoord(DefaultForward, camRotationMatrix);
-	camTarget = XMVector3Normalize(camTarget);
+	// The camera follows the player on x and z; the player moves itself in
+	// the simulation.
+	float swift = Simulation::PlayerSpeed * dt;
+	float moveLeftRight = input.MoveX * swift;
+	float moveBackForward = input.MoveZ * swift;
 
 	XMMATRIX RotateYTempMatrix;
 	RotateYTempMatrix = XMMatrixRotationY(camYaw);
@@ -147,47 +174,32 @@ void BoxApp::Camera(const GameTimer& gt)
 	camUp = XMVector3TransformCoord(camUp, RotateYTempMatrix);
 	camForward = XMVector3TransformCoord(DefaultForward, RotateYTempMatrix);
 
+	prevCamPosition = camPosition;
 	camPosition += moveLeftRight * camRight;
 	camPosition += moveBackForward * camForward;
 
-	for (size_t i = 0; i < gameObject.GetOpaqueItems().size(); i++)
-	{
-		if (gameObject.GetOpaqueItems()[i]->Type == "player" && moveUpPlayer) {
-			gameObject.GetOpaqueItems()[i]->World._42 += 0.05;
-			moveUpPlayer = false;
-		}
-		if (gameObject.GetOpaqueItems()[i]->Type == "player" && moveDownPlayer) {
-			gameObject.GetOpaqueItems()[i]->World._42 -= 0.05;
-			moveDownPlayer = false;
-		}
-		if (gameObject.GetOpaqueItems()[i]->Type == "player" && movePlayer) {
-			gameObject.GetOpaqueItems()[i]->World._41 += moveLeftRight;
-			gameObject.GetOpaqueItems()[i]->World._43 += moveBackForward;
-			movePlayer = false;
-		}
-		//if (gameObject.GetOpaqueItems()[i]->Type == "player" && rotatePlayer)
-		//{
-		//	XMStoreFloat4x4(&gameObject.GetOpaqueItems()[i]->World, XMMatrixMultiply(XMLoadFloat4x4(&gameObject.GetOpaqueItems()[i]->World), camRotationMatrix));
-		//	rotatePlayer = false;
-		//}
-	}
+	//if (rotatePlayer)
+	//{
+	//	XMStoreFloat4(&entities.Rotation[i], XMQuaternionMultiply(XMLoadFloat4(&entities.Rotation[i]), XMQuaternionRotationMatrix(camRotationMatrix)));
+	//	entities.MarkDirty(i);
+	//	rotatePlayer = false;
+	//}
+}
 
-	moveLeftRight = 0.0f;
-	moveBackForward = 0.0f;
+void BoxApp::Camera(const GameTimer& gt)
+{
+	PROFILE_SCOPE("BoxApp::Camera");
+	camRotationMatrix = XMMatrixRotationRollPitchYaw(camPitch, camYaw, 0);
+	camTarget = XMVector3TransformCoord(DefaultForward, camRotationMatrix);
+	camTarget = XMVector3Normalize(camTarget);
 
 	XMMATRIX world = XMLoadFloat4x4(&mWorld);
 	XMMATRIX proj = XMLoadFloat4x4(&mProj);
 
-	camTarget = camPosition + camTarget;
-	camView = XMMatrixLookAtLH(camPosition, camTarget, camUp);
-
-	for (auto& e : gameObject.GetAllItems()) {
-		XMMATRIX world = XMLoadFloat4x4(&e->World);
-		XMMATRIX worldViewProj = world;
-		ObjectConstants objConstants;
-		XMStoreFloat4x4(&objConstants.WorldViewProj, XMMatrixTranspose(worldViewProj));
-		e->mObjectCB->CopyData(0, objConstants);
-	}
+	// Between the camera positions of the last two ticks, like the entities.
+	XMVECTOR eyePosition = XMVectorLerp(prevCamPosition, camPosition, mTickAlpha);
+	camTarget = eyePosition + camTarget;
+	camView = XMMatrixLookAtLH(eyePosition, camTarget, camUp);
 
 	XMMATRIX viewProj = XMMatrixMultiply(camView, proj);
 
@@ -209,116 +221,180 @@ void BoxApp::Camera(const GameTimer& gt)
 	mMainPassCB.TotalTime = gt.TotalTime();
 	mMainPassCB.DeltaTime = gt.DeltaTime();
 
-	PassCB->CopyData(0, mMainPassCB);
-	for (size_t i = 0; i < gameObject.GetOpaqueItems().size(); i++)
-	{
-		gameObject.SetOpaqueItems(gameObject.GetOpaqueItems()[i]->CheckCollision(gameObject.GetOpaqueItems(), i));
-	}
+	mCurrFrameResource->PassCB->CopyData(0, mMainPassCB);
 }
 
-void BoxApp::CheckShoot(const GameTimer& gt) 
+void BoxApp::FixedUpdate(float dt)
 {
-	int key = inputManager.GetKeyPressed();
-
-	//RUN
-
-	if (key == 'R' && canShoot)
-	{
-		for (size_t i = 0; i < gameObject.GetOpaqueItems().size(); i++)
-		{
-			if (gameObject.GetOpaqueItems()[i]->Type == "player")
-			{
+	PROFILE_SCOPE("BoxApp::FixedUpdate");
+	SimInput input = ReadInput();
+	// Once the player is dead the camera stops with it.  MoveCamera still runs
+	// with no input so the interpolated eye settles on its last position.
+	MoveCamera(mSimulation.IsGameOver() ? SimInput() : input, dt);
+	mSimulation.Tick(mJobs, input, dt);
+}
 
-				gameObject.BuildRenderOpProjectile(gameObject.GetOpaqueItems()[i]->World._41, gameObject.GetOpaqueItems()[i]->World._42, gameObject.GetOpaqueItems()[i]->World._43);
+void BoxApp::Update(const GameTimer& gt)
+{
+	PROFILE_SCOPE("BoxApp::Update");
+	// Cycle through the circular frame resource array.  This only blocks when
+	// the GPU is gNumFrameResources frames behind.
+	std::chrono::steady_clock::time_point waitBegin = std::chrono::steady_clock::now();
+	mCurrFrameResource = mFrameResources[mFrameScheduler->BeginFrame()].get();
+	mPresentWaitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - waitBegin).count();
 
-			}
-		}
-		canShoot = false;
-		cd = 0;
-	}
+	Camera(gt);
+	UpdateObjectCBs(gt);
+	BuildRenderQueue();
 }
 
-void BoxApp::CheckProjectileLifeTime(const GameTimer& gt)
+void BoxApp::UpdateObjectCBs(const GameTimer& gt)
 {
-	for (size_t i = 0; i < gameObject.GetOpaqueItems().size(); i++)
+	PROFILE_SCOPE("BoxApp::UpdateObjectCBs");
+	auto currInstanceBuffer = mCurrFrameResource->InstanceBuffer.get();
+
+	// Written after the simulation so spawns, moves and removals of this tick
+	// are already reflected.  Instance data lives at the slot of its entity, so
+	// only entities that changed since this frame resource was last used need
+	// to be written.
+	// Every entity writes its own slot, so ranges pack in parallel.  Entities
+	// that moved last tick are written every frame, at their interpolated
+	// position, even once the frame resources are all up to date.
+	EntityStore& entities = mSimulation.GetEntities();
+	std::atomic<UINT64> bytesUploaded{ 0 };
+	auto pack = [&](UINT begin, UINT end)
 	{
-		if (gameObject.GetOpaqueItems()[i]->Type == "projectile" && gameObject.GetOpaqueItems()[i]->Timer >= gameObject.GetOpaqueItems()[i]->lifeTime) {
-			gameObject.RemoveObject(i);
+		UINT64 bytes = 0;
+		for (UINT i = begin; i < end; i++) {
+			const XMFLOAT3& prev = entities.PrevPosition[i];
+			const XMFLOAT3& position = entities.Position[i];
+			bool moving = prev.x != position.x || prev.y != position.y || prev.z != position.z;
+			if (entities.NumFramesDirty[i] == 0 && !moving)
+				continue;
+
+			XMMATRIX world = XMMatrixMultiply(XMMatrixRotationQuaternion(XMLoadFloat4(&entities.Rotation[i])),
+				XMMatrixTranslationFromVector(GetRenderPosition(entities, i, mTickAlpha)));
+			InstanceData data;
+			XMStoreFloat4x4(&data.World, XMMatrixTranspose(world));
+			currInstanceBuffer->CopyData(entities.Slot[i], data);
+
+			// Next FrameResource need to be updated too.
+			if (entities.NumFramesDirty[i] > 0)
+				entities.NumFramesDirty[i]--;
+			bytes += sizeof(InstanceData);
 		}
-	}
+		bytesUploaded.fetch_add(bytes, std::memory_order_relaxed);
+	};
+	mJobs.ParallelFor(0, entities.Size(), EntityGrainSize, pack);
+
+	mObjectCBBytesUploaded = bytesUploaded.load();
+	mObjectCBBytesTotal += mObjectCBBytesUploaded;
 }
 
-void BoxApp::AsteroidSpawn(const GameTimer& gt)
+void BoxApp::BuildRenderQueue()
 {
-	for (size_t i = 0; i < gameObject.GetOpaqueItems().size(); i++)
+	PROFILE_SCOPE("BoxApp::BuildRenderQueue");
+	// World space bounding spheres of every entity, culled against the frustum.
+	EntityStore& entities = mSimulation.GetEntities();
+	mCuller.Resize(entities.Size());
+	auto computeBounds = [&](UINT begin, UINT end)
 	{
-		if (gameObject.GetOpaqueItems()[i]->Type == "asteroid")
-		{
-			numAsteroid = true;
+		for (UINT i = begin; i < end; i++) {
+			const BoundingSphere& bounds = gameObject.GetRenderItem(entities.DrawArg[i]).Bounds;
+			XMVECTOR center = XMVectorAdd(GetRenderPosition(entities, i, mTickAlpha),
+				XMVector3Rotate(XMLoadFloat3(&bounds.Center), XMLoadFloat4(&entities.Rotation[i])));
+			mCuller.CenterX[i] = XMVectorGetX(center);
+			mCuller.CenterY[i] = XMVectorGetY(center);
+			mCuller.CenterZ[i] = XMVectorGetZ(center);
+			mCuller.Radius[i] = bounds.Radius;
 		}
+	};
+	mJobs.ParallelFor(0, entities.Size(), EntityGrainSize, computeBounds);
+	mVisible.clear();
+	mCuller.Cull(XMMatrixMultiply(camView, XMLoadFloat4x4(&mProj)), mVisible);
+
+	// Pick the LOD of every visible entity from its projected size, then push
+	// one key per visible entity, with its view space depth, and build one
+	// batch per run of equal state in the sorted queue.
+	float projScaleY = mProj(1, 1);
+	mEntityRenderItem.resize(entities.Size());
+	mRenderQueue.Clear();
+	for (UINT i : mVisible) {
+		float depth = XMVectorGetZ(XMVector3TransformCoord(XMVectorSet(mCuller.CenterX[i], mCuller.CenterY[i], mCuller.CenterZ[i], 1.0f), camView));
+		float screenSize = LodSelector::ScreenSize(mCuller.Radius[i], depth, projScaleY);
+		entities.Lod[i] = mLodSelector.Select(gameObject.GetLodChain(entities.DrawArg[i]), screenSize, entities.Lod[i]);
+
+		UINT renderItem = gameObject.GetRenderItemIndex(entities.DrawArg[i], entities.Lod[i]);
+		mEntityRenderItem[i] = renderItem;
+		const RenderItem& ri = gameObject.GetRenderItemAt(renderItem);
+		mRenderQueue.Push(RenderQueue::MakeKey(ri.Layer, (UINT)ri.Layer, ri.GeometryId, ri.SubmeshId,
+			depth, 1.0f, 1000.0f), i);
 	}
+	mRenderQueue.Sort();
+	mBatcher.Build(mRenderQueue, mEntityRenderItem, entities.Slot);
 
-	if (numAsteroid == false)
-	{
-		for (int i = 0; i < asteroid; i++)
-		{
-			gameObject.BuildRenderOpCircle();
-		}
-		asteroid++;
-	}
-	else
-	{
-		numAsteroid = false;
-	}
-}
+	mFrameRing->Retire(mFence->GetCompletedValue());
 
-void BoxApp::Update(const GameTimer& gt)
-{
-	CameraInputs(gt);
-	Camera(gt);
-	CheckShoot(gt);
-	AsteroidSpawn(gt);
-	cd += 0.05;
-	if (cd > 5) {
-		canShoot = true;
-	}
-	for (size_t i = 0; i < gameObject.GetOpaqueItems().size(); i++)
+	const std::vector<UINT>& slots = mBatcher.GetInstanceSlots();
+	UINT64 slotsByteSize = slots.size() * sizeof(UINT);
+	mInstanceSlotsAddress = 0;
+	if (slotsByteSize > 0)
 	{
-		if (gameObject.GetOpaqueItems()[i]->Type == "projectile") {
-			gameObject.GetOpaqueItems()[i]->UpdateTimer();
-		}
-	}
-	CheckProjectileLifeTime(gt);
-	if (gameObject.getGameOver()) {
+		UploadRing::Allocation allocation = mFrameRing->Allocate(slotsByteSize, 16);
+		memcpy(allocation.CPU, slots.data(), slotsByteSize);
+		mInstanceSlotsAddress = allocation.GPU;
+		mObjectCBBytesUploaded += slotsByteSize;
+		mObjectCBBytesTotal += slotsByteSize;
 	}
 }
 
 void BoxApp::DrawRenderItems() 
 {
+	PROFILE_SCOPE("BoxApp::DrawRenderItems");
+	mCommandList->SetGraphicsRootShaderResourceView(1, mCurrFrameResource->InstanceBuffer->Resource()->GetGPUVirtualAddress());
+
+	// One instanced draw per batch, in render queue order; the slot list of a
+	// batch is bound by offsetting the root SRV, so SV_InstanceID indexes
+	// straight into it.
+	MeshGeometry* boundGeo = nullptr;
+	RenderLayer boundLayer = RenderLayer::Opaque;
+	for (const InstanceBatcher::Batch& batch : mBatcher.GetBatches()) {
+		const RenderItem& ri = gameObject.GetRenderItemAt(batch.RenderItem);
+		if (batch.Layer != boundLayer)
+		{
+			mCommandList->SetPipelineState(mPSOs[(UINT)batch.Layer].Get());
+			boundLayer = batch.Layer;
+		}
+		if (ri.Geo != boundGeo)
+		{
+			mCommandList->IASetVertexBuffers(0, 1, &ri.Geo->VertexBufferView());
+			mCommandList->IASetIndexBuffer(&ri.Geo->IndexBufferView());
+			boundGeo = ri.Geo;
+		}
+		mCommandList->IASetPrimitiveTopology(ri.PrimitiveType);
 
-	UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
-
-	for (size_t i = 0; i < gameObject.GetOpaqueItems().size(); i++) {
-		auto ri = gameObject.GetOpaqueItems()[i];
-		mCommandList->IASetVertexBuffers(0, 1, &ri->Geo->VertexBufferView());
-		mCommandList->IASetIndexBuffer(&ri->Geo->IndexBufferView());
-		mCommandList->IASetPrimitiveTopology(ri->PrimitiveType);
-
-		mCommandList->SetGraphicsRootConstantBufferView(0, ri->mObjectCB->Resource()->GetGPUVirtualAddress());
-		mCommandList->DrawIndexedInstanced(ri->IndexCount, 1, ri->StartIndexLocation, ri->BaseVertexLocation, 0);
+		mCommandList->SetGraphicsRootShaderResourceView(2, mInstanceSlotsAddress + (UINT64)batch.StartInstance * sizeof(UINT));
+		mCommandList->DrawIndexedInstanced(ri.IndexCount, batch.InstanceCount, ri.StartIndexLocation, ri.BaseVertexLocation, 0);
 	}
+}
 
+std::wstring BoxApp::GetFrameStatsText()const
+{
+	return L"   cb upload: " + std::to_wstring(mObjectCBBytesUploaded) + L" B/frame" +
+		L"   drawn: " + std::to_wstring(mVisible.size()) + L"/" + std::to_wstring(mSimulation.GetEntities().Size());
 }
 
 void BoxApp::Draw(const GameTimer& gt)
 {
+	PROFILE_SCOPE("BoxApp::Draw");
 	// Reuse the memory associated with command recording.
 	// We can only reset when the associated command lists have finished execution on the GPU.
-	ThrowIfFailed(mDirectCmdListAlloc->Reset());
+	auto cmdListAlloc = mCurrFrameResource->CmdListAlloc;
+	ThrowIfFailed(cmdListAlloc->Reset());
 
 	// A command list can be reset after it has been added to the command queue via ExecuteCommandList.
 	// Reusing the command list reuses memory.
-	ThrowIfFailed(mCommandList->Reset(mDirectCmdListAlloc.Get(), mPSO.Get()));
+	ThrowIfFailed(mCommandList->Reset(cmdListAlloc.Get(), mPSOs[(UINT)RenderLayer::Opaque].Get()));
 
 	mCommandList->RSSetViewports(1, &mScreenViewport);
 	mCommandList->RSSetScissorRects(1, &mScissorRect);
@@ -334,12 +410,10 @@ void BoxApp::Draw(const GameTimer& gt)
     // Specify the buffers we are going to render to.
 	mCommandList->OMSetRenderTargets(1, &CurrentBackBufferView(), true, &DepthStencilView());
 
-	ID3D12DescriptorHeap* descriptorHeaps[] = { mCbvHeap.Get() };
-	mCommandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
 
 	mCommandList->SetGraphicsRootSignature(mRootSignature.Get());
 
-	mCommandList->SetGraphicsRootConstantBufferView(1, PassCB->Resource()->GetGPUVirtualAddress());
+	mCommandList->SetGraphicsRootConstantBufferView(0, mCurrFrameResource->PassCB->Resource()->GetGPUVirtualAddress());
 
 	DrawRenderItems();
 
@@ -354,52 +428,43 @@ void BoxApp::Draw(const GameTimer& gt)
 	ID3D12CommandList* cmdsLists[] = { mCommandList.Get() };
 	mCommandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
 
-	// swap the back and front buffers
+	// swap the back and front buffers.  Present blocks once the queue of
+	// frames waiting for the display is full.
+	std::chrono::steady_clock::time_point presentBegin = std::chrono::steady_clock::now();
 	ThrowIfFailed(mSwapChain->Present(0, 0));
+	mPresentWaitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - presentBegin).count();
 	mCurrBackBuffer = (mCurrBackBuffer + 1) % SwapChainBufferCount;
 
-	// Wait until frame commands are complete.  This waiting is inefficient and is
-	// done for simplicity.  Later we will show how to organize our rendering code
-	// so we do not have to wait per frame.
-	FlushCommandQueue();
-}
+	// Mark the commands of this frame with a fence point instead of waiting for
+	// them.  The frame resource and the slot lists are only reused once the GPU
+	// has passed that point.
+	UINT64 fence = mFrameScheduler->EndFrame();
+	mFrameRing->FinishFrame(fence);
 
-void BoxApp::BuildDescriptorHeaps()
-{
-	UINT objCount = (UINT)gameObject.GetOpaqueItems().size();
-
-	UINT numDescriptor = (objCount + 1);
-	mPassCbvOffset = objCount;
-	D3D12_DESCRIPTOR_HEAP_DESC cbvHeapDesc;
-	cbvHeapDesc.NumDescriptors = numDescriptor;
-	cbvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-	cbvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-	cbvHeapDesc.NodeMask = 0;
-	ThrowIfFailed(md3dDevice->CreateDescriptorHeap(&cbvHeapDesc,
-		IID_PPV_ARGS(&mCbvHeap)));
+	if (!mFirstFramePresented)
+	{
+		mFirstFramePresented = true;
+		std::chrono::duration<double, std::milli> coldStart = std::chrono::steady_clock::now() - mStartupBegin;
+		char line[64];
+		snprintf(line, sizeof(line), "cold start: %.1f ms to first frame\n", coldStart.count());
+		::OutputDebugStringA(line);
+	}
 }
 
-void BoxApp::BuildConstantBuffers()
+void BoxApp::BuildFrameResources()
 {
-	mObjectCB = std::make_unique<UploadBuffer<ObjectConstants>>(md3dDevice.Get(), 1, true);
-	PassCB = std::make_unique<UploadBuffer<PassConstants>>(md3dDevice.Get(), 1, true);
-
-	UINT passObjCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(PassConstants));
-
-	D3D12_GPU_VIRTUAL_ADDRESS passCbAddress = PassCB->Resource()->GetGPUVirtualAddress();
-
-	int heapIndex = mPassCbvOffset;
-	// Offset to the ith object constant buffer in the buffer.
-	auto handle = CD3DX12_CPU_DESCRIPTOR_HANDLE(
-		mCbvHeap->GetCPUDescriptorHandleForHeapStart());
-	handle.Offset(heapIndex, mCbvSrvUavDescriptorSize);
+	for (int i = 0; i < gNumFrameResources; ++i)
+	{
+		mFrameResources.push_back(std::make_unique<FrameResource>(md3dDevice.Get(),
+			1, mSimulation.GetEntities().SlotCount()));
+	}
 
-	D3D12_CONSTANT_BUFFER_VIEW_DESC passCbvDesc;
-	passCbvDesc.BufferLocation = passCbAddress;
-	passCbvDesc.SizeInBytes = passObjCBByteSize;
+	mFrameScheduler = std::make_unique<FrameScheduler>(mFence.get(), (std::uint32_t)gNumFrameResources);
 
-	md3dDevice->CreateConstantBufferView(
-		&passCbvDesc, handle);
+	// Room for the instance slot list of every entity slot, for every frame in
+	// flight plus the one being written.
+	UINT64 slotsByteSize = (UINT64)mSimulation.GetEntities().SlotCount() * sizeof(UINT) + 16;
+	mFrameRing = std::make_unique<UploadRing>(md3dDevice.Get(), (gNumFrameResources + 1) * slotsByteSize);
 }
 
 void BoxApp::BuildRootSignature()
@@ -411,13 +476,14 @@ void BoxApp::BuildRootSignature()
 	// thought of as defining the function signature.  
 
 	// Root parameter can be a table, root descriptor or root constants.
-	CD3DX12_ROOT_PARAMETER slotRootParameter[2];
+	CD3DX12_ROOT_PARAMETER slotRootParameter[3];
 
 	slotRootParameter[0].InitAsConstantBufferView(0);
-	slotRootParameter[1].InitAsConstantBufferView(1);
+	slotRootParameter[1].InitAsShaderResourceView(0);
+	slotRootParameter[2].InitAsShaderResourceView(1);
 
 	// A root signature is an array of root parameters.
-	CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(2, slotRootParameter, 0, nullptr,
+	CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(3, slotRootParameter, 0, nullptr,
 		D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 
 	// create a root signature with a single slot which points to a descriptor range consisting of a single constant buffer
@@ -439,6 +505,30 @@ void BoxApp::BuildRootSignature()
 		IID_PPV_ARGS(&mRootSignature)));
 }
 
+namespace
+{
+	// Per-vertex input layout of a vertex format, all elements in slot 0.
+	template<typename Format>
+	std::vector<D3D12_INPUT_ELEMENT_DESC> MakeInputLayout()
+	{
+		static const DXGI_FORMAT dxgiFormats[] =
+		{
+			DXGI_FORMAT_R32G32_FLOAT,       // VertexElementFormat::Float2
+			DXGI_FORMAT_R32G32B32_FLOAT,    // VertexElementFormat::Float3
+			DXGI_FORMAT_R32G32B32A32_FLOAT  // VertexElementFormat::Float4
+		};
+
+		const VertexElement* elements = Format::Elements();
+		std::vector<D3D12_INPUT_ELEMENT_DESC> layout(Format::ElementCount);
+		for (UINT i = 0; i < Format::ElementCount; ++i)
+		{
+			layout[i] = { elements[i].SemanticName, 0, dxgiFormats[(UINT)elements[i].Format], 0,
+				elements[i].AlignedByteOffset, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+		}
+		return layout;
+	}
+}
+
 void BoxApp::BuildShadersAndInputLayout()
 {
 	HRESULT hr = S_OK;
@@ -446,11 +536,7 @@ void BoxApp::BuildShadersAndInputLayout()
 	mvsByteCode = d3dUtil::CompileShader(L"Shaders\\color.hlsl", nullptr, "VS", "vs_5_0");
 	mpsByteCode = d3dUtil::CompileShader(L"Shaders\\color.hlsl", nullptr, "PS", "ps_5_0");
 
-	mInputLayout =
-	{
-		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-		{ "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
-	};
+	mInputLayout = MakeInputLayout<RenderVertexFormat>();
 }
 
 void BoxApp::BuildPSO()
@@ -479,5 +565,27 @@ void BoxApp::BuildPSO()
 	psoDesc.SampleDesc.Count = m4xMsaaState ? 4 : 1;
 	psoDesc.SampleDesc.Quality = m4xMsaaState ? (m4xMsaaQuality - 1) : 0;
 	psoDesc.DSVFormat = mDepthStencilFormat;
-	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&mPSO)));
+	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&mPSOs[(UINT)RenderLayer::Opaque])));
+
+	//
+	// PSO for transparent objects: blended over the opaque pass, depth tested
+	// but not written so sorted back to front layers all show through.
+	//
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC transparentPsoDesc = psoDesc;
+
+	D3D12_RENDER_TARGET_BLEND_DESC transparencyBlendDesc;
+	transparencyBlendDesc.BlendEnable = true;
+	transparencyBlendDesc.LogicOpEnable = false;
+	transparencyBlendDesc.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+	transparencyBlendDesc.DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+	transparencyBlendDesc.BlendOp = D3D12_BLEND_OP_ADD;
+	transparencyBlendDesc.SrcBlendAlpha = D3D12_BLEND_ONE;
+	transparencyBlendDesc.DestBlendAlpha = D3D12_BLEND_ZERO;
+	transparencyBlendDesc.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+	transparencyBlendDesc.LogicOp = D3D12_LOGIC_OP_NOOP;
+	transparencyBlendDesc.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+
+	transparentPsoDesc.BlendState.RenderTarget[0] = transparencyBlendDesc;
+	transparentPsoDesc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ZERO;
+	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&transparentPsoDesc, IID_PPV_ARGS(&mPSOs[(UINT)RenderLayer::Transparent])));
 }
\ No newline at end of file
@@ -3,32 +3,24 @@
 #include "d3dApp.h"
 #include "MathHelper.h"
 #include "UploadBuffer.h"
+#include "UploadRing.h"
+#include "FrameResource.h"
+#include "InstanceBatcher.h"
+#include "FrustumCuller.h"
+#include "FrameScheduler.h"
 #include "Transform.h"
 #include "CreateGeometry.h"
 #include "GameObject.h"
+#include "Simulation.h"
 #include "InputManager.h"
+#include "ThreadPool.h"
+#include "JobSystem.h"
+#include <chrono>
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
 using namespace DirectX::PackedVector;
 
-struct PassConstants {
-    XMFLOAT4X4                                                          View;
-    XMFLOAT4X4                                                          InvView;
-    XMFLOAT4X4                                                          Proj;
-    XMFLOAT4X4                                                          InvProj;
-    XMFLOAT4X4                                                          ViewProj;
-    XMFLOAT4X4                                                          InvViewProj;
-    XMFLOAT3                                                            EyePosW;
-    float                                                               cbPerObjectPad1;
-    XMFLOAT2                                                            RenderTargetSize;
-    XMFLOAT2                                                            InvRenderTargetSize;
-    float                                                               NearZ;
-    float                                                               FarZ;
-    float                                                               TotalTime;
-    float                                                               DeltaTime;
-};
-
 class BoxApp : public D3DApp
 {
 public:
@@ -41,16 +33,17 @@ public:
 
 private:
     virtual void                                                        OnResize()override;
-    void                                                                CameraInputs(const GameTimer& gt);
+    virtual std::wstring                                                GetFrameStatsText()const override;
+    SimInput                                                            ReadInput();
+    void                                                                MoveCamera(const SimInput& input, float dt);
     void                                                                Camera(const GameTimer& gt);
-    void                                                                CheckShoot(const GameTimer& gt);
+    virtual void                                                        FixedUpdate(float dt)override;
     virtual void                                                        Update(const GameTimer& gt)override;
     void                                                                DrawRenderItems();
     virtual void                                                        Draw(const GameTimer& gt)override;
-    void                                                                AsteroidSpawn(const GameTimer& gt);
-    void                                                                CheckProjectileLifeTime(const GameTimer& gt);
-    void                                                                BuildDescriptorHeaps();
-    void                                                                BuildConstantBuffers();
+    void                                                                UpdateObjectCBs(const GameTimer& gt);
+    void                                                                BuildRenderQueue();
+    void                                                                BuildFrameResources();
     void                                                                BuildRootSignature();
     void                                                                BuildShadersAndInputLayout();
     void                                                                BuildPSO();
@@ -59,26 +52,40 @@ private:
     XMFLOAT4                                                            CubePos;
     XMFLOAT4X4                                                          CubeRotMat;
     ComPtr<ID3D12RootSignature>                                         mRootSignature = nullptr;
-    ComPtr<ID3D12DescriptorHeap>                                        mCbvHeap = nullptr;
 
+    Simulation                                                          mSimulation;
     GameObject gameObject;
+    // Per-frame entity loops.  Created here, so the window thread is its thread 0.
+    JobSystem                                                           mJobs;
     std::unordered_map<std::string, std::unique_ptr<MeshGeometry>>      mGeometries;
 
-    bool                                                                movePlayer = false;
-    bool                                                                moveUpPlayer = false;
-    bool                                                                moveDownPlayer = false;
     bool                                                                rotatePlayer = false;
 
-    float                                                               cd;
-    bool                                                                canShoot = true;
-
-    //Constant Buffer
-    std::unique_ptr<UploadBuffer<ObjectConstants>>                      mObjectCB = nullptr;
-    std::unique_ptr<UploadBuffer<PassConstants>>                        PassCB = nullptr;
+    // Per-frame transient data: the instance slot lists of the batches.
+    std::unique_ptr<UploadRing>                                         mFrameRing = nullptr;
+    FrustumCuller                                                       mCuller;
+    std::vector<UINT>                                                   mVisible;
+    LodSelector                                                         mLodSelector;
+    std::vector<UINT>                                                   mEntityRenderItem;
+    RenderQueue                                                         mRenderQueue;
+    InstanceBatcher                                                     mBatcher;
+
+    // Bytes of instance data written to mapped memory, last frame and since start.
+    UINT64                                                              mObjectCBBytesUploaded = 0;
+    UINT64                                                              mObjectCBBytesTotal = 0;
+
+    // Construction time, for the cold start time logged at the first Present.
+    std::chrono::steady_clock::time_point                               mStartupBegin;
+    bool                                                                mFirstFramePresented = false;
+    D3D12_GPU_VIRTUAL_ADDRESS                                           mInstanceSlotsAddress = 0;
+
+    // Frames in flight
+    std::vector<std::unique_ptr<FrameResource>>                         mFrameResources;
+    FrameResource*                                                      mCurrFrameResource = nullptr;
+    std::unique_ptr<FrameScheduler>                                     mFrameScheduler = nullptr;
 
     //Stock RenderItem
 
-    UINT                                                                mPassCbvOffset = 0;
     std::unique_ptr<MeshGeometry>                                       mBoxGeo = nullptr;
 
     ComPtr<ID3DBlob>                                                    mvsByteCode = nullptr;
@@ -86,7 +93,7 @@ private:
 
     std::vector<D3D12_INPUT_ELEMENT_DESC>                               mInputLayout;
 
-    ComPtr<ID3D12PipelineState>                                         mPSO = nullptr;
+    ComPtr<ID3D12PipelineState>                                         mPSOs[(UINT)RenderLayer::Count];
 
     // Inputs
     InputManager                                                        inputManager;
@@ -101,6 +108,8 @@ private:
     XMVECTOR                                                            camUp = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
 
     XMVECTOR                                                            camPosition = XMVectorSet(0.0f, 0.0f, -4.0f, 1.0f);
+    // camPosition before the last tick, for interpolation.
+    XMVECTOR                                                            prevCamPosition = XMVectorSet(0.0f, 0.0f, -4.0f, 1.0f);
 
     XMMATRIX                                                            camRotationMatrix;
     XMMATRIX                                                            groundWorld;
@@ -108,18 +117,19 @@ private:
 
     XMVECTOR                                                            getCam;
 
-    float                                                               moveLeftRight = 0.0f;
-    float                                                               moveBackForward = 0.0f;
-
     XMVECTOR                                                            camTarget;
 
     float                                                               camYaw = 0.0f;
     float                                                               camPitch = 0.0f;
 
-    int                                                                 numAsteroid = false;
-    int                                                                 asteroid = 1;
-
     XMFLOAT4X4                                                          mWorld = MathHelper::Identity4x4();
     XMFLOAT4X4                                                          mView = MathHelper::Identity4x4();
     XMFLOAT4X4                                                          mProj = MathHelper::Identity4x4();
+
+    // Startup tasks write gameObject, mvsByteCode, mpsByteCode and
+    // mInputLayout.  Declared last, the pool is destroyed first: it runs the
+    // tasks still queued and joins the workers while those members are alive,
+    // even when Initialize throws before waiting on mStartupTasks.
+    TaskGroup                                                           mStartupTasks;
+    ThreadPool                                                          mThreadPool;
 };
\ No newline at end of file
@@ -1,51 +1,62 @@
 #include "CreateGeometry.h"
-#include "d3dx12.h"
-#include <d3d12.h>
-#include "MathHelper.h"
+#include <algorithm>
 
-using Microsoft::WRL::ComPtr;
 using namespace DirectX;
 
+namespace
+{
+	// Shorthand for the fixed vertices of the box, pyramid and caps.
+	template<typename Format>
+	typename Format::Vertex MakeVertex(const Format& format,
+		float px, float py, float pz,
+		float nx, float ny, float nz,
+		float tx, float ty, float tz,
+		float u, float v)
+	{
+		return format.Make(XMFLOAT3(px, py, pz), XMFLOAT3(nx, ny, nz), XMFLOAT3(tx, ty, tz), XMFLOAT2(u, v));
+	}
+}
 
-CreateGeometry::MeshData CreateGeometry::CreateBox(float width, float height, float depth, uint32 numSubdivisions)
+template<typename Format>
+CreateGeometry::BasicMeshData<Format> CreateGeometry::CreateBox(float width, float height, float depth, uint32 numSubdivisions, const Format& format)
 {
-	MeshData meshData;
+	BasicMeshData<Format> meshData;
 
-	Vertex v[24];
+	typename Format::Vertex v[24];
 
 	float w2 = 0.5f * width;
 	float h2 = 0.5f * height;
 	float d2 = 0.5f * depth;
 
-	v[0] = Vertex(-w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[1] = Vertex(-w2, +h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[2] = Vertex(+w2, +h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-	v[3] = Vertex(+w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+	v[0] = MakeVertex(format, -w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	v[1] = MakeVertex(format, -w2, +h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+	v[2] = MakeVertex(format, +w2, +h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+	v[3] = MakeVertex(format, +w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
 
-	v[4] = Vertex(-w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[5] = Vertex(+w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[6] = Vertex(+w2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[7] = Vertex(-w2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+	v[4] = MakeVertex(format, -w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+	v[5] = MakeVertex(format, +w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	v[6] = MakeVertex(format, +w2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+	v[7] = MakeVertex(format, -w2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
 
-	v[8] = Vertex(-w2, +h2, -d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[9] = Vertex(-w2, +h2, +d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[10] = Vertex(+w2, +h2, +d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-	v[11] = Vertex(+w2, +h2, -d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+	v[8] = MakeVertex(format, -w2, +h2, -d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	v[9] = MakeVertex(format, -w2, +h2, +d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+	v[10] = MakeVertex(format, +w2, +h2, +d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+	v[11] = MakeVertex(format, +w2, +h2, -d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
 
-	v[12] = Vertex(-w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[13] = Vertex(+w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[14] = Vertex(+w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[15] = Vertex(-w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+	v[12] = MakeVertex(format, -w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+	v[13] = MakeVertex(format, +w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	v[14] = MakeVertex(format, +w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+	v[15] = MakeVertex(format, -w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
 
-	v[16] = Vertex(-w2, -h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f);
-	v[17] = Vertex(-w2, +h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f);
-	v[18] = Vertex(-w2, +h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f);
-	v[19] = Vertex(-w2, -h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f);
+	v[16] = MakeVertex(format, -w2, -h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f);
+	v[17] = MakeVertex(format, -w2, +h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f);
+	v[18] = MakeVertex(format, -w2, +h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f);
+	v[19] = MakeVertex(format, -w2, -h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f);
 
-	v[20] = Vertex(+w2, -h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f);
-	v[21] = Vertex(+w2, +h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
-	v[22] = Vertex(+w2, +h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f);
-	v[23] = Vertex(+w2, -h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f);
+	v[20] = MakeVertex(format, +w2, -h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f);
+	v[21] = MakeVertex(format, +w2, +h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+	v[22] = MakeVertex(format, +w2, +h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f);
+	v[23] = MakeVertex(format, +w2, -h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f);
 
 	meshData.Vertices.assign(&v[0], &v[24]);
 
@@ -73,47 +84,49 @@ CreateGeometry::MeshData CreateGeometry::CreateBox(float width, float height, fl
 
 	numSubdivisions = std::min<uint32>(numSubdivisions, 6u);
 
-	for (uint32 i = 0; i < numSubdivisions; ++i)
-		Subdivide(meshData);
+	Subdivide(meshData, numSubdivisions, format);
+
+	ComputeBounds(meshData);
 
 	return meshData;
 }
 
-CreateGeometry::MeshData CreateGeometry::CreatePyramide(float width, float height, float depth, uint32 numSubdivisions)
+template<typename Format>
+CreateGeometry::BasicMeshData<Format> CreateGeometry::CreatePyramide(float width, float height, float depth, uint32 numSubdivisions, const Format& format)
 {
-	MeshData meshData;
+	BasicMeshData<Format> meshData;
 
-	Vertex v[16];
+	typename Format::Vertex v[16];
 
 	float w2 = 0.5f * width;
 	float h2 = 0.5f * height;
 	float d2 = 0.5f * depth;
 
 	//front
-	v[0] = Vertex(-w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[1] = Vertex(0, +h2, 0, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[2] = Vertex(+w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+	v[0] = MakeVertex(format, -w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	v[1] = MakeVertex(format, 0, +h2, 0, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+	v[2] = MakeVertex(format, +w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
 
 	//back
-	v[3] = Vertex(-w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[4] = Vertex(+w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[5] = Vertex(0, +h2, 0, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+	v[3] = MakeVertex(format, -w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+	v[4] = MakeVertex(format, +w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	v[5] = MakeVertex(format, 0, +h2, 0, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
 
 	//pas touch
-	v[6] = Vertex(-w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[7] = Vertex(+w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[8] = Vertex(+w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[9] = Vertex(-w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+	v[6] = MakeVertex(format, -w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+	v[7] = MakeVertex(format, +w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	v[8] = MakeVertex(format, +w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+	v[9] = MakeVertex(format, -w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
 
 	//gauche
-	v[10] = Vertex(-w2, -h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f);
-	v[11] = Vertex(0, +h2, 0, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f);
-	v[12] = Vertex(-w2, -h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f);
+	v[10] = MakeVertex(format, -w2, -h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f);
+	v[11] = MakeVertex(format, 0, +h2, 0, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f);
+	v[12] = MakeVertex(format, -w2, -h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f);
 
 	//droite
-	v[13] = Vertex(+w2, -h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f);
-	v[14] = Vertex(0, +h2, 0, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f);
-	v[15] = Vertex(+w2, -h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f);
+	v[13] = MakeVertex(format, +w2, -h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f);
+	v[14] = MakeVertex(format, 0, +h2, 0, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f);
+	v[15] = MakeVertex(format, +w2, -h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f);
 
 	meshData.Vertices.assign(&v[0], &v[16]);
 
@@ -134,17 +147,19 @@ CreateGeometry::MeshData CreateGeometry::CreatePyramide(float width, float heigh
 
 	numSubdivisions = std::min<uint32>(numSubdivisions, 6u);
 
-	for (uint32 i = 0; i < numSubdivisions; ++i)
-		Subdivide(meshData);
+	Subdivide(meshData, numSubdivisions, format);
+
+	ComputeBounds(meshData);
 
 	return meshData;
 }
 
-CreateGeometry::MeshData CreateGeometry::CreateSphere(float radius, uint32 sliceCount, uint32 stackCount)
+template<typename Format>
+CreateGeometry::BasicMeshData<Format> CreateGeometry::CreateSphere(float radius, uint32 sliceCount, uint32 stackCount, const Format& format)
 {
-	MeshData meshData;
-	Vertex topVertex(0.0f, +radius, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	Vertex bottomVertex(0.0f, -radius, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	BasicMeshData<Format> meshData;
+	typename Format::Vertex topVertex = MakeVertex(format, 0.0f, +radius, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+	typename Format::Vertex bottomVertex = MakeVertex(format, 0.0f, -radius, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
 	meshData.Vertices.push_back(topVertex);
 
 	float phiStep = XM_PI / stackCount;
@@ -154,26 +169,25 @@ CreateGeometry::MeshData CreateGeometry::CreateSphere(float radius, uint32 slice
 		float phi = i * phiStep;
 		for (uint32 j = 0; j <= sliceCount; ++j) {
 			float theta = j * thetaStep;
-			Vertex v;
+			XMFLOAT3 position, normal, tangent;
 
-			v.Position.x = radius * sinf(phi) * cosf(theta);
-			v.Position.y = radius * cosf(phi);
-			v.Position.z = radius * sinf(phi) * sinf(theta);
+			position.x = radius * sinf(phi) * cosf(theta);
+			position.y = radius * cosf(phi);
+			position.z = radius * sinf(phi) * sinf(theta);
 
-			v.TangentU.x = -radius * sinf(phi) * sinf(theta);
-			v.TangentU.y = 0.0f;
-			v.TangentU.z = +radius * sinf(phi) * cosf(theta);
+			tangent.x = -radius * sinf(phi) * sinf(theta);
+			tangent.y = 0.0f;
+			tangent.z = +radius * sinf(phi) * cosf(theta);
 
-			XMVECTOR T = XMLoadFloat3(&v.TangentU);
-			XMStoreFloat3(&v.TangentU, XMVector3Normalize(T));
+			XMVECTOR T = XMLoadFloat3(&tangent);
+			XMStoreFloat3(&tangent, XMVector3Normalize(T));
 
-			XMVECTOR p = XMLoadFloat3(&v.Position);
-			XMStoreFloat3(&v.Normal, XMVector3Normalize(p));
+			XMVECTOR p = XMLoadFloat3(&position);
+			XMStoreFloat3(&normal, XMVector3Normalize(p));
 
-			v.TexC.x = theta / XM_2PI;
-			v.TexC.y = phi / XM_PI;
+			XMFLOAT2 texC(theta / XM_2PI, phi / XM_PI);
 
-			meshData.Vertices.push_back(v);
+			meshData.Vertices.push_back(format.Make(position, normal, tangent, texC));
 		}
 	}
 
@@ -215,12 +229,15 @@ CreateGeometry::MeshData CreateGeometry::CreateSphere(float radius, uint32 slice
 		meshData.Indices32.push_back(baseIndex + i + 1);
 	}
 
+	ComputeBounds(meshData);
+
 	return meshData;
 }
 
-CreateGeometry::MeshData CreateGeometry::CreateCylinder(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount)
+template<typename Format>
+CreateGeometry::BasicMeshData<Format> CreateGeometry::CreateCylinder(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, const Format& format)
 {
-	MeshData meshData;
+	BasicMeshData<Format> meshData;
 
 	float stackHeight = height / stackCount;
 
@@ -240,20 +257,19 @@ CreateGeometry::MeshData CreateGeometry::CreateCylinder(float bottomRadius, floa
 
 		for (uint32 j = 0; j <= sliceCount; ++j)
 		{
-			Vertex vertex;
 			float c = cosf(j * dTheta);
 			float s = sinf(j * dTheta);
-			vertex.Position = XMFLOAT3(r * c, y, r * s);
-			vertex.TexC.x = (float)j / sliceCount;
-			vertex.TexC.y = 1.0f - (float)i / stackCount;
-			vertex.TangentU = XMFLOAT3(-s, 0.0f, c);
+			XMFLOAT3 position(r * c, y, r * s);
+			XMFLOAT2 texC((float)j / sliceCount, 1.0f - (float)i / stackCount);
+			XMFLOAT3 tangent(-s, 0.0f, c);
 			float dr = bottomRadius - topRadius;
 			XMFLOAT3 bitangent(dr * c, -height, dr * s);
-			XMVECTOR T = XMLoadFloat3(&vertex.TangentU);
+			XMVECTOR T = XMLoadFloat3(&tangent);
 			XMVECTOR B = XMLoadFloat3(&bitangent);
 			XMVECTOR N = XMVector3Normalize(XMVector3Cross(T, B));
-			XMStoreFloat3(&vertex.Normal, N);
-			meshData.Vertices.push_back(vertex);
+			XMFLOAT3 normal;
+			XMStoreFloat3(&normal, N);
+			meshData.Vertices.push_back(format.Make(position, normal, tangent, texC));
 		}
 	}
 
@@ -270,16 +286,19 @@ CreateGeometry::MeshData CreateGeometry::CreateCylinder(float bottomRadius, floa
 		}
 	}
 	BuildCylinderTopCap(bottomRadius, topRadius, height,
-		sliceCount, stackCount, meshData);
+		sliceCount, stackCount, meshData, format);
 	BuildCylinderBottomCap(bottomRadius, topRadius, height,
-		sliceCount, stackCount, meshData);
+		sliceCount, stackCount, meshData, format);
+
+	ComputeBounds(meshData);
 
 	return meshData;
 }
 
-CreateGeometry::MeshData CreateGeometry::CreateGrid(float width, float depth, uint32 m, uint32 n)
+template<typename Format>
+CreateGeometry::BasicMeshData<Format> CreateGeometry::CreateGrid(float width, float depth, uint32 m, uint32 n, const Format& format)
 {
-	MeshData meshData;
+	BasicMeshData<Format> meshData;
 
 	uint32 vertexCount = m * n;
 	uint32 faceCount = (m - 1) * (n - 1) * 2;
@@ -301,12 +320,8 @@ CreateGeometry::MeshData CreateGeometry::CreateGrid(float width, float depth, ui
 		{
 			float x = -halfWidth + j * dx;
 
-			meshData.Vertices[i * n + j].Position = XMFLOAT3(x, 0.0f, z);
-			meshData.Vertices[i * n + j].Normal = XMFLOAT3(0.0f, 1.0f, 0.0f);
-			meshData.Vertices[i * n + j].TangentU = XMFLOAT3(1.0f, 0.0f, 0.0f);
-
-			meshData.Vertices[i * n + j].TexC.x = j * du;
-			meshData.Vertices[i * n + j].TexC.y = i * dv;
+			meshData.Vertices[i * n + j] = format.Make(XMFLOAT3(x, 0.0f, z), XMFLOAT3(0.0f, 1.0f, 0.0f),
+				XMFLOAT3(1.0f, 0.0f, 0.0f), XMFLOAT2(j * du, i * dv));
 		}
 	}
 
@@ -329,103 +344,184 @@ CreateGeometry::MeshData CreateGeometry::CreateGrid(float width, float depth, ui
 		}
 	}
 
+	ComputeBounds(meshData);
+
 	return meshData;
 }
 
-void CreateGeometry::Subdivide(MeshData& meshData)
+template<typename Format>
+std::vector<CreateGeometry::BasicMeshData<Format>> CreateGeometry::CreateBoxLods(float width, float height, float depth, uint32 numSubdivisions, uint32 levelCount, const Format& format)
 {
-	// Save a copy of the input geometry.
-	MeshData inputCopy = meshData;
-
+	std::vector<BasicMeshData<Format>> lods;
+	numSubdivisions = std::min<uint32>(numSubdivisions, 6u);
+	for (uint32 level = 0; level < levelCount; ++level)
+	{
+		lods.push_back(CreateBox(width, height, depth, numSubdivisions, format));
+		if (numSubdivisions == 0)
+			break;
+		numSubdivisions--;
+	}
+	return lods;
+}
 
-	meshData.Vertices.resize(0);
-	meshData.Indices32.resize(0);
+template<typename Format>
+std::vector<CreateGeometry::BasicMeshData<Format>> CreateGeometry::CreatePyramideLods(float width, float height, float depth, uint32 numSubdivisions, uint32 levelCount, const Format& format)
+{
+	std::vector<BasicMeshData<Format>> lods;
+	numSubdivisions = std::min<uint32>(numSubdivisions, 6u);
+	for (uint32 level = 0; level < levelCount; ++level)
+	{
+		lods.push_back(CreatePyramide(width, height, depth, numSubdivisions, format));
+		if (numSubdivisions == 0)
+			break;
+		numSubdivisions--;
+	}
+	return lods;
+}
 
-	//       v1
-	//       *
-	//      / \
-	//     /   \
-	//  m0*-----*m1
-	//   / \   / \
-	//  /   \ /   \
-	// *-----*-----*
-	// v0    m2     v2
+template<typename Format>
+std::vector<CreateGeometry::BasicMeshData<Format>> CreateGeometry::CreateSphereLods(float radius, uint32 sliceCount, uint32 stackCount, uint32 levelCount, const Format& format)
+{
+	// Below 3 slices or 2 stacks the sphere degenerates.
+	std::vector<BasicMeshData<Format>> lods;
+	for (uint32 level = 0; level < levelCount; ++level)
+	{
+		lods.push_back(CreateSphere(radius, sliceCount, stackCount, format));
+		if (sliceCount <= 3 && stackCount <= 2)
+			break;
+		sliceCount = std::max<uint32>(sliceCount / 2, 3u);
+		stackCount = std::max<uint32>(stackCount / 2, 2u);
+	}
+	return lods;
+}
 
-	uint32 numTris = (uint32)inputCopy.Indices32.size() / 3;
-	for (uint32 i = 0; i < numTris; ++i)
+template<typename Format>
+std::vector<CreateGeometry::BasicMeshData<Format>> CreateGeometry::CreateCylinderLods(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, uint32 levelCount, const Format& format)
+{
+	std::vector<BasicMeshData<Format>> lods;
+	for (uint32 level = 0; level < levelCount; ++level)
 	{
-		Vertex v0 = inputCopy.Vertices[inputCopy.Indices32[i * 3 + 0]];
-		Vertex v1 = inputCopy.Vertices[inputCopy.Indices32[i * 3 + 1]];
-		Vertex v2 = inputCopy.Vertices[inputCopy.Indices32[i * 3 + 2]];
-
-		//
-		// Generate the midpoints.
-		//
-
-		Vertex m0 = MidPoint(v0, v1);
-		Vertex m1 = MidPoint(v1, v2);
-		Vertex m2 = MidPoint(v0, v2);
-
-		//
-		// Add new geometry.
-		//
-
-		meshData.Vertices.push_back(v0); // 0
-		meshData.Vertices.push_back(v1); // 1
-		meshData.Vertices.push_back(v2); // 2
-		meshData.Vertices.push_back(m0); // 3
-		meshData.Vertices.push_back(m1); // 4
-		meshData.Vertices.push_back(m2); // 5
-
-		meshData.Indices32.push_back(i * 6 + 0);
-		meshData.Indices32.push_back(i * 6 + 3);
-		meshData.Indices32.push_back(i * 6 + 5);
-
-		meshData.Indices32.push_back(i * 6 + 3);
-		meshData.Indices32.push_back(i * 6 + 4);
-		meshData.Indices32.push_back(i * 6 + 5);
-
-		meshData.Indices32.push_back(i * 6 + 5);
-		meshData.Indices32.push_back(i * 6 + 4);
-		meshData.Indices32.push_back(i * 6 + 2);
-
-		meshData.Indices32.push_back(i * 6 + 3);
-		meshData.Indices32.push_back(i * 6 + 1);
-		meshData.Indices32.push_back(i * 6 + 4);
+		lods.push_back(CreateCylinder(bottomRadius, topRadius, height, sliceCount, stackCount, format));
+		if (sliceCount <= 3 && stackCount <= 1)
+			break;
+		sliceCount = std::max<uint32>(sliceCount / 2, 3u);
+		stackCount = std::max<uint32>(stackCount / 2, 1u);
 	}
+	return lods;
 }
 
-CreateGeometry::Vertex CreateGeometry::MidPoint(const Vertex& v0, const Vertex& v1)
+template<typename Format>
+std::vector<CreateGeometry::BasicMeshData<Format>> CreateGeometry::CreateGridLods(float width, float depth, uint32 m, uint32 n, uint32 levelCount, const Format& format)
 {
-	XMVECTOR p0 = XMLoadFloat3(&v0.Position);
-	XMVECTOR p1 = XMLoadFloat3(&v1.Position);
+	std::vector<BasicMeshData<Format>> lods;
+	for (uint32 level = 0; level < levelCount; ++level)
+	{
+		lods.push_back(CreateGrid(width, depth, m, n, format));
+		if (m <= 2 && n <= 2)
+			break;
+		m = std::max<uint32>(m / 2, 2u);
+		n = std::max<uint32>(n / 2, 2u);
+	}
+	return lods;
+}
 
-	XMVECTOR n0 = XMLoadFloat3(&v0.Normal);
-	XMVECTOR n1 = XMLoadFloat3(&v1.Normal);
+template<typename Format>
+void CreateGeometry::Subdivide(BasicMeshData<Format>& meshData, uint32 numSubdivisions, const Format& format)
+{
+	if (numSubdivisions == 0)
+		return;
 
-	XMVECTOR tan0 = XMLoadFloat3(&v0.TangentU);
-	XMVECTOR tan1 = XMLoadFloat3(&v1.TangentU);
+	// Final index count is known up front; vertices are reserved per level
+	// once its edges are counted.
+	size_t finalIndexCount = meshData.Indices32.size() << (2 * numSubdivisions);
+	std::vector<uint32> indices;
+	indices.reserve(finalIndexCount);
+	meshData.Indices32.reserve(finalIndexCount);
 
-	XMVECTOR tex0 = XMLoadFloat2(&v0.TexC);
-	XMVECTOR tex1 = XMLoadFloat2(&v1.TexC);
+	std::vector<uint64> edgeKeys;
+	std::vector<uint32> edgeMidpoints;
 
-	// Compute the midpoints of all the attributes.  Vectors need to be normalized
-	// since linear interpolating can make them not unit length.  
-	XMVECTOR pos = 0.5f * (p0 + p1);
-	XMVECTOR normal = XMVector3Normalize(0.5f * (n0 + n1));
-	XMVECTOR tangent = XMVector3Normalize(0.5f * (tan0 + tan1));
-	XMVECTOR tex = 0.5f * (tex0 + tex1);
+	for (uint32 level = 0; level < numSubdivisions; ++level)
+	{
+		// Ping-pong: read the triangles of the previous level from indices and
+		// write the new ones to meshData.Indices32.
+		indices.swap(meshData.Indices32);
+		uint32 numTris = (uint32)indices.size() / 3;
+
+		// Open addressing table from edge (lo, hi) to its midpoint vertex, at
+		// most half full.  Both triangles sharing an edge get the same midpoint.
+		size_t tableSize = 64;
+		while (tableSize < (size_t)numTris * 3 * 2)
+			tableSize <<= 1;
+		edgeKeys.assign(tableSize, UINT64_MAX);
+		edgeMidpoints.resize(tableSize);
+
+		uint32 firstMidpoint = (uint32)meshData.Vertices.size();
+		uint32 nextMidpoint = firstMidpoint;
+		auto midpoint = [&](uint32 a, uint32 b) -> uint32
+		{
+			uint64 key = a < b ? ((uint64)a << 32) | b : ((uint64)b << 32) | a;
+			size_t h = (size_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & (tableSize - 1);
+			while (edgeKeys[h] != key)
+			{
+				if (edgeKeys[h] == UINT64_MAX)
+				{
+					edgeKeys[h] = key;
+					edgeMidpoints[h] = nextMidpoint++;
+					break;
+				}
+				h = (h + 1) & (tableSize - 1);
+			}
+			return edgeMidpoints[h];
+		};
+
+		//       v1
+		//       *
+		//      / \         Each triangle (v0, v1, v2) is split at its
+		//     /   \        edge midpoints into (v0, m0, m2),
+		//  m0*-----*m1     (m0, m1, m2), (m2, m1, v2) and
+		//   / \   / \      (m0, v1, m1), all wound like the
+		//  /   \ /   \     parent.
+		// *-----*-----*
+		// v0    m2     v2
+
+		meshData.Indices32.resize(indices.size() * 4);
+		uint32* out = meshData.Indices32.data();
+		for (uint32 i = 0; i < numTris; ++i)
+		{
+			uint32 v0 = indices[i * 3 + 0];
+			uint32 v1 = indices[i * 3 + 1];
+			uint32 v2 = indices[i * 3 + 2];
+
+			uint32 m0 = midpoint(v0, v1);
+			uint32 m1 = midpoint(v1, v2);
+			uint32 m2 = midpoint(v0, v2);
+
+			out[0] = v0; out[1] = m0; out[2] = m2;
+			out[3] = m0; out[4] = m1; out[5] = m2;
+			out[6] = m2; out[7] = m1; out[8] = v2;
+			out[9] = m0; out[10] = v1; out[11] = m1;
+			out += 12;
+		}
 
-	Vertex v;
-	XMStoreFloat3(&v.Position, pos);
-	XMStoreFloat3(&v.Normal, normal);
-	XMStoreFloat3(&v.TangentU, tangent);
-	XMStoreFloat2(&v.TexC, tex);
+		// Now that the edges are known, grow the vertices exactly and fill
+		// every midpoint once.
+		meshData.Vertices.resize(nextMidpoint);
+		for (size_t h = 0; h < tableSize; ++h)
+		{
+			uint64 key = edgeKeys[h];
+			if (key == UINT64_MAX)
+				continue;
 
-	return v;
+			uint32 a = (uint32)(key >> 32);
+			uint32 b = (uint32)key;
+			meshData.Vertices[edgeMidpoints[h]] = format.MidPoint(meshData.Vertices[a], meshData.Vertices[b]);
+		}
+	}
 }
 
-void CreateGeometry::BuildCylinderTopCap(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, MeshData& meshData)
+template<typename Format>
+void CreateGeometry::BuildCylinderTopCap(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, BasicMeshData<Format>& meshData, const Format& format)
 {
 	uint32 baseIndex = (uint32)meshData.Vertices.size();
 	float y = 0.5f * height;
@@ -441,11 +537,11 @@ void CreateGeometry::BuildCylinderTopCap(float bottomRadius, float topRadius, fl
 		float u = x / height + 0.5f;
 		float v = z / height + 0.5f;
 		meshData.Vertices.push_back(
-			Vertex(x, y, z, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, u, v));
+			MakeVertex(format, x, y, z, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, u, v));
 	}
 	// Cap center vertex.
 	meshData.Vertices.push_back(
-		Vertex(0.0f, y, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.5f,
+		MakeVertex(format, 0.0f, y, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.5f,
 			0.5f));
 	// Index of center vertex.
 	uint32 centerIndex = (uint32)meshData.Vertices.size() - 1;
@@ -457,7 +553,8 @@ void CreateGeometry::BuildCylinderTopCap(float bottomRadius, float topRadius, fl
 	}
 }
 
-void CreateGeometry::BuildCylinderBottomCap(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, MeshData& meshData)
+template<typename Format>
+void CreateGeometry::BuildCylinderBottomCap(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, BasicMeshData<Format>& meshData, const Format& format)
 {
 	uint32 baseIndex = (uint32)meshData.Vertices.size();
 	float y = -0.5f * height;
@@ -474,11 +571,11 @@ void CreateGeometry::BuildCylinderBottomCap(float bottomRadius, float topRadius,
 		float u = x / height + 0.5f;
 		float v = z / height + 0.5f;
 
-		meshData.Vertices.push_back(Vertex(x, y, z, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, u, v));
+		meshData.Vertices.push_back(MakeVertex(format, x, y, z, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, u, v));
 	}
 
 	// Cap center vertex.
-	meshData.Vertices.push_back(Vertex(0.0f, y, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.5f, 0.5f));
+	meshData.Vertices.push_back(MakeVertex(format, 0.0f, y, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.5f, 0.5f));
 
 	// Cache the index of center vertex.
 	uint32 centerIndex = (uint32)meshData.Vertices.size() - 1;
@@ -490,3 +587,21 @@ void CreateGeometry::BuildCylinderBottomCap(float bottomRadius, float topRadius,
 		meshData.Indices32.push_back(baseIndex + i + 1);
 	}
 }
+
+// The generators are defined here rather than in the header, so instantiate
+// them for every format of VertexFormats.
+#define INSTANTIATE_CREATE_GEOMETRY(Format) \
+	template CreateGeometry::BasicMeshData<Format> CreateGeometry::CreateBox(float, float, float, uint32, const Format&); \
+	template CreateGeometry::BasicMeshData<Format> CreateGeometry::CreatePyramide(float, float, float, uint32, const Format&); \
+	template CreateGeometry::BasicMeshData<Format> CreateGeometry::CreateSphere(float, uint32, uint32, const Format&); \
+	template CreateGeometry::BasicMeshData<Format> CreateGeometry::CreateCylinder(float, float, float, uint32, uint32, const Format&); \
+	template CreateGeometry::BasicMeshData<Format> CreateGeometry::CreateGrid(float, float, uint32, uint32, const Format&); \
+	template std::vector<CreateGeometry::BasicMeshData<Format>> CreateGeometry::CreateBoxLods(float, float, float, uint32, uint32, const Format&); \
+	template std::vector<CreateGeometry::BasicMeshData<Format>> CreateGeometry::CreatePyramideLods(float, float, float, uint32, uint32, const Format&); \
+	template std::vector<CreateGeometry::BasicMeshData<Format>> CreateGeometry::CreateSphereLods(float, uint32, uint32, uint32, const Format&); \
+	template std::vector<CreateGeometry::BasicMeshData<Format>> CreateGeometry::CreateCylinderLods(float, float, float, uint32, uint32, uint32, const Format&); \
+	template std::vector<CreateGeometry::BasicMeshData<Format>> CreateGeometry::CreateGridLods(float, float, uint32, uint32, uint32, const Format&);
+
+INSTANTIATE_CREATE_GEOMETRY(VertexFormats::Position)
+INSTANTIATE_CREATE_GEOMETRY(VertexFormats::PositionColor)
+INSTANTIATE_CREATE_GEOMETRY(VertexFormats::PositionNormalTangentUV)
@@ -1,47 +1,35 @@
 #pragma once
 #include <cstdint>
 #include <DirectXMath.h>
+#include <DirectXCollision.h>
 #include <vector>
+#include "VertexFormat.h"
 
+// Procedural shapes.  Every generator is templated on a vertex format (see
+// VertexFormat.h) and emits vertices of that layout directly; the default is
+// the full position/normal/tangent/UV layout.  The templates are defined in
+// CreateGeometry.cpp and instantiated there for the formats of VertexFormats.
 class CreateGeometry
 {
 public:
 	using uint16 = std::uint16_t;
 	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
 
-	struct Vertex
-	{
-		Vertex() {}
-		Vertex(
-			const DirectX::XMFLOAT3& p,
-			const DirectX::XMFLOAT3& n,
-			const DirectX::XMFLOAT3& t,
-			const DirectX::XMFLOAT2& uv) :
-			Position(p),
-			Normal(n),
-			TangentU(t),
-			TexC(uv) {}
-		Vertex(
-			float px, float py, float pz,
-			float nx, float ny, float nz,
-			float tx, float ty, float tz,
-			float u, float v) :
-			Position(px, py, pz),
-			Normal(nx, ny, nz),
-			TangentU(tx, ty, tz),
-			TexC(u, v) {}
-
-		DirectX::XMFLOAT3 Position;
-		DirectX::XMFLOAT3 Normal;
-		DirectX::XMFLOAT3 TangentU;
-		DirectX::XMFLOAT2 TexC;
-	};
+	using DefaultFormat = VertexFormats::PositionNormalTangentUV;
+	using Vertex = DefaultFormat::Vertex;
 
-	struct MeshData
+	template<typename Format>
+	struct BasicMeshData
 	{
-		std::vector<Vertex> Vertices;
+		using VertexType = typename Format::Vertex;
+
+		std::vector<VertexType> Vertices;
 		std::vector<uint32> Indices32;
 
+		// Local space bounds of Vertices, filled by every Create function.
+		DirectX::BoundingBox Bounds;
+
 		std::vector<uint16>& GetIndices16()
 		{
 			if (mIndices16.empty())
@@ -58,17 +46,58 @@ public:
 		std::vector<uint16> mIndices16;
 	};
 
-	MeshData								CreateBox(float width, float height, float depth, uint32 numSubdivisions);
-	MeshData								CreatePyramide(float width, float height, float depth, uint32 numSubdivisions);
-	MeshData								CreateSphere(float radius, uint32 numSubdivisions, uint32 stackCount);
-	MeshData								CreateCylinder(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount);
-	MeshData								CreateGrid(float width, float depth, uint32 m, uint32 n);
+	using MeshData = BasicMeshData<DefaultFormat>;
+
+	template<typename Format = DefaultFormat>
+	BasicMeshData<Format>					CreateBox(float width, float height, float depth, uint32 numSubdivisions, const Format& format = Format());
+	template<typename Format = DefaultFormat>
+	BasicMeshData<Format>					CreatePyramide(float width, float height, float depth, uint32 numSubdivisions, const Format& format = Format());
+	template<typename Format = DefaultFormat>
+	BasicMeshData<Format>					CreateSphere(float radius, uint32 numSubdivisions, uint32 stackCount, const Format& format = Format());
+	template<typename Format = DefaultFormat>
+	BasicMeshData<Format>					CreateCylinder(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, const Format& format = Format());
+	template<typename Format = DefaultFormat>
+	BasicMeshData<Format>					CreateGrid(float width, float depth, uint32 m, uint32 n, const Format& format = Format());
+
+	// LOD chains: level 0 is the mesh built with the given parameters, every
+	// next level halves the slice and stack (or row and column) counts, or
+	// drops one subdivision.  Generation stops early once a level cannot get
+	// any coarser, so fewer than levelCount meshes may come back.
+	template<typename Format = DefaultFormat>
+	std::vector<BasicMeshData<Format>>		CreateBoxLods(float width, float height, float depth, uint32 numSubdivisions, uint32 levelCount, const Format& format = Format());
+	template<typename Format = DefaultFormat>
+	std::vector<BasicMeshData<Format>>		CreatePyramideLods(float width, float height, float depth, uint32 numSubdivisions, uint32 levelCount, const Format& format = Format());
+	template<typename Format = DefaultFormat>
+	std::vector<BasicMeshData<Format>>		CreateSphereLods(float radius, uint32 sliceCount, uint32 stackCount, uint32 levelCount, const Format& format = Format());
+	template<typename Format = DefaultFormat>
+	std::vector<BasicMeshData<Format>>		CreateCylinderLods(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, uint32 levelCount, const Format& format = Format());
+	template<typename Format = DefaultFormat>
+	std::vector<BasicMeshData<Format>>		CreateGridLods(float width, float depth, uint32 m, uint32 n, uint32 levelCount, const Format& format = Format());
+
+	// Local space bounds of any vertex format; every format has a Position.
+	template<typename Format>
+	static void								ComputeBounds(BasicMeshData<Format>& meshData)
+	{
+		if (meshData.Vertices.empty())
+		{
+			meshData.Bounds = DirectX::BoundingBox();
+			return;
+		}
+
+		DirectX::BoundingBox::CreateFromPoints(meshData.Bounds, meshData.Vertices.size(),
+			&meshData.Vertices[0].Position, sizeof(typename Format::Vertex));
+	}
 
 private:
 
-	void									Subdivide(MeshData& meshData);
-	Vertex									MidPoint(const Vertex& v0, const Vertex& v1);
-	void									BuildCylinderTopCap(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, MeshData& meshData);
-	void									BuildCylinderBottomCap(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, MeshData& meshData);
+	// Splits every triangle in four numSubdivisions times.  Edge midpoints are
+	// shared between the triangles of an edge, so each level adds one vertex
+	// per edge instead of six per triangle.
+	template<typename Format>
+	void									Subdivide(BasicMeshData<Format>& meshData, uint32 numSubdivisions, const Format& format);
+	template<typename Format>
+	void									BuildCylinderTopCap(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, BasicMeshData<Format>& meshData, const Format& format);
+	template<typename Format>
+	void									BuildCylinderBottomCap(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, BasicMeshData<Format>& meshData, const Format& format);
 
-};
\ No newline at end of file
+};
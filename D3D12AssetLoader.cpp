@@ -0,0 +1,51 @@
+#include "D3D12AssetLoader.h"
+
+using namespace DirectX;
+
+std::unique_ptr<MeshGeometry> D3D12AssetLoader::CreateMesh(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList,
+	const AssetArchive& archive, const ArchiveEntry& entry)
+{
+	AssetArchive::MeshView view;
+	if (!archive.GetMesh(entry, view))
+		ThrowIfFailed(E_INVALIDARG);
+
+	auto geo = std::make_unique<MeshGeometry>();
+	geo->Name = std::string(archive.GetName(entry.NameOffset));
+	geo->VertexByteStride = view.Header->VertexByteStride;
+	geo->VertexBufferByteSize = (UINT)view.Vertices.size();
+	geo->IndexFormat = view.Header->IndexByteStride == 4 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+	geo->IndexBufferByteSize = (UINT)view.Indices.size();
+
+	// The mapping is the upload source, there is no intermediate copy.
+	geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(device, cmdList,
+		view.Vertices.data(), view.Vertices.size(), geo->VertexBufferUploader);
+	geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(device, cmdList,
+		view.Indices.data(), view.Indices.size(), geo->IndexBufferUploader);
+
+	for (const ArchiveSubmesh& record : view.Submeshes)
+	{
+		SubmeshGeometry submesh;
+		submesh.IndexCount = record.IndexCount;
+		submesh.StartIndexLocation = record.StartIndexLocation;
+		submesh.BaseVertexLocation = record.BaseVertexLocation;
+		submesh.Bounds.Center = XMFLOAT3(record.BoundsCenter);
+		submesh.Bounds.Extents = XMFLOAT3(record.BoundsExtents);
+		geo->DrawArgs[std::string(archive.GetName(record.NameOffset))] = submesh;
+	}
+
+	return geo;
+}
+
+std::unique_ptr<Texture> D3D12AssetLoader::CreateTexture(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList,
+	const AssetArchive& archive, const ArchiveEntry& entry)
+{
+	if (entry.Type != ArchiveAssetType::Texture)
+		ThrowIfFailed(E_INVALIDARG);
+
+	std::span<const std::byte> dds = archive.GetBlob(entry);
+	auto tex = std::make_unique<Texture>();
+	tex->Name = std::string(archive.GetName(entry.NameOffset));
+	ThrowIfFailed(DirectX::CreateDDSTextureFromMemory12(device, cmdList,
+		reinterpret_cast<const uint8_t*>(dds.data()), dds.size(), tex->Resource, tex->UploadHeap));
+	return tex;
+}
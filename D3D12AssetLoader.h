@@ -0,0 +1,22 @@
+#pragma once
+
+#include <memory>
+#include "d3dUtil.h"
+#include "AssetArchive.h"
+
+// Creates GPU resources straight from the views of a mapped AssetArchive.
+// Like d3dUtil::CreateDefaultBuffer, the copies are recorded on cmdList: the
+// upload buffers kept in the returned objects, and the archive mapping, must
+// outlive the execution of the command list.
+class D3D12AssetLoader
+{
+public:
+	// The mesh has no CPU copies, VertexBufferCPU and IndexBufferCPU are null;
+	// its DrawArgs are the submeshes of the archive.  Throws if entry is not
+	// a valid mesh.
+	static std::unique_ptr<MeshGeometry>	CreateMesh(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList,
+												const AssetArchive& archive, const ArchiveEntry& entry);
+	// Throws if entry is not a texture or not a DDS file the loader supports.
+	static std::unique_ptr<Texture>			CreateTexture(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList,
+												const AssetArchive& archive, const ArchiveEntry& entry);
+};
@@ -0,0 +1,44 @@
+#include "D3D12GpuFence.h"
+
+D3D12GpuFence::D3D12GpuFence(ID3D12Device* device, ID3D12CommandQueue* queue) :
+	mQueue(queue)
+{
+	ThrowIfFailed(device->CreateFence(0, D3D12_FENCE_FLAG_NONE,
+		IID_PPV_ARGS(&mFence)));
+
+	mEventHandle = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
+}
+
+D3D12GpuFence::~D3D12GpuFence()
+{
+	if (mEventHandle != nullptr)
+		CloseHandle(mEventHandle);
+}
+
+std::uint64_t D3D12GpuFence::Signal()
+{
+	// Advance the fence value to mark commands up to this fence point.
+	mCurrentFence++;
+
+	// Add an instruction to the command queue to set a new fence point.  Because we 
+	// are on the GPU timeline, the new fence point won't be set until the GPU finishes
+	// processing all the commands prior to this Signal().
+	ThrowIfFailed(mQueue->Signal(mFence.Get(), mCurrentFence));
+	return mCurrentFence;
+}
+
+std::uint64_t D3D12GpuFence::GetCompletedValue() const
+{
+	return mFence->GetCompletedValue();
+}
+
+void D3D12GpuFence::Wait(std::uint64_t value)
+{
+	// Wait until the GPU has completed commands up to this fence point.
+	if (mFence->GetCompletedValue() < value)
+	{
+		// Fire event when GPU hits the fence.
+		ThrowIfFailed(mFence->SetEventOnCompletion(value, mEventHandle));
+		WaitForSingleObject(mEventHandle, INFINITE);
+	}
+}
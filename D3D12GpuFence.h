@@ -0,0 +1,23 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "GpuFence.h"
+
+class D3D12GpuFence : public GpuFence
+{
+public:
+	D3D12GpuFence(ID3D12Device* device, ID3D12CommandQueue* queue);
+	D3D12GpuFence(const D3D12GpuFence& rhs) = delete;
+	D3D12GpuFence& operator=(const D3D12GpuFence& rhs) = delete;
+	~D3D12GpuFence();
+
+	std::uint64_t Signal() override;
+	std::uint64_t GetCompletedValue() const override;
+	void Wait(std::uint64_t value) override;
+
+private:
+	Microsoft::WRL::ComPtr<ID3D12Fence> mFence;
+	ID3D12CommandQueue* mQueue = nullptr;
+	UINT64 mCurrentFence = 0;
+	HANDLE mEventHandle = nullptr;
+};
@@ -0,0 +1,157 @@
+#include "EntityStore.h"
+
+using namespace DirectX;
+
+void EntityStore::CreatePool(EntityKind kind, uint32 capacity)
+{
+	uint32 first = (uint32)mSlotIndex.size();
+	uint32 total = first + capacity;
+
+	// Chain the new slots in front of whatever is already free for this kind.
+	uint32& head = mFreeHead[(uint32)kind];
+	mSlotIndex.resize(total, FreeSlot);
+	mNextFree.resize(total);
+	mSlotGeneration.resize(total, 0);
+	for (uint32 slot = total; slot-- > first;)
+	{
+		mNextFree[slot] = head;
+		head = slot;
+	}
+
+	Position.reserve(total);
+	PrevPosition.reserve(total);
+	Rotation.reserve(total);
+	Kind.reserve(total);
+	Timer.reserve(total);
+	LifeTime.reserve(total);
+	DrawArg.reserve(total);
+	Lod.reserve(total);
+	Slot.reserve(total);
+	NumFramesDirty.reserve(total);
+}
+
+void EntityStore::SetFrameResourceCount(uint32 count)
+{
+	mFrameResourceCount = count;
+}
+
+EntityHandle EntityStore::Add(EntityKind kind, uint32 drawArg, const XMFLOAT3& position, const XMFLOAT4& rotation)
+{
+	uint32& head = mFreeHead[(uint32)kind];
+	if (head == UINT32_MAX)
+		return EntityHandle();
+
+	uint32 slot = head;
+	head = mNextFree[slot];
+	mSlotIndex[slot] = (uint32)Kind.size();
+	mCount[(uint32)kind]++;
+
+	Position.push_back(position);
+	PrevPosition.push_back(position);
+	Rotation.push_back(rotation);
+	Kind.push_back(kind);
+	Timer.push_back(0.0f);
+	LifeTime.push_back(0.0f);
+	DrawArg.push_back(drawArg);
+	Lod.push_back(0);
+	Slot.push_back(slot);
+	NumFramesDirty.push_back(mFrameResourceCount);
+
+	EntityHandle handle;
+	handle.Index = slot;
+	handle.Generation = mSlotGeneration[slot];
+	return handle;
+}
+
+void EntityStore::Remove(EntityHandle handle)
+{
+	if (IsAlive(handle))
+		RemoveAt(mSlotIndex[handle.Index]);
+}
+
+void EntityStore::RemoveAt(uint32 index)
+{
+	uint32 last = (uint32)Kind.size() - 1;
+	uint32 slot = Slot[index];
+	uint32& head = mFreeHead[(uint32)Kind[index]];
+	mCount[(uint32)Kind[index]]--;
+
+	// Swap the last entity into the hole and pop.
+	if (index != last)
+	{
+		Position[index] = Position[last];
+		PrevPosition[index] = PrevPosition[last];
+		Rotation[index] = Rotation[last];
+		Kind[index] = Kind[last];
+		Timer[index] = Timer[last];
+		LifeTime[index] = LifeTime[last];
+		DrawArg[index] = DrawArg[last];
+		Lod[index] = Lod[last];
+		Slot[index] = Slot[last];
+		NumFramesDirty[index] = NumFramesDirty[last];
+		mSlotIndex[Slot[index]] = index;
+	}
+
+	Position.pop_back();
+	PrevPosition.pop_back();
+	Rotation.pop_back();
+	Kind.pop_back();
+	Timer.pop_back();
+	LifeTime.pop_back();
+	DrawArg.pop_back();
+	Lod.pop_back();
+	Slot.pop_back();
+	NumFramesDirty.pop_back();
+
+	mSlotGeneration[slot]++;
+	mSlotIndex[slot] = FreeSlot;
+	mNextFree[slot] = head;
+	head = slot;
+}
+
+void EntityStore::Clear()
+{
+	while (!Kind.empty())
+		RemoveAt((uint32)Kind.size() - 1);
+}
+
+EntityStore::uint32 EntityStore::Size() const
+{
+	return (uint32)Kind.size();
+}
+
+EntityStore::uint32 EntityStore::Count(EntityKind kind) const
+{
+	return mCount[(uint32)kind];
+}
+
+bool EntityStore::IsAlive(EntityHandle handle) const
+{
+	// A free slot fails even with the right generation: that handle was
+	// never issued.
+	return handle.Index < mSlotIndex.size() && mSlotIndex[handle.Index] != FreeSlot
+		&& mSlotGeneration[handle.Index] == handle.Generation;
+}
+
+EntityStore::uint32 EntityStore::IndexOf(EntityHandle handle) const
+{
+	return mSlotIndex[handle.Index];
+}
+
+EntityHandle EntityStore::HandleAt(uint32 index) const
+{
+	EntityHandle handle;
+	handle.Index = Slot[index];
+	handle.Generation = mSlotGeneration[handle.Index];
+	return handle;
+}
+
+EntityStore::uint32 EntityStore::SlotCount() const
+{
+	return (uint32)mSlotIndex.size();
+}
+
+void EntityStore::MarkDirty(uint32 index)
+{
+	NumFramesDirty[index] = mFrameResourceCount;
+}
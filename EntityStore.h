@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include <DirectXMath.h>
+#include <vector>
+
+enum class EntityKind : std::uint8_t
+{
+	TestBox,
+	Player,
+	Asteroid,
+	Projectile
+};
+
+constexpr std::uint32_t EntityKindCount = 4;
+
+// Generational handle to an entity.  Index is a slot that stays the same for
+// the whole life of the entity; Generation is bumped every time the slot is
+// freed, so a handle kept past the removal of its entity is detected as stale.
+struct EntityHandle
+{
+	std::uint32_t Index = UINT32_MAX;
+	std::uint32_t Generation = 0;
+};
+
+// Struct-of-arrays storage for every entity of the scene.  Each entity is a
+// dense index shared by all the arrays below, so the per-frame loops
+// (movement, timers, collision, constant buffer packing) stream through
+// contiguous memory and only touch the fields they need.
+//
+// Dense indices move when entities are removed (the last entity is swapped
+// into the hole), so anything that must outlive a frame holds an
+// EntityHandle.  Slots come from fixed-size pools, one per kind, created up
+// front with CreatePool.  Each pool owns a contiguous slot range and a free
+// list, so Add and Remove are O(1) and never allocate.
+class EntityStore
+{
+public:
+	using uint32 = std::uint32_t;
+
+	// Preallocates capacity slots for kind.  Call once per kind before spawning.
+	void									CreatePool(EntityKind kind, uint32 capacity);
+	// Value NumFramesDirty is reset to when an entity is added or changed.
+	void									SetFrameResourceCount(uint32 count);
+
+	// Returns an invalid handle when the pool of kind is exhausted.
+	EntityHandle							Add(EntityKind kind, uint32 drawArg, const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT4& rotation);
+	void									Remove(EntityHandle handle);
+	void									RemoveAt(uint32 index);
+	void									Clear();
+	uint32									Size() const;
+	// Live entities of kind, kept up to date by Add and Remove.
+	uint32									Count(EntityKind kind) const;
+
+	bool									IsAlive(EntityHandle handle) const;
+	// Dense index of a live entity.
+	uint32									IndexOf(EntityHandle handle) const;
+	EntityHandle							HandleAt(uint32 index) const;
+	// Total slots of all pools; slot indices are always below this.
+	uint32									SlotCount() const;
+
+	// Flags the constants of an entity for upload to every frame resource.
+	void									MarkDirty(uint32 index);
+
+	// Hot data, indexed by dense entity index.
+	std::vector<DirectX::XMFLOAT3>			Position;
+	// Position at the start of the current simulation tick; frames drawn
+	// between two ticks interpolate from it to Position.
+	std::vector<DirectX::XMFLOAT3>			PrevPosition;
+	std::vector<DirectX::XMFLOAT4>			Rotation; // quaternion
+	std::vector<EntityKind>					Kind;
+	std::vector<float>						Timer;
+	std::vector<float>						LifeTime;
+	std::vector<uint32>						DrawArg;  // mesh (LOD chain) of the entity
+	std::vector<uint32>						Lod;      // LOD level picked last frame
+	std::vector<uint32>						Slot;     // slot owning this dense index
+	// Dirty flag indicating the object data has changed and we need to update the constant buffer.
+	// Because we have an object cbuffer for each FrameResource, we have to apply the
+	// update to each FrameResource.  Thus, when we modify object data we call
+	// MarkDirty so that each frame resource gets the update.
+	std::vector<uint32>						NumFramesDirty;
+
+private:
+	static constexpr uint32					FreeSlot = UINT32_MAX;
+
+	// Per slot: dense index while alive, FreeSlot while free.
+	std::vector<uint32>						mSlotIndex;
+	// Per free slot: next free slot of its pool.
+	std::vector<uint32>						mNextFree;
+	std::vector<uint32>						mSlotGeneration;
+	uint32									mFreeHead[EntityKindCount] = { UINT32_MAX, UINT32_MAX, UINT32_MAX, UINT32_MAX };
+	uint32									mCount[EntityKindCount] = {};
+	uint32									mFrameResourceCount = 1;
+};
@@ -0,0 +1,18 @@
+#include "FrameResource.h"
+
+const int gNumFrameResources = 3;
+
+FrameResource::FrameResource(ID3D12Device* device, UINT passCount, UINT objectCount)
+{
+    ThrowIfFailed(device->CreateCommandAllocator(
+        D3D12_COMMAND_LIST_TYPE_DIRECT,
+        IID_PPV_ARGS(CmdListAlloc.GetAddressOf())));
+
+    PassCB = std::make_unique<UploadBuffer<PassConstants>>(device, passCount, true);
+    InstanceBuffer = std::make_unique<UploadBuffer<InstanceData>>(device, objectCount, false);
+}
+
+FrameResource::~FrameResource()
+{
+
+}
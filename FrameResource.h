@@ -0,0 +1,46 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "MathHelper.h"
+#include "UploadBuffer.h"
+#include "GameObject.h"
+
+struct PassConstants {
+    DirectX::XMFLOAT4X4                                                 View;
+    DirectX::XMFLOAT4X4                                                 InvView;
+    DirectX::XMFLOAT4X4                                                 Proj;
+    DirectX::XMFLOAT4X4                                                 InvProj;
+    DirectX::XMFLOAT4X4                                                 ViewProj;
+    DirectX::XMFLOAT4X4                                                 InvViewProj;
+    DirectX::XMFLOAT3                                                   EyePosW;
+    float                                                               cbPerObjectPad1;
+    DirectX::XMFLOAT2                                                   RenderTargetSize;
+    DirectX::XMFLOAT2                                                   InvRenderTargetSize;
+    float                                                               NearZ;
+    float                                                               FarZ;
+    float                                                               TotalTime;
+    float                                                               DeltaTime;
+};
+
+// Stores the resources needed for the CPU to build the command lists
+// for a frame.  There are gNumFrameResources of them so the CPU can work on
+// the next frames while the GPU still reads the previous ones.
+struct FrameResource
+{
+public:
+    FrameResource(ID3D12Device* device, UINT passCount, UINT objectCount);
+    FrameResource(const FrameResource& rhs) = delete;
+    FrameResource& operator=(const FrameResource& rhs) = delete;
+    ~FrameResource();
+
+    // We cannot reset the allocator until the GPU is done processing the commands.
+    // So each frame needs their own allocator.
+    Microsoft::WRL::ComPtr<ID3D12CommandAllocator> CmdListAlloc;
+
+    // We cannot update a cbuffer until the GPU is done processing the commands
+    // that reference it.  So each frame needs their own cbuffers.
+    std::unique_ptr<UploadBuffer<PassConstants>> PassCB = nullptr;
+    // Structured buffer indexed by entity slot, so the data of an entity stays
+    // valid while it lives and only has to be rewritten when it changes.
+    std::unique_ptr<UploadBuffer<InstanceData>> InstanceBuffer = nullptr;
+};
@@ -0,0 +1,43 @@
+#include "FrameScheduler.h"
+
+FrameScheduler::FrameScheduler(GpuFence* fence, std::uint32_t frameCount) :
+	mFence(fence),
+	mFrameFences(frameCount, 0),
+	// So that the first BeginFrame lands on resource 0.
+	mCurrentFrame(frameCount - 1)
+{
+}
+
+std::uint32_t FrameScheduler::BeginFrame()
+{
+	mCurrentFrame = (mCurrentFrame + 1) % (std::uint32_t)mFrameFences.size();
+
+	// Has the GPU finished processing the commands of the current frame resource?
+	// If not, wait until the GPU has completed commands up to this fence point.
+	std::uint64_t fence = mFrameFences[mCurrentFrame];
+	if (fence != 0 && mFence->GetCompletedValue() < fence)
+		mFence->Wait(fence);
+
+	return mCurrentFrame;
+}
+
+std::uint64_t FrameScheduler::EndFrame()
+{
+	mFrameFences[mCurrentFrame] = mFence->Signal();
+	return mFrameFences[mCurrentFrame];
+}
+
+std::uint32_t FrameScheduler::GetCurrentFrame() const
+{
+	return mCurrentFrame;
+}
+
+std::uint32_t FrameScheduler::GetFrameCount() const
+{
+	return (std::uint32_t)mFrameFences.size();
+}
+
+std::uint64_t FrameScheduler::GetFrameFence(std::uint32_t index) const
+{
+	return mFrameFences[index];
+}
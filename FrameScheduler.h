@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "GpuFence.h"
+
+// Cycles through a fixed number of frame resources so the CPU can record
+// frame N+1 while the GPU still works on frame N.  BeginFrame only blocks
+// when the GPU is so far behind that the resource about to be reused is
+// still referenced by a submitted frame.
+class FrameScheduler
+{
+public:
+	FrameScheduler(GpuFence* fence, std::uint32_t frameCount);
+
+	// Moves to the next frame resource and returns its index, waiting for the
+	// GPU to release it if needed.
+	std::uint32_t							BeginFrame();
+	// Signals the fence behind the commands of the current frame and returns
+	// the value that marks its completion.
+	std::uint64_t							EndFrame();
+
+	std::uint32_t							GetCurrentFrame() const;
+	std::uint32_t							GetFrameCount() const;
+	// Fence value that releases frame resource index (0 if never submitted).
+	std::uint64_t							GetFrameFence(std::uint32_t index) const;
+
+private:
+	GpuFence*								mFence;
+	std::vector<std::uint64_t>				mFrameFences;
+	std::uint32_t							mCurrentFrame;
+};
@@ -0,0 +1,265 @@
+#include "FrameStats.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+namespace
+{
+	static_assert((FrameStats::Capacity & (FrameStats::Capacity - 1)) == 0, "the frame capacity must be a power of two");
+
+	// Nearest rank: the smallest value with at least fraction of the values at or below it.
+	float Percentile(const std::vector<float>& sorted, double fraction)
+	{
+		size_t rank = (size_t)std::ceil(fraction * sorted.size());
+		return sorted[rank > 0 ? rank - 1 : 0];
+	}
+}
+
+void FrameStats::Histogram::Add(float milliseconds)
+{
+	uint64 microseconds = milliseconds > 0.0f ? (uint64)(milliseconds * 1000.0 + 0.5) : 0;
+	mCounts[GetBucket(microseconds)]++;
+	mCount++;
+}
+
+FrameStats::uint32 FrameStats::Histogram::GetBucket(uint64 microseconds)
+{
+	if (microseconds < SubBucketCount)
+		return (uint32)microseconds;
+
+	// microseconds is in [SubBucketCount, 2 * SubBucketCount) << magnitude, and
+	// its top SubBucketBits + 1 bits pick the bucket within the magnitude.
+	uint32 magnitude = (uint32)std::bit_width(microseconds) - SubBucketBits - 1;
+	if (magnitude >= MagnitudeCount)
+		return BucketCount - 1;
+	return (uint32)(microseconds >> magnitude) + magnitude * SubBucketCount;
+}
+
+FrameStats::uint64 FrameStats::Histogram::GetBucketLowMicroseconds(uint32 bucket)
+{
+	if (bucket < SubBucketCount)
+		return bucket;
+
+	uint32 magnitude = bucket / SubBucketCount - 1;
+	return (uint64)(SubBucketCount + bucket % SubBucketCount) << magnitude;
+}
+
+FrameStats::uint64 FrameStats::Histogram::GetCount() const
+{
+	return mCount;
+}
+
+FrameStats::uint64 FrameStats::Histogram::GetBucketCount(uint32 bucket) const
+{
+	return mCounts[bucket];
+}
+
+float FrameStats::Histogram::GetBucketLow(uint32 bucket) const
+{
+	return GetBucketLowMicroseconds(bucket) / 1000.0f;
+}
+
+float FrameStats::Histogram::GetBucketHigh(uint32 bucket) const
+{
+	uint64 width = bucket < SubBucketCount ? 1 : (uint64)1 << (bucket / SubBucketCount - 1);
+	return (GetBucketLowMicroseconds(bucket) + width) / 1000.0f;
+}
+
+float FrameStats::Histogram::GetValueAtPercentile(double fraction) const
+{
+	if (mCount == 0)
+		return 0.0f;
+
+	uint64 rank = std::max<uint64>((uint64)std::ceil(fraction * mCount), 1);
+	uint64 seen = 0;
+	for (uint32 bucket = 0; bucket < BucketCount; bucket++)
+	{
+		seen += mCounts[bucket];
+		if (seen >= rank)
+			return GetBucketHigh(bucket);
+	}
+	return GetBucketHigh(BucketCount - 1);
+}
+
+FrameStats::uint64 FrameStats::Histogram::GetCountAbove(float milliseconds) const
+{
+	uint64 count = 0;
+	for (uint32 bucket = BucketCount; bucket-- > 0;)
+	{
+		if (GetBucketLow(bucket) < milliseconds)
+			break;
+		count += mCounts[bucket];
+	}
+	return count;
+}
+
+FrameStats::FrameStats()
+{
+	// The ring and the sort space are allocated once, so adding a frame never allocates.
+	mFrames.resize(Capacity);
+	mScratch.reserve(Capacity);
+}
+
+void FrameStats::AddFrame(const Frame& frame)
+{
+	mFrames[mFrameCount & (Capacity - 1)] = frame;
+	mFrameCount++;
+
+	for (uint32 phase = 0; phase < PhaseCount; phase++)
+		mHistograms[phase].Add(frame.Milliseconds[phase]);
+	if (frame.Milliseconds[Total] > mHitchThreshold)
+		mHitchCount++;
+}
+
+FrameStats::uint32 FrameStats::GetFrameCount() const
+{
+	return (uint32)std::min<uint64>(mFrameCount, Capacity);
+}
+
+FrameStats::uint64 FrameStats::GetTotalFrameCount() const
+{
+	return mFrameCount;
+}
+
+const FrameStats::Frame& FrameStats::GetFrame(uint32 index) const
+{
+	uint64 oldest = mFrameCount - GetFrameCount();
+	return mFrames[(oldest + index) & (Capacity - 1)];
+}
+
+FrameStats::Summary FrameStats::Summarize(Phase phase, uint32 frameCount) const
+{
+	Summary summary;
+	uint32 count = std::min(frameCount, GetFrameCount());
+	if (count == 0)
+		return summary;
+
+	mScratch.clear();
+	double sum = 0.0;
+	for (uint32 i = GetFrameCount() - count; i < GetFrameCount(); i++)
+	{
+		float value = GetFrame(i).Milliseconds[phase];
+		mScratch.push_back(value);
+		sum += value;
+		if (value > mHitchThreshold)
+			summary.Hitches++;
+	}
+	std::sort(mScratch.begin(), mScratch.end());
+
+	summary.FrameCount = count;
+	summary.Mean = (float)(sum / count);
+	summary.P50 = Percentile(mScratch, 0.50);
+	summary.P95 = Percentile(mScratch, 0.95);
+	summary.P99 = Percentile(mScratch, 0.99);
+	summary.Max = mScratch.back();
+	return summary;
+}
+
+const FrameStats::Histogram& FrameStats::GetHistogram(Phase phase) const
+{
+	return mHistograms[phase];
+}
+
+void FrameStats::SetHitchThreshold(float milliseconds)
+{
+	mHitchThreshold = milliseconds;
+}
+
+float FrameStats::GetHitchThreshold() const
+{
+	return mHitchThreshold;
+}
+
+FrameStats::uint64 FrameStats::GetHitchCount() const
+{
+	return mHitchCount;
+}
+
+bool FrameStats::WriteCsv(const char* path) const
+{
+	std::ofstream fout(path, std::ios::trunc);
+	if (!fout)
+		return false;
+
+	fout << "frame";
+	for (uint32 phase = 0; phase < PhaseCount; phase++)
+		fout << ',' << GetPhaseName((Phase)phase) << "_ms";
+	fout << '\n';
+
+	uint64 oldest = mFrameCount - GetFrameCount();
+	char value[32];
+	for (uint32 i = 0; i < GetFrameCount(); i++)
+	{
+		fout << oldest + i;
+		for (uint32 phase = 0; phase < PhaseCount; phase++)
+		{
+			snprintf(value, sizeof(value), ",%.3f", GetFrame(i).Milliseconds[phase]);
+			fout << value;
+		}
+		fout << '\n';
+	}
+	return (bool)fout;
+}
+
+bool FrameStats::WriteHistogramCsv(const char* path) const
+{
+	std::ofstream fout(path, std::ios::trunc);
+	if (!fout)
+		return false;
+
+	fout << "low_ms,high_ms";
+	for (uint32 phase = 0; phase < PhaseCount; phase++)
+		fout << ',' << GetPhaseName((Phase)phase);
+	fout << '\n';
+
+	char range[48];
+	for (uint32 bucket = 0; bucket < Histogram::BucketCount; bucket++)
+	{
+		bool empty = true;
+		for (uint32 phase = 0; phase < PhaseCount; phase++)
+			empty = empty && mHistograms[phase].GetBucketCount(bucket) == 0;
+		if (empty)
+			continue;
+
+		const Histogram& any = mHistograms[0];
+		snprintf(range, sizeof(range), "%.3f,%.3f", any.GetBucketLow(bucket), any.GetBucketHigh(bucket));
+		fout << range;
+		for (uint32 phase = 0; phase < PhaseCount; phase++)
+			fout << ',' << mHistograms[phase].GetBucketCount(bucket);
+		fout << '\n';
+	}
+	return (bool)fout;
+}
+
+bool FrameStats::WriteSummaryCsv(const char* path) const
+{
+	std::ofstream fout(path, std::ios::trunc);
+	if (!fout)
+		return false;
+
+	fout << "phase,frames,mean_ms,p50_ms,p95_ms,p99_ms,max_ms,hitches\n";
+	char line[160];
+	for (uint32 phase = 0; phase < PhaseCount; phase++)
+	{
+		Summary summary = Summarize((Phase)phase);
+		snprintf(line, sizeof(line), "%s,%u,%.3f,%.3f,%.3f,%.3f,%.3f,%u\n", GetPhaseName((Phase)phase),
+			summary.FrameCount, summary.Mean, summary.P50, summary.P95, summary.P99, summary.Max, summary.Hitches);
+		fout << line;
+	}
+	fout << "total_hitches_since_start," << mHitchCount << '\n';
+	return (bool)fout;
+}
+
+const char* FrameStats::GetPhaseName(Phase phase)
+{
+	switch (phase)
+	{
+	case Sim:			return "sim";
+	case Record:		return "record";
+	case PresentWait:	return "present_wait";
+	case Total:			return "total";
+	default:			return "unknown";
+	}
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Frame time statistics.  Every frame adds its durations, split by phase;
+// the last Capacity frames are kept as they are in a ring, for percentiles
+// over a recent window and the CSV dump, while a histogram per phase counts
+// every frame since the start.
+//
+// Averages hide stutter: a spawn wave that stalls one frame in a hundred
+// barely moves the mean but shows in p99, max and the hitch count.
+class FrameStats
+{
+public:
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	// Phases of a frame, in milliseconds.
+	enum Phase : uint32
+	{
+		// Simulation ticks of the frame.
+		Sim,
+		// Update and Draw on the CPU, waits excluded.
+		Record,
+		// Blocked on the GPU: frame resource fence and Present.
+		PresentWait,
+		// Frame to frame interval, what the player sees.
+		Total,
+		PhaseCount
+	};
+
+	struct Frame
+	{
+		float Milliseconds[PhaseCount] = {};
+	};
+
+	struct Summary
+	{
+		uint32 FrameCount = 0;
+		float Mean = 0.0f;
+		float P50 = 0.0f;
+		float P95 = 0.0f;
+		float P99 = 0.0f;
+		float Max = 0.0f;
+		// Frames over the hitch threshold.
+		uint32 Hitches = 0;
+	};
+
+	// Log-linear histogram in the style of HdrHistogram: every power of two
+	// of microseconds is split into SubBucketCount linear buckets, so a
+	// value is known within 1/SubBucketCount of itself from 1 us to a
+	// minute, in a few kilobytes.
+	class Histogram
+	{
+	public:
+		static constexpr uint32				SubBucketBits = 4;
+		static constexpr uint32				SubBucketCount = 1u << SubBucketBits;
+		// Values up to 2^26 us (67 s); longer ones land in the last bucket.
+		static constexpr uint32				MagnitudeCount = 26 - SubBucketBits;
+		static constexpr uint32				BucketCount = SubBucketCount + MagnitudeCount * SubBucketCount;
+
+		void								Add(float milliseconds);
+		uint64								GetCount() const;
+		uint64								GetBucketCount(uint32 bucket) const;
+		// Range of a bucket, in milliseconds.
+		float								GetBucketLow(uint32 bucket) const;
+		float								GetBucketHigh(uint32 bucket) const;
+		// Upper bound of the bucket holding the given fraction of the values, in [0, 1].
+		float								GetValueAtPercentile(double fraction) const;
+		// Values in buckets entirely above milliseconds.
+		uint64								GetCountAbove(float milliseconds) const;
+
+	private:
+		static uint32						GetBucket(uint64 microseconds);
+		static uint64						GetBucketLowMicroseconds(uint32 bucket);
+
+		uint64								mCounts[BucketCount] = {};
+		uint64								mCount = 0;
+	};
+
+	// Frames kept in the ring: over four minutes at 60 Hz.
+	static constexpr uint32					Capacity = 16384;
+
+	FrameStats();
+
+	void									AddFrame(const Frame& frame);
+
+	// Frames in the ring, at most Capacity.
+	uint32									GetFrameCount() const;
+	// Frames added since the start.
+	uint64									GetTotalFrameCount() const;
+	// index 0 is the oldest frame of the ring.
+	const Frame&							GetFrame(uint32 index) const;
+
+	// Statistics of phase over the last frameCount frames of the ring, or
+	// all of them if it holds fewer.
+	Summary									Summarize(Phase phase, uint32 frameCount = Capacity) const;
+	const Histogram&						GetHistogram(Phase phase) const;
+
+	// A frame whose Total goes over this many milliseconds is a hitch.
+	void									SetHitchThreshold(float milliseconds);
+	float									GetHitchThreshold() const;
+	// Hitches since the start.
+	uint64									GetHitchCount() const;
+
+	// One line per frame of the ring, oldest first.
+	bool									WriteCsv(const char* path) const;
+	// One line per non-empty bucket, a column per phase.
+	bool									WriteHistogramCsv(const char* path) const;
+	// One line per phase: Summarize over the ring, then the hitches since the start.
+	bool									WriteSummaryCsv(const char* path) const;
+
+	static const char*						GetPhaseName(Phase phase);
+
+private:
+	std::vector<Frame>						mFrames;
+	uint64									mFrameCount = 0;
+	Histogram								mHistograms[PhaseCount];
+	float									mHitchThreshold = 1000.0f / 30.0f;
+	uint64									mHitchCount = 0;
+	// Sort space of Summarize.
+	mutable std::vector<float>				mScratch;
+};
@@ -0,0 +1,88 @@
+#include "FrustumCuller.h"
+
+using namespace DirectX;
+
+void FrustumCuller::Resize(uint32 count)
+{
+	mCount = count;
+
+	uint32 padded = (count + 3) & ~3u;
+	CenterX.resize(padded, 0.0f);
+	CenterY.resize(padded, 0.0f);
+	CenterZ.resize(padded, 0.0f);
+	Radius.resize(padded, 0.0f);
+}
+
+FrustumCuller::uint32 FrustumCuller::Size() const
+{
+	return mCount;
+}
+
+void FrustumCuller::ExtractPlanes(FXMMATRIX viewProj, XMFLOAT4 planes[6])
+{
+	// With row vectors, clip = v * M, so each clip coordinate is v dotted with
+	// a column of M.  A point is inside when -w <= x <= w, -w <= y <= w and
+	// 0 <= z <= w, which gives the six planes below.
+	XMMATRIX m = XMMatrixTranspose(viewProj);
+	XMVECTOR cx = m.r[0];
+	XMVECTOR cy = m.r[1];
+	XMVECTOR cz = m.r[2];
+	XMVECTOR cw = m.r[3];
+
+	XMVECTOR p[6] =
+	{
+		XMVectorAdd(cw, cx),
+		XMVectorSubtract(cw, cx),
+		XMVectorAdd(cw, cy),
+		XMVectorSubtract(cw, cy),
+		cz,
+		XMVectorSubtract(cw, cz)
+	};
+
+	for (int i = 0; i < 6; ++i)
+		XMStoreFloat4(&planes[i], XMPlaneNormalize(p[i]));
+}
+
+void FrustumCuller::Cull(FXMMATRIX viewProj, std::vector<uint32>& visible) const
+{
+	XMFLOAT4 planes[6];
+	ExtractPlanes(viewProj, planes);
+
+	// Splat every plane component once so the loop is pure vertical math.
+	XMVECTOR pa[6], pb[6], pc[6], pd[6];
+	for (int i = 0; i < 6; ++i)
+	{
+		pa[i] = XMVectorReplicate(planes[i].x);
+		pb[i] = XMVectorReplicate(planes[i].y);
+		pc[i] = XMVectorReplicate(planes[i].z);
+		pd[i] = XMVectorReplicate(planes[i].w);
+	}
+
+	for (uint32 i = 0; i < mCount; i += 4)
+	{
+		XMVECTOR x = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&CenterX[i]));
+		XMVECTOR y = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&CenterY[i]));
+		XMVECTOR z = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&CenterZ[i]));
+		XMVECTOR negRadius = XMVectorNegate(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&Radius[i])));
+
+		// A sphere is outside as soon as its center is further than its radius
+		// behind one plane.
+		XMVECTOR inside = XMVectorTrueInt();
+		for (int p = 0; p < 6; ++p)
+		{
+			XMVECTOR distance = XMVectorMultiplyAdd(x, pa[p],
+				XMVectorMultiplyAdd(y, pb[p], XMVectorMultiplyAdd(z, pc[p], pd[p])));
+			inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(distance, negRadius));
+		}
+
+		XMUINT4 mask;
+		XMStoreUInt4(&mask, inside);
+		uint32 lanes = mCount - i < 4 ? mCount - i : 4;
+		const uint32 laneMask[4] = { mask.x, mask.y, mask.z, mask.w };
+		for (uint32 k = 0; k < lanes; ++k)
+		{
+			if (laneMask[k] != 0)
+				visible.push_back(i + k);
+		}
+	}
+}
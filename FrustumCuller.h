@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <DirectXMath.h>
+#include <vector>
+
+// Tests world space bounding spheres against the view frustum four at a
+// time.  Spheres are kept as struct-of-arrays so one XMVECTOR holds the same
+// component of four spheres, and each frustum plane costs three
+// multiply-adds and a compare per group of four.  The arrays are padded to a
+// multiple of four; padding lanes are never reported.
+class FrustumCuller
+{
+public:
+	using uint32 = std::uint32_t;
+
+	// Sets the number of spheres; the arrays are then filled by the caller.
+	void									Resize(uint32 count);
+	uint32									Size() const;
+
+	// Appends the index of every sphere that intersects or is inside the
+	// frustum of viewProj (row vector convention, D3D clip space).
+	void									Cull(DirectX::FXMMATRIX viewProj, std::vector<uint32>& visible) const;
+
+	// Normalized planes (a, b, c, d) facing inside: left, right, bottom, top, near, far.
+	static void								ExtractPlanes(DirectX::FXMMATRIX viewProj, DirectX::XMFLOAT4 planes[6]);
+
+	std::vector<float>						CenterX;
+	std::vector<float>						CenterY;
+	std::vector<float>						CenterZ;
+	std::vector<float>						Radius;
+
+private:
+	uint32									mCount = 0;
+};
@@ -1,4 +1,5 @@
 #include "GameObject.h"
+#include <chrono>
 
 
 
@@ -11,243 +12,319 @@ GameObject::~GameObject()
 
 }
 
-void GameObject::Init(ComPtr<ID3D12GraphicsCommandList> cmdList, ComPtr<ID3D12Device> device) {
-	m_device = device;
-	CreateGeometry geoGen;
-	CreateGeometry::MeshData box = geoGen.CreateBox(.5f, 0.5f, 1.5f, 3);
-	CreateGeometry::MeshData sphere = geoGen.CreateSphere(0.5f, 20, 20);
-	CreateGeometry::MeshData pyramide = geoGen.CreatePyramide(1.f, 1.f, 0.3f, 3);
-	CreateGeometry::MeshData projectile = geoGen.CreateCylinder(0.05f, 0.05f, 1.f, 380, 250);
-	UINT boxVertexOffset = 0;
-	UINT boxIndexOffset = 0;
-	UINT sphereVertexOffset = (UINT)box.Vertices.size();
-	UINT sphereIndexOffset = (UINT)box.Indices32.size();
-	UINT pyramideVertexOffset = (UINT)box.Vertices.size() + (UINT)sphere.Vertices.size();
-	UINT pyramideIndexOffset = (UINT)box.Indices32.size() + (UINT)sphere.Indices32.size();
-	UINT projectileVertexOffset = (UINT)box.Vertices.size() + (UINT)sphere.Vertices.size() + (UINT)pyramide.Vertices.size();
-	UINT projectileIndexOffset = (UINT)box.Indices32.size() + (UINT)sphere.Indices32.size() + (UINT)pyramide.Vertices.size();
-
-
-	SubmeshGeometry boxSubmesh;
-	boxSubmesh.IndexCount = (UINT)box.Indices32.size();
-	boxSubmesh.StartIndexLocation = boxIndexOffset;
-	boxSubmesh.BaseVertexLocation = boxVertexOffset;
-
-	SubmeshGeometry sphereSubmesh;
-	sphereSubmesh.IndexCount = (UINT)sphere.Indices32.size();
-	sphereSubmesh.StartIndexLocation = sphereIndexOffset;
-	sphereSubmesh.BaseVertexLocation = sphereVertexOffset;
-
-	SubmeshGeometry pyramideSubmesh;
-	pyramideSubmesh.IndexCount = (UINT)pyramide.Indices32.size();
-	pyramideSubmesh.StartIndexLocation = pyramideIndexOffset;
-	pyramideSubmesh.BaseVertexLocation = pyramideVertexOffset;
-
-	SubmeshGeometry projectileSubmesh;
-	projectileSubmesh.IndexCount = (UINT)projectile.Indices32.size();
-	projectileSubmesh.StartIndexLocation = projectileIndexOffset;
-	projectileSubmesh.BaseVertexLocation = projectileVertexOffset;
-
-	auto totalVertexCount = box.Vertices.size() + sphere.Vertices.size() + pyramide.Vertices.size() + projectile.Vertices.size();
-	std::vector<Vertex> vertices(totalVertexCount);
-	UINT k = 0;
-	for (size_t i = 0; i < box.Vertices.size(); ++i, ++k)
+namespace
+{
+	using RenderMesh = CreateGeometry::BasicMeshData<RenderVertexFormat>;
+
+	// Bump whenever the generators, the simplifier, the optimizer or the
+	// packer change what they output, so cached meshes are rebuilt.
+	const UINT MeshBuildVersion = 1;
+	const char* MeshCachePath = "meshes.cache";
+	const float SimplifyMaxError = 1e-7f;
+
+	// Generator and parameters of every draw arg.  They are hashed into the
+	// mesh cache key, so editing them invalidates the cache.
+	struct ShapeDesc
 	{
-		vertices[k].Pos = box.Vertices[i].Position;
-		vertices[k].Color = XMFLOAT4(DirectX::Colors::DarkGreen);
-	}
-	for (size_t i = 0; i < sphere.Vertices.size(); ++i, ++k)
+		const char* Name;
+		const char* Generator;
+		float Size[3];
+		UINT Tessellation[2];
+		XMFLOAT4 Color;
+	};
+
+	const ShapeDesc& GetShapeDesc(UINT drawArg)
 	{
-		vertices[k].Pos = sphere.Vertices[i].Position;
-		vertices[k].Color = XMFLOAT4(DirectX::Colors::Crimson);
-	}
-	for (size_t i = 0; i < pyramide.Vertices.size(); i++, k++) {
-		vertices[k].Pos = pyramide.Vertices[i].Position;
-		vertices[k].Color = XMFLOAT4(DirectX::Colors::Yellow);
+		static const ShapeDesc shapes[DrawArgCount] =
+		{
+			{ "box", "CreateBoxLods", { .5f, 0.5f, 1.5f }, { 3, 0 }, XMFLOAT4(DirectX::Colors::DarkGreen) },
+			{ "sphere", "CreateSphereLods", { 0.5f, 0.f, 0.f }, { 20, 20 }, XMFLOAT4(DirectX::Colors::Crimson) },
+			{ "pyramide", "CreatePyramideLods", { 1.f, 1.f, 0.3f }, { 3, 0 }, XMFLOAT4(DirectX::Colors::Yellow) },
+			{ "projectile", "CreateCylinderLods", { 0.05f, 0.05f, 1.f }, { 380, 250 }, XMFLOAT4(DirectX::Colors::Aquamarine) }
+		};
+		return shapes[drawArg];
 	}
 
-	for (size_t i = 0; i < projectile.Vertices.size(); i++, k++) {
-		vertices[k].Pos = projectile.Vertices[i].Position;
-		vertices[k].Color = XMFLOAT4(DirectX::Colors::Aquamarine);
+	// Submesh name of every level: "sphere", "sphere_lod1", ...
+	std::string GetSubmeshName(UINT drawArg, UINT lod)
+	{
+		const char* name = GetShapeDesc(drawArg).Name;
+		return lod == 0 ? std::string(name) : std::string(name) + "_lod" + std::to_string(lod);
 	}
 
-	std::vector<std::uint16_t> indices;
-	indices.insert(indices.end(),
-		std::begin(box.GetIndices16()),
-		std::end(box.GetIndices16()));
-	indices.insert(indices.end(),
-		std::begin(sphere.GetIndices16()),
-		std::end(sphere.GetIndices16()));
-	indices.insert(indices.end(),
-		std::begin(pyramide.GetIndices16()),
-		std::end(pyramide.GetIndices16()));
-	indices.insert(indices.end(),
-		std::begin(projectile.GetIndices16()),
-		std::end(projectile.GetIndices16()));
-
-	const UINT vbByteSize = (UINT)vertices.size() * sizeof(Vertex);
-	const UINT ibByteSize = (UINT)indices.size() * sizeof(std::uint16_t);
-	auto geo = std::make_unique<MeshGeometry>();
-	geo->Name = "shapeGeo";
-	ThrowIfFailed(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
-	CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), vertices.data(),
-		vbByteSize);
-	ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
-	CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), indices.data(),
-		ibByteSize);
-	geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(m_device.Get(),
-		cmdList.Get(), vertices.data(), vbByteSize, geo->VertexBufferUploader);
-	geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(m_device.Get(),
-		cmdList.Get(), indices.data(), ibByteSize, geo->IndexBufferUploader);
-	geo->VertexByteStride = sizeof(Vertex);
-	geo->VertexBufferByteSize = vbByteSize;
-	geo->IndexFormat = DXGI_FORMAT_R16_UINT;
-	geo->IndexBufferByteSize = ibByteSize;
-	geo->DrawArgs["box"] = boxSubmesh;
-	geo->DrawArgs["sphere"] = sphereSubmesh;
-	geo->DrawArgs["pyramide"] = pyramideSubmesh;
-	geo->DrawArgs["projectile"] = projectileSubmesh;
-	mGeometries[geo->Name] = std::move(geo);
-}
-
-void GameObject::BuildRenderOpBox() {
-	auto boxRitem = std::make_unique<RenderItem>();
-	boxRitem->ObjCBIndex = ObjIndex;
-	boxRitem->Geo = mGeometries["shapeGeo"].get();
-	boxRitem->Type = "testBox";
-	boxRitem->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-	boxRitem->IndexCount = boxRitem->Geo->DrawArgs["box"].IndexCount;
-	boxRitem->StartIndexLocation = boxRitem->Geo->DrawArgs["box"].StartIndexLocation;
-	boxRitem->BaseVertexLocation = boxRitem->Geo->DrawArgs["box"].BaseVertexLocation;
-
-	BuildObjectConstantBuffers(&boxRitem);
-
-	mAllRitems.push_back(std::move(boxRitem));
-	mOpaqueRitems.push_back(mAllRitems[ObjIndex].get());
-	ObjIndex++;
-
-}
-
-void GameObject::BuildRenderOpPyramide() {
-	auto pyramideRitem = std::make_unique<RenderItem>();
-	pyramideRitem->ObjCBIndex = ObjIndex;
-	pyramideRitem->Geo = mGeometries["shapeGeo"].get();
-	pyramideRitem->Type = "player";
-	pyramideRitem->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-	pyramideRitem->IndexCount = pyramideRitem->Geo->DrawArgs["pyramide"].IndexCount;
-	pyramideRitem->StartIndexLocation = pyramideRitem->Geo->DrawArgs["pyramide"].StartIndexLocation;
-	pyramideRitem->BaseVertexLocation = pyramideRitem->Geo->DrawArgs["pyramide"].BaseVertexLocation;
-	XMStoreFloat4x4(&pyramideRitem->World, XMMatrixMultiply(XMLoadFloat4x4(&pyramideRitem->World), pyramideRitem->Rotate(0, 70, 0)));
-	XMStoreFloat4x4(&pyramideRitem->World, XMMatrixMultiply(XMLoadFloat4x4(&pyramideRitem->World), pyramideRitem->Translate(0, -1, 0)));
-
-	BuildObjectConstantBuffers(&pyramideRitem);
+	// The generators write the render vertex layout, color included, so the
+	// meshes can be copied to the vertex buffers as they are.
+	std::vector<RenderMesh> CreateLodChain(UINT drawArg)
+	{
+		const ShapeDesc& shape = GetShapeDesc(drawArg);
+		RenderVertexFormat format(shape.Color);
+		CreateGeometry geoGen;
+		switch (drawArg)
+		{
+		case DrawArgBox:
+			return geoGen.CreateBoxLods(shape.Size[0], shape.Size[1], shape.Size[2], shape.Tessellation[0], MaxLodLevels, format);
+		case DrawArgSphere:
+			return geoGen.CreateSphereLods(shape.Size[0], shape.Tessellation[0], shape.Tessellation[1], MaxLodLevels, format);
+		case DrawArgPyramide:
+			return geoGen.CreatePyramideLods(shape.Size[0], shape.Size[1], shape.Size[2], shape.Tessellation[0], MaxLodLevels, format);
+		default:
+			return geoGen.CreateCylinderLods(shape.Size[0], shape.Size[1], shape.Size[2], shape.Tessellation[0], shape.Tessellation[1], MaxLodLevels, format);
+		}
+	}
 
-	mAllRitems.push_back(std::move(pyramideRitem));
-	mOpaqueRitems.push_back(mAllRitems[ObjIndex].get());
-	ObjIndex++;
+	// Everything the cached meshes depend on.
+	MeshCache::uint64 GetMeshCacheKey()
+	{
+		MeshCacheKey key;
+		key.Add(MeshBuildVersion).Add(MaxLodLevels).Add(SimplifyMaxError);
+		for (UINT i = 0; i < DrawArgCount; i++)
+		{
+			const ShapeDesc& shape = GetShapeDesc(i);
+			key.Add(shape.Generator).Add(shape.Size).Add(shape.Tessellation).Add(shape.Color);
+		}
+
+		key.Add((UINT)sizeof(Vertex));
+		const VertexElement* elements = RenderVertexFormat::Elements();
+		for (UINT e = 0; e < RenderVertexFormat::ElementCount; e++)
+			key.Add(elements[e].SemanticName).Add(elements[e].Format).Add(elements[e].AlignedByteOffset);
+		return key.Get();
+	}
 
+	// Drops the triangles that do not change the shape (the 250 stacks of the
+	// projectile cylinder all lie on the same lines), then reorders for the
+	// post-transform cache and vertex fetch.  Returns the debug report line.
+	std::string PrepareMesh(RenderMesh& mesh, const std::string& name)
+	{
+		UINT triangleCount = (UINT)mesh.Indices32.size() / 3;
+		MeshSimplifier::Result simplified = MeshSimplifier::Simplify(mesh, 0, SimplifyMaxError);
+
+		MeshOptimizer::VertexCacheStats before = MeshOptimizer::AnalyzeVertexCache(mesh.Indices32, (UINT)mesh.Vertices.size());
+		MeshOptimizer::Optimize(mesh, true);
+		MeshOptimizer::VertexCacheStats after = MeshOptimizer::AnalyzeVertexCache(mesh.Indices32, (UINT)mesh.Vertices.size());
+
+		char line[160];
+		snprintf(line, sizeof(line), "%s: %u -> %u triangles, %u vertices, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+			name.c_str(), triangleCount, simplified.TriangleCount, (UINT)mesh.Vertices.size(),
+			before.ACMR, after.ACMR, before.ATVR, after.ATVR);
+		return line;
+	}
 }
 
-void GameObject::BuildRenderOpProjectile(float playerPosX, float playerPosY, float playerPosZ) {
-	auto projectileRitem = std::make_unique<RenderItem>();
-	projectileRitem->ObjCBIndex = ObjIndex;
-	projectileRitem->lifeTime = 20;
-	projectileRitem->Geo = mGeometries["shapeGeo"].get();
-	projectileRitem->Type = "projectile";
-	projectileRitem->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-	projectileRitem->IndexCount = projectileRitem->Geo->DrawArgs["projectile"].IndexCount;
-	projectileRitem->StartIndexLocation = projectileRitem->Geo->DrawArgs["projectile"].StartIndexLocation;
-	projectileRitem->BaseVertexLocation = projectileRitem->Geo->DrawArgs["projectile"].BaseVertexLocation;
-	XMStoreFloat4x4(&projectileRitem->World, XMMatrixMultiply(XMLoadFloat4x4(&projectileRitem->World), projectileRitem->Rotate(0, 90, 0)));
-	projectileRitem->World._41 = playerPosX;
-	projectileRitem->World._42 = playerPosY;
-	projectileRitem->World._43 = playerPosZ;
-	BuildObjectConstantBuffers(&projectileRitem);
-
-	mAllRitems.push_back(std::move(projectileRitem));
-	mOpaqueRitems.push_back(mAllRitems[ObjIndex].get());
-	ObjIndex++;
+void GameObject::BuildMeshes(ThreadPool& pool)
+{
+	auto buildStart = std::chrono::steady_clock::now();
+
+	// On a hit the pages are read in place from the mapped cache file by
+	// Init; nothing is generated.
+	MeshCache::uint64 key = GetMeshCacheKey();
+	MeshCache::Status status = mMeshCache.Open(MeshCachePath, key);
+	std::vector<MeshCache::Submesh> submeshes;
+	if (status == MeshCache::Status::Hit)
+	{
+		const std::vector<MeshCache::Page>& pages = mMeshCache.GetPages();
+		for (UINT p = 0; p < pages.size(); p++)
+		{
+			MeshGeometry* geo = AddPage(p, pages[p].Use32BitIndices != 0, pages[p].VertexByteSize, pages[p].IndexByteSize);
+			mPageSources.push_back({ geo, pages[p].Vertices, pages[p].Indices });
+		}
+		submeshes = mMeshCache.GetSubmeshes();
+	}
+	else
+	{
+		GenerateMeshes(pool, submeshes);
+
+		std::vector<MeshCache::Page> pages(mPageSources.size());
+		for (UINT p = 0; p < mPageSources.size(); p++)
+		{
+			const MeshGeometry* geo = mPageSources[p].Geo;
+			pages[p].Use32BitIndices = geo->IndexFormat == DXGI_FORMAT_R32_UINT;
+			pages[p].VertexByteStride = geo->VertexByteStride;
+			pages[p].VertexByteSize = geo->VertexBufferByteSize;
+			pages[p].IndexByteSize = geo->IndexBufferByteSize;
+			pages[p].Vertices = mPageSources[p].Vertices;
+			pages[p].Indices = mPageSources[p].Indices;
+		}
+		if (!MeshCache::Write(MeshCachePath, key, pages, submeshes))
+			::OutputDebugStringA("mesh cache: could not write the cache file\n");
+	}
 
+	UINT levelCounts[DrawArgCount] = {};
+	for (UINT id = 0; id < submeshes.size(); id++)
+	{
+		const MeshCache::Submesh& submesh = submeshes[id];
+		PlaceSubmesh(id, submesh);
+		levelCounts[submesh.DrawArg] = std::max(levelCounts[submesh.DrawArg], submesh.Lod + 1);
+	}
+	for (UINT i = 0; i < DrawArgCount; i++)
+		mLodChains[i] = LodSelector::MakeChain(levelCounts[i], 0.2f, 0.5f);
+
+	std::chrono::duration<double, std::milli> buildTime = std::chrono::steady_clock::now() - buildStart;
+	char line[128];
+	snprintf(line, sizeof(line), "meshes built in %.1f ms on %u threads, mesh cache %s\n",
+		buildTime.count(), pool.GetWorkerCount() + 1, MeshCache::GetStatusName(status));
+	::OutputDebugStringA(line);
 }
 
-void GameObject::BuildRenderOpCircle() {
-	// Providing a seed value
-	srand((unsigned)time(NULL));
-	// Get a random number
-	float randomX = (float)rand() / (float)(RAND_MAX / (1.5f));
-	// Providing a seed value
-	srand((unsigned)time(NULL));
-
-	int randomSignX = 1 + (rand() % 2);
-
-	// Providing a seed value
-	srand((unsigned)time(NULL));
-	// Get a random number
-	float randomY = (float)rand() / (float)(RAND_MAX / (1.5f));
-
-	srand((unsigned)time(NULL));
-	int randomSignY = 1 + (rand() % 2);
-
-	auto leftSphereRitem = std::make_unique<RenderItem>();
-	leftSphereRitem->ObjCBIndex = ObjIndex;
-	leftSphereRitem->Geo = mGeometries["shapeGeo"].get();
-	leftSphereRitem->Type = "asteroid";
-	leftSphereRitem->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-	leftSphereRitem->IndexCount = leftSphereRitem->Geo->DrawArgs["sphere"].IndexCount;
-	leftSphereRitem->StartIndexLocation = leftSphereRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
-	leftSphereRitem->BaseVertexLocation = leftSphereRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
-	XMMATRIX temp = XMLoadFloat4x4(&leftSphereRitem->World);
-	if (randomSignX == 1 && randomSignY == 1) {
-		XMStoreFloat4x4(&leftSphereRitem->World, XMMatrixMultiply(temp, leftSphereRitem->Translate(randomX, randomY, 5)));
-	}
-	else if (randomSignX == 2 && randomSignY == 1) {
-		XMStoreFloat4x4(&leftSphereRitem->World, XMMatrixMultiply(temp, leftSphereRitem->Translate(-randomX, randomY, 5)));
+void GameObject::GenerateMeshes(ThreadPool& pool, std::vector<MeshCache::Submesh>& submeshes)
+{
+	std::vector<RenderMesh> lods[DrawArgCount];
+	std::vector<std::string> reports[DrawArgCount];
+
+	// One task generates each chain, then hands every level to a task of its
+	// own: simplifying the finest projectile level is by far the longest job
+	// and must not hold up the other levels.
+	TaskGroup group;
+	for (UINT i = 0; i < DrawArgCount; i++)
+	{
+		pool.Submit(group, [&, i]
+		{
+			lods[i] = CreateLodChain(i);
+			reports[i].resize(lods[i].size());
+			for (UINT lod = 0; lod < lods[i].size(); lod++)
+				pool.Submit(group, [&, i, lod] { reports[i][lod] = PrepareMesh(lods[i][lod], GetSubmeshName(i, lod)); });
+		});
 	}
-	else if (randomSignX == 2 && randomSignY == 2) {
-		XMStoreFloat4x4(&leftSphereRitem->World, XMMatrixMultiply(temp, leftSphereRitem->Translate(-randomX, -randomY, 5)));
+	pool.Wait(group);
+
+	for (UINT i = 0; i < DrawArgCount; i++)
+	{
+		for (const std::string& report : reports[i])
+			::OutputDebugStringA(report.c_str());
 	}
-	else if (randomSignX == 1 && randomSignY == 2) {
-		XMStoreFloat4x4(&leftSphereRitem->World, XMMatrixMultiply(temp, leftSphereRitem->Translate(randomX, -randomY, 5)));
+
+	// The packer decides which page every submesh lands in and its offsets,
+	// and switches a page to 32-bit indices once it holds more than 65536
+	// vertices.
+	MeshPacker packer;
+	for (UINT i = 0; i < DrawArgCount; i++)
+	{
+		for (UINT lod = 0; lod < lods[i].size(); lod++)
+			packer.AddSubmesh((UINT)lods[i][lod].Vertices.size(), (UINT)lods[i][lod].Indices32.size());
 	}
-	BuildObjectConstantBuffers(&leftSphereRitem);
+	packer.Pack();
+	::OutputDebugStringA(packer.GetOccupancyReport().c_str());
 
-	mAllRitems.push_back(std::move(leftSphereRitem));
-	mOpaqueRitems.push_back(mAllRitems[ObjIndex].get());
-	ObjIndex++;
+	// Meshes are copied straight into the CPU blobs the GPU buffers are
+	// created from by Init.
+	const std::vector<MeshPacker::Page>& pages = packer.GetPages();
+	for (UINT p = 0; p < pages.size(); p++)
+	{
+		const MeshPacker::Page& page = pages[p];
+		MeshGeometry* geo = AddPage(p, page.Use32BitIndices, page.VertexCount * sizeof(Vertex), page.IndexCount * packer.GetIndexStride(p));
+		ThrowIfFailed(D3DCreateBlob(geo->VertexBufferByteSize, &geo->VertexBufferCPU));
+		ThrowIfFailed(D3DCreateBlob(geo->IndexBufferByteSize, &geo->IndexBufferCPU));
+		mPageSources.push_back({ geo, geo->VertexBufferCPU->GetBufferPointer(), geo->IndexBufferCPU->GetBufferPointer() });
+	}
 
+	// Every submesh owns a disjoint range of its page, so the copies run
+	// in parallel without synchronization.  Submesh ids are in order of
+	// addition to the packer.
+	const std::vector<MeshPacker::Submesh>& placements = packer.GetSubmeshes();
+	for (UINT i = 0; i < DrawArgCount; i++)
+	{
+		for (UINT lod = 0; lod < lods[i].size(); lod++)
+		{
+			const MeshPacker::Submesh& placement = placements[submeshes.size()];
+			const RenderMesh& mesh = lods[i][lod];
+			bool use32 = pages[placement.Page].Use32BitIndices;
+			UINT indexStride = packer.GetIndexStride(placement.Page);
+			Vertex* vertices = reinterpret_cast<Vertex*>(const_cast<void*>(mPageSources[placement.Page].Vertices));
+			BYTE* indices = reinterpret_cast<BYTE*>(const_cast<void*>(mPageSources[placement.Page].Indices));
+
+			pool.Submit(group, [&mesh, &placement, vertices, indices, use32, indexStride]
+			{
+				std::copy(mesh.Vertices.begin(), mesh.Vertices.end(), vertices + placement.BaseVertexLocation);
+				MeshPacker::CopyIndices(mesh.Indices32.data(), placement.IndexCount, use32,
+					&indices[(size_t)placement.StartIndexLocation * indexStride]);
+			});
+
+			MeshCache::Submesh submesh;
+			submesh.DrawArg = i;
+			submesh.Lod = lod;
+			submesh.Page = placement.Page;
+			submesh.IndexCount = placement.IndexCount;
+			submesh.StartIndexLocation = placement.StartIndexLocation;
+			submesh.BaseVertexLocation = placement.BaseVertexLocation;
+			memcpy(submesh.BoundsCenter, &mesh.Bounds.Center, sizeof(submesh.BoundsCenter));
+			memcpy(submesh.BoundsExtents, &mesh.Bounds.Extents, sizeof(submesh.BoundsExtents));
+			submeshes.push_back(submesh);
+		}
+	}
+	pool.Wait(group);
 }
 
-const std::vector<RenderItem*>& GameObject::GetOpaqueItems()
+MeshGeometry* GameObject::AddPage(UINT index, bool use32BitIndices, UINT vbByteSize, UINT ibByteSize)
 {
-	return mOpaqueRitems;
+	auto geo = std::make_unique<MeshGeometry>();
+	geo->Name = index == 0 ? "shapeGeo" : "shapeGeo" + std::to_string(index);
+	geo->VertexByteStride = sizeof(Vertex);
+	geo->VertexBufferByteSize = vbByteSize;
+	geo->IndexFormat = use32BitIndices ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+	geo->IndexBufferByteSize = ibByteSize;
+
+	MeshGeometry* page = geo.get();
+	mGeometries[geo->Name] = std::move(geo);
+	return page;
 }
 
-std::vector<std::unique_ptr<RenderItem>>& GameObject::GetAllItems()
+void GameObject::PlaceSubmesh(UINT id, const MeshCache::Submesh& placement)
 {
-	return mAllRitems;
+	MeshGeometry* geo = mPageSources[placement.Page].Geo;
+
+	SubmeshGeometry submesh;
+	submesh.IndexCount = placement.IndexCount;
+	submesh.StartIndexLocation = placement.StartIndexLocation;
+	submesh.BaseVertexLocation = placement.BaseVertexLocation;
+	submesh.Bounds.Center = XMFLOAT3(placement.BoundsCenter);
+	submesh.Bounds.Extents = XMFLOAT3(placement.BoundsExtents);
+	geo->DrawArgs[GetSubmeshName(placement.DrawArg, placement.Lod)] = submesh;
+
+	RenderItem& ri = mRenderItems[GetRenderItemIndex(placement.DrawArg, placement.Lod)];
+	ri.Geo = geo;
+	ri.PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+	ri.IndexCount = submesh.IndexCount;
+	ri.StartIndexLocation = submesh.StartIndexLocation;
+	ri.BaseVertexLocation = submesh.BaseVertexLocation;
+	ri.Layer = RenderLayer::Opaque;
+	ri.GeometryId = placement.Page;
+	ri.SubmeshId = id;
+	BoundingSphere::CreateFromBoundingBox(ri.Bounds, submesh.Bounds);
 }
 
-void GameObject::SetOpaqueItems(std::vector<RenderItem*> OpaqueItems)
-{
-	mOpaqueRitems = OpaqueItems;
+void GameObject::Init(ComPtr<ID3D12GraphicsCommandList> cmdList, ComPtr<ID3D12Device> device) {
+	m_device = device;
+
+	// The page bytes were prepared by BuildMeshes, in blobs or in the mapped
+	// cache file; CreateDefaultBuffer copies them to the upload heap, after
+	// which the cache can be unmapped.
+	for (const PageSource& source : mPageSources)
+	{
+		MeshGeometry* geo = source.Geo;
+		geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(m_device.Get(), cmdList.Get(),
+			source.Vertices, geo->VertexBufferByteSize, geo->VertexBufferUploader);
+		geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(m_device.Get(), cmdList.Get(),
+			source.Indices, geo->IndexBufferByteSize, geo->IndexBufferUploader);
+	}
+	mPageSources.clear();
+	mMeshCache.Close();
 }
 
-void GameObject::BuildObjectConstantBuffers(std::unique_ptr<RenderItem>* object)
+const RenderItem& GameObject::GetRenderItem(UINT drawArg, UINT lod) const
 {
-	object->get()->mObjectCB = std::make_unique<UploadBuffer<ObjectConstants>>(m_device.Get(), 1, true);
+	return mRenderItems[GetRenderItemIndex(drawArg, lod)];
 }
 
-void GameObject::RemoveObject(size_t index)
+const RenderItem& GameObject::GetRenderItemAt(UINT index) const
 {
-	mOpaqueRitems.erase(mOpaqueRitems.begin() + index);
+	return mRenderItems[index];
 }
-void GameObject::setGameOver(bool newGameOver)
+
+UINT GameObject::GetRenderItemIndex(UINT drawArg, UINT lod) const
 {
-	gameOver = newGameOver;
+	return drawArg * MaxLodLevels + lod;
 }
-bool GameObject::getGameOver()
+
+const LodChain& GameObject::GetLodChain(UINT drawArg) const
 {
-	return gameOver;
+	return mLodChains[drawArg];
 }
-
-
@@ -2,121 +2,88 @@
 #include "MathHelper.h"
 #include "UploadBuffer.h"
 #include "CreateGeometry.h"
-#include "Transform.h"
+#include "Simulation.h"
+#include "RenderQueue.h"
+#include "MeshPacker.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "LodSelector.h"
+#include "ThreadPool.h"
+#include "MeshCache.h"
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
 using namespace DirectX::PackedVector;
 
-struct ObjectConstants
+// Per-instance data read by the vertex shader, stored at the slot of its entity.
+struct InstanceData
 {
-	XMFLOAT4X4 WorldViewProj = MathHelper::Identity4x4();
+	XMFLOAT4X4 World = MathHelper::Identity4x4();
 };
 
-struct Vertex
-{
-	XMFLOAT3 Pos;
-	XMFLOAT4 Color;
-};
+// Layout of every vertex buffer.  The shape generators write it directly and
+// BoxApp builds the input layout from its elements.
+using RenderVertexFormat = VertexFormats::PositionColor;
+using Vertex = RenderVertexFormat::Vertex;
 
-struct RenderItem : Transform {
+// Geometry and draw parameters shared by every entity drawn with the same submesh.
+// There is one per LOD level of every draw arg; entities reference the chain
+// through EntityStore::DrawArg and the level through EntityStore::Lod.
+struct RenderItem {
 	RenderItem() = default;
-	XMFLOAT4X4 World = MathHelper::Identity4x4();
-
-	// Dirty flag indicating the object data has changed and we need to update the constant buffer.
-	// Because we have an object cbuffer for each FrameResource, we have to apply the
-	// update to each FrameResource.  Thus, when we modify obect data we should set 
-	// NumFramesDirty = gNumFrameResources so that each frame resource gets the update.
-	// Index into GPU constant buffer corresponding to the ObjectCB for this render item.
-	UINT ObjCBIndex = -1;
-	std::string Type;
 	MeshGeometry* Geo = nullptr;
-	bool gameOver;
-	bool RemoveAsteroid;
-	bool dontMove;
-	float Timer;
-	int lifeTime;
-	void UpdateTimer() {
-		Timer += 0.01;
-	}
-	std::vector<RenderItem*> CheckCollision(std::vector<RenderItem*> mOpaqueList,size_t offset) {
-		XMMATRIX translation = XMLoadFloat4x4(&World);
-		if (Type == "asteroid") {
-			XMMATRIX temp = XMLoadFloat4x4(&World);
-			translation = XMMatrixMultiply(temp, Translate(0, 0, -0.01));
-		}
-		if (Type == "projectile") {
-			XMMATRIX temp = XMLoadFloat4x4(&World);
-			translation = XMMatrixMultiply(temp, Translate(0, 0, 0.01));
-		}
-
-		for (size_t i = offset+1; i < mOpaqueList.size(); i++)
-		{
-			if (World._41 <= mOpaqueList[i]->World._41+0.60 && World._41 >= mOpaqueList[i]->World._41 - 0.60 && World._42 <= mOpaqueList[i]->World._42+0.60 && World._42 >= mOpaqueList[i]->World._42 - 0.60 && World._43 <= mOpaqueList[i]->World._43+0.60 && World._43 >= mOpaqueList[i]->World._43 - 0.60) {
-				if (Type == "asteroid" && mOpaqueList[i]->Type == "player") {
-					mOpaqueList.clear();
-				}
-				else if (Type == "player" && mOpaqueList[i]->Type == "asteroid") {
-
-					mOpaqueList.clear();
-				}
-				else if (Type == "asteroid" && mOpaqueList[i]->Type == "projectile") {
-					RemoveAsteroid = !RemoveAsteroid;
-					mOpaqueList.erase(mOpaqueList.begin() + offset);
-					mOpaqueList.erase(mOpaqueList.begin() + (i-1));
-				}
-				else if (Type == "projectile" && mOpaqueList[i]->Type == "asteroid") {
-					RemoveAsteroid = !RemoveAsteroid;
-					mOpaqueList.erase(mOpaqueList.begin() + (i-1));
-					mOpaqueList.erase(mOpaqueList.begin() + offset);
-				}
-				/*else if (Type == "asteroid" && mOpaqueList[i]->Type == "asteroid") {
-					dontMove = !dontMove;
-				}*/
-			}
-		}
-		XMStoreFloat4x4(&World, translation);
-		return mOpaqueList;
-	};
 
 	// Primitive topology.
-	D3D12_PRIMITIVE_TOPOLOGY PrimitiveType = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-	std::unique_ptr<UploadBuffer<ObjectConstants>> mObjectCB = nullptr;
+	D3D12_PRIMITIVE_TOPOLOGY PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 	// DrawIndexedInstanced parameters.
 	UINT IndexCount = 0;
 	UINT StartIndexLocation = 0;
 	int BaseVertexLocation = 0;
 
-};
+	// Local space bounding sphere of the submesh, used for frustum culling.
+	BoundingSphere Bounds;
 
+	// Render queue sort key fields.  The layer also selects the PSO.
+	RenderLayer Layer = RenderLayer::Opaque;
+	UINT GeometryId = 0;
+	UINT SubmeshId = 0;
+};
 
 class GameObject {
 public:
 	GameObject();
 	~GameObject();
 	Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+	// CPU side of the mesh setup: maps the mesh cache, or on a miss generates,
+	// simplifies and optimizes every LOD on the pool, packs them, fills the
+	// page blobs and writes the cache.  Needs no device, so it runs while the
+	// device is being created.
+	void BuildMeshes(ThreadPool& pool);
+	// Creates the GPU buffers of the meshes of BuildMeshes, which must have
+	// completed.
 	void Init(ComPtr<ID3D12GraphicsCommandList> cmdList, ComPtr<ID3D12Device> device);
-	void BuildRenderOpBox();
-	void BuildRenderOpPyramide();
-	void BuildRenderOpProjectile(float playerPosX, float playerPosY, float playerPosZ);
-	void BuildRenderOpCircle();
-	const std::vector<RenderItem*>& GetOpaqueItems();
-	std::vector<std::unique_ptr<RenderItem>>& GetAllItems();
-	void SetOpaqueItems(std::vector<RenderItem*> OpaqueItems);
-	void BuildObjectConstantBuffers(std::unique_ptr<RenderItem>* sphere);
-	void RemoveObject(size_t index);
-	void setGameOver(bool newGameOver);
-	bool getGameOver();
+	const RenderItem& GetRenderItem(UINT drawArg, UINT lod = 0) const;
+	// Flat render item table, indexed by GetRenderItemIndex.
+	const RenderItem& GetRenderItemAt(UINT index) const;
+	UINT GetRenderItemIndex(UINT drawArg, UINT lod) const;
+	const LodChain& GetLodChain(UINT drawArg) const;
 private:
-	std::unordered_map<std::string, std::unique_ptr<MeshGeometry>> mGeometries;
-	UINT ObjIndex = 0;
+	// Page bytes for Init to upload: blobs of the page, or the mapped cache.
+	struct PageSource
+	{
+		MeshGeometry* Geo;
+		const void* Vertices;
+		const void* Indices;
+	};
 
-	//Stock RenderItem
-	std::vector<std::unique_ptr<RenderItem>> mAllRitems;
-	bool gameOver = false;
-	std::vector<RenderItem*> mOpaqueRitems;
-	std::vector<RenderItem*> mTransparentRitems;
-	UINT mPassCbvOffset = 0;
-	std::unique_ptr<MeshGeometry> mBoxGeo = nullptr;
+	void GenerateMeshes(ThreadPool& pool, std::vector<MeshCache::Submesh>& submeshes);
+	MeshGeometry* AddPage(UINT index, bool use32BitIndices, UINT vbByteSize, UINT ibByteSize);
+	// Fills the draw args and the render item of a submesh.
+	void PlaceSubmesh(UINT id, const MeshCache::Submesh& placement);
 
+	std::unordered_map<std::string, std::unique_ptr<MeshGeometry>> mGeometries;
+	RenderItem mRenderItems[DrawArgCount * MaxLodLevels];
+	LodChain mLodChains[DrawArgCount];
+	MeshCache mMeshCache;
+	std::vector<PageSource> mPageSources;
 };
\ No newline at end of file
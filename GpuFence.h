@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+
+// CPU/GPU synchronisation point.  Values handed out by Signal strictly
+// increase and complete in order, which is all the frame pacing relies on.
+// D3D12GpuFence wraps the device fence; MockGpuFence stands in for it when
+// there is no device, with the GPU progress driven by hand.
+class GpuFence
+{
+public:
+	virtual ~GpuFence() = default;
+
+	// Queues a signal behind the work submitted so far and returns its value.
+	virtual std::uint64_t					Signal() = 0;
+	virtual std::uint64_t					GetCompletedValue() const = 0;
+	// Blocks the CPU until the GPU has reached value.
+	virtual void							Wait(std::uint64_t value) = 0;
+};
+
+class MockGpuFence : public GpuFence
+{
+public:
+	std::uint64_t Signal() override
+	{
+		return ++mLastSignaled;
+	}
+
+	std::uint64_t GetCompletedValue() const override
+	{
+		return mCompleted;
+	}
+
+	// A blocking wait on the mock means the "GPU" catches up to value.
+	void Wait(std::uint64_t value) override
+	{
+		mWaitCount++;
+		Complete(value);
+	}
+
+	void Complete(std::uint64_t value)
+	{
+		if (value > mLastSignaled)
+			value = mLastSignaled;
+		if (value > mCompleted)
+			mCompleted = value;
+	}
+
+	std::uint64_t GetLastSignaled() const
+	{
+		return mLastSignaled;
+	}
+
+	std::uint32_t GetWaitCount() const
+	{
+		return mWaitCount;
+	}
+
+private:
+	std::uint64_t							mLastSignaled = 0;
+	std::uint64_t							mCompleted = 0;
+	std::uint32_t							mWaitCount = 0;
+};
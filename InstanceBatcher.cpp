@@ -0,0 +1,36 @@
+#include "InstanceBatcher.h"
+
+void InstanceBatcher::Build(const RenderQueue& queue, const std::vector<uint32>& renderItems, const std::vector<uint32>& slots)
+{
+	const std::vector<RenderQueue::uint64>& keys = queue.GetKeys();
+	const std::vector<uint32>& values = queue.GetValues();
+	uint32 count = queue.Size();
+
+	mBatches.clear();
+	mInstanceSlots.resize(count);
+
+	RenderQueue::uint64 state = 0;
+	for (uint32 i = 0; i < count; ++i)
+	{
+		uint32 entity = values[i];
+		RenderQueue::uint64 itemState = RenderQueue::GetStateKey(keys[i]);
+		if (mBatches.empty() || itemState != state)
+		{
+			mBatches.push_back({ RenderQueue::GetLayer(keys[i]), renderItems[entity], i, 0 });
+			state = itemState;
+		}
+
+		mBatches.back().InstanceCount++;
+		mInstanceSlots[i] = slots[entity];
+	}
+}
+
+const std::vector<InstanceBatcher::Batch>& InstanceBatcher::GetBatches() const
+{
+	return mBatches;
+}
+
+const std::vector<InstanceBatcher::uint32>& InstanceBatcher::GetInstanceSlots() const
+{
+	return mInstanceSlots;
+}
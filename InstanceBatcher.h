@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "RenderQueue.h"
+
+// Turns a sorted render queue into instanced draws.  Consecutive queue
+// entries with the same state key (layer, PSO, geometry, submesh) form one
+// batch, and the entity slots of the whole queue are packed into one list
+// where the instances of a batch are the contiguous range
+// [StartInstance, StartInstance + InstanceCount).  The vertex shader reads
+// its world matrix through that list, so the per-slot instance data written
+// by UpdateObjectCBs never has to be reordered.
+class InstanceBatcher
+{
+public:
+	using uint32 = std::uint32_t;
+
+	struct Batch
+	{
+		RenderLayer Layer;
+		uint32 RenderItem;
+		uint32 StartInstance;
+		uint32 InstanceCount;
+	};
+
+	// Queue values are dense entity indices into renderItems (render item
+	// table index of each entity) and slots.
+	void									Build(const RenderQueue& queue, const std::vector<uint32>& renderItems, const std::vector<uint32>& slots);
+
+	// Batches in queue order.
+	const std::vector<Batch>&				GetBatches() const;
+	const std::vector<uint32>&				GetInstanceSlots() const;
+
+private:
+	std::vector<Batch>						mBatches;
+	std::vector<uint32>						mInstanceSlots;
+};
@@ -0,0 +1,332 @@
+#include "JobSystem.h"
+
+namespace
+{
+	// Thread of the calling thread in its JobSystem.
+	thread_local const JobSystem* tSystem = nullptr;
+	thread_local std::uint32_t tThreadIndex = 0;
+
+	// Slots per block of a thread's job pool.
+	const std::uint32_t PoolBlockSize = 2 * JobSystem::DequeCapacity;
+	// Failed rounds of stealing before an idle worker goes to sleep.
+	const int SpinRounds = 64;
+
+	static_assert((JobSystem::DequeCapacity & (JobSystem::DequeCapacity - 1)) == 0, "the deque capacity must be a power of two");
+}
+
+bool JobCounter::IsDone() const
+{
+	return mPending.load(std::memory_order_acquire) == 0;
+}
+
+bool JobSystem::Deque::Push(Job* job)
+{
+	std::int64_t bottom = mBottom.load(std::memory_order_relaxed);
+	std::int64_t top = mTop.load(std::memory_order_acquire);
+	if (bottom - top >= (std::int64_t)DequeCapacity)
+		return false;
+
+	// Release: a thief that sees the new bottom sees the job and its contents.
+	mJobs[bottom & (DequeCapacity - 1)].store(job, std::memory_order_relaxed);
+	mBottom.store(bottom + 1, std::memory_order_release);
+	return true;
+}
+
+JobSystem::Job* JobSystem::Deque::Pop()
+{
+	std::int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+	mBottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	std::int64_t top = mTop.load(std::memory_order_relaxed);
+
+	if (top > bottom)
+	{
+		// Empty.
+		mBottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = mJobs[bottom & (DequeCapacity - 1)].load(std::memory_order_relaxed);
+	if (top == bottom)
+	{
+		// Last job: race the thieves for it.
+		if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			job = nullptr;
+		mBottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+JobSystem::Job* JobSystem::Deque::Steal()
+{
+	std::int64_t top = mTop.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	std::int64_t bottom = mBottom.load(std::memory_order_acquire);
+	if (top >= bottom)
+		return nullptr;
+
+	Job* job = mJobs[top & (DequeCapacity - 1)].load(std::memory_order_relaxed);
+	if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		return nullptr;
+	return job;
+}
+
+JobSystem::JobSystem(uint32 threadCount)
+{
+	if (threadCount == 0)
+		threadCount = std::thread::hardware_concurrency();
+	if (threadCount == 0)
+		threadCount = 1;
+
+	for (uint32 i = 0; i < threadCount; i++)
+	{
+		mThreads.push_back(std::make_unique<Thread>());
+		mThreads[i]->Pool.push_back(std::make_unique<Job[]>(PoolBlockSize));
+		mThreads[i]->Random = 0x9E3779B9u * (i + 1);
+	}
+
+	tSystem = this;
+	tThreadIndex = 0;
+	mWorkers.reserve(threadCount - 1);
+	for (uint32 i = 1; i < threadCount; i++)
+		mWorkers.emplace_back(&JobSystem::WorkerMain, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(mSleepLock);
+		mQuit.store(true);
+	}
+	mWake.notify_all();
+
+	for (std::thread& worker : mWorkers)
+		worker.join();
+
+	if (tSystem == this)
+		tSystem = nullptr;
+}
+
+JobSystem::uint32 JobSystem::GetThreadCount() const
+{
+	return (uint32)mThreads.size();
+}
+
+JobSystem::Job* JobSystem::Allocate(JobFunction function, const void* context, uint32 begin, uint32 end, uint32 grainSize, JobCounter& counter)
+{
+	Thread& thread = *mThreads[tThreadIndex];
+	uint32 capacity = (uint32)thread.Pool.size() * PoolBlockSize;
+	Job* job = nullptr;
+	for (uint32 i = 0; i < capacity && job == nullptr; i++)
+	{
+		uint32 slot = thread.PoolNext;
+		thread.PoolNext = slot + 1 < capacity ? slot + 1 : 0;
+
+		// Acquire: the thread that cleared Busy is done copying the job out.
+		Job* candidate = &thread.Pool[slot / PoolBlockSize][slot % PoolBlockSize];
+		if (!std::atomic_ref<bool>(candidate->Busy).load(std::memory_order_acquire))
+			job = candidate;
+	}
+
+	if (job == nullptr)
+	{
+		// Every slot holds a queued or parked job.  Blocks never move, so
+		// the jobs already handed out stay valid.
+		thread.Pool.push_back(std::make_unique<Job[]>(PoolBlockSize));
+		job = &thread.Pool.back()[0];
+		thread.PoolNext = capacity + 1;
+	}
+
+	job->Busy = true;
+	job->Function = function;
+	job->Context = context;
+	job->Begin = begin;
+	job->End = end;
+	job->GrainSize = grainSize;
+	job->Counter = &counter;
+	job->Next = nullptr;
+	return job;
+}
+
+void JobSystem::Submit(JobFunction function, const void* context, uint32 begin, uint32 end, uint32 grainSize, JobCounter& counter, JobCounter* dependency)
+{
+	counter.mPending.fetch_add(1, std::memory_order_relaxed);
+
+	if (GetThreadIndex() == UINT32_MAX)
+	{
+		// Not one of our threads: it has no deque, run the job right here.
+		if (dependency != nullptr)
+			Wait(*dependency);
+		Job job = { function, context, begin, end, grainSize, &counter, nullptr };
+		Execute(&job);
+		return;
+	}
+
+	Job* job = Allocate(function, context, begin, end, grainSize, counter);
+	if (dependency != nullptr)
+	{
+		// Parked until the last job of dependency finishes, unless it already has.
+		std::lock_guard<std::mutex> lock(dependency->mLock);
+		if (dependency->mPending.load(std::memory_order_acquire) != 0)
+		{
+			job->Next = dependency->mContinuations;
+			dependency->mContinuations = job;
+			return;
+		}
+	}
+	Push(*mThreads[tThreadIndex], job);
+}
+
+void JobSystem::Push(Thread& thread, Job* job)
+{
+	if (!thread.Jobs.Push(job))
+	{
+		// Deque full: the caller has plenty queued already, run it now.
+		Execute(job);
+		return;
+	}
+
+	// mQueued is raised before mSleepers is read, and a worker raises
+	// mSleepers before reading mQueued, so either it sees the job or we see
+	// it going to sleep and wake it.  Taking the lock orders the notify
+	// after its wait has begun.
+	mQueued.fetch_add(1, std::memory_order_seq_cst);
+	if (mSleepers.load(std::memory_order_seq_cst) > 0)
+	{
+		std::lock_guard<std::mutex> lock(mSleepLock);
+		mWake.notify_one();
+	}
+}
+
+JobSystem::Job* JobSystem::FindJob(uint32 threadIndex)
+{
+	Thread& thread = *mThreads[threadIndex];
+	Job* job = thread.Jobs.Pop();
+	if (job == nullptr && mThreads.size() > 1)
+	{
+		// Steal, starting from a random thread so thieves spread out.
+		thread.Random ^= thread.Random << 13;
+		thread.Random ^= thread.Random >> 17;
+		thread.Random ^= thread.Random << 5;
+		uint32 count = (uint32)mThreads.size();
+		uint32 start = thread.Random % count;
+		for (uint32 i = 0; i < count && job == nullptr; i++)
+		{
+			uint32 victim = (start + i) % count;
+			if (victim != threadIndex)
+				job = mThreads[victim]->Jobs.Steal();
+		}
+	}
+
+	if (job != nullptr)
+		mQueued.fetch_sub(1, std::memory_order_relaxed);
+	return job;
+}
+
+void JobSystem::Execute(Job* job)
+{
+	// Copied out, the pool slot of the job may be reused from here on.
+	Job range = *job;
+	std::atomic_ref<bool>(job->Busy).store(false, std::memory_order_release);
+
+	// Keep the lower half, push the upper one for other threads to steal.
+	while (range.End - range.Begin > range.GrainSize)
+	{
+		uint32 middle = range.Begin + (range.End - range.Begin) / 2;
+		Submit(range.Function, range.Context, middle, range.End, range.GrainSize, *range.Counter, nullptr);
+		range.End = middle;
+	}
+
+	range.Function(range.Context, range.Begin, range.End);
+	Finish(*range.Counter);
+}
+
+void JobSystem::Finish(JobCounter& counter)
+{
+	// Not the last job: nothing else to do, and the counter must not be
+	// touched past the decrement, its owner may be done with it.
+	uint32 pending = counter.mPending.load(std::memory_order_relaxed);
+	while (pending > 1)
+	{
+		if (counter.mPending.compare_exchange_weak(pending, pending - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+			return;
+	}
+
+	// Maybe the last one.  The lock keeps RunAfter from parking a job in
+	// between, and Wait takes it too before returning, so the counter
+	// outlives this block.
+	Job* continuations;
+	{
+		std::lock_guard<std::mutex> lock(counter.mLock);
+		continuations = counter.mContinuations;
+		counter.mContinuations = nullptr;
+		if (counter.mPending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		{
+			// A job split off more work meanwhile.
+			counter.mContinuations = continuations;
+			return;
+		}
+	}
+
+	while (continuations != nullptr)
+	{
+		Job* next = continuations->Next;
+		if (GetThreadIndex() == UINT32_MAX)
+			Execute(continuations);
+		else
+			Push(*mThreads[tThreadIndex], continuations);
+		continuations = next;
+	}
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	uint32 threadIndex = GetThreadIndex();
+	while (counter.mPending.load(std::memory_order_acquire) != 0)
+	{
+		Job* job = threadIndex != UINT32_MAX ? FindJob(threadIndex) : nullptr;
+		if (job != nullptr)
+			Execute(job);
+		else
+			std::this_thread::yield();
+	}
+
+	// Wait for the thread that finished the last job to be done with the counter.
+	std::lock_guard<std::mutex> lock(counter.mLock);
+}
+
+void JobSystem::WorkerMain(uint32 threadIndex)
+{
+	tSystem = this;
+	tThreadIndex = threadIndex;
+
+	int idleRounds = 0;
+	while (!mQuit.load(std::memory_order_relaxed))
+	{
+		Job* job = FindJob(threadIndex);
+		if (job != nullptr)
+		{
+			Execute(job);
+			idleRounds = 0;
+			continue;
+		}
+
+		if (++idleRounds < SpinRounds)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		// Nothing to steal for a while: sleep until a job is pushed.
+		std::unique_lock<std::mutex> lock(mSleepLock);
+		mSleepers.fetch_add(1, std::memory_order_seq_cst);
+		mWake.wait(lock, [this] { return mQueued.load(std::memory_order_seq_cst) > 0 || mQuit.load(); });
+		mSleepers.fetch_sub(1, std::memory_order_relaxed);
+		idleRounds = 0;
+	}
+}
+
+JobSystem::uint32 JobSystem::GetThreadIndex() const
+{
+	return tSystem == this ? tThreadIndex : UINT32_MAX;
+}
@@ -0,0 +1,206 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+
+// Number of jobs of a batch still to run.  Every job is tied to a counter
+// when it is submitted; JobSystem::Wait blocks until the counter drops to
+// zero, and RunAfter parks a job on a counter until then.
+class JobCounter
+{
+public:
+	JobCounter() = default;
+	JobCounter(const JobCounter& rhs) = delete;
+	JobCounter& operator=(const JobCounter& rhs) = delete;
+
+	bool									IsDone() const;
+
+private:
+	friend class JobSystem;
+	struct Job;
+
+	std::atomic<std::uint32_t>				mPending{ 0 };
+	// Guards mContinuations and orders the last decrement of mPending against
+	// RunAfter and Wait.
+	std::mutex								mLock;
+	Job*									mContinuations = nullptr;
+};
+
+// Work-stealing scheduler for fine-grained, per-frame work such as entity
+// loops.  Every thread owns a Chase-Lev deque: it pushes and pops jobs at
+// the bottom, while idle threads steal from the top of the others.  A
+// ParallelFor range is split in halves lazily, each thread pushing the upper
+// half and keeping the lower one, so idle threads steal large ranges and
+// busy ones never touch a shared queue.
+//
+// The thread that creates the JobSystem is thread 0 and takes part in the
+// work whenever it waits; the others are workers.  Jobs may be submitted
+// from thread 0 or from inside a job.  Any other thread runs what it submits
+// on the spot, so calling code never has to know where it runs.
+//
+// Jobs hold a pointer to their callable, not a copy, so submitting never
+// allocates: the callable must outlive the wait on its counter.  Jobs must
+// not throw.  Use ThreadPool for coarse tasks that block or throw.
+class JobSystem
+{
+public:
+	using uint32 = std::uint32_t;
+
+	// 0 picks one thread per hardware thread, the creating thread included.
+	explicit JobSystem(uint32 threadCount = 0);
+	JobSystem(const JobSystem& rhs) = delete;
+	JobSystem& operator=(const JobSystem& rhs) = delete;
+	// Every counter must have been waited on.
+	~JobSystem();
+
+	// Worker threads plus the creating thread.
+	uint32									GetThreadCount() const;
+
+	// Runs function() as one job.
+	template<typename Function>
+	void									Run(JobCounter& counter, const Function& function);
+	// Runs function() once dependency drops to zero; counter counts it from now.
+	template<typename Function>
+	void									RunAfter(JobCounter& dependency, JobCounter& counter, const Function& function);
+	// Calls function(rangeBegin, rangeEnd) over [begin, end) in ranges of at
+	// most grainSize elements, as jobs of counter.
+	template<typename Function>
+	void									ParallelFor(JobCounter& counter, uint32 begin, uint32 end, uint32 grainSize, const Function& function);
+	// Same, and waits for the whole range.
+	template<typename Function>
+	void									ParallelFor(uint32 begin, uint32 end, uint32 grainSize, const Function& function);
+
+	// Runs jobs, stealing if need be, until counter drops to zero.
+	void									Wait(JobCounter& counter);
+
+	// Jobs a thread can have queued at once; past that it runs them inline.
+	static constexpr uint32					DequeCapacity = 4096;
+
+private:
+	using Job = JobCounter::Job;
+	using JobFunction = void (*)(const void* context, uint32 begin, uint32 end);
+
+	// Fixed-size Chase-Lev deque ("Correct and Efficient Work-Stealing for
+	// Weak Memory Models", Le et al. 2013).  Push and Pop are for the owner
+	// only, Steal for any thread.
+	class Deque
+	{
+	public:
+		bool								Push(Job* job);
+		Job*								Pop();
+		Job*								Steal();
+
+	private:
+		alignas(64) std::atomic<std::int64_t>	mTop{ 0 };
+		alignas(64) std::atomic<std::int64_t>	mBottom{ 0 };
+		std::atomic<Job*>					mJobs[DequeCapacity];
+	};
+
+	struct alignas(64) Thread
+	{
+		Deque Jobs;
+		// Jobs are carved from these blocks, walked as one ring.  A job is
+		// copied out when it starts, so a slot is only busy while its job is
+		// queued or parked.  Parked jobs can stay busy for as long as their
+		// dependency runs, so busy slots are skipped, and a lap without a
+		// free one adds a block rather than overwrite a live job.
+		std::vector<std::unique_ptr<Job[]>> Pool;
+		uint32 PoolNext = 0;
+		uint32 Random = 0;
+	};
+
+	template<typename Function>
+	static void								CallTask(const void* context, uint32 begin, uint32 end);
+	template<typename Function>
+	static void								CallRange(const void* context, uint32 begin, uint32 end);
+
+	Job*									Allocate(JobFunction function, const void* context, uint32 begin, uint32 end, uint32 grainSize, JobCounter& counter);
+	void									Submit(JobFunction function, const void* context, uint32 begin, uint32 end, uint32 grainSize, JobCounter& counter, JobCounter* dependency);
+	void									Push(Thread& thread, Job* job);
+	Job*									FindJob(uint32 threadIndex);
+	void									Execute(Job* job);
+	void									Finish(JobCounter& counter);
+	void									WorkerMain(uint32 threadIndex);
+	// Index of the calling thread, or UINT32_MAX for a thread of another system.
+	uint32									GetThreadIndex() const;
+
+	std::vector<std::unique_ptr<Thread>>	mThreads;
+	std::vector<std::thread>				mWorkers;
+
+	// Jobs pushed and not taken yet, for workers to know when to sleep.
+	std::atomic<uint32>						mQueued{ 0 };
+	std::atomic<uint32>						mSleepers{ 0 };
+	std::mutex								mSleepLock;
+	std::condition_variable					mWake;
+	std::atomic<bool>						mQuit{ false };
+};
+
+struct JobCounter::Job
+{
+	void (*Function)(const void* context, std::uint32_t begin, std::uint32_t end);
+	const void* Context;
+	std::uint32_t Begin;
+	std::uint32_t End;
+	// Ranges larger than this are split before running.
+	std::uint32_t GrainSize;
+	JobCounter* Counter;
+	// Next continuation parked on the same counter.
+	Job* Next;
+	// Set by the owner of the pool slot when it hands the job out, cleared
+	// by whichever thread starts it.
+	bool Busy = false;
+};
+
+template<typename Function>
+void JobSystem::CallTask(const void* context, uint32, uint32)
+{
+	(*static_cast<const Function*>(context))();
+}
+
+template<typename Function>
+void JobSystem::CallRange(const void* context, uint32 begin, uint32 end)
+{
+	(*static_cast<const Function*>(context))(begin, end);
+}
+
+template<typename Function>
+void JobSystem::Run(JobCounter& counter, const Function& function)
+{
+	Submit(&CallTask<Function>, &function, 0, 1, UINT32_MAX, counter, nullptr);
+}
+
+template<typename Function>
+void JobSystem::RunAfter(JobCounter& dependency, JobCounter& counter, const Function& function)
+{
+	Submit(&CallTask<Function>, &function, 0, 1, UINT32_MAX, counter, &dependency);
+}
+
+template<typename Function>
+void JobSystem::ParallelFor(JobCounter& counter, uint32 begin, uint32 end, uint32 grainSize, const Function& function)
+{
+	if (begin < end)
+		Submit(&CallRange<Function>, &function, begin, end, grainSize > 0 ? grainSize : 1, counter, nullptr);
+}
+
+template<typename Function>
+void JobSystem::ParallelFor(uint32 begin, uint32 end, uint32 grainSize, const Function& function)
+{
+	if (begin >= end)
+		return;
+	// A range that would not be split is not worth a job.
+	if (end - begin <= grainSize)
+	{
+		function(begin, end);
+		return;
+	}
+
+	JobCounter counter;
+	ParallelFor(counter, begin, end, grainSize, function);
+	Wait(counter);
+}
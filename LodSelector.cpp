@@ -0,0 +1,42 @@
+#include "LodSelector.h"
+
+LodSelector::LodSelector(float hysteresis) :
+	mHysteresis(hysteresis)
+{
+}
+
+float LodSelector::ScreenSize(float radius, float viewDepth, float projScaleY)
+{
+	// Entities around or behind the eye are as big as they get.
+	const float minDepth = 1e-3f;
+	return radius * projScaleY / (viewDepth > minDepth ? viewDepth : minDepth);
+}
+
+LodChain LodSelector::MakeChain(uint32 levelCount, float finestSize, float ratio)
+{
+	LodChain chain;
+	chain.LevelCount = levelCount < 1 ? 1 : (levelCount > MaxLodLevels ? MaxLodLevels : levelCount);
+
+	float size = finestSize;
+	for (uint32 i = 0; i + 1 < chain.LevelCount; ++i)
+	{
+		chain.MinScreenSize[i] = size;
+		size *= ratio;
+	}
+	chain.MinScreenSize[chain.LevelCount - 1] = 0.0f;
+	return chain;
+}
+
+LodSelector::uint32 LodSelector::Select(const LodChain& chain, float screenSize, uint32 currentLod) const
+{
+	uint32 lod = currentLod < chain.LevelCount ? currentLod : chain.LevelCount - 1;
+
+	// Refine while clearly above the threshold of the next finer level,
+	// coarsen while clearly below the threshold of the current one.
+	while (lod > 0 && screenSize >= chain.MinScreenSize[lod - 1] * (1.0f + mHysteresis))
+		lod--;
+	while (lod + 1 < chain.LevelCount && screenSize < chain.MinScreenSize[lod] * (1.0f - mHysteresis))
+		lod++;
+
+	return lod;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+
+constexpr std::uint32_t MaxLodLevels = 5;
+
+// Screen size thresholds of one LOD chain.  Level i is used while the
+// screen size of the entity is at least MinScreenSize[i]; the last level has
+// a threshold of 0 and is used for everything smaller.
+struct LodChain
+{
+	std::uint32_t LevelCount = 1;
+	float MinScreenSize[MaxLodLevels] = {};
+};
+
+// Picks the LOD level of an entity from its projected size.  A level only
+// changes once the size is past the threshold by the hysteresis fraction, so
+// entities sitting right on a threshold do not flip between two levels
+// every frame.
+class LodSelector
+{
+public:
+	using uint32 = std::uint32_t;
+
+	LodSelector(float hysteresis = 0.15f);
+
+	// Radius of a bounding sphere as a fraction of half the viewport height.
+	// projScaleY is the [1][1] entry of the projection matrix.
+	static float							ScreenSize(float radius, float viewDepth, float projScaleY);
+
+	// Thresholds finestSize, finestSize * ratio, ... down to 0 for the last level.
+	static LodChain							MakeChain(uint32 levelCount, float finestSize, float ratio);
+
+	uint32									Select(const LodChain& chain, float screenSize, uint32 currentLod) const;
+
+private:
+	float									mHysteresis;
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Read-only view of a whole file mapped into memory.  Pages are loaded by the
+// OS on first touch, so opening is cheap whatever the size of the file, and
+// the data can be copied straight to its destination without an
+// intermediate read buffer.
+//
+// Uses MapViewOfFile on Windows and mmap elsewhere.  An empty file opens
+// successfully with a null Data.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile& rhs) = delete;
+	MappedFile& operator=(const MappedFile& rhs) = delete;
+	MappedFile(MappedFile&& rhs) noexcept;
+	MappedFile& operator=(MappedFile&& rhs) noexcept;
+	~MappedFile();
+
+	// Returns false if the file can not be opened or mapped.
+	bool									Open(const char* path);
+	void									Close();
+
+	bool									IsOpen() const;
+	const std::uint8_t*						Data() const;
+	std::size_t								Size() const;
+
+private:
+	const std::uint8_t*						mData = nullptr;
+	std::size_t								mSize = 0;
+	bool									mOpen = false;
+#ifdef _WIN32
+	void*									mFile = nullptr;
+	void*									mMapping = nullptr;
+#else
+	int										mFile = -1;
+#endif
+};
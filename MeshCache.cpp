@@ -0,0 +1,270 @@
+#include "MeshCache.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	const uint32 FileMagic = 'M' | ('S' << 8) | ('H' << 16) | ('C' << 24);
+	// Bump when the layout of the file changes.
+	const uint32 FileVersion = 1;
+	const uint64 BlobAlignment = 16;
+
+	// The checksum covers everything from PayloadSize to the end of the file.
+	struct FileHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		uint64 Key;
+		uint64 Checksum;
+		uint64 PayloadSize;
+		uint32 PageCount;
+		uint32 SubmeshCount;
+	};
+
+	// Offsets are from the start of the file.
+	struct PageRecord
+	{
+		uint32 Use32BitIndices;
+		uint32 VertexByteStride;
+		uint32 VertexByteSize;
+		uint32 IndexByteSize;
+		uint64 VertexOffset;
+		uint64 IndexOffset;
+	};
+
+	const std::size_t ChecksumStart = offsetof(FileHeader, PayloadSize);
+
+	static_assert(std::is_trivially_copyable<MeshCache::Submesh>::value, "submeshes are stored as raw bytes");
+
+	uint64 AlignUp(uint64 offset)
+	{
+		return (offset + BlobAlignment - 1) & ~(BlobAlignment - 1);
+	}
+
+	uint64 Rotl(uint64 x, int r)
+	{
+		return (x << r) | (x >> (64 - r));
+	}
+}
+
+MeshCacheKey& MeshCacheKey::Add(const void* data, std::size_t size)
+{
+	// FNV-1a.  Keys hash a few hundred bytes, speed does not matter here.
+	const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+	for (std::size_t i = 0; i < size; i++)
+		mHash = (mHash ^ bytes[i]) * 1099511628211ull;
+	return *this;
+}
+
+MeshCacheKey& MeshCacheKey::Add(const char* text)
+{
+	return Add(text, std::strlen(text) + 1);
+}
+
+MeshCacheKey::uint64 MeshCacheKey::Get() const
+{
+	return mHash;
+}
+
+const char* MeshCache::GetStatusName(Status status)
+{
+	switch (status)
+	{
+	case Status::Hit:		return "hit";
+	case Status::Missing:	return "missing";
+	case Status::Stale:		return "stale";
+	default:				return "corrupt";
+	}
+}
+
+MeshCache::Status MeshCache::Open(const char* path, uint64 key)
+{
+	Close();
+	if (!mFile.Open(path))
+		return Status::Missing;
+
+	const std::uint8_t* data = mFile.Data();
+	std::size_t size = mFile.Size();
+	FileHeader header;
+	if (size < sizeof(FileHeader))
+	{
+		Close();
+		return Status::Corrupt;
+	}
+	std::memcpy(&header, data, sizeof(FileHeader));
+
+	if (header.Magic != FileMagic || header.Version != FileVersion || header.Key != key)
+	{
+		Close();
+		return Status::Stale;
+	}
+
+	uint64 tableSize = (uint64)header.PageCount * sizeof(PageRecord) + (uint64)header.SubmeshCount * sizeof(Submesh);
+	if (header.PayloadSize != size - sizeof(FileHeader) || tableSize > header.PayloadSize ||
+		Checksum(data + ChecksumStart, size - ChecksumStart) != header.Checksum)
+	{
+		Close();
+		return Status::Corrupt;
+	}
+
+	// The checksum only proves the file is what was written; the ranges are
+	// still checked so a bad writer can not make us read past the mapping.
+	const std::uint8_t* tables = data + sizeof(FileHeader);
+	mPages.resize(header.PageCount);
+	for (uint32 p = 0; p < header.PageCount; p++)
+	{
+		PageRecord record;
+		std::memcpy(&record, tables + p * sizeof(PageRecord), sizeof(PageRecord));
+		// Compared against what is left after the offset, so a huge offset
+		// can not wrap the sum back into range.
+		if (record.VertexOffset > size || record.VertexByteSize > size - record.VertexOffset ||
+			record.IndexOffset > size || record.IndexByteSize > size - record.IndexOffset)
+		{
+			Close();
+			return Status::Corrupt;
+		}
+
+		Page& page = mPages[p];
+		page.Use32BitIndices = record.Use32BitIndices;
+		page.VertexByteStride = record.VertexByteStride;
+		page.VertexByteSize = record.VertexByteSize;
+		page.IndexByteSize = record.IndexByteSize;
+		page.Vertices = data + record.VertexOffset;
+		page.Indices = data + record.IndexOffset;
+	}
+
+	mSubmeshes.resize(header.SubmeshCount);
+	if (header.SubmeshCount > 0)
+		std::memcpy(mSubmeshes.data(), tables + header.PageCount * sizeof(PageRecord), header.SubmeshCount * sizeof(Submesh));
+	for (const Submesh& submesh : mSubmeshes)
+	{
+		if (submesh.Page >= header.PageCount)
+		{
+			Close();
+			return Status::Corrupt;
+		}
+
+		const Page& page = mPages[submesh.Page];
+		uint64 pageIndexCount = page.IndexByteSize / (page.Use32BitIndices ? 4 : 2);
+		uint64 pageVertexCount = page.VertexByteStride > 0 ? page.VertexByteSize / page.VertexByteStride : 0;
+		if ((uint64)submesh.StartIndexLocation + submesh.IndexCount > pageIndexCount ||
+			submesh.BaseVertexLocation < 0 || (uint64)submesh.BaseVertexLocation > pageVertexCount)
+		{
+			Close();
+			return Status::Corrupt;
+		}
+	}
+
+	return Status::Hit;
+}
+
+void MeshCache::Close()
+{
+	mFile.Close();
+	mPages.clear();
+	mSubmeshes.clear();
+}
+
+const std::vector<MeshCache::Page>& MeshCache::GetPages() const
+{
+	return mPages;
+}
+
+const std::vector<MeshCache::Submesh>& MeshCache::GetSubmeshes() const
+{
+	return mSubmeshes;
+}
+
+bool MeshCache::Write(const char* path, uint64 key, const std::vector<Page>& pages, const std::vector<Submesh>& submeshes)
+{
+	// Lay the file out in memory first; it is as large as the page data, a
+	// few megabytes at most.
+	uint64 offset = sizeof(FileHeader) + pages.size() * sizeof(PageRecord) + submeshes.size() * sizeof(Submesh);
+	std::vector<PageRecord> records(pages.size());
+	for (std::size_t p = 0; p < pages.size(); p++)
+	{
+		PageRecord& record = records[p];
+		record.Use32BitIndices = pages[p].Use32BitIndices;
+		record.VertexByteStride = pages[p].VertexByteStride;
+		record.VertexByteSize = pages[p].VertexByteSize;
+		record.IndexByteSize = pages[p].IndexByteSize;
+		record.VertexOffset = AlignUp(offset);
+		record.IndexOffset = AlignUp(record.VertexOffset + record.VertexByteSize);
+		offset = record.IndexOffset + record.IndexByteSize;
+	}
+
+	std::vector<std::uint8_t> file((std::size_t)offset, 0);
+	std::uint8_t* tables = file.data() + sizeof(FileHeader);
+	if (!records.empty())
+		std::memcpy(tables, records.data(), records.size() * sizeof(PageRecord));
+	if (!submeshes.empty())
+		std::memcpy(tables + records.size() * sizeof(PageRecord), submeshes.data(), submeshes.size() * sizeof(Submesh));
+	for (std::size_t p = 0; p < pages.size(); p++)
+	{
+		if (pages[p].VertexByteSize > 0)
+			std::memcpy(&file[(std::size_t)records[p].VertexOffset], pages[p].Vertices, pages[p].VertexByteSize);
+		if (pages[p].IndexByteSize > 0)
+			std::memcpy(&file[(std::size_t)records[p].IndexOffset], pages[p].Indices, pages[p].IndexByteSize);
+	}
+
+	FileHeader header = {};
+	header.Magic = FileMagic;
+	header.Version = FileVersion;
+	header.Key = key;
+	header.PayloadSize = offset - sizeof(FileHeader);
+	header.PageCount = (uint32)pages.size();
+	header.SubmeshCount = (uint32)submeshes.size();
+	std::memcpy(file.data(), &header, sizeof(FileHeader));
+	header.Checksum = Checksum(file.data() + ChecksumStart, file.size() - ChecksumStart);
+	std::memcpy(file.data(), &header, sizeof(FileHeader));
+
+	std::string tempPath = std::string(path) + ".tmp";
+	{
+		std::ofstream fout(tempPath, std::ios::binary | std::ios::trunc);
+		fout.write(reinterpret_cast<const char*>(file.data()), (std::streamsize)file.size());
+		if (!fout)
+			return false;
+	}
+
+	// rename does not replace an existing file on Windows.
+	std::remove(path);
+	return std::rename(tempPath.c_str(), path) == 0;
+}
+
+MeshCache::uint64 MeshCache::Checksum(const void* data, std::size_t size)
+{
+	const uint64 Prime1 = 0x9E3779B185EBCA87ull;
+	const uint64 Prime2 = 0xC2B2AE3D27D4EB4Full;
+	const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+
+	// Four independent lanes keep several multiplies in flight.
+	uint64 lanes[4] = { Prime1 + Prime2, Prime2, 0, 0 - Prime1 };
+	std::size_t i = 0;
+	for (; i + 32 <= size; i += 32)
+	{
+		for (int l = 0; l < 4; l++)
+		{
+			uint64 word;
+			std::memcpy(&word, bytes + i + 8 * l, 8);
+			lanes[l] = Rotl(lanes[l] + word * Prime2, 31) * Prime1;
+		}
+	}
+
+	uint64 hash = Rotl(lanes[0], 1) + Rotl(lanes[1], 7) + Rotl(lanes[2], 12) + Rotl(lanes[3], 18) + size;
+	for (; i < size; i++)
+		hash = Rotl(hash ^ (bytes[i] * Prime1), 11) * Prime2;
+
+	// Final avalanche, so every input bit affects every output bit.
+	hash ^= hash >> 33;
+	hash *= Prime2;
+	hash ^= hash >> 29;
+	hash *= Prime1;
+	hash ^= hash >> 32;
+	return hash;
+}
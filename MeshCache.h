@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+// 64-bit key of a mesh cache entry, hashed from everything the cached data
+// depends on: generator names and parameters, vertex format, and a version
+// number bumped whenever the code that builds the meshes changes.
+class MeshCacheKey
+{
+public:
+	using uint64 = std::uint64_t;
+
+	MeshCacheKey&							Add(const void* data, std::size_t size);
+	// Includes the terminating zero, so "ab","c" and "a","bc" differ.
+	MeshCacheKey&							Add(const char* text);
+	template<typename T>
+	MeshCacheKey&							Add(const T& value)
+	{
+		return Add(&value, sizeof(T));
+	}
+
+	uint64									Get() const;
+
+private:
+	uint64									mHash = 14695981039346656037ull;
+};
+
+// On-disk image of packed mesh pages: the vertex and index bytes of every
+// page, and the placement and bounds of every submesh in them.
+//
+// The file is a header, the page and submesh tables, then the page bytes,
+// each blob 16-byte aligned.  The header holds the key the file was written
+// for and a checksum of everything after it.  Open maps the file and
+// validates both, so a hit costs one pass of hashing over the file and the
+// page bytes are then read in place from the mapping.
+class MeshCache
+{
+public:
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	enum class Status
+	{
+		Hit,
+		// No cache file.
+		Missing,
+		// Written for another key or another file version.
+		Stale,
+		// Truncated, or the checksum does not match.
+		Corrupt
+	};
+
+	struct Page
+	{
+		uint32 Use32BitIndices = 0;
+		uint32 VertexByteStride = 0;
+		uint32 VertexByteSize = 0;
+		uint32 IndexByteSize = 0;
+		// Into the mapping after Open; caller memory for Write.
+		const void* Vertices = nullptr;
+		const void* Indices = nullptr;
+	};
+
+	struct Submesh
+	{
+		uint32 DrawArg = 0;
+		uint32 Lod = 0;
+		uint32 Page = 0;
+		uint32 IndexCount = 0;
+		uint32 StartIndexLocation = 0;
+		std::int32_t BaseVertexLocation = 0;
+		float BoundsCenter[3] = {};
+		float BoundsExtents[3] = {};
+	};
+
+	static const char*						GetStatusName(Status status);
+
+	// Maps path and checks it against key.  The pages and submeshes are only
+	// filled on a hit, and the page pointers stay valid until Close.
+	Status									Open(const char* path, uint64 key);
+	void									Close();
+
+	const std::vector<Page>&				GetPages() const;
+	const std::vector<Submesh>&				GetSubmeshes() const;
+
+	// Writes to a temporary file renamed over path once complete, so a crash
+	// midway leaves no half-written cache behind.
+	static bool								Write(const char* path, uint64 key, const std::vector<Page>& pages, const std::vector<Submesh>& submeshes);
+
+	// 4-lane multiply-rotate hash over 8-byte words, for the file checksum.
+	static uint64							Checksum(const void* data, std::size_t size);
+
+private:
+	MappedFile								mFile;
+	std::vector<Page>						mPages;
+	std::vector<Submesh>					mSubmeshes;
+};
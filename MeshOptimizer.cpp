@@ -0,0 +1,209 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+
+using namespace DirectX;
+
+void MeshOptimizer::OptimizeVertexCache(std::vector<uint32>& indices, uint32 vertexCount,
+	uint32 cacheSize, std::vector<uint32>* clusters)
+{
+	uint32 triangleCount = (uint32)indices.size() / 3;
+	if (clusters != nullptr)
+		clusters->clear();
+	if (triangleCount == 0)
+		return;
+
+	// Vertex to triangle adjacency as flat offset/data arrays.  live[v] is the
+	// number of triangles of v not emitted yet.
+	std::vector<uint32> live(vertexCount, 0);
+	for (uint32 index : indices)
+		live[index]++;
+
+	std::vector<uint32> adjacencyStart(vertexCount + 1, 0);
+	for (uint32 v = 0; v < vertexCount; ++v)
+		adjacencyStart[v + 1] = adjacencyStart[v] + live[v];
+
+	std::vector<uint32> adjacency(indices.size());
+	{
+		std::vector<uint32> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+		for (uint32 i = 0; i < (uint32)indices.size(); ++i)
+			adjacency[fill[indices[i]]++] = i / 3;
+	}
+
+	std::vector<uint32> cacheTime(vertexCount, 0);
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32> deadEnd;
+	std::vector<uint32> candidates;
+	std::vector<uint32> output;
+	output.reserve(indices.size());
+	deadEnd.reserve(indices.size());
+
+	uint32 timestamp = cacheSize + 1;
+	uint32 cursor = 1;
+	int fanning = 0;
+	if (clusters != nullptr)
+		clusters->push_back(0);
+
+	while (fanning >= 0)
+	{
+		// Emit every remaining triangle around the fanning vertex.
+		candidates.clear();
+		for (uint32 a = adjacencyStart[fanning]; a < adjacencyStart[fanning + 1]; ++a)
+		{
+			uint32 t = adjacency[a];
+			if (emitted[t])
+				continue;
+
+			for (uint32 k = 0; k < 3; ++k)
+			{
+				uint32 v = indices[t * 3 + k];
+				output.push_back(v);
+				deadEnd.push_back(v);
+				candidates.push_back(v);
+				live[v]--;
+				if (timestamp - cacheTime[v] > cacheSize)
+					cacheTime[v] = timestamp++;
+			}
+			emitted[t] = true;
+		}
+
+		// Next fanning vertex: the one among the candidates that will still be
+		// in the cache after its remaining triangles are emitted, preferring
+		// the oldest such entry.
+		int best = -1;
+		uint32 bestPriority = 0;
+		for (uint32 v : candidates)
+		{
+			if (live[v] == 0)
+				continue;
+
+			uint32 priority = 0;
+			if (timestamp - cacheTime[v] + 2 * live[v] <= cacheSize)
+				priority = timestamp - cacheTime[v];
+			if (best < 0 || priority > bestPriority)
+			{
+				best = (int)v;
+				bestPriority = priority;
+			}
+		}
+
+		if (best < 0)
+		{
+			// Dead end: go back to a recently used vertex, else scan forward.
+			// The cache is cold from here on, which starts a new cluster.
+			while (!deadEnd.empty() && best < 0)
+			{
+				uint32 v = deadEnd.back();
+				deadEnd.pop_back();
+				if (live[v] > 0)
+					best = (int)v;
+			}
+			while (best < 0 && cursor < vertexCount)
+			{
+				if (live[cursor] > 0)
+					best = (int)cursor;
+				cursor++;
+			}
+			if (best >= 0 && clusters != nullptr && output.size() / 3 < triangleCount)
+				clusters->push_back((uint32)output.size() / 3);
+		}
+
+		fanning = best;
+	}
+
+	indices.swap(output);
+}
+
+void MeshOptimizer::OptimizeOverdraw(std::vector<uint32>& indices, const std::vector<uint32>& clusters,
+	const XMFLOAT3* positions, size_t positionStride, uint32 vertexCount)
+{
+	auto position = [&](uint32 v)
+	{
+		return XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(reinterpret_cast<const unsigned char*>(positions) + v * positionStride));
+	};
+
+	uint32 triangleCount = (uint32)indices.size() / 3;
+	uint32 clusterCount = (uint32)clusters.size();
+	if (clusterCount < 2)
+		return;
+
+	XMVECTOR meshCenter = XMVectorZero();
+	for (uint32 v = 0; v < vertexCount; ++v)
+		meshCenter = XMVectorAdd(meshCenter, position(v));
+	meshCenter = XMVectorScale(meshCenter, 1.0f / (float)vertexCount);
+
+	// Sort key of a cluster: how much its area weighted normal faces away
+	// from the mesh center.
+	std::vector<std::pair<float, uint32>> order(clusterCount);
+	for (uint32 c = 0; c < clusterCount; ++c)
+	{
+		uint32 begin = clusters[c];
+		uint32 end = c + 1 < clusterCount ? clusters[c + 1] : triangleCount;
+
+		XMVECTOR center = XMVectorZero();
+		XMVECTOR normal = XMVectorZero();
+		float area = 0.0f;
+		for (uint32 t = begin; t < end; ++t)
+		{
+			XMVECTOR p0 = position(indices[t * 3 + 0]);
+			XMVECTOR p1 = position(indices[t * 3 + 1]);
+			XMVECTOR p2 = position(indices[t * 3 + 2]);
+			XMVECTOR n = XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0));
+			float a = XMVectorGetX(XMVector3Length(n));
+
+			center = XMVectorAdd(center, XMVectorScale(XMVectorAdd(XMVectorAdd(p0, p1), p2), a / 3.0f));
+			normal = XMVectorAdd(normal, n);
+			area += a;
+		}
+		if (area > 0.0f)
+			center = XMVectorScale(center, 1.0f / area);
+
+		float key = XMVectorGetX(XMVector3Dot(XMVectorSubtract(center, meshCenter), XMVector3Normalize(normal)));
+		order[c] = std::make_pair(key, c);
+	}
+
+	std::stable_sort(order.begin(), order.end(),
+		[](const std::pair<float, uint32>& a, const std::pair<float, uint32>& b) { return a.first > b.first; });
+
+	std::vector<uint32> output;
+	output.reserve(indices.size());
+	for (const auto& entry : order)
+	{
+		uint32 c = entry.second;
+		uint32 begin = clusters[c];
+		uint32 end = c + 1 < clusterCount ? clusters[c + 1] : triangleCount;
+		output.insert(output.end(), indices.begin() + begin * 3, indices.begin() + end * 3);
+	}
+	indices.swap(output);
+}
+
+MeshOptimizer::VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const std::vector<uint32>& indices, uint32 vertexCount,
+	uint32 cacheSize)
+{
+	VertexCacheStats stats;
+	if (indices.empty())
+		return stats;
+
+	// FIFO cache: a vertex is a hit while fewer than cacheSize misses happened
+	// since it was last loaded.
+	std::vector<uint32> loadedAt(vertexCount, 0);
+	std::vector<bool> used(vertexCount, false);
+	uint32 misses = 0;
+	uint32 unique = 0;
+	for (uint32 v : indices)
+	{
+		if (!used[v])
+		{
+			used[v] = true;
+			unique++;
+		}
+		if (loadedAt[v] == 0 || misses - loadedAt[v] >= cacheSize)
+		{
+			misses++;
+			loadedAt[v] = misses;
+		}
+	}
+
+	stats.ACMR = (float)misses / (float)(indices.size() / 3);
+	stats.ATVR = (float)misses / (float)unique;
+	return stats;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "CreateGeometry.h"
+
+// Reorders generated meshes for the GPU before they are uploaded.
+//
+//  - OptimizeVertexCache reorders triangles with Tipsify (Sander, Nehab and
+//    Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced
+//    Overdraw"): it fans around the most recently used vertex that still has
+//    triangles left, so consecutive triangles share vertices still in the
+//    post-transform cache.  Linear in the triangle count.
+//  - OptimizeOverdraw (optional) keeps the clusters found by the cache pass
+//    intact but draws the ones facing away from the mesh center first, so
+//    outer surfaces tend to occlude inner ones.
+//  - OptimizeVertexFetch renumbers vertices in order of first use, so vertex
+//    fetch walks the vertex buffer forward.  Unused vertices are dropped.
+//
+// AnalyzeVertexCache simulates a FIFO cache to report ACMR (vertex shader
+// invocations per triangle) and ATVR (invocations per unique vertex, 1.0
+// being ideal).
+class MeshOptimizer
+{
+public:
+	using uint32 = std::uint32_t;
+
+	struct VertexCacheStats
+	{
+		float ACMR = 0.0f;
+		float ATVR = 0.0f;
+	};
+
+	static constexpr uint32 DefaultCacheSize = 16;
+
+	// Triangle order of indices for a cache of cacheSize entries.  When
+	// clusters is not null it receives the index (in triangles) where each
+	// cluster starts.
+	static void								OptimizeVertexCache(std::vector<uint32>& indices, uint32 vertexCount,
+												uint32 cacheSize = DefaultCacheSize, std::vector<uint32>* clusters = nullptr);
+	// Reorders the clusters of an index list optimized by OptimizeVertexCache.
+	// Positions are read with a stride of positionStride bytes.
+	static void								OptimizeOverdraw(std::vector<uint32>& indices, const std::vector<uint32>& clusters,
+												const DirectX::XMFLOAT3* positions, size_t positionStride, uint32 vertexCount);
+
+	template<typename Format>
+	static void								OptimizeVertexFetch(CreateGeometry::BasicMeshData<Format>& meshData)
+	{
+		std::vector<uint32> remap(meshData.Vertices.size(), UINT32_MAX);
+		std::vector<typename Format::Vertex> vertices;
+		vertices.reserve(meshData.Vertices.size());
+
+		for (uint32& index : meshData.Indices32)
+		{
+			if (remap[index] == UINT32_MAX)
+			{
+				remap[index] = (uint32)vertices.size();
+				vertices.push_back(meshData.Vertices[index]);
+			}
+			index = remap[index];
+		}
+
+		meshData.Vertices.swap(vertices);
+	}
+
+	// All three passes on a mesh, in order.
+	template<typename Format>
+	static void								Optimize(CreateGeometry::BasicMeshData<Format>& meshData, bool reduceOverdraw)
+	{
+		if (meshData.Vertices.empty())
+			return;
+
+		std::vector<uint32> clusters;
+		OptimizeVertexCache(meshData.Indices32, (uint32)meshData.Vertices.size(), DefaultCacheSize,
+			reduceOverdraw ? &clusters : nullptr);
+		if (reduceOverdraw)
+		{
+			OptimizeOverdraw(meshData.Indices32, clusters, &meshData.Vertices[0].Position,
+				sizeof(typename Format::Vertex), (uint32)meshData.Vertices.size());
+		}
+		OptimizeVertexFetch(meshData);
+	}
+
+	static VertexCacheStats					AnalyzeVertexCache(const std::vector<uint32>& indices, uint32 vertexCount,
+												uint32 cacheSize = DefaultCacheSize);
+};
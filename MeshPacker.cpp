@@ -0,0 +1,98 @@
+#include "MeshPacker.h"
+#include <cstdio>
+
+MeshPacker::MeshPacker(uint32 pageVertexCapacity, uint32 pageIndexCapacity) :
+	mPageVertexCapacity(pageVertexCapacity),
+	mPageIndexCapacity(pageIndexCapacity)
+{
+}
+
+MeshPacker::uint32 MeshPacker::AddSubmesh(uint32 vertexCount, uint32 indexCount)
+{
+	Submesh submesh;
+	submesh.VertexCount = vertexCount;
+	submesh.IndexCount = indexCount;
+	mSubmeshes.push_back(submesh);
+	return (uint32)mSubmeshes.size() - 1;
+}
+
+void MeshPacker::Pack()
+{
+	mPages.clear();
+	for (Submesh& submesh : mSubmeshes)
+	{
+		// Largest index of the submesh has to fit the index format.
+		bool use32 = submesh.VertexCount > 0x10000;
+
+		uint32 page = 0;
+		for (; page < mPages.size(); ++page)
+		{
+			const Page& p = mPages[page];
+			if (p.Use32BitIndices == use32
+				&& p.VertexCount + submesh.VertexCount <= mPageVertexCapacity
+				&& p.IndexCount + submesh.IndexCount <= mPageIndexCapacity)
+				break;
+		}
+
+		if (page == mPages.size())
+		{
+			Page p;
+			p.Use32BitIndices = use32;
+			mPages.push_back(p);
+		}
+
+		Page& p = mPages[page];
+		submesh.Page = page;
+		submesh.BaseVertexLocation = (int)p.VertexCount;
+		submesh.StartIndexLocation = p.IndexCount;
+		p.VertexCount += submesh.VertexCount;
+		p.IndexCount += submesh.IndexCount;
+	}
+}
+
+const std::vector<MeshPacker::Submesh>& MeshPacker::GetSubmeshes() const
+{
+	return mSubmeshes;
+}
+
+const std::vector<MeshPacker::Page>& MeshPacker::GetPages() const
+{
+	return mPages;
+}
+
+MeshPacker::uint32 MeshPacker::GetIndexStride(uint32 page) const
+{
+	return mPages[page].Use32BitIndices ? 4 : 2;
+}
+
+std::string MeshPacker::GetOccupancyReport() const
+{
+	std::string report;
+	char line[160];
+	for (uint32 i = 0; i < mPages.size(); ++i)
+	{
+		const Page& p = mPages[i];
+		std::snprintf(line, sizeof(line), "page %u: %s, %u/%u vertices (%.1f%%), %u/%u indices (%.1f%%)\n",
+			i, p.Use32BitIndices ? "R32_UINT" : "R16_UINT",
+			p.VertexCount, mPageVertexCapacity, 100.0 * p.VertexCount / mPageVertexCapacity,
+			p.IndexCount, mPageIndexCapacity, 100.0 * p.IndexCount / mPageIndexCapacity);
+		report += line;
+	}
+	return report;
+}
+
+void MeshPacker::CopyIndices(const uint32* src, uint32 count, bool use32, void* dst)
+{
+	if (use32)
+	{
+		uint32* out = static_cast<uint32*>(dst);
+		for (uint32 i = 0; i < count; ++i)
+			out[i] = src[i];
+	}
+	else
+	{
+		std::uint16_t* out = static_cast<std::uint16_t*>(dst);
+		for (uint32 i = 0; i < count; ++i)
+			out[i] = static_cast<std::uint16_t>(src[i]);
+	}
+}
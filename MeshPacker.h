@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Lays submeshes out in shared vertex/index pages, each page becoming one
+// MeshGeometry.  Indices stay relative to the submesh (BaseVertexLocation
+// is added by the draw), so a page can use R16_UINT as long as every
+// submesh in it has at most 65536 vertices; bigger submeshes go to R32_UINT
+// pages.  A page holds up to the vertex and index capacities given to the
+// constructor, and a submesh larger than that gets a page of its own.
+//
+// The packer only computes offsets; the caller fills the page buffers with
+// them, using CopyIndices to narrow indices for 16-bit pages.
+class MeshPacker
+{
+public:
+	using uint32 = std::uint32_t;
+
+	struct Submesh
+	{
+		uint32 VertexCount = 0;
+		uint32 Page = 0;
+		uint32 IndexCount = 0;
+		uint32 StartIndexLocation = 0;
+		int BaseVertexLocation = 0;
+	};
+
+	struct Page
+	{
+		bool Use32BitIndices = false;
+		uint32 VertexCount = 0;
+		uint32 IndexCount = 0;
+	};
+
+	MeshPacker(uint32 pageVertexCapacity = 1u << 20, uint32 pageIndexCapacity = 1u << 22);
+
+	// Returns the id of the submesh, in order of addition.
+	uint32									AddSubmesh(uint32 vertexCount, uint32 indexCount);
+	// Assigns every submesh to a page, first fit in order of addition.
+	void									Pack();
+
+	const std::vector<Submesh>&				GetSubmeshes() const;
+	const std::vector<Page>&				GetPages() const;
+	uint32									GetIndexStride(uint32 page) const;
+
+	// One line per page: index format, vertex and index use against capacity.
+	std::string								GetOccupancyReport() const;
+
+	// Writes count indices at dst, as uint16 or uint32 depending on use32.
+	static void								CopyIndices(const uint32* src, uint32 count, bool use32, void* dst);
+
+private:
+	uint32									mPageVertexCapacity;
+	uint32									mPageIndexCapacity;
+	std::vector<Submesh>					mSubmeshes;
+	std::vector<Page>						mPages;
+};
@@ -0,0 +1,569 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	// Symmetric 4x4 quadric, upper triangle.
+	struct Quadric
+	{
+		double a2 = 0, ab = 0, ac = 0, ad = 0;
+		double b2 = 0, bc = 0, bd = 0;
+		double c2 = 0, cd = 0;
+		double d2 = 0;
+
+		void AddPlane(double a, double b, double c, double d, double w)
+		{
+			a2 += w * a * a; ab += w * a * b; ac += w * a * c; ad += w * a * d;
+			b2 += w * b * b; bc += w * b * c; bd += w * b * d;
+			c2 += w * c * c; cd += w * c * d;
+			d2 += w * d * d;
+		}
+
+		// Squared distance to a point, scaled by w.
+		void AddPoint(double x, double y, double z, double w)
+		{
+			a2 += w; ad -= w * x;
+			b2 += w; bd -= w * y;
+			c2 += w; cd -= w * z;
+			d2 += w * (x * x + y * y + z * z);
+		}
+
+		void Add(const Quadric& q)
+		{
+			a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+			b2 += q.b2; bc += q.bc; bd += q.bd;
+			c2 += q.c2; cd += q.cd;
+			d2 += q.d2;
+		}
+
+		double Evaluate(double x, double y, double z) const
+		{
+			return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+				+ b2 * y * y + 2 * bc * y * z + 2 * bd * y
+				+ c2 * z * z + 2 * cd * z
+				+ d2;
+		}
+	};
+
+	// Weight of the point term of the quadrics relative to the plane terms.
+	constexpr double PointWeight = 1e-3;
+
+	struct Collapse
+	{
+		float Cost;
+		uint32 To;
+	};
+
+	struct HeapEntry
+	{
+		float Cost;
+		uint32 Vertex;
+	};
+
+	struct Float3
+	{
+		float x, y, z;
+	};
+
+	Float3 Sub(const Float3& a, const Float3& b)
+	{
+		return { a.x - b.x, a.y - b.y, a.z - b.z };
+	}
+
+	Float3 Cross(const Float3& a, const Float3& b)
+	{
+		return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+	}
+
+	float Dot(const Float3& a, const Float3& b)
+	{
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+
+	class Simplifier
+	{
+	public:
+		Simplifier(std::vector<uint32>& indices, const DirectX::XMFLOAT3* positions, size_t positionStride, uint32 vertexCount) :
+			mIndices(indices),
+			mSourcePositions(reinterpret_cast<const unsigned char*>(positions)),
+			mSourceStride(positionStride),
+			mVertexCount(vertexCount),
+			mTriangleCount((uint32)indices.size() / 3)
+		{
+		}
+
+		MeshSimplifier::Result Run(uint32 targetTriangleCount, float maxError)
+		{
+			BuildPositions();
+			BuildAdjacency();
+			ClassifyVertices();
+			BuildQuadrics();
+
+			mHeap.reserve(mVertexCount);
+			mHeapPosition.assign(mVertexCount, UINT32_MAX);
+			mBest.resize(mVertexCount);
+			for (uint32 v = 0; v < mVertexCount; ++v)
+				UpdateBestCollapse(v);
+
+			MeshSimplifier::Result result;
+			uint32 alive = mTriangleCount;
+			while (alive > targetTriangleCount && !mHeap.empty())
+			{
+				uint32 from = mHeap[0].Vertex;
+				Collapse c = mBest[from];
+				if (c.Cost > maxError)
+					break;
+
+				alive -= Apply(from, c.To);
+				result.Error = std::max(result.Error, c.Cost);
+			}
+
+			Compact();
+			result.TriangleCount = (uint32)mIndices.size() / 3;
+			return result;
+		}
+
+	private:
+		// Welds vertices by exact position so seams can be found.
+		void BuildPositions()
+		{
+			// Open addressing table of the first vertex seen at each position.
+			size_t tableSize = 64;
+			while (tableSize < (size_t)mVertexCount * 2)
+				tableSize <<= 1;
+			std::vector<uint32> table(tableSize, UINT32_MAX);
+
+			mPositions.resize(mVertexCount);
+			mPositionId.resize(mVertexCount);
+			uint32 next = 0;
+			for (uint32 v = 0; v < mVertexCount; ++v)
+			{
+				const DirectX::XMFLOAT3& p = SourcePosition(v);
+				mPositions[v] = { p.x, p.y, p.z };
+				uint32 bits[3];
+				memcpy(bits, &p, sizeof(bits));
+				size_t h = (size_t)((bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u)) & (tableSize - 1);
+				for (;;)
+				{
+					uint32 other = table[h];
+					if (other == UINT32_MAX)
+					{
+						table[h] = v;
+						mPositionId[v] = next++;
+						break;
+					}
+
+					const DirectX::XMFLOAT3& q = SourcePosition(other);
+					if (q.x == p.x && q.y == p.y && q.z == p.z)
+					{
+						mPositionId[v] = mPositionId[other];
+						break;
+					}
+					h = (h + 1) & (tableSize - 1);
+				}
+			}
+			mPositionCount = next;
+		}
+
+		void BuildAdjacency()
+		{
+			const std::vector<uint32>& indices = mIndices;
+
+			mAdjacencyStart.assign(mVertexCount + 1, 0);
+			for (uint32 index : indices)
+				mAdjacencyStart[index + 1]++;
+			for (uint32 v = 0; v < mVertexCount; ++v)
+				mAdjacencyStart[v + 1] += mAdjacencyStart[v];
+
+			mAdjacency.resize(indices.size());
+			std::vector<uint32> fill(mAdjacencyStart.begin(), mAdjacencyStart.end() - 1);
+			for (uint32 i = 0; i < (uint32)indices.size(); ++i)
+				mAdjacency[fill[indices[i]]++] = i / 3;
+
+			mAdjacencyCount.resize(mVertexCount);
+			for (uint32 v = 0; v < mVertexCount; ++v)
+				mAdjacencyCount[v] = mAdjacencyStart[v + 1] - mAdjacencyStart[v];
+			mAdjacencyStart.pop_back();
+
+			mTriangleAlive.assign(mTriangleCount, true);
+			mCollapsed.assign(mVertexCount, false);
+		}
+
+		void ClassifyVertices()
+		{
+			mLocked.assign(mVertexCount, false);
+
+			// Seams: more than one vertex at a position.
+			std::vector<uint32> perPosition(mPositionCount, 0);
+			for (uint32 v = 0; v < mVertexCount; ++v)
+				perPosition[mPositionId[v]]++;
+			for (uint32 v = 0; v < mVertexCount; ++v)
+				mLocked[v] = perPosition[mPositionId[v]] > 1;
+
+			// Borders and non-manifold edges: an edge between two positions
+			// not used by exactly two triangles.  Counted in an open addressing
+			// table keyed on the sorted position pair.
+			size_t tableSize = 64;
+			while (tableSize < (size_t)mTriangleCount * 3 * 2)
+				tableSize <<= 1;
+			std::vector<std::uint64_t> edgeKeys(tableSize, UINT64_MAX);
+			std::vector<uint32> edgeUse(tableSize, 0);
+
+			const std::vector<uint32>& indices = mIndices;
+			std::vector<uint32> edgeSlot(indices.size());
+			for (uint32 i = 0; i < (uint32)indices.size(); ++i)
+			{
+				uint32 t = i / 3;
+				std::uint64_t key = EdgeKey(indices[i], indices[t * 3 + (i + 1) % 3]);
+				size_t h = (size_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & (tableSize - 1);
+				while (edgeKeys[h] != key && edgeKeys[h] != UINT64_MAX)
+					h = (h + 1) & (tableSize - 1);
+				edgeKeys[h] = key;
+				edgeUse[h]++;
+				edgeSlot[i] = (uint32)h;
+			}
+
+			for (uint32 i = 0; i < (uint32)indices.size(); ++i)
+			{
+				if (edgeUse[edgeSlot[i]] != 2)
+				{
+					mLocked[indices[i]] = true;
+					mLocked[indices[i / 3 * 3 + (i + 1) % 3]] = true;
+				}
+			}
+		}
+
+		void BuildQuadrics()
+		{
+			mQuadrics.assign(mPositionCount, Quadric());
+			const std::vector<uint32>& indices = mIndices;
+			for (uint32 t = 0; t < mTriangleCount; ++t)
+			{
+				Float3 p0 = Position(indices[t * 3 + 0]);
+				Float3 p1 = Position(indices[t * 3 + 1]);
+				Float3 p2 = Position(indices[t * 3 + 2]);
+				Float3 n = Cross(Sub(p1, p0), Sub(p2, p0));
+				double length = std::sqrt((double)Dot(n, n));
+				if (length <= 0.0)
+					continue;
+
+				// Area weighted plane of the triangle.
+				double a = n.x / length, b = n.y / length, c = n.z / length;
+				double d = -(a * p0.x + b * p0.y + c * p0.z);
+				for (uint32 k = 0; k < 3; ++k)
+				{
+					// A faint pull towards the original position breaks ties on
+					// flat regions, where every plane error is zero.  Without it
+					// collapses keep landing on the same vertex and its fan grows
+					// without bound.
+					Float3 p = Position(indices[t * 3 + k]);
+					Quadric& q = mQuadrics[mPositionId[indices[t * 3 + k]]];
+					q.AddPlane(a, b, c, d, 0.5 * length);
+					q.AddPoint(p.x, p.y, p.z, 0.5 * length * PointWeight);
+				}
+			}
+		}
+
+		std::uint64_t EdgeKey(uint32 a, uint32 b) const
+		{
+			uint32 pa = mPositionId[a];
+			uint32 pb = mPositionId[b];
+			return pa < pb ? ((std::uint64_t)pa << 32) | pb : ((std::uint64_t)pb << 32) | pa;
+		}
+
+		const Float3& Position(uint32 v) const
+		{
+			return mPositions[v];
+		}
+
+		float CollapseCost(uint32 from, uint32 to) const
+		{
+			Float3 p = Position(to);
+			double error = mQuadrics[mPositionId[from]].Evaluate(p.x, p.y, p.z) + mQuadrics[mPositionId[to]].Evaluate(p.x, p.y, p.z);
+			return (float)std::max(0.0, error);
+		}
+
+		// Finds the cheapest valid collapse of v onto one of its neighbours and
+		// files it in the heap.  Any collapse that changes the triangles around
+		// v refreshes it, so the entry of v in the heap is always valid.
+		void UpdateBestCollapse(uint32 v)
+		{
+			if (mLocked[v] || mCollapsed[v])
+				return;
+
+			Collapse best = { 0.0f, UINT32_MAX };
+			const std::vector<uint32>& indices = mIndices;
+			mCandidates.clear();
+			for (uint32 a = mAdjacencyStart[v]; a < mAdjacencyStart[v] + mAdjacencyCount[v]; ++a)
+			{
+				// Movable vertices have a closed fan, so taking the vertex after
+				// v in each triangle visits every neighbour exactly once.
+				const uint32* tri = &indices[mAdjacency[a] * 3];
+				uint32 w = tri[0] == v ? tri[1] : tri[1] == v ? tri[2] : tri[0];
+				mCandidates.push_back({ CollapseCost(v, w), w });
+			}
+
+			// Validity is checked cheapest first, as it walks the whole fan.
+			while (!mCandidates.empty())
+			{
+				auto cheapest = std::min_element(mCandidates.begin(), mCandidates.end(),
+					[](const Collapse& a, const Collapse& b) { return a.Cost < b.Cost; });
+				if (IsValid(v, cheapest->To))
+				{
+					best.Cost = cheapest->Cost;
+					best.To = cheapest->To;
+					break;
+				}
+				*cheapest = mCandidates.back();
+				mCandidates.pop_back();
+			}
+
+			mBest[v] = best;
+			if (best.To == UINT32_MAX)
+				HeapRemove(v);
+			else if (mHeapPosition[v] == UINT32_MAX)
+				HeapInsert(v);
+			else
+				HeapUpdate(v);
+		}
+
+		// Binary min-heap of vertices keyed on the cost of their best collapse,
+		// with the position of every vertex tracked so its entry can be moved
+		// or removed.  The cost is duplicated in the entry so sifting stays
+		// within the heap array.
+		bool HeapLess(uint32 a, uint32 b) const
+		{
+			return mHeap[a].Cost < mHeap[b].Cost;
+		}
+
+		void HeapSwap(uint32 a, uint32 b)
+		{
+			std::swap(mHeap[a], mHeap[b]);
+			mHeapPosition[mHeap[a].Vertex] = a;
+			mHeapPosition[mHeap[b].Vertex] = b;
+		}
+
+		void SiftUp(uint32 i)
+		{
+			while (i > 0 && HeapLess(i, (i - 1) / 2))
+			{
+				HeapSwap(i, (i - 1) / 2);
+				i = (i - 1) / 2;
+			}
+		}
+
+		void SiftDown(uint32 i)
+		{
+			uint32 count = (uint32)mHeap.size();
+			for (;;)
+			{
+				uint32 smallest = i;
+				uint32 left = i * 2 + 1;
+				if (left < count && HeapLess(left, smallest))
+					smallest = left;
+				if (left + 1 < count && HeapLess(left + 1, smallest))
+					smallest = left + 1;
+				if (smallest == i)
+					return;
+				HeapSwap(i, smallest);
+				i = smallest;
+			}
+		}
+
+		void HeapInsert(uint32 v)
+		{
+			mHeapPosition[v] = (uint32)mHeap.size();
+			mHeap.push_back({ mBest[v].Cost, v });
+			SiftUp(mHeapPosition[v]);
+		}
+
+		void HeapUpdate(uint32 v)
+		{
+			mHeap[mHeapPosition[v]].Cost = mBest[v].Cost;
+			SiftUp(mHeapPosition[v]);
+			SiftDown(mHeapPosition[v]);
+		}
+
+		void HeapRemove(uint32 v)
+		{
+			uint32 i = mHeapPosition[v];
+			if (i == UINT32_MAX)
+				return;
+
+			HeapSwap(i, (uint32)mHeap.size() - 1);
+			mHeap.pop_back();
+			mHeapPosition[v] = UINT32_MAX;
+			if (i < mHeap.size())
+			{
+				SiftUp(i);
+				SiftDown(i);
+			}
+		}
+
+		// Rejects collapses that flip or degenerate a remaining triangle.
+		bool IsValid(uint32 from, uint32 to)
+		{
+			const std::vector<uint32>& indices = mIndices;
+			Float3 target = Position(to);
+			for (uint32 a = mAdjacencyStart[from]; a < mAdjacencyStart[from] + mAdjacencyCount[from]; ++a)
+			{
+				const uint32* v = &indices[mAdjacency[a] * 3];
+				if (v[0] == to || v[1] == to || v[2] == to)
+					continue; // removed by the collapse
+
+				Float3 p[3] = { Position(v[0]), Position(v[1]), Position(v[2]) };
+				Float3 before = Cross(Sub(p[1], p[0]), Sub(p[2], p[0]));
+				for (uint32 k = 0; k < 3; ++k)
+				{
+					if (v[k] == from)
+						p[k] = target;
+				}
+				Float3 after = Cross(Sub(p[1], p[0]), Sub(p[2], p[0]));
+				if (Dot(before, after) <= 0.0f)
+					return false;
+			}
+			return true;
+		}
+
+		// Moves from onto to.  Returns the number of triangles removed.
+		uint32 Apply(uint32 from, uint32 to)
+		{
+			std::vector<uint32>& indices = mIndices;
+			uint32 removed = 0;
+
+			// The new triangle list of to is appended to mAdjacency: the live
+			// triangles of to that survive, then those of from, rewired.
+			uint32 start = (uint32)mAdjacency.size();
+			for (uint32 a = mAdjacencyStart[to]; a < mAdjacencyStart[to] + mAdjacencyCount[to]; ++a)
+			{
+				uint32 t = mAdjacency[a];
+				uint32* v = &indices[t * 3];
+				if (v[0] == from || v[1] == from || v[2] == from)
+					continue;
+				mAdjacency.push_back(t);
+			}
+			for (uint32 a = mAdjacencyStart[from]; a < mAdjacencyStart[from] + mAdjacencyCount[from]; ++a)
+			{
+				uint32 t = mAdjacency[a];
+				uint32* v = &indices[t * 3];
+				if (v[0] == to || v[1] == to || v[2] == to)
+				{
+					mTriangleAlive[t] = false;
+					removed++;
+					for (uint32 k = 0; k < 3; ++k)
+					{
+						if (v[k] != from && v[k] != to)
+							RemoveTriangle(v[k], t);
+					}
+					continue;
+				}
+
+				for (uint32 k = 0; k < 3; ++k)
+				{
+					if (v[k] == from)
+						v[k] = to;
+				}
+				mAdjacency.push_back(t);
+			}
+			mAdjacencyStart[to] = start;
+			mAdjacencyCount[to] = (uint32)mAdjacency.size() - start;
+			mAdjacencyCount[from] = 0;
+
+			mCollapsed[from] = true;
+			HeapRemove(from);
+			mQuadrics[mPositionId[to]].Add(mQuadrics[mPositionId[from]]);
+
+			// Costs around to changed: refresh to and its neighbours.
+			mNeighbours.clear();
+			mNeighbours.push_back(to);
+			for (uint32 a = mAdjacencyStart[to]; a < mAdjacencyStart[to] + mAdjacencyCount[to]; ++a)
+			{
+				const uint32* v = &indices[mAdjacency[a] * 3];
+				mNeighbours.insert(mNeighbours.end(), v, v + 3);
+			}
+			std::sort(mNeighbours.begin(), mNeighbours.end());
+			mNeighbours.erase(std::unique(mNeighbours.begin(), mNeighbours.end()), mNeighbours.end());
+			for (uint32 w : mNeighbours)
+				UpdateBestCollapse(w);
+
+			return removed;
+		}
+
+		void RemoveTriangle(uint32 v, uint32 t)
+		{
+			uint32 begin = mAdjacencyStart[v];
+			uint32 end = begin + mAdjacencyCount[v];
+			for (uint32 a = begin; a < end; ++a)
+			{
+				if (mAdjacency[a] == t)
+				{
+					mAdjacency[a] = mAdjacency[end - 1];
+					mAdjacencyCount[v]--;
+					return;
+				}
+			}
+		}
+
+		// Rebuilds the index list from the live triangles.
+		void Compact()
+		{
+			uint32 out = 0;
+			for (uint32 t = 0; t < mTriangleCount; ++t)
+			{
+				if (!mTriangleAlive[t])
+					continue;
+				for (uint32 k = 0; k < 3; ++k)
+					mIndices[out++] = mIndices[t * 3 + k];
+			}
+			mIndices.resize(out);
+		}
+
+		const DirectX::XMFLOAT3& SourcePosition(uint32 v) const
+		{
+			return *reinterpret_cast<const DirectX::XMFLOAT3*>(mSourcePositions + v * mSourceStride);
+		}
+
+		std::vector<uint32>& mIndices;
+		const unsigned char* mSourcePositions;
+		size_t mSourceStride;
+		uint32 mVertexCount;
+		uint32 mTriangleCount;
+		uint32 mPositionCount = 0;
+
+		// Positions are copied out of the vertices to keep the hot loop
+		// away from the other attributes.
+		std::vector<Float3> mPositions;
+		std::vector<uint32> mPositionId;
+		std::vector<bool> mLocked;
+		std::vector<Quadric> mQuadrics;
+
+		// Live triangles of vertex v are mAdjacency[mAdjacencyStart[v]] and the
+		// mAdjacencyCount[v] - 1 entries after it.  A collapse appends the
+		// merged list of the target rather than growing it in place.
+		std::vector<uint32> mAdjacencyStart;
+		std::vector<uint32> mAdjacencyCount;
+		std::vector<uint32> mAdjacency;
+		std::vector<bool> mTriangleAlive;
+
+		std::vector<bool> mCollapsed;
+
+		// Cheapest collapse of every movable vertex, and a heap of those vertices.
+		std::vector<Collapse> mBest;
+		std::vector<HeapEntry> mHeap;
+		std::vector<uint32> mHeapPosition;
+
+		std::vector<Collapse> mCandidates;
+		std::vector<uint32> mNeighbours;
+	};
+}
+
+MeshSimplifier::Result MeshSimplifier::SimplifyIndices(std::vector<uint32>& indices, const DirectX::XMFLOAT3* positions, size_t positionStride,
+	uint32 vertexCount, uint32 targetTriangleCount, float maxError)
+{
+	Simplifier simplifier(indices, positions, positionStride, vertexCount);
+	return simplifier.Run(targetTriangleCount, maxError);
+}
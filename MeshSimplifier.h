@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "CreateGeometry.h"
+
+// Edge collapse simplifier driven by quadric error metrics (Garland and
+// Heckbert, "Surface Simplification Using Quadric Error Metrics").
+//
+// Every collapse moves a vertex onto one of its neighbours (half-edge
+// collapse), so surviving vertices keep their own normal, tangent and UV
+// and no attribute has to be interpolated.  The cost of moving v onto u is
+// the sum of the quadrics of both positions evaluated at u.  Each vertex
+// keeps its cheapest collapse in an indexed binary heap that is updated in
+// place when its neighbourhood changes, and adjacency lives in flat arrays,
+// so a run is O(n log n).
+//
+// Vertices on a UV or normal seam (several vertices sharing a position), on
+// an open border or on a non-manifold edge are locked: others may collapse
+// onto them but they never move, which keeps seams and borders intact.
+// Collapses that would flip a triangle are rejected.
+class MeshSimplifier
+{
+public:
+	using uint32 = std::uint32_t;
+
+	struct Result
+	{
+		uint32 TriangleCount = 0;
+		// Largest quadric error accepted, in squared distance units.
+		float Error = 0.0f;
+	};
+
+	// Collapses edges until the mesh has at most targetTriangleCount triangles
+	// or the next collapse would cost more than maxError.  Unused vertices are
+	// removed, the rest keep their relative order, and Bounds is recomputed.
+	// Works on any vertex format; only Position is read.
+	template<typename Format>
+	static Result							Simplify(CreateGeometry::BasicMeshData<Format>& meshData, uint32 targetTriangleCount, float maxError)
+	{
+		if (meshData.Vertices.empty())
+			return Result();
+
+		Result result = SimplifyIndices(meshData.Indices32, &meshData.Vertices[0].Position, sizeof(typename Format::Vertex),
+			(uint32)meshData.Vertices.size(), targetTriangleCount, maxError);
+
+		// Drop the collapsed vertices.
+		std::vector<uint32> remap(meshData.Vertices.size(), UINT32_MAX);
+		for (uint32 index : meshData.Indices32)
+			remap[index] = 0;
+
+		uint32 next = 0;
+		for (uint32 v = 0; v < (uint32)meshData.Vertices.size(); ++v)
+		{
+			if (remap[v] == UINT32_MAX)
+				continue;
+			remap[v] = next;
+			meshData.Vertices[next++] = meshData.Vertices[v];
+		}
+		meshData.Vertices.resize(next);
+
+		for (uint32& index : meshData.Indices32)
+			index = remap[index];
+
+		CreateGeometry::ComputeBounds(meshData);
+		return result;
+	}
+
+	// Same on a bare index list; positions are read with a stride of
+	// positionStride bytes.  Indices keep referring to the input vertices.
+	static Result							SimplifyIndices(std::vector<uint32>& indices, const DirectX::XMFLOAT3* positions, size_t positionStride,
+												uint32 vertexCount, uint32 targetTriangleCount, float maxError);
+};
@@ -0,0 +1,549 @@
+#include "ObjImporter.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <map>
+
+using namespace DirectX;
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	// Group and material of a chunk run that are not set in the chunk itself
+	// and carry over from the previous chunk.
+	const uint32 Inherited = UINT32_MAX;
+
+	// Faces from FirstFace up to the next run share a group and a material,
+	// both chunk-local name ids.
+	struct Run
+	{
+		uint32 Group;
+		uint32 Material;
+		uint32 FirstFace;
+		uint32 FirstCorner;
+		uint32 FirstTriangle;
+	};
+
+	// A face corner that uses a negative index, with the number of elements
+	// the chunk had parsed when the face was read.
+	struct Fixup
+	{
+		uint32 Corner;
+		uint32 PositionCount;
+		uint32 TexCoordCount;
+		uint32 NormalCount;
+	};
+
+	struct Chunk
+	{
+		const char* Begin = nullptr;
+		const char* End = nullptr;
+
+		std::vector<XMFLOAT3> Positions;
+		std::vector<XMFLOAT2> TexCoords;
+		std::vector<XMFLOAT3> Normals;
+		// Three raw OBJ indices per face corner, 0 when absent.  Faces are
+		// triangulated when the indices are scattered.
+		std::vector<std::int32_t> Corners;
+		std::vector<uint32> FaceSizes;
+		uint32 TriangleCount = 0;
+		std::vector<Fixup> Fixups;
+		std::vector<Run> Runs;
+		std::vector<std::string> Names;
+		std::vector<std::string> MaterialLibraries;
+		uint32 SkippedLines = 0;
+
+		// Filled by the dedup pass.
+		uint32 PositionBase = 0;
+		uint32 TexCoordBase = 0;
+		uint32 NormalBase = 0;
+		std::vector<uint32> LocalIndices;
+		std::vector<uint32> LocalVertices;
+		std::vector<uint32> Remap;
+		// Global submesh and destination of every run.
+		std::vector<uint32> RunSubmesh;
+		std::vector<uint32> RunStartIndex;
+		bool Valid = true;
+	};
+
+	bool IsBlank(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	const char* SkipBlanks(const char* p, const char* end)
+	{
+		while (p < end && IsBlank(*p))
+			p++;
+		return p;
+	}
+
+	// std::from_chars rejects a leading '+', which some exporters write.
+	const char* ParseFloat(const char* p, const char* end, float& value)
+	{
+		p = SkipBlanks(p, end);
+		if (p < end && *p == '+')
+			p++;
+		std::from_chars_result result = std::from_chars(p, end, value);
+		return result.ec == std::errc() ? result.ptr : nullptr;
+	}
+
+	// Text up to the end of the line, without surrounding blanks.
+	std::string ParseName(const char* p, const char* end)
+	{
+		p = SkipBlanks(p, end);
+		while (end > p && IsBlank(end[-1]))
+			end--;
+		return std::string(p, end);
+	}
+
+	template<std::size_t N>
+	bool Matches(const char* p, const char* end, const char (&keyword)[N])
+	{
+		const std::size_t length = N - 1;
+		return (std::size_t)(end - p) > length && std::memcmp(p, keyword, length) == 0 && IsBlank(p[length]);
+	}
+
+	uint32 AddName(Chunk& chunk, std::string name)
+	{
+		chunk.Names.push_back(std::move(name));
+		return (uint32)chunk.Names.size() - 1;
+	}
+
+	// Starts a new run unless the current one has no triangle yet, in which
+	// case it is updated in place.
+	Run& BeginRun(Chunk& chunk)
+	{
+		uint32 faces = (uint32)chunk.FaceSizes.size();
+		if (chunk.Runs.back().FirstFace != faces)
+		{
+			Run run = chunk.Runs.back();
+			run.FirstFace = faces;
+			run.FirstCorner = (uint32)(chunk.Corners.size() / 3);
+			run.FirstTriangle = chunk.TriangleCount;
+			chunk.Runs.push_back(run);
+		}
+		return chunk.Runs.back();
+	}
+
+	// Parses "v", "v/t", "v//n" or "v/t/n".  Returns nullptr on error.
+	const char* ParseCorner(const char* p, const char* end, std::int32_t corner[3])
+	{
+		corner[0] = corner[1] = corner[2] = 0;
+		for (int i = 0; i < 3; i++)
+		{
+			if (p < end && *p != '/')
+			{
+				std::from_chars_result result = std::from_chars(p, end, corner[i]);
+				if (result.ec != std::errc() || corner[i] == 0)
+					return nullptr;
+				p = result.ptr;
+			}
+			else if (i == 0)
+				return nullptr;
+
+			if (i == 2 || p >= end || *p != '/')
+				break;
+			p++;
+		}
+		return p;
+	}
+
+	bool ParseFace(Chunk& chunk, const char* p, const char* end)
+	{
+		std::size_t faceStart = chunk.Corners.size();
+		bool relative = false;
+		for (;;)
+		{
+			p = SkipBlanks(p, end);
+			if (p >= end)
+				break;
+
+			std::int32_t corner[3];
+			p = ParseCorner(p, end, corner);
+			if (p == nullptr || (p < end && !IsBlank(*p)))
+			{
+				chunk.Corners.resize(faceStart);
+				return false;
+			}
+			relative |= corner[0] < 0 || corner[1] < 0 || corner[2] < 0;
+			chunk.Corners.insert(chunk.Corners.end(), corner, corner + 3);
+		}
+
+		uint32 size = (uint32)(chunk.Corners.size() - faceStart) / 3;
+		if (size < 3)
+		{
+			chunk.Corners.resize(faceStart);
+			return false;
+		}
+		chunk.FaceSizes.push_back(size);
+		chunk.TriangleCount += size - 2;
+
+		if (relative)
+		{
+			for (std::size_t c = faceStart / 3; c < chunk.Corners.size() / 3; c++)
+				chunk.Fixups.push_back({ (uint32)c, (uint32)chunk.Positions.size(), (uint32)chunk.TexCoords.size(), (uint32)chunk.Normals.size() });
+		}
+		return true;
+	}
+
+	bool ParseLine(Chunk& chunk, const char* p, const char* end)
+	{
+		p = SkipBlanks(p, end);
+		if (p >= end || *p == '#')
+			return true;
+
+		switch (*p)
+		{
+		case 'v':
+			if (Matches(p, end, "v"))
+			{
+				XMFLOAT3 v;
+				if ((p = ParseFloat(p + 1, end, v.x)) == nullptr ||
+					(p = ParseFloat(p, end, v.y)) == nullptr ||
+					(p = ParseFloat(p, end, v.z)) == nullptr)
+					return false;
+				chunk.Positions.push_back(v);
+			}
+			else if (Matches(p, end, "vt"))
+			{
+				XMFLOAT2 t(0.0f, 0.0f);
+				if ((p = ParseFloat(p + 2, end, t.x)) == nullptr)
+					return false;
+				// The v coordinate is optional for 1D textures.
+				if (SkipBlanks(p, end) < end)
+					p = ParseFloat(p, end, t.y);
+				if (p == nullptr)
+					return false;
+				chunk.TexCoords.push_back(t);
+			}
+			else if (Matches(p, end, "vn"))
+			{
+				XMFLOAT3 n;
+				if ((p = ParseFloat(p + 2, end, n.x)) == nullptr ||
+					(p = ParseFloat(p, end, n.y)) == nullptr ||
+					(p = ParseFloat(p, end, n.z)) == nullptr)
+					return false;
+				chunk.Normals.push_back(n);
+			}
+			break;
+		case 'f':
+			if (Matches(p, end, "f"))
+				return ParseFace(chunk, p + 1, end);
+			break;
+		case 'g':
+		case 'o':
+			if (Matches(p, end, "g") || Matches(p, end, "o"))
+				BeginRun(chunk).Group = AddName(chunk, ParseName(p + 1, end));
+			break;
+		case 'u':
+			if (Matches(p, end, "usemtl"))
+				BeginRun(chunk).Material = AddName(chunk, ParseName(p + 6, end));
+			break;
+		case 'm':
+			if (Matches(p, end, "mtllib"))
+				chunk.MaterialLibraries.push_back(ParseName(p + 6, end));
+			break;
+		}
+		return true;
+	}
+
+	void ParseChunk(Chunk& chunk)
+	{
+		// Rough guess of the share of each statement in a typical file, to
+		// avoid most of the regrowth.
+		std::size_t lines = (std::size_t)(chunk.End - chunk.Begin) / 32;
+		chunk.Positions.reserve(lines / 3);
+		chunk.Corners.reserve(lines * 3);
+		chunk.Runs.push_back({ Inherited, Inherited, 0, 0, 0 });
+
+		const char* p = chunk.Begin;
+		while (p < chunk.End)
+		{
+			const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', chunk.End - p));
+			if (lineEnd == nullptr)
+				lineEnd = chunk.End;
+			if (!ParseLine(chunk, p, lineEnd))
+				chunk.SkippedLines++;
+			p = lineEnd + 1;
+		}
+	}
+
+	// Resolves a raw OBJ index: 1-based from the start of the file, or
+	// negative from the last element read before the face.
+	uint32 ResolveIndex(std::int32_t index, uint32 base, uint32 countBeforeFace, uint32 total, bool& valid)
+	{
+		if (index == 0)
+			return ObjImporter::None;
+		std::int64_t resolved = index > 0 ? (std::int64_t)index - 1 : (std::int64_t)base + countBeforeFace + index;
+		if (resolved < 0 || resolved >= total)
+		{
+			valid = false;
+			return 0;
+		}
+		return (uint32)resolved;
+	}
+
+	// Chained hash table of vertices keyed by their position/uv/normal
+	// tuple, three uint32 per vertex in an external array.  The bucket is the
+	// position index modulo the table size: faces reference positions in
+	// roughly file order, so consecutive lookups land in neighbouring buckets
+	// and the table stays in cache.  Tuples that share a position (seams)
+	// share a chain.
+	class VertexTable
+	{
+	public:
+		explicit VertexTable(std::size_t expectedCount)
+		{
+			std::size_t size = 16;
+			while (size < expectedCount)
+				size *= 2;
+			mHeads.assign(size, UINT32_MAX);
+			mNext.reserve(expectedCount);
+			mMask = (uint32)(size - 1);
+		}
+
+		// Returns the id of tuple, appending it to tuples when it is new.
+		uint32 FindOrAdd(std::vector<uint32>& tuples, const uint32* tuple)
+		{
+			uint32& head = mHeads[tuple[0] & mMask];
+			for (uint32 id = head; id != UINT32_MAX; id = mNext[id])
+			{
+				const uint32* other = &tuples[3 * (std::size_t)id];
+				if (other[0] == tuple[0] && other[1] == tuple[1] && other[2] == tuple[2])
+					return id;
+			}
+
+			uint32 id = (uint32)mNext.size();
+			tuples.insert(tuples.end(), tuple, tuple + 3);
+			mNext.push_back(head);
+			head = id;
+			return id;
+		}
+
+	private:
+		std::vector<uint32> mHeads;
+		std::vector<uint32> mNext;
+		uint32 mMask;
+	};
+
+	// Resolves the corners of a chunk and dedups them locally.  LocalVertices
+	// holds three global attribute indices per local vertex.
+	void DedupChunk(Chunk& chunk, uint32 positionCount, uint32 texCoordCount, uint32 normalCount)
+	{
+		std::size_t cornerCount = chunk.Corners.size() / 3;
+		VertexTable table(cornerCount / 2);
+		chunk.LocalIndices.resize(cornerCount);
+		chunk.LocalVertices.clear();
+		chunk.LocalVertices.reserve(cornerCount);
+
+		std::size_t nextFixup = 0;
+		for (std::size_t c = 0; c < cornerCount; c++)
+		{
+			const std::int32_t* raw = &chunk.Corners[3 * c];
+			uint32 counts[3] = {};
+			if (nextFixup < chunk.Fixups.size() && chunk.Fixups[nextFixup].Corner == c)
+			{
+				const Fixup& fixup = chunk.Fixups[nextFixup++];
+				counts[0] = fixup.PositionCount;
+				counts[1] = fixup.TexCoordCount;
+				counts[2] = fixup.NormalCount;
+			}
+
+			uint32 tuple[3];
+			tuple[0] = ResolveIndex(raw[0], chunk.PositionBase, counts[0], positionCount, chunk.Valid);
+			tuple[1] = ResolveIndex(raw[1], chunk.TexCoordBase, counts[1], texCoordCount, chunk.Valid);
+			tuple[2] = ResolveIndex(raw[2], chunk.NormalBase, counts[2], normalCount, chunk.Valid);
+			chunk.LocalIndices[c] = table.FindOrAdd(chunk.LocalVertices, tuple);
+		}
+		chunk.Corners = std::vector<std::int32_t>();
+	}
+}
+
+bool ObjImporter::Parse(const char* text, std::size_t size, ThreadPool& pool, IndexedObj& obj, Stats& stats)
+{
+	auto parseStart = std::chrono::steady_clock::now();
+
+	// Chunks end right after a newline, so no line spans two of them.
+	uint32 threadCount = pool.GetWorkerCount() + 1;
+	std::size_t chunkCount = std::max<std::size_t>(1, std::min<std::size_t>(size / MinChunkBytes, 4 * threadCount));
+	std::vector<Chunk> chunks(chunkCount);
+	const char* end = text + size;
+	const char* begin = text;
+	for (std::size_t i = 0; i < chunkCount; i++)
+	{
+		const char* chunkEnd = end;
+		if (i + 1 < chunkCount)
+		{
+			chunkEnd = std::max(begin, text + size / chunkCount * (i + 1));
+			const char* newline = static_cast<const char*>(std::memchr(chunkEnd, '\n', end - chunkEnd));
+			chunkEnd = newline != nullptr ? newline + 1 : end;
+		}
+		chunks[i].Begin = begin;
+		chunks[i].End = chunkEnd;
+		begin = chunkEnd;
+	}
+
+	TaskGroup tasks;
+	for (Chunk& chunk : chunks)
+		pool.Submit(tasks, [&chunk] { ParseChunk(chunk); });
+	pool.Wait(tasks);
+	auto dedupStart = std::chrono::steady_clock::now();
+
+	// Attribute offsets of every chunk, and the groups and materials that
+	// carry over from one chunk to the next.  Submeshes are numbered in order
+	// of first appearance of their group/material pair.
+	uint32 positionCount = 0;
+	uint32 texCoordCount = 0;
+	uint32 normalCount = 0;
+	uint32 triangleCount = 0;
+	std::string group = "default";
+	std::string material;
+	std::map<std::pair<std::string, std::string>, uint32> submeshIds;
+	std::vector<uint32> submeshTriangles;
+	for (Chunk& chunk : chunks)
+	{
+		chunk.PositionBase = positionCount;
+		chunk.TexCoordBase = texCoordCount;
+		chunk.NormalBase = normalCount;
+		positionCount += (uint32)chunk.Positions.size();
+		texCoordCount += (uint32)chunk.TexCoords.size();
+		normalCount += (uint32)chunk.Normals.size();
+		stats.SkippedLines += chunk.SkippedLines;
+		obj.MaterialLibraries.insert(obj.MaterialLibraries.end(), chunk.MaterialLibraries.begin(), chunk.MaterialLibraries.end());
+
+		uint32 chunkTriangles = chunk.TriangleCount;
+		chunk.RunSubmesh.resize(chunk.Runs.size());
+		chunk.RunStartIndex.resize(chunk.Runs.size());
+		for (std::size_t r = 0; r < chunk.Runs.size(); r++)
+		{
+			const Run& run = chunk.Runs[r];
+			if (run.Group != Inherited)
+				group = chunk.Names[run.Group];
+			if (run.Material != Inherited)
+				material = chunk.Names[run.Material];
+
+			uint32 runEnd = r + 1 < chunk.Runs.size() ? chunk.Runs[r + 1].FirstTriangle : chunkTriangles;
+			uint32 runTriangles = runEnd - run.FirstTriangle;
+			if (runTriangles == 0)
+				continue;
+
+			auto inserted = submeshIds.emplace(std::make_pair(group, material), (uint32)submeshTriangles.size());
+			if (inserted.second)
+			{
+				ObjSubmesh submesh;
+				submesh.Group = group;
+				submesh.Material = material;
+				obj.Submeshes.push_back(submesh);
+				submeshTriangles.push_back(0);
+			}
+
+			// Destination relative to the submesh for now.
+			uint32 submesh = inserted.first->second;
+			chunk.RunSubmesh[r] = submesh;
+			chunk.RunStartIndex[r] = 3 * submeshTriangles[submesh];
+			submeshTriangles[submesh] += runTriangles;
+		}
+		triangleCount += chunkTriangles;
+	}
+
+	uint32 startIndex = 0;
+	for (std::size_t s = 0; s < obj.Submeshes.size(); s++)
+	{
+		obj.Submeshes[s].StartIndexLocation = startIndex;
+		obj.Submeshes[s].IndexCount = 3 * submeshTriangles[s];
+		startIndex += obj.Submeshes[s].IndexCount;
+	}
+
+	// Gather the attributes and dedup every chunk locally.
+	obj.Positions.resize(positionCount);
+	obj.TexCoords.resize(texCoordCount);
+	obj.Normals.resize(normalCount);
+	for (Chunk& chunk : chunks)
+	{
+		pool.Submit(tasks, [&chunk, &obj, positionCount, texCoordCount, normalCount]
+		{
+			std::copy(chunk.Positions.begin(), chunk.Positions.end(), obj.Positions.begin() + chunk.PositionBase);
+			std::copy(chunk.TexCoords.begin(), chunk.TexCoords.end(), obj.TexCoords.begin() + chunk.TexCoordBase);
+			std::copy(chunk.Normals.begin(), chunk.Normals.end(), obj.Normals.begin() + chunk.NormalBase);
+			chunk.Positions = std::vector<XMFLOAT3>();
+			chunk.TexCoords = std::vector<XMFLOAT2>();
+			chunk.Normals = std::vector<XMFLOAT3>();
+			DedupChunk(chunk, positionCount, texCoordCount, normalCount);
+		});
+	}
+	pool.Wait(tasks);
+
+	for (const Chunk& chunk : chunks)
+	{
+		if (!chunk.Valid)
+			return false;
+	}
+
+	// Merge the chunk vertices into the global table, in chunk order.
+	std::size_t localVertexCount = 0;
+	for (const Chunk& chunk : chunks)
+		localVertexCount += chunk.LocalVertices.size() / 3;
+	std::vector<uint32> tuples;
+	tuples.reserve(3 * localVertexCount);
+	VertexTable table(localVertexCount);
+	for (Chunk& chunk : chunks)
+	{
+		uint32 chunkVertexCount = (uint32)chunk.LocalVertices.size() / 3;
+		chunk.Remap.resize(chunkVertexCount);
+		for (uint32 v = 0; v < chunkVertexCount; v++)
+			chunk.Remap[v] = table.FindOrAdd(tuples, &chunk.LocalVertices[3 * v]);
+		chunk.LocalVertices = std::vector<uint32>();
+	}
+
+	obj.Vertices.resize(tuples.size() / 3);
+	std::memcpy(obj.Vertices.data(), tuples.data(), tuples.size() * sizeof(uint32));
+
+	// Remap and scatter the indices of every run to its submesh range.
+	obj.Indices.resize(3 * (std::size_t)triangleCount);
+	for (Chunk& chunk : chunks)
+	{
+		pool.Submit(tasks, [&chunk, &obj]
+		{
+			// Fan triangulation: corners 0, i - 1, i for every i >= 2.
+			const uint32* corners = chunk.LocalIndices.data();
+			for (std::size_t r = 0; r < chunk.Runs.size(); r++)
+			{
+				const Run& run = chunk.Runs[r];
+				uint32 lastFace = r + 1 < chunk.Runs.size() ? chunk.Runs[r + 1].FirstFace : (uint32)chunk.FaceSizes.size();
+				if (run.FirstFace == lastFace)
+					continue;
+
+				uint32* dst = &obj.Indices[obj.Submeshes[chunk.RunSubmesh[r]].StartIndexLocation + chunk.RunStartIndex[r]];
+				const uint32* face = corners + run.FirstCorner;
+				for (uint32 f = run.FirstFace; f < lastFace; f++)
+				{
+					uint32 size = chunk.FaceSizes[f];
+					uint32 first = chunk.Remap[face[0]];
+					uint32 previous = chunk.Remap[face[1]];
+					for (uint32 i = 2; i < size; i++)
+					{
+						uint32 current = chunk.Remap[face[i]];
+						*dst++ = first;
+						*dst++ = previous;
+						*dst++ = current;
+						previous = current;
+					}
+					face += size;
+				}
+			}
+		});
+	}
+	pool.Wait(tasks);
+
+	auto parseEnd = std::chrono::steady_clock::now();
+	stats.Bytes = size;
+	stats.Chunks = (uint32)chunkCount;
+	stats.Triangles = triangleCount;
+	stats.Vertices = (uint32)obj.Vertices.size();
+	stats.ParseMilliseconds = std::chrono::duration<double, std::milli>(dedupStart - parseStart).count();
+	stats.DedupMilliseconds = std::chrono::duration<double, std::milli>(parseEnd - dedupStart).count();
+	return true;
+}
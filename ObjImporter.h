@@ -0,0 +1,147 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <DirectXMath.h>
+#include "CreateGeometry.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+// Triangles of one group/material pair of an OBJ file, contiguous in the
+// index buffer.  Faces of the pair are gathered here in file order even when
+// the pair appears several times in the file.
+struct ObjSubmesh
+{
+	std::string Group;
+	std::string Material;
+	std::uint32_t StartIndexLocation = 0;
+	std::uint32_t IndexCount = 0;
+};
+
+template<typename Format>
+struct ObjModel
+{
+	CreateGeometry::BasicMeshData<Format> Mesh;
+	std::vector<ObjSubmesh> Submeshes;
+	// Names of the mtllib files, in order of appearance.
+	std::vector<std::string> MaterialLibraries;
+};
+
+// Wavefront OBJ importer.  The file is memory-mapped and cut into
+// line-aligned chunks that are parsed in parallel on a ThreadPool:
+//  1. Every chunk parses its v/vt/vn lines into local arrays and its faces
+//     into fan-triangulated corners, with std::from_chars.
+//  2. Chunk counts are prefix-summed into global attribute offsets, which
+//     resolve relative (negative) indices and runs of faces without a group
+//     or material of their own.
+//  3. Every chunk dedups its position/uv/normal tuples in a local hash
+//     table; the chunk vertices are then merged into one global table in
+//     chunk order, so the output is the same whatever the thread count.
+//  4. Chunk indices are remapped to global vertices and scattered to their
+//     submesh ranges in parallel.
+//
+// Supported: v, vt, vn, f (any polygon, any of the v, v/t, v//n, v/t/n
+// forms, negative indices), g, o, usemtl and mtllib.  Other statements are
+// ignored.  Texture v is flipped, OBJ putting v = 0 at the bottom of the
+// image and Direct3D at the top.  Missing normals and texture coordinates
+// are zero; tangents are not computed.
+class ObjImporter
+{
+public:
+	using uint32 = std::uint32_t;
+
+	struct Stats
+	{
+		std::size_t Bytes = 0;
+		uint32 Chunks = 0;
+		uint32 Triangles = 0;
+		uint32 Vertices = 0;
+		// Statements that could not be parsed and were skipped.
+		uint32 SkippedLines = 0;
+		// Parallel parse of the chunks.
+		double ParseMilliseconds = 0.0;
+		// Index resolution, local and global dedup, index scatter.
+		double DedupMilliseconds = 0.0;
+		// Everything, conversion to the vertex format included.
+		double TotalMilliseconds = 0.0;
+	};
+
+	// Returns false if the file can not be mapped or a face references an
+	// element that does not exist.
+	template<typename Format = CreateGeometry::DefaultFormat>
+	static bool								Load(const char* path, ThreadPool& pool, ObjModel<Format>& model, const Format& format = Format(), Stats* stats = nullptr);
+	template<typename Format = CreateGeometry::DefaultFormat>
+	static bool								LoadFromMemory(const char* text, std::size_t size, ThreadPool& pool, ObjModel<Format>& model, const Format& format = Format(), Stats* stats = nullptr);
+
+	// Smallest chunk handed to a task.
+	static constexpr std::size_t			MinChunkBytes = 1u << 20;
+	// Value of Tuple::TexCoord and Tuple::Normal when the face has none.
+	static constexpr uint32					None = UINT32_MAX;
+
+private:
+	// One output vertex: indices into the attribute arrays.
+	struct Tuple
+	{
+		uint32 Position;
+		uint32 TexCoord;
+		uint32 Normal;
+	};
+
+	// Format-independent result of Parse.
+	struct IndexedObj
+	{
+		std::vector<DirectX::XMFLOAT3> Positions;
+		std::vector<DirectX::XMFLOAT2> TexCoords;
+		std::vector<DirectX::XMFLOAT3> Normals;
+		std::vector<Tuple> Vertices;
+		std::vector<uint32> Indices;
+		std::vector<ObjSubmesh> Submeshes;
+		std::vector<std::string> MaterialLibraries;
+	};
+
+	static bool								Parse(const char* text, std::size_t size, ThreadPool& pool, IndexedObj& obj, Stats& stats);
+};
+
+template<typename Format>
+bool ObjImporter::Load(const char* path, ThreadPool& pool, ObjModel<Format>& model, const Format& format, Stats* stats)
+{
+	MappedFile file;
+	if (!file.Open(path))
+		return false;
+	return LoadFromMemory(reinterpret_cast<const char*>(file.Data()), file.Size(), pool, model, format, stats);
+}
+
+template<typename Format>
+bool ObjImporter::LoadFromMemory(const char* text, std::size_t size, ThreadPool& pool, ObjModel<Format>& model, const Format& format, Stats* stats)
+{
+	auto loadStart = std::chrono::steady_clock::now();
+	Stats localStats;
+	IndexedObj obj;
+	if (!Parse(text, size, pool, obj, localStats))
+		return false;
+
+	const DirectX::XMFLOAT3 zero3(0.0f, 0.0f, 0.0f);
+	const DirectX::XMFLOAT2 zero2(0.0f, 0.0f);
+	model.Mesh.Vertices.resize(obj.Vertices.size());
+	for (std::size_t i = 0; i < obj.Vertices.size(); i++)
+	{
+		const Tuple& tuple = obj.Vertices[i];
+		DirectX::XMFLOAT2 uv = zero2;
+		if (tuple.TexCoord != None)
+			uv = DirectX::XMFLOAT2(obj.TexCoords[tuple.TexCoord].x, 1.0f - obj.TexCoords[tuple.TexCoord].y);
+		model.Mesh.Vertices[i] = format.Make(obj.Positions[tuple.Position],
+			tuple.Normal != None ? obj.Normals[tuple.Normal] : zero3, zero3, uv);
+	}
+	model.Mesh.Indices32 = std::move(obj.Indices);
+	model.Submeshes = std::move(obj.Submeshes);
+	model.MaterialLibraries = std::move(obj.MaterialLibraries);
+	CreateGeometry::ComputeBounds(model.Mesh);
+
+	if (stats != nullptr)
+	{
+		*stats = localStats;
+		stats->TotalMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+	}
+	return true;
+}
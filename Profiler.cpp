@@ -0,0 +1,133 @@
+#include "Profiler.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+namespace
+{
+	std::int64_t SteadyNanoseconds()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	static_assert((Profiler::ThreadCapacity & (Profiler::ThreadCapacity - 1)) == 0, "the thread capacity must be a power of two");
+	static_assert((Profiler::CaptureCapacity & (Profiler::CaptureCapacity - 1)) == 0, "the capture capacity must be a power of two");
+
+	// Names are literals in practice, but a quote or a backslash would break the file.
+	void WriteJsonString(std::ofstream& fout, const char* text)
+	{
+		fout << '"';
+		for (const char* c = text; *c != 0; c++)
+		{
+			if (*c == '"' || *c == '\\')
+				fout << '\\';
+			if ((unsigned char)*c >= 0x20)
+				fout << *c;
+		}
+		fout << '"';
+	}
+}
+
+std::mutex Profiler::sLock;
+std::vector<std::unique_ptr<Profiler::ThreadBuffer>> Profiler::sThreads;
+std::vector<Profiler::CapturedEvent> Profiler::sCapture;
+Profiler::uint64 Profiler::sCaptureNext = 0;
+const Profiler::uint64 Profiler::sStartTicks = Profiler::Now();
+const std::int64_t Profiler::sStartNanoseconds = SteadyNanoseconds();
+
+Profiler::ThreadBuffer* Profiler::RegisterThread()
+{
+	auto buffer = std::make_unique<ThreadBuffer>();
+	buffer->Events = std::make_unique<Event[]>(ThreadCapacity);
+
+	std::lock_guard<std::mutex> lock(sLock);
+	buffer->Index = (uint32)sThreads.size();
+	buffer->Name = "thread " + std::to_string(buffer->Index);
+	// Buffers live until exit, so events of threads that are gone can
+	// still be collected.
+	tBuffer = buffer.get();
+	sThreads.push_back(std::move(buffer));
+	return tBuffer;
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+	ThreadBuffer* buffer = tBuffer;
+	if (buffer == nullptr)
+		buffer = RegisterThread();
+
+	std::lock_guard<std::mutex> lock(sLock);
+	buffer->Name = name;
+}
+
+void Profiler::Collect()
+{
+	std::lock_guard<std::mutex> lock(sLock);
+	CollectLocked();
+}
+
+void Profiler::CollectLocked()
+{
+	if (sCapture.empty())
+		sCapture.resize(CaptureCapacity);
+
+	for (const std::unique_ptr<ThreadBuffer>& buffer : sThreads)
+	{
+		uint64 tail = buffer->Tail.load(std::memory_order_relaxed);
+		uint64 head = buffer->Head.load(std::memory_order_acquire);
+		for (uint64 i = tail; i < head; i++)
+			sCapture[sCaptureNext++ & (CaptureCapacity - 1)] = { buffer->Events[i & (ThreadCapacity - 1)], buffer->Index };
+		// Release: the owner overwrites these slots only after reading the new tail.
+		buffer->Tail.store(head, std::memory_order_release);
+	}
+}
+
+bool Profiler::WriteChromeTrace(const char* path)
+{
+	std::lock_guard<std::mutex> lock(sLock);
+	CollectLocked();
+
+	// Timestamp units per microsecond, measured over the whole run.
+	double elapsedMicroseconds = (SteadyNanoseconds() - sStartNanoseconds) / 1000.0;
+	double ticksPerMicrosecond = elapsedMicroseconds > 0.0 ? (Now() - sStartTicks) / elapsedMicroseconds : 1.0;
+
+	std::ofstream fout(path, std::ios::trunc);
+	if (!fout)
+		return false;
+
+	fout << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first = true;
+	for (const std::unique_ptr<ThreadBuffer>& buffer : sThreads)
+	{
+		fout << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->Index << ",\"args\":{\"name\":";
+		WriteJsonString(fout, buffer->Name.c_str());
+		fout << "}}";
+		first = false;
+	}
+
+	uint64 begin = sCaptureNext > CaptureCapacity ? sCaptureNext - CaptureCapacity : 0;
+	char line[96];
+	for (uint64 i = begin; i < sCaptureNext; i++)
+	{
+		const CapturedEvent& captured = sCapture[i & (CaptureCapacity - 1)];
+		// Complete events: "X" with a start and a duration, in microseconds.
+		double ts = (std::int64_t)(captured.Scope.Begin - sStartTicks) / ticksPerMicrosecond;
+		double dur = (captured.Scope.End - captured.Scope.Begin) / ticksPerMicrosecond;
+		fout << (first ? "" : ",\n") << "{\"name\":";
+		WriteJsonString(fout, captured.Scope.Name);
+		snprintf(line, sizeof(line), ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", captured.Thread, ts, dur);
+		fout << line;
+		first = false;
+	}
+	fout << "\n]}\n";
+	return (bool)fout;
+}
+
+Profiler::uint64 Profiler::GetDroppedCount()
+{
+	std::lock_guard<std::mutex> lock(sLock);
+	uint64 dropped = 0;
+	for (const std::unique_ptr<ThreadBuffer>& buffer : sThreads)
+		dropped += buffer->Dropped.load(std::memory_order_relaxed);
+	return dropped;
+}
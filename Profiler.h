@@ -0,0 +1,170 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+// Set to 0 to compile every PROFILE_SCOPE out.
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if PROFILER_ENABLED
+// Times the rest of the enclosing block.  name must be a string literal, or
+// any string that outlives the profiler: only the pointer is recorded.
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
+
+// CPU scope profiler.  Every thread records its scopes into a ring of its
+// own, with no lock and no allocation: the owner writes at the head, Collect
+// reads from the tail.  A scope is one event holding its name and its begin
+// and end timestamps; nesting follows from the timestamps.
+//
+// Collect, called once a frame, moves the events of every thread into a
+// larger capture ring that keeps the most recent CaptureCapacity events, and
+// WriteChromeTrace writes the capture as Chrome trace_event JSON for
+// chrome://tracing or ui.perfetto.dev.
+//
+// Timestamps are raw TSC reads where available, converted to microseconds
+// when written; the TSC is assumed invariant and synchronized across cores,
+// as on every CPU D3D12 runs on.  A scope costs its two timestamp reads
+// plus a few nanoseconds of recording; ProfilerBench measures both.
+class Profiler
+{
+public:
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	// Events a thread can hold between two Collects; past that its scopes
+	// are dropped and counted.
+	static constexpr uint32					ThreadCapacity = 16384;
+	// Events kept for WriteChromeTrace, the oldest overwritten first.
+	static constexpr uint32					CaptureCapacity = 1 << 18;
+
+	static uint64							Now();
+	static void								Record(const char* name, uint64 begin, uint64 end);
+	// Name of the calling thread in the trace; "thread N" by default.
+	static void								SetThreadName(const char* name);
+
+	// Moves the events recorded so far by every thread into the capture.
+	static void								Collect();
+	// Collects, then writes the capture to path.  Returns false if the file
+	// can not be written.
+	static bool								WriteChromeTrace(const char* path);
+	// Scopes dropped because a thread ring was full.
+	static uint64							GetDroppedCount();
+
+private:
+	struct Event
+	{
+		const char* Name;
+		uint64 Begin;
+		uint64 End;
+	};
+
+	struct ThreadBuffer
+	{
+		// Written by the owner only.
+		alignas(64) std::atomic<uint64>		Head{ 0 };
+		// Tail as last seen by the owner, so it reads Tail only when it
+		// looks full.
+		uint64								CachedTail = 0;
+		std::atomic<uint64>					Dropped{ 0 };
+		// Written by Collect only.
+		alignas(64) std::atomic<uint64>		Tail{ 0 };
+		uint32								Index = 0;
+		std::string							Name;
+		std::unique_ptr<Event[]>			Events;
+	};
+
+	struct CapturedEvent
+	{
+		Event Scope;
+		uint32 Thread;
+	};
+
+	static ThreadBuffer*					RegisterThread();
+	static void								CollectLocked();
+
+	static inline thread_local ThreadBuffer* tBuffer = nullptr;
+
+	static std::mutex						sLock;
+	static std::vector<std::unique_ptr<ThreadBuffer>> sThreads;
+	static std::vector<CapturedEvent>		sCapture;
+	static uint64							sCaptureNext;
+	// Now() and the steady clock when the profiler started, to convert
+	// timestamps to microseconds.
+	static const uint64						sStartTicks;
+	static const std::int64_t				sStartNanoseconds;
+};
+
+class ProfileScope
+{
+public:
+	explicit ProfileScope(const char* name) :
+		mName(name),
+		mBegin(Profiler::Now())
+	{
+	}
+
+	ProfileScope(const ProfileScope& rhs) = delete;
+	ProfileScope& operator=(const ProfileScope& rhs) = delete;
+
+	~ProfileScope()
+	{
+		Profiler::Record(mName, mBegin, Profiler::Now());
+	}
+
+private:
+	const char*								mName;
+	Profiler::uint64						mBegin;
+};
+
+inline Profiler::uint64 Profiler::Now()
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return (uint64)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+inline void Profiler::Record(const char* name, uint64 begin, uint64 end)
+{
+	ThreadBuffer* buffer = tBuffer;
+	if (buffer == nullptr)
+		buffer = RegisterThread();
+
+	uint64 head = buffer->Head.load(std::memory_order_relaxed);
+	if (head - buffer->CachedTail >= ThreadCapacity)
+	{
+		buffer->CachedTail = buffer->Tail.load(std::memory_order_acquire);
+		if (head - buffer->CachedTail >= ThreadCapacity)
+		{
+			buffer->Dropped.store(buffer->Dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			return;
+		}
+	}
+
+	Event& event = buffer->Events[head & (ThreadCapacity - 1)];
+	event.Name = name;
+	event.Begin = begin;
+	event.End = end;
+	// Release: Collect sees the event once it sees the new head.
+	buffer->Head.store(head + 1, std::memory_order_release);
+}
@@ -0,0 +1,121 @@
+#include "RenderQueue.h"
+
+namespace
+{
+	constexpr std::uint32_t LayerShift = 60;
+	constexpr std::uint64_t DepthMask = (1ull << RenderQueue::DepthBits) - 1;
+
+	std::uint64_t StateBits(std::uint32_t pso, std::uint32_t geometry, std::uint32_t submesh)
+	{
+		return ((std::uint64_t)(pso & 0xff) << 28)
+			| ((std::uint64_t)(geometry & 0xfff) << 16)
+			| (std::uint64_t)(submesh & 0xffff);
+	}
+}
+
+RenderQueue::uint64 RenderQueue::MakeKey(RenderLayer layer, uint32 pso, uint32 geometry, uint32 submesh,
+	float depth, float nearZ, float farZ)
+{
+	float t = (depth - nearZ) / (farZ - nearZ);
+	t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+	uint64 q = (uint64)(t * (float)DepthMask) & DepthMask;
+
+	uint64 key = (uint64)layer << LayerShift;
+	if (layer == RenderLayer::Transparent)
+		return key | ((DepthMask - q) << 36) | StateBits(pso, geometry, submesh);
+
+	return key | (StateBits(pso, geometry, submesh) << DepthBits) | q;
+}
+
+RenderLayer RenderQueue::GetLayer(uint64 key)
+{
+	return (RenderLayer)(key >> LayerShift);
+}
+
+RenderQueue::uint64 RenderQueue::GetStateKey(uint64 key)
+{
+	if (GetLayer(key) == RenderLayer::Transparent)
+		return key & ~(DepthMask << 36);
+	return key & ~DepthMask;
+}
+
+void RenderQueue::Clear()
+{
+	mKeys.clear();
+	mValues.clear();
+}
+
+void RenderQueue::Reserve(uint32 count)
+{
+	mKeys.reserve(count);
+	mValues.reserve(count);
+	mScratchKeys.reserve(count);
+	mScratchValues.reserve(count);
+}
+
+void RenderQueue::Push(uint64 key, uint32 value)
+{
+	mKeys.push_back(key);
+	mValues.push_back(value);
+}
+
+void RenderQueue::Sort()
+{
+	uint32 count = (uint32)mKeys.size();
+	if (count < 2)
+		return;
+
+	// All eight byte histograms in one read of the keys.
+	uint32 histograms[8][256] = {};
+	for (uint32 i = 0; i < count; ++i)
+	{
+		uint64 key = mKeys[i];
+		for (uint32 b = 0; b < 8; ++b)
+			histograms[b][(key >> (b * 8)) & 0xff]++;
+	}
+
+	mScratchKeys.resize(count);
+	mScratchValues.resize(count);
+	for (uint32 b = 0; b < 8; ++b)
+	{
+		uint32* histogram = histograms[b];
+		uint32 shift = b * 8;
+
+		// Every key has the same byte here (unused fields, a single layer...):
+		// the pass would not move anything.
+		if (histogram[(mKeys[0] >> shift) & 0xff] == count)
+			continue;
+
+		uint32 offset = 0;
+		for (uint32 d = 0; d < 256; ++d)
+		{
+			uint32 n = histogram[d];
+			histogram[d] = offset;
+			offset += n;
+		}
+
+		for (uint32 i = 0; i < count; ++i)
+		{
+			uint32 dst = histogram[(mKeys[i] >> shift) & 0xff]++;
+			mScratchKeys[dst] = mKeys[i];
+			mScratchValues[dst] = mValues[i];
+		}
+		mKeys.swap(mScratchKeys);
+		mValues.swap(mScratchValues);
+	}
+}
+
+RenderQueue::uint32 RenderQueue::Size() const
+{
+	return (uint32)mKeys.size();
+}
+
+const std::vector<RenderQueue::uint64>& RenderQueue::GetKeys() const
+{
+	return mKeys;
+}
+
+const std::vector<RenderQueue::uint32>& RenderQueue::GetValues() const
+{
+	return mValues;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+enum class RenderLayer : std::uint32_t
+{
+	Opaque,
+	Transparent,
+	Count
+};
+
+// Per-frame list of visible items sorted on a packed 64-bit key.
+//
+//   Opaque:      layer:4 | pso:8 | geometry:12 | submesh:16 | depth:24
+//   Transparent: layer:4 | inverted depth:24 | pso:8 | geometry:12 | submesh:16
+//
+// Opaque items are grouped by state first and go front to back inside a
+// group, which keeps state changes down and lets the depth test reject
+// hidden pixels early.  Transparent items must blend back to front, so their
+// depth is inverted and placed above the state bits.  Layers come out in
+// enum order.  Sort is an LSD radix sort on bytes, so it is linear in the
+// item count and reuses its buffers from frame to frame.
+class RenderQueue
+{
+public:
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	static constexpr uint32 DepthBits = 24;
+
+	// Depth is quantized linearly over [nearZ, farZ] and clamped to it.
+	static uint64							MakeKey(RenderLayer layer, uint32 pso, uint32 geometry, uint32 submesh,
+												float depth, float nearZ, float farZ);
+	static RenderLayer						GetLayer(uint64 key);
+	// Key with the depth bits cleared: items with equal state keys can be
+	// drawn together.
+	static uint64							GetStateKey(uint64 key);
+
+	void									Clear();
+	void									Reserve(uint32 count);
+	void									Push(uint64 key, uint32 value);
+	void									Sort();
+
+	uint32									Size() const;
+	const std::vector<uint64>&				GetKeys() const;
+	// Payload pushed with each key, in sorted order after Sort.
+	const std::vector<uint32>&				GetValues() const;
+
+private:
+	std::vector<uint64>						mKeys;
+	std::vector<uint32>						mValues;
+	std::vector<uint64>						mScratchKeys;
+	std::vector<uint32>						mScratchValues;
+};
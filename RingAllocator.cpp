@@ -0,0 +1,68 @@
+#include "RingAllocator.h"
+#include <cassert>
+
+RingAllocator::RingAllocator(uint64 capacity, std::uint32_t maxFramesInFlight) :
+	mCapacity(capacity),
+	mFrames(maxFramesInFlight)
+{
+}
+
+RingAllocator::uint64 RingAllocator::Allocate(uint64 size, uint64 alignment)
+{
+	// Nothing in flight: restart at the beginning to avoid wrapping waste.
+	if (mUsed == 0)
+		mHead = 0;
+
+	uint64 offset = (mHead + alignment - 1) & ~(alignment - 1);
+	uint64 padding = offset - mHead;
+
+	// Does not fit before the end of the buffer: skip the tail and wrap.
+	if (offset + size > mCapacity)
+	{
+		padding = mCapacity - mHead;
+		offset = 0;
+	}
+
+	if (size > mCapacity || mUsed + padding + size > mCapacity)
+		return InvalidOffset;
+
+	mHead = offset + size;
+	if (mHead == mCapacity)
+		mHead = 0;
+
+	mUsed += padding + size;
+	mCurrentFrameSize += padding + size;
+	return offset;
+}
+
+void RingAllocator::FinishFrame(uint64 fenceValue)
+{
+	assert(mFrameCount < mFrames.size() && "Too many frames in flight.");
+
+	FrameMarker& frame = mFrames[(mFirstFrame + mFrameCount) % mFrames.size()];
+	frame.FenceValue = fenceValue;
+	frame.Size = mCurrentFrameSize;
+	mFrameCount++;
+
+	mCurrentFrameSize = 0;
+}
+
+void RingAllocator::Retire(uint64 completedFenceValue)
+{
+	while (mFrameCount > 0 && mFrames[mFirstFrame].FenceValue <= completedFenceValue)
+	{
+		mUsed -= mFrames[mFirstFrame].Size;
+		mFirstFrame = (mFirstFrame + 1) % (std::uint32_t)mFrames.size();
+		mFrameCount--;
+	}
+}
+
+RingAllocator::uint64 RingAllocator::Capacity() const
+{
+	return mCapacity;
+}
+
+RingAllocator::uint64 RingAllocator::UsedSize() const
+{
+	return mUsed;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Offset bookkeeping for a ring of per-frame transient allocations.  It only
+// deals in byte offsets, so the same code drives the mapped D3D12 upload
+// buffer in UploadRing and any plain memory block.
+//
+// Allocations of the current frame are grouped by FinishFrame(fence) and
+// released together by Retire(completed) once the GPU has passed that fence.
+// Allocations never straddle the end of the ring: the leftover tail is
+// skipped and charged to the frame that wrapped.
+class RingAllocator
+{
+public:
+	using uint64 = std::uint64_t;
+
+	static constexpr uint64 InvalidOffset = UINT64_MAX;
+
+	RingAllocator(uint64 capacity, std::uint32_t maxFramesInFlight = 8);
+
+	// Returns InvalidOffset when the ring has no room left.
+	uint64									Allocate(uint64 size, uint64 alignment);
+	void									FinishFrame(uint64 fenceValue);
+	void									Retire(uint64 completedFenceValue);
+
+	uint64									Capacity() const;
+	uint64									UsedSize() const;
+
+private:
+	struct FrameMarker
+	{
+		uint64 FenceValue = 0;
+		uint64 Size = 0;
+	};
+
+	uint64									mCapacity;
+	uint64									mHead = 0;
+	uint64									mUsed = 0;
+	uint64									mCurrentFrameSize = 0;
+
+	// Fixed circular queue of frames still owned by the GPU.
+	std::vector<FrameMarker>				mFrames;
+	std::uint32_t							mFirstFrame = 0;
+	std::uint32_t							mFrameCount = 0;
+};
@@ -4,12 +4,17 @@
 // Transforms and colors geometry.
 //***************************************************************************************
 
-cbuffer cbPerObject : register(b0)
+struct InstanceData
 {
-	float4x4 gWorld; 
+	float4x4 World;
 };
 
-cbuffer cbPass : register(b1)
+// Indexed by entity slot.
+StructuredBuffer<InstanceData> gInstanceData : register(t0);
+// Entity slot of every instance of the current draw.
+StructuredBuffer<uint> gInstanceSlots : register(t1);
+
+cbuffer cbPass : register(b0)
 {
     float4x4 View;
     float4x4 InvView;
@@ -39,12 +44,15 @@ struct VertexOut
     float4 Color : COLOR;
 };
 
-VertexOut VS(VertexIn vin)
+VertexOut VS(VertexIn vin, uint instanceID : SV_InstanceID)
 {
 	VertexOut vout;
-	
+
+	// Fetch the instance data.
+	float4x4 world = gInstanceData[gInstanceSlots[instanceID]].World;
+
 	// Transform to homogeneous clip space.
-    float4 posW = mul(float4(vin.PosL, 1.0f), gWorld);
+    float4 posW = mul(float4(vin.PosL, 1.0f), world);
 
     vout.PosH = mul(posW,ViewProj);
 	
@@ -0,0 +1,432 @@
+// SimRunner: runs the simulation without a window or a GPU and times it.
+//
+//   SimRunner [options]
+//     --ticks N              ticks per run, 600 by default (10 s at 60 Hz)
+//     --asteroids N[,N...]   one run per asteroid count, 1000,10000,100000
+//                            by default
+//     --threads N            job system threads, 0 (the default) for one per
+//                            hardware thread
+//     --density D            asteroids per cubic unit of the field, 0.1 by
+//                            default
+//     --seed N               seed of the asteroid field
+//     --script <file>        player input, see below
+//     --trace <file>         write the scopes of the last ticks as a Chrome
+//                            trace
+//
+// Every run fills a field ahead of the player with the asteroids, then ticks
+// the simulation at 60 Hz with scripted input, timing every stage of every
+// tick and counting the heap allocations made while ticking.
+//
+// A script is a list of "<ticks> <move x> <move y> <move z> <shoot>" lines,
+// each holding that input for that many ticks, played in a loop; # starts a
+// comment.  Without one the player strafes and shoots, see DefaultScript.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../Profiler.h"
+#include "../Simulation.h"
+
+using namespace DirectX;
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+	using Clock = std::chrono::steady_clock;
+
+	// Every operator new of the process, counted by the replacements below.
+	std::atomic<uint64> gAllocations{ 0 };
+	std::atomic<uint64> gAllocatedBytes{ 0 };
+
+	struct AllocationCount
+	{
+		uint64 Count = 0;
+		uint64 Bytes = 0;
+
+		static AllocationCount Now()
+		{
+			return { gAllocations.load(std::memory_order_relaxed), gAllocatedBytes.load(std::memory_order_relaxed) };
+		}
+
+		AllocationCount operator-(const AllocationCount& rhs) const
+		{
+			return { Count - rhs.Count, Bytes - rhs.Bytes };
+		}
+	};
+
+	void* Allocate(std::size_t size, std::size_t alignment)
+	{
+		gAllocations.fetch_add(1, std::memory_order_relaxed);
+		gAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+		if (size == 0)
+			size = 1;
+#ifdef _WIN32
+		void* p = alignment > alignof(std::max_align_t) ? _aligned_malloc(size, alignment) : std::malloc(size);
+#else
+		// aligned_alloc wants a multiple of the alignment.
+		void* p = alignment > alignof(std::max_align_t) ? std::aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1)) : std::malloc(size);
+#endif
+		if (p == nullptr)
+			throw std::bad_alloc();
+		return p;
+	}
+
+	void Free(void* p, std::size_t alignment)
+	{
+#ifdef _WIN32
+		if (alignment > alignof(std::max_align_t))
+		{
+			_aligned_free(p);
+			return;
+		}
+#endif
+		(void)alignment;
+		std::free(p);
+	}
+}
+
+// The array and nothrow forms call these.
+void* operator new(std::size_t size) { return Allocate(size, alignof(std::max_align_t)); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return Allocate(size, (std::size_t)alignment); }
+void operator delete(void* p) noexcept { Free(p, alignof(std::max_align_t)); }
+void operator delete(void* p, std::size_t) noexcept { Free(p, alignof(std::max_align_t)); }
+void operator delete(void* p, std::align_val_t alignment) noexcept { Free(p, (std::size_t)alignment); }
+void operator delete(void* p, std::size_t, std::align_val_t alignment) noexcept { Free(p, (std::size_t)alignment); }
+
+namespace
+{
+	const float TickSeconds = 1.0f / 60.0f;
+	// Distance from the player to the near side of the field.  Asteroids
+	// take over 12 s to cross it, so the default runs end before any reaches
+	// the player; projectiles reach the near side after about 7 s.
+	const float FieldStart = 8.0f;
+
+	const char* StageNames[SimStageCount] =
+	{
+		"save positions",
+		"player",
+		"broadphase",
+		"narrowphase",
+		"resolve",
+		"move",
+		"spawn",
+		"timers"
+	};
+
+	struct ScriptStep
+	{
+		uint32 Ticks;
+		SimInput Input;
+	};
+
+	// Strafes left and right and bobs up and down, back where it started
+	// after every loop, shooting as often as the cooldown allows.
+	std::vector<ScriptStep> DefaultScript()
+	{
+		return {
+			{ 60, { 0.0f, 0.0f, 0.0f, true } },
+			{ 30, { -1.0f, 0.0f, 0.0f, true } },
+			{ 60, { 1.0f, 0.0f, 0.0f, true } },
+			{ 30, { -1.0f, 0.0f, 0.0f, true } },
+			{ 20, { 0.0f, 1.0f, 0.0f, false } },
+			{ 20, { 0.0f, -1.0f, 0.0f, false } }
+		};
+	}
+
+	bool LoadScript(const char* path, std::vector<ScriptStep>& script)
+	{
+		std::ifstream file(path);
+		if (!file)
+			return false;
+
+		script.clear();
+		std::string line;
+		while (std::getline(file, line))
+		{
+			line = line.substr(0, line.find('#'));
+			std::istringstream fields(line);
+			ScriptStep step;
+			int shoot = 0;
+			if (!(fields >> step.Ticks))
+				continue;
+			if (!(fields >> step.Input.MoveX >> step.Input.MoveY >> step.Input.MoveZ >> shoot))
+				return false;
+			step.Input.Shoot = shoot != 0;
+			if (step.Ticks > 0)
+				script.push_back(step);
+		}
+		return !script.empty();
+	}
+
+	// Plays a script in a loop.
+	class ScriptPlayer
+	{
+	public:
+		ScriptPlayer(const std::vector<ScriptStep>& script) :
+			mScript(script)
+		{
+		}
+
+		const SimInput& Next()
+		{
+			if (mTick == mScript[mStep].Ticks)
+			{
+				mStep = (mStep + 1) % mScript.size();
+				mTick = 0;
+			}
+			mTick++;
+			return mScript[mStep].Input;
+		}
+
+	private:
+		const std::vector<ScriptStep>& mScript;
+		std::size_t mStep = 0;
+		uint32 mTick = 0;
+	};
+
+	// Same xorshift32 as Simulation, for a field that does not depend on the platform.
+	class Random
+	{
+	public:
+		Random(uint32 seed) :
+			mState(seed != 0 ? seed : 1)
+		{
+		}
+
+		// Uniform in [0, 1).
+		float Next()
+		{
+			mState ^= mState << 13;
+			mState ^= mState >> 17;
+			mState ^= mState << 5;
+			return (float)(mState >> 8) * (1.0f / 16777216.0f);
+		}
+
+	private:
+		uint32 mState;
+	};
+
+	struct Options
+	{
+		uint32 Ticks = 600;
+		std::vector<uint32> AsteroidCounts = { 1000, 10000, 100000 };
+		uint32 Threads = 0;
+		// About one asteroid per 6 broadphase cells.
+		float Density = 0.1f;
+		uint32 Seed = 1;
+		std::vector<ScriptStep> Script = DefaultScript();
+		const char* TracePath = nullptr;
+	};
+
+	struct StageSummary
+	{
+		double Mean = 0.0;
+		double P50 = 0.0;
+		double P99 = 0.0;
+		double Max = 0.0;
+	};
+
+	// In milliseconds.  Sorts seconds.
+	StageSummary Summarize(std::vector<double>& seconds)
+	{
+		StageSummary summary;
+		if (seconds.empty())
+			return summary;
+
+		double sum = 0.0;
+		for (double s : seconds)
+			sum += s;
+		std::sort(seconds.begin(), seconds.end());
+		std::size_t n = seconds.size();
+		summary.Mean = 1000.0 * sum / n;
+		summary.P50 = 1000.0 * seconds[(n - 1) / 2];
+		summary.P99 = 1000.0 * seconds[std::min(n - 1, (std::size_t)(0.99 * n))];
+		summary.Max = 1000.0 * seconds[n - 1];
+		return summary;
+	}
+
+	double Megabytes(uint64 bytes)
+	{
+		return bytes / (1024.0 * 1024.0);
+	}
+
+	void Run(const Options& options, uint32 asteroidCount, JobSystem& jobs)
+	{
+		Clock::time_point setupStart = Clock::now();
+		AllocationCount setupAllocations = AllocationCount::Now();
+
+		Simulation sim;
+		SimulationDesc desc;
+		desc.MaxAsteroids = asteroidCount;
+		desc.Seed = options.Seed;
+		sim.Init(desc);
+		sim.SpawnPlayer();
+
+		// A cube of asteroids in front of the player, centered on its axis.
+		Random random(options.Seed);
+		float side = std::cbrt(asteroidCount / options.Density);
+		for (uint32 i = 0; i < asteroidCount; i++)
+		{
+			float x = (random.Next() - 0.5f) * side;
+			float y = (random.Next() - 0.5f) * side;
+			float z = FieldStart + random.Next() * side;
+			sim.SpawnAsteroid(XMFLOAT3(x, y, z));
+		}
+
+		double setupMs = std::chrono::duration<double, std::milli>(Clock::now() - setupStart).count();
+		setupAllocations = AllocationCount::Now() - setupAllocations;
+
+		// Result storage is allocated up front so the counts below are the
+		// simulation's own.
+		std::vector<Simulation::StageTimes> stageTimes(options.Ticks);
+		std::vector<double> tickTimes(options.Ticks);
+		std::vector<AllocationCount> tickAllocations(options.Ticks);
+		ScriptPlayer script(options.Script);
+		uint32 gameOverTick = UINT32_MAX;
+
+		Clock::time_point runStart = Clock::now();
+		for (uint32 t = 0; t < options.Ticks; t++)
+		{
+			const SimInput& input = script.Next();
+			AllocationCount before = AllocationCount::Now();
+			Clock::time_point tickStart = Clock::now();
+
+			sim.Tick(jobs, input, TickSeconds, &stageTimes[t]);
+
+			tickTimes[t] = std::chrono::duration<double>(Clock::now() - tickStart).count();
+			tickAllocations[t] = AllocationCount::Now() - before;
+			if (sim.IsGameOver() && gameOverTick == UINT32_MAX)
+				gameOverTick = t;
+			// As the game does once a frame.
+			Profiler::Collect();
+		}
+		double runSeconds = std::chrono::duration<double>(Clock::now() - runStart).count();
+
+		printf("%u asteroids, %u ticks, %u thread(s)\n", asteroidCount, options.Ticks, jobs.GetThreadCount());
+		printf("  setup           %9.3f ms, %llu allocations (%.1f MB)\n", setupMs,
+			(unsigned long long)setupAllocations.Count, Megabytes(setupAllocations.Bytes));
+
+		printf("  %-15s %9s %9s %9s %9s\n", "stage (ms)", "mean", "p50", "p99", "max");
+		std::vector<double> seconds(options.Ticks);
+		for (uint32 s = 0; s < SimStageCount; s++)
+		{
+			for (uint32 t = 0; t < options.Ticks; t++)
+				seconds[t] = stageTimes[t].Seconds[s];
+			StageSummary summary = Summarize(seconds);
+			printf("  %-15s %9.3f %9.3f %9.3f %9.3f\n", StageNames[s], summary.Mean, summary.P50, summary.P99, summary.Max);
+		}
+		StageSummary tick = Summarize(tickTimes);
+		printf("  %-15s %9.3f %9.3f %9.3f %9.3f\n", "tick", tick.Mean, tick.P50, tick.P99, tick.Max);
+
+		// The first tick grows the collision scratch; the later ones should
+		// not allocate at all.
+		AllocationCount later;
+		uint64 maxInTick = 0;
+		for (uint32 t = 1; t < options.Ticks; t++)
+		{
+			later.Count += tickAllocations[t].Count;
+			later.Bytes += tickAllocations[t].Bytes;
+			maxInTick = std::max(maxInTick, tickAllocations[t].Count);
+		}
+		printf("  allocations     first tick %llu (%.2f MB), later ticks %llu (%.2f MB), at most %llu in a tick\n",
+			(unsigned long long)tickAllocations[0].Count, Megabytes(tickAllocations[0].Bytes),
+			(unsigned long long)later.Count, Megabytes(later.Bytes), (unsigned long long)maxInTick);
+
+		uint32 counts[EntityKindCount] = {};
+		const EntityStore& entities = sim.GetEntities();
+		for (uint32 i = 0; i < entities.Size(); i++)
+			counts[(uint32)entities.Kind[i]]++;
+		printf("  end             %u asteroids, %u projectiles", counts[(uint32)EntityKind::Asteroid], counts[(uint32)EntityKind::Projectile]);
+		if (gameOverTick != UINT32_MAX)
+			printf(", game over at tick %u", gameOverTick);
+		printf("\n  speed           %.0f ticks/s, %.1fx real time\n\n", options.Ticks / runSeconds, options.Ticks * TickSeconds / runSeconds);
+	}
+
+	bool ParseCounts(const char* text, std::vector<uint32>& counts)
+	{
+		counts.clear();
+		std::istringstream list(text);
+		std::string item;
+		while (std::getline(list, item, ','))
+		{
+			char* end = nullptr;
+			unsigned long count = std::strtoul(item.c_str(), &end, 10);
+			if (end == item.c_str() || *end != 0)
+				return false;
+			counts.push_back((uint32)count);
+		}
+		return !counts.empty();
+	}
+
+	int Usage()
+	{
+		fprintf(stderr,
+			"usage: SimRunner [--ticks N] [--asteroids N[,N...]] [--threads N] [--density D] [--seed N] [--script file] [--trace file]\n");
+		return 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (value == nullptr)
+			return Usage();
+		i++;
+
+		if (strcmp(arg, "--ticks") == 0)
+			options.Ticks = (uint32)std::strtoul(value, nullptr, 10);
+		else if (strcmp(arg, "--asteroids") == 0)
+		{
+			if (!ParseCounts(value, options.AsteroidCounts))
+				return Usage();
+		}
+		else if (strcmp(arg, "--threads") == 0)
+			options.Threads = (uint32)std::strtoul(value, nullptr, 10);
+		else if (strcmp(arg, "--density") == 0)
+			options.Density = (float)std::strtod(value, nullptr);
+		else if (strcmp(arg, "--seed") == 0)
+			options.Seed = (uint32)std::strtoul(value, nullptr, 10);
+		else if (strcmp(arg, "--trace") == 0)
+			options.TracePath = value;
+		else if (strcmp(arg, "--script") == 0)
+		{
+			if (!LoadScript(value, options.Script))
+			{
+				fprintf(stderr, "SimRunner: could not read the script %s\n", value);
+				return 1;
+			}
+		}
+		else
+			return Usage();
+	}
+	if (options.Ticks == 0 || !(options.Density > 0.0f))
+		return Usage();
+
+	// Created on the main thread, which takes part in the work as thread 0.
+	Profiler::SetThreadName("main");
+	JobSystem jobs(options.Threads);
+	for (uint32 count : options.AsteroidCounts)
+		Run(options, count, jobs);
+
+	if (options.TracePath != nullptr && !Profiler::WriteChromeTrace(options.TracePath))
+	{
+		fprintf(stderr, "SimRunner: could not write the trace %s\n", options.TracePath);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,328 @@
+#include "Simulation.h"
+#include <chrono>
+#include "Profiler.h"
+
+using namespace DirectX;
+
+namespace
+{
+	// Entities per job of the per-entity loops.  Below this many entities a
+	// loop runs inline on the calling thread.
+	const std::uint32_t EntityGrainSize = 1024;
+	// Entities or candidate pairs per job of the collision loops.
+	const std::uint32_t CollisionGrainSize = 2048;
+	// Asteroids spawn at this z, within this distance of the axis on x and y.
+	const float SpawnDistance = 5.0f;
+	const float SpawnSpread = 1.5f;
+
+	using Clock = std::chrono::steady_clock;
+
+	// Charges the time since the last call to a stage of times, if any.
+	class StageTimer
+	{
+	public:
+		StageTimer(Simulation::StageTimes* times) :
+			mTimes(times)
+		{
+			if (mTimes != nullptr)
+				mLast = Clock::now();
+		}
+
+		void Stop(SimStage stage)
+		{
+			if (mTimes == nullptr)
+				return;
+			Clock::time_point now = Clock::now();
+			mTimes->Seconds[(std::uint32_t)stage] = std::chrono::duration<double>(now - mLast).count();
+			mLast = now;
+		}
+
+	private:
+		Simulation::StageTimes* mTimes;
+		Clock::time_point mLast;
+	};
+}
+
+void Simulation::Init(const SimulationDesc& desc)
+{
+	// Every entity slot is allocated here once; spawning afterwards only pops
+	// a slot from the pool of its kind.
+	mEntities.CreatePool(EntityKind::Player, MaxPlayers);
+	mEntities.CreatePool(EntityKind::TestBox, MaxTestBoxes);
+	mEntities.CreatePool(EntityKind::Asteroid, desc.MaxAsteroids);
+	mEntities.CreatePool(EntityKind::Projectile, desc.MaxProjectiles);
+	mEntities.SetFrameResourceCount(desc.FrameResourceCount);
+
+	// xorshift32 is stuck at zero.
+	mRandom = desc.Seed != 0 ? desc.Seed : 1;
+
+	XMStoreFloat4(&mPlayerRotation, XMQuaternionRotationMatrix(mTransform.Rotate(0, 70, 0)));
+	XMStoreFloat4(&mProjectileRotation, XMQuaternionRotationMatrix(mTransform.Rotate(0, 90, 0)));
+}
+
+float Simulation::RandomSigned()
+{
+	mRandom ^= mRandom << 13;
+	mRandom ^= mRandom >> 17;
+	mRandom ^= mRandom << 5;
+	// Top 24 bits, exact in a float.
+	return (float)(mRandom >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+EntityHandle Simulation::SpawnTestBox()
+{
+	return mEntities.Add(EntityKind::TestBox, DrawArgBox, XMFLOAT3(0, 0, 0), XMFLOAT4(0, 0, 0, 1));
+}
+
+EntityHandle Simulation::SpawnPlayer()
+{
+	mPlayer = mEntities.Add(EntityKind::Player, DrawArgPyramide, XMFLOAT3(0, -1, 0), mPlayerRotation);
+	return mPlayer;
+}
+
+EntityHandle Simulation::SpawnAsteroid()
+{
+	float x = SpawnSpread * RandomSigned();
+	float y = SpawnSpread * RandomSigned();
+	return SpawnAsteroid(XMFLOAT3(x, y, SpawnDistance));
+}
+
+EntityHandle Simulation::SpawnAsteroid(const XMFLOAT3& position)
+{
+	return mEntities.Add(EntityKind::Asteroid, DrawArgSphere, position, XMFLOAT4(0, 0, 0, 1));
+}
+
+EntityHandle Simulation::SpawnProjectile(const XMFLOAT3& position)
+{
+	EntityHandle handle = mEntities.Add(EntityKind::Projectile, DrawArgProjectile, position, mProjectileRotation);
+	if (mEntities.IsAlive(handle))
+		mEntities.LifeTime[mEntities.IndexOf(handle)] = ProjectileLifeTime;
+	return handle;
+}
+
+void Simulation::Tick(JobSystem& jobs, const SimInput& input, float dt, StageTimes* times)
+{
+	PROFILE_SCOPE("Simulation::Tick");
+	StageTimer timer(times);
+
+	SavePositions(jobs);
+	timer.Stop(SimStage::SavePositions);
+
+	MovePlayer(input, dt);
+	timer.Stop(SimStage::Player);
+
+	// Collisions are tested where the entities stand once the player has
+	// moved, then the survivors move, in the order of the original Update.
+	{
+		PROFILE_SCOPE("Collision");
+		FindPairs();
+		timer.Stop(SimStage::Broadphase);
+
+		FindCollisions(jobs);
+		timer.Stop(SimStage::Narrowphase);
+
+		ResolveCollisions();
+		timer.Stop(SimStage::Resolve);
+	}
+
+	MoveEntities(jobs, dt);
+	timer.Stop(SimStage::Move);
+
+	Shoot(input);
+	SpawnWave();
+	timer.Stop(SimStage::Spawn);
+
+	UpdateTimers(jobs, dt);
+	timer.Stop(SimStage::Timers);
+}
+
+void Simulation::SavePositions(JobSystem& jobs)
+{
+	PROFILE_SCOPE("SavePositions");
+	// Where this tick starts from, for the frames drawn until the next one.
+	// Entities that moved last tick are flagged so every frame resource gets
+	// their final position once they stop.
+	auto save = [this](uint32 begin, uint32 end)
+	{
+		for (uint32 i = begin; i < end; i++)
+		{
+			XMFLOAT3& prev = mEntities.PrevPosition[i];
+			const XMFLOAT3& position = mEntities.Position[i];
+			if (prev.x != position.x || prev.y != position.y || prev.z != position.z) {
+				prev = position;
+				mEntities.MarkDirty(i);
+			}
+		}
+	};
+	jobs.ParallelFor(0, mEntities.Size(), EntityGrainSize, save);
+}
+
+void Simulation::MovePlayer(const SimInput& input, float dt)
+{
+	if (!mEntities.IsAlive(mPlayer) || (input.MoveX == 0.0f && input.MoveY == 0.0f && input.MoveZ == 0.0f))
+		return;
+
+	uint32 i = mEntities.IndexOf(mPlayer);
+	float step = PlayerSpeed * dt;
+	mEntities.Position[i].x += input.MoveX * step;
+	mEntities.Position[i].y += input.MoveY * step;
+	mEntities.Position[i].z += input.MoveZ * step;
+	mEntities.MarkDirty(i);
+}
+
+void Simulation::MoveEntities(JobSystem& jobs, float dt)
+{
+	PROFILE_SCOPE("MoveEntities");
+	auto move = [this, dt](uint32 begin, uint32 end)
+	{
+		for (uint32 i = begin; i < end; i++)
+		{
+			if (mEntities.Kind[i] == EntityKind::Asteroid)
+			{
+				mEntities.Position[i].z -= AsteroidSpeed * dt;
+				mEntities.MarkDirty(i);
+			}
+			else if (mEntities.Kind[i] == EntityKind::Projectile)
+			{
+				mEntities.Position[i].z += ProjectileSpeed * dt;
+				mEntities.MarkDirty(i);
+			}
+		}
+	};
+	jobs.ParallelFor(0, mEntities.Size(), CollisionGrainSize, move);
+}
+
+void Simulation::FindPairs()
+{
+	PROFILE_SCOPE("Broadphase");
+	mPairs.clear();
+	mBroadphase.Build(mEntities.Position);
+	mBroadphase.FindPairs(mPairs);
+}
+
+void Simulation::FindCollisions(JobSystem& jobs)
+{
+	PROFILE_SCOPE("Narrowphase");
+	// Narrowphase on every candidate of the broadphase in parallel; only the
+	// few pairs that overlap are resolved, in order, as a pair may be skipped
+	// because one of its entities was destroyed by an earlier pair.
+	mPairHits.resize(mPairs.size());
+	auto overlap = [this](uint32 begin, uint32 end)
+	{
+		for (uint32 p = begin; p < end; p++)
+		{
+			const XMFLOAT3& pa = mEntities.Position[mPairs[p].first];
+			const XMFLOAT3& pb = mEntities.Position[mPairs[p].second];
+			mPairHits[p] = !(pa.x > pb.x + CollisionExtent || pa.x < pb.x - CollisionExtent
+				|| pa.y > pb.y + CollisionExtent || pa.y < pb.y - CollisionExtent
+				|| pa.z > pb.z + CollisionExtent || pa.z < pb.z - CollisionExtent);
+		}
+	};
+	jobs.ParallelFor(0, (uint32)mPairs.size(), CollisionGrainSize, overlap);
+}
+
+void Simulation::ResolveCollisions()
+{
+	PROFILE_SCOPE("ResolveCollisions");
+	uint32 count = mEntities.Size();
+	mDestroyed.assign(count, false);
+	for (size_t p = 0; p < mPairs.size(); p++)
+	{
+		if (!mPairHits[p])
+			continue;
+
+		uint32 a = mPairs[p].first;
+		uint32 b = mPairs[p].second;
+		if (mDestroyed[a] || mDestroyed[b])
+			continue;
+
+		EntityKind ka = mEntities.Kind[a];
+		EntityKind kb = mEntities.Kind[b];
+		if ((ka == EntityKind::Asteroid && kb == EntityKind::Player) || (ka == EntityKind::Player && kb == EntityKind::Asteroid)) {
+			mEntities.Clear();
+			mGameOver = true;
+			return;
+		}
+		if ((ka == EntityKind::Asteroid && kb == EntityKind::Projectile) || (ka == EntityKind::Projectile && kb == EntityKind::Asteroid)) {
+			mDestroyed[a] = true;
+			mDestroyed[b] = true;
+		}
+	}
+
+	// Swap-and-pop removal moves the last entity into the hole, so walk backwards.
+	for (uint32 i = count; i-- > 0;)
+	{
+		if (mDestroyed[i])
+			mEntities.RemoveAt(i);
+	}
+}
+
+void Simulation::Shoot(const SimInput& input)
+{
+	if (input.Shoot && mCanShoot)
+	{
+		if (mEntities.IsAlive(mPlayer))
+			SpawnProjectile(mEntities.Position[mEntities.IndexOf(mPlayer)]);
+		mCanShoot = false;
+		mShootCooldown = 0;
+	}
+}
+
+void Simulation::SpawnWave()
+{
+	if (mEntities.Count(EntityKind::Asteroid) > 0)
+		return;
+
+	for (uint32 i = 0; i < mWaveSize; i++)
+		SpawnAsteroid();
+	mWaveSize++;
+}
+
+void Simulation::UpdateTimers(JobSystem& jobs, float dt)
+{
+	PROFILE_SCOPE("UpdateTimers");
+	mShootCooldown += dt;
+	if (mShootCooldown > ShootCooldown)
+		mCanShoot = true;
+
+	auto updateTimers = [this, dt](uint32 begin, uint32 end)
+	{
+		for (uint32 i = begin; i < end; i++)
+		{
+			if (mEntities.Kind[i] == EntityKind::Projectile)
+				mEntities.Timer[i] += dt;
+		}
+	};
+	jobs.ParallelFor(0, mEntities.Size(), EntityGrainSize, updateTimers);
+
+	for (uint32 i = mEntities.Size(); i-- > 0;)
+	{
+		if (mEntities.Kind[i] == EntityKind::Projectile && mEntities.Timer[i] >= mEntities.LifeTime[i])
+			mEntities.RemoveAt(i);
+	}
+}
+
+EntityStore& Simulation::GetEntities()
+{
+	return mEntities;
+}
+
+const EntityStore& Simulation::GetEntities() const
+{
+	return mEntities;
+}
+
+EntityHandle Simulation::GetPlayer() const
+{
+	return mPlayer;
+}
+
+bool Simulation::IsGameOver() const
+{
+	return mGameOver;
+}
+
+void Simulation::SetGameOver(bool gameOver)
+{
+	mGameOver = gameOver;
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include <cstdint>
+#include <DirectXMath.h>
+#include <vector>
+#include "EntityStore.h"
+#include "JobSystem.h"
+#include "SpatialHash.h"
+#include "Transform.h"
+
+// Mesh (LOD chain) of an entity, stored in EntityStore::DrawArg.
+enum DrawArgIndex : std::uint32_t
+{
+	DrawArgBox,
+	DrawArgSphere,
+	DrawArgPyramide,
+	DrawArgProjectile,
+	DrawArgCount
+};
+
+// Player commands for one tick.  BoxApp fills it from the keyboard, the
+// headless runner from a script.
+struct SimInput
+{
+	// Direction the player moves in, each axis in [-1, 1].  A full axis moves
+	// Simulation::PlayerSpeed units per second.
+	float MoveX = 0.0f;
+	float MoveY = 0.0f;
+	float MoveZ = 0.0f;
+	bool Shoot = false;
+};
+
+struct SimulationDesc
+{
+	std::uint32_t MaxAsteroids = 4096;
+	std::uint32_t MaxProjectiles = 1024;
+	// EntityStore::SetFrameResourceCount; 1 when nothing is drawn.
+	std::uint32_t FrameResourceCount = 1;
+	// Seed of the asteroid spawn positions.
+	std::uint32_t Seed = 1;
+};
+
+// Stages of a tick in the order Tick runs them, timed when asked to.
+enum class SimStage : std::uint32_t
+{
+	SavePositions,
+	Player,
+	Broadphase,
+	Narrowphase,
+	Resolve,
+	Move,
+	Spawn,
+	Timers,
+	Count
+};
+
+constexpr std::uint32_t SimStageCount = (std::uint32_t)SimStage::Count;
+
+// Game state and rules, without anything of the renderer: entities,
+// movement, collisions, spawning, shooting and projectile lifetimes.  It only
+// needs DirectXMath and the standard library, so the headless runner builds
+// it on any platform.
+class Simulation
+{
+public:
+	using uint32 = std::uint32_t;
+
+	// Seconds of each stage of a tick.
+	struct StageTimes
+	{
+		double Seconds[SimStageCount] = {};
+	};
+
+	// Creates the entity pools.  Call once before spawning.
+	void									Init(const SimulationDesc& desc);
+
+	EntityHandle							SpawnTestBox();
+	// The player is kept as GetPlayer.
+	EntityHandle							SpawnPlayer();
+	// At a random position of the spawn plane.
+	EntityHandle							SpawnAsteroid();
+	EntityHandle							SpawnAsteroid(const DirectX::XMFLOAT3& position);
+	EntityHandle							SpawnProjectile(const DirectX::XMFLOAT3& position);
+
+	// Advances the game by dt seconds.  Fills times, if not null, with the
+	// time spent in each stage.
+	void									Tick(JobSystem& jobs, const SimInput& input, float dt, StageTimes* times = nullptr);
+
+	EntityStore&							GetEntities();
+	const EntityStore&						GetEntities() const;
+	EntityHandle							GetPlayer() const;
+	bool									IsGameOver() const;
+	void									SetGameOver(bool gameOver);
+
+	static constexpr float					CollisionExtent = 0.60f;
+	// Units per second along z.
+	static constexpr float					AsteroidSpeed = 0.6f;
+	static constexpr float					ProjectileSpeed = 0.6f;
+	// Units per second on every axis, the 0.05 per frame the player used to move at 60 Hz.
+	static constexpr float					PlayerSpeed = 3.0f;
+	// Seconds a projectile lives.
+	static constexpr float					ProjectileLifeTime = 2000.0f / 60.0f;
+	// Seconds between two shots: the old 100 frames.
+	static constexpr float					ShootCooldown = 100.0f / 60.0f;
+
+	static constexpr uint32					MaxPlayers = 1;
+	static constexpr uint32					MaxTestBoxes = 1;
+
+private:
+	// Uniform in [-1, 1).
+	float									RandomSigned();
+
+	void									SavePositions(JobSystem& jobs);
+	void									MovePlayer(const SimInput& input, float dt);
+	void									MoveEntities(JobSystem& jobs, float dt);
+	// Broadphase: candidate pairs into mPairs.
+	void									FindPairs();
+	void									FindCollisions(JobSystem& jobs);
+	void									ResolveCollisions();
+	void									Shoot(const SimInput& input);
+	void									SpawnWave();
+	void									UpdateTimers(JobSystem& jobs, float dt);
+
+	EntityStore								mEntities;
+	EntityHandle							mPlayer;
+	Transform								mTransform;
+	DirectX::XMFLOAT4						mPlayerRotation;
+	DirectX::XMFLOAT4						mProjectileRotation;
+	std::uint32_t							mRandom = 1;
+	bool									mGameOver = false;
+
+	// Seconds since the last shot.
+	float									mShootCooldown = 0.0f;
+	bool									mCanShoot = true;
+	// Asteroids of the next wave, spawned once none is left.
+	uint32									mWaveSize = 1;
+
+	//Collision scratch, reused every tick
+	// Boxes overlap when their centers are within CollisionExtent on every
+	// axis, so cells that wide keep every overlapping pair within one cell.
+	// The test is inclusive and floor(x / size) can round either way at a
+	// cell edge, so the cells get a little margin on top.
+	SpatialHash								mBroadphase{ CollisionExtent * 1.001f };
+	std::vector<SpatialHash::Pair>			mPairs;
+	// Per pair of mPairs: nonzero if the boxes overlap.
+	std::vector<std::uint8_t>				mPairHits;
+	std::vector<bool>						mDestroyed;
+};
@@ -0,0 +1,98 @@
+#include "SpatialHash.h"
+#include <cmath>
+
+using namespace DirectX;
+
+SpatialHash::SpatialHash(float cellSize) :
+	mCellSize(cellSize),
+	mInvCellSize(1.0f / cellSize)
+{
+}
+
+float SpatialHash::GetCellSize() const
+{
+	return mCellSize;
+}
+
+SpatialHash::uint32 SpatialHash::Hash(std::int32_t x, std::int32_t y, std::int32_t z) const
+{
+	// Large primes from Teschner et al., "Optimized Spatial Hashing for
+	// Collision Detection of Deformable Objects".
+	uint32 h = ((uint32)x * 73856093u) ^ ((uint32)y * 19349663u) ^ ((uint32)z * 83492791u);
+	return h & mTableMask;
+}
+
+void SpatialHash::Build(const std::vector<XMFLOAT3>& positions)
+{
+	uint32 count = (uint32)positions.size();
+
+	// Keep the table at least twice as large as the entity count so most
+	// buckets hold a single cell.
+	uint32 tableSize = 64;
+	while (tableSize < count * 2)
+		tableSize <<= 1;
+	mTableMask = tableSize - 1;
+
+	mCellStart.assign(tableSize + 1, 0);
+	mEntries.resize(count);
+	mCells.resize(count);
+
+	for (uint32 i = 0; i < count; ++i)
+	{
+		Cell& c = mCells[i];
+		c.x = (std::int32_t)std::floor(positions[i].x * mInvCellSize);
+		c.y = (std::int32_t)std::floor(positions[i].y * mInvCellSize);
+		c.z = (std::int32_t)std::floor(positions[i].z * mInvCellSize);
+		mCellStart[Hash(c.x, c.y, c.z)]++;
+	}
+
+	// Running sum, then fill back to front so every bucket ends up as
+	// [mCellStart[h], mCellStart[h + 1]).
+	uint32 start = 0;
+	for (uint32 h = 0; h < tableSize; ++h)
+	{
+		start += mCellStart[h];
+		mCellStart[h] = start;
+	}
+	mCellStart[tableSize] = start;
+
+	for (uint32 i = 0; i < count; ++i)
+	{
+		const Cell& c = mCells[i];
+		mEntries[--mCellStart[Hash(c.x, c.y, c.z)]] = i;
+	}
+}
+
+void SpatialHash::FindPairs(std::vector<Pair>& pairs) const
+{
+	uint32 count = (uint32)mCells.size();
+	for (uint32 i = 0; i < count; ++i)
+	{
+		const Cell& c = mCells[i];
+		for (std::int32_t dz = -1; dz <= 1; ++dz)
+		{
+			for (std::int32_t dy = -1; dy <= 1; ++dy)
+			{
+				for (std::int32_t dx = -1; dx <= 1; ++dx)
+				{
+					std::int32_t x = c.x + dx;
+					std::int32_t y = c.y + dy;
+					std::int32_t z = c.z + dz;
+					uint32 h = Hash(x, y, z);
+
+					for (uint32 k = mCellStart[h]; k < mCellStart[h + 1]; ++k)
+					{
+						uint32 j = mEntries[k];
+
+						// Different cells can share a bucket, so compare the actual
+						// cell as well.  Each j lives in exactly one cell, which keeps
+						// every pair unique.
+						const Cell& o = mCells[j];
+						if (j > i && o.x == x && o.y == y && o.z == z)
+							pairs.emplace_back(i, j);
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <DirectXMath.h>
+#include <utility>
+#include <vector>
+
+// Uniform grid broadphase.  Positions are bucketed into cubic cells of side
+// mCellSize and hashed into a flat table that is rebuilt every tick with a
+// counting sort, so building and querying allocate nothing once the vectors
+// have grown to the entity count.  Any two points no farther apart than
+// mCellSize on every axis end up in the same or in neighbouring cells, so
+// the pairs reported by FindPairs are a superset of the pairs that can
+// overlap.
+class SpatialHash
+{
+public:
+	using uint32 = std::uint32_t;
+	using Pair = std::pair<uint32, uint32>;
+
+	SpatialHash(float cellSize);
+
+	void									Build(const std::vector<DirectX::XMFLOAT3>& positions);
+
+	// Appends every candidate pair (i, j) with i < j, each pair exactly once.
+	void									FindPairs(std::vector<Pair>& pairs) const;
+
+	float									GetCellSize() const;
+
+private:
+	struct Cell
+	{
+		std::int32_t x;
+		std::int32_t y;
+		std::int32_t z;
+	};
+
+	uint32									Hash(std::int32_t x, std::int32_t y, std::int32_t z) const;
+
+	float									mCellSize;
+	float									mInvCellSize;
+	uint32									mTableMask = 0;
+
+	// mCellStart[h] .. mCellStart[h + 1] is the range of mEntries hashed to bucket h.
+	std::vector<uint32>						mCellStart;
+	std::vector<uint32>						mEntries;
+	std::vector<Cell>						mCells;
+};
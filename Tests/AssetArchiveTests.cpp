@@ -0,0 +1,233 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include "Check.h"
+#include "../AssetArchive.h"
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	std::string TempPath(const char* name)
+	{
+		return (std::filesystem::temp_directory_path() / name).string();
+	}
+
+	std::vector<std::byte> ReadBytes(const std::string& path)
+	{
+		std::ifstream fin(path, std::ios::binary);
+		std::vector<char> chars((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+		std::vector<std::byte> bytes(chars.size());
+		if (!chars.empty())
+			std::memcpy(bytes.data(), chars.data(), chars.size());
+		return bytes;
+	}
+
+	void WriteBytes(const std::string& path, const std::vector<std::byte>& bytes)
+	{
+		std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+		fout.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize)bytes.size());
+	}
+
+	template<typename T>
+	std::span<const std::byte> AsBytes(const std::vector<T>& values)
+	{
+		return std::as_bytes(std::span<const T>(values));
+	}
+
+	// A 16-bit mesh with two submeshes, a 32-bit mesh with none and a
+	// texture, in an order that is not the hash order of the names.
+	struct TestAssets
+	{
+		std::vector<float> Vertices = std::vector<float>(5 * 7);
+		std::vector<std::uint16_t> Indices16 = { 0, 1, 2, 2, 1, 3, 4, 3, 1 };
+		std::vector<float> Vertices32 = std::vector<float>(3 * 3, 2.0f);
+		std::vector<uint32> Indices32 = { 0, 1, 2 };
+		std::vector<std::uint8_t> Dds = std::vector<std::uint8_t>(77);
+
+		TestAssets()
+		{
+			for (size_t i = 0; i < Vertices.size(); i++)
+				Vertices[i] = (float)i * 0.5f;
+			for (size_t i = 0; i < Dds.size(); i++)
+				Dds[i] = (std::uint8_t)(i * 3);
+		}
+
+		void Add(AssetArchiveBuilder& builder) const
+		{
+			AssetArchiveBuilder::Submesh hull;
+			hull.Name = "hull";
+			hull.IndexCount = 6;
+			hull.BoundsCenter[1] = 1.5f;
+			AssetArchiveBuilder::Submesh wing;
+			wing.Name = "wing";
+			wing.IndexCount = 3;
+			wing.StartIndexLocation = 6;
+			wing.BaseVertexLocation = 1;
+			wing.BoundsExtents[2] = 4.0f;
+			builder.AddMesh("ship", 20, AsBytes(Vertices), 2, AsBytes(Indices16), { hull, wing });
+			builder.AddTexture("ship.dds", AsBytes(Dds));
+			builder.AddMesh("rock", 12, AsBytes(Vertices32), 4, AsBytes(Indices32), {});
+		}
+	};
+
+	bool Aligned(const void* p)
+	{
+		return reinterpret_cast<std::uintptr_t>(p) % AssetArchive::BlobAlignment == 0;
+	}
+
+	void TestRoundTrip()
+	{
+		TestAssets assets;
+		AssetArchiveBuilder builder;
+		assets.Add(builder);
+		CHECK(builder.GetEntryCount() == 3);
+
+		std::string path = TempPath("AssetArchiveTests.pak");
+		CHECK(builder.Write(path.c_str()));
+		CHECK(!std::filesystem::exists(path + ".tmp"));
+
+		AssetArchive archive;
+		CHECK(archive.Open(path.c_str()));
+		CHECK(archive.GetEntries().size() == 3);
+		for (size_t i = 1; i < archive.GetEntries().size(); i++)
+			CHECK(archive.GetEntries()[i - 1].NameHash <= archive.GetEntries()[i].NameHash);
+
+		CHECK(archive.Find("missing") == nullptr);
+		CHECK(archive.Find("shi") == nullptr);
+		const ArchiveEntry* ship = archive.Find("ship");
+		const ArchiveEntry* texture = archive.Find("ship.dds");
+		const ArchiveEntry* rock = archive.Find("rock");
+		CHECK(ship != nullptr && texture != nullptr && rock != nullptr);
+		if (ship == nullptr || texture == nullptr || rock == nullptr)
+			return;
+		CHECK(archive.GetName(ship->NameOffset) == "ship");
+		CHECK(ship->NameHash == AssetArchive::HashName("ship"));
+		CHECK(ship->Type == ArchiveAssetType::Mesh);
+		CHECK(texture->Type == ArchiveAssetType::Texture);
+
+		AssetArchive::MeshView mesh;
+		CHECK(archive.GetMesh(*ship, mesh));
+		CHECK(mesh.Header->VertexByteStride == 20 && mesh.Header->VertexCount == 7);
+		CHECK(mesh.Header->IndexByteStride == 2 && mesh.Header->IndexCount == 9);
+		CHECK(mesh.Vertices.size() == assets.Vertices.size() * sizeof(float));
+		CHECK(std::memcmp(mesh.Vertices.data(), assets.Vertices.data(), mesh.Vertices.size()) == 0);
+		CHECK(mesh.Indices.size() == assets.Indices16.size() * 2);
+		CHECK(std::memcmp(mesh.Indices.data(), assets.Indices16.data(), mesh.Indices.size()) == 0);
+		CHECK(Aligned(mesh.Header) && Aligned(mesh.Vertices.data()) && Aligned(mesh.Indices.data()) && Aligned(mesh.Submeshes.data()));
+
+		CHECK(mesh.Submeshes.size() == 2);
+		if (mesh.Submeshes.size() == 2)
+		{
+			CHECK(archive.GetName(mesh.Submeshes[0].NameOffset) == "hull");
+			CHECK(archive.GetName(mesh.Submeshes[1].NameOffset) == "wing");
+			CHECK(mesh.Submeshes[0].IndexCount == 6 && mesh.Submeshes[0].BoundsCenter[1] == 1.5f);
+			CHECK(mesh.Submeshes[1].StartIndexLocation == 6 && mesh.Submeshes[1].BaseVertexLocation == 1);
+			CHECK(mesh.Submeshes[1].BoundsExtents[2] == 4.0f);
+		}
+
+		CHECK(archive.GetMesh(*rock, mesh));
+		CHECK(mesh.Header->IndexByteStride == 4 && mesh.Header->IndexCount == 3);
+		CHECK(mesh.Submeshes.empty());
+
+		// A texture is its DDS bytes as is, and not a mesh.
+		std::span<const std::byte> dds = archive.GetBlob(*texture);
+		CHECK(dds.size() == assets.Dds.size());
+		CHECK(std::memcmp(dds.data(), assets.Dds.data(), dds.size()) == 0);
+		CHECK(Aligned(dds.data()));
+		CHECK(!archive.GetMesh(*texture, mesh));
+
+		archive.Close();
+		CHECK(archive.GetEntries().empty());
+		CHECK(archive.Find("ship") == nullptr);
+		std::filesystem::remove(path);
+	}
+
+	void TestDuplicateName()
+	{
+		TestAssets assets;
+		AssetArchiveBuilder builder;
+		assets.Add(builder);
+		builder.AddTexture("rock", AsBytes(assets.Dds));
+		std::string path = TempPath("AssetArchiveTests.pak");
+		std::filesystem::remove(path);
+		CHECK(!builder.Write(path.c_str()));
+		CHECK(!std::filesystem::exists(path));
+	}
+
+	// Files that are not archives, or whose tables point outside the file or
+	// the blob, do not open or do not give a mesh.
+	void TestInvalid()
+	{
+		TestAssets assets;
+		AssetArchiveBuilder builder;
+		assets.Add(builder);
+		std::string path = TempPath("AssetArchiveTests.pak");
+		CHECK(builder.Write(path.c_str()));
+		const std::vector<std::byte> original = ReadBytes(path);
+
+		AssetArchive archive;
+		std::filesystem::remove(path);
+		CHECK(!archive.Open(path.c_str()));
+
+		std::vector<std::byte> bytes = original;
+		bytes[0] = std::byte{ 'X' };
+		WriteBytes(path, bytes);
+		CHECK(!archive.Open(path.c_str()));
+
+		WriteBytes(path, std::vector<std::byte>(original.begin(), original.end() - 1));
+		CHECK(!archive.Open(path.c_str()));
+		WriteBytes(path, std::vector<std::byte>(original.begin(), original.begin() + sizeof(ArchiveHeader) - 1));
+		CHECK(!archive.Open(path.c_str()));
+
+		// An entry whose blob ends past the file.
+		ArchiveHeader header;
+		std::memcpy(&header, original.data(), sizeof(header));
+		bytes = original;
+		std::uint64_t hugeSize = ~0ull - 8;
+		std::memcpy(&bytes[(std::size_t)header.TocOffset + offsetof(ArchiveEntry, Size)], &hugeSize, sizeof(hugeSize));
+		WriteBytes(path, bytes);
+		CHECK(!archive.Open(path.c_str()));
+
+		// A submesh past the indices of its mesh.
+		WriteBytes(path, original);
+		CHECK(archive.Open(path.c_str()));
+		const ArchiveEntry* ship = archive.Find("ship");
+		CHECK(ship != nullptr);
+		if (ship == nullptr)
+			return;
+		AssetArchive::MeshView mesh;
+		CHECK(archive.GetMesh(*ship, mesh));
+		std::size_t wing = (std::size_t)(ship->Offset + mesh.Header->SubmeshesOffset + sizeof(ArchiveSubmesh));
+		archive.Close();
+
+		bytes = original;
+		uint32 indexCount = 4;
+		std::memcpy(&bytes[wing + offsetof(ArchiveSubmesh, IndexCount)], &indexCount, sizeof(indexCount));
+		WriteBytes(path, bytes);
+		CHECK(archive.Open(path.c_str()));
+		ship = archive.Find("ship");
+		CHECK(ship != nullptr && !archive.GetMesh(*ship, mesh));
+
+		bytes = original;
+		std::int32_t baseVertex = 8;
+		std::memcpy(&bytes[wing + offsetof(ArchiveSubmesh, BaseVertexLocation)], &baseVertex, sizeof(baseVertex));
+		WriteBytes(path, bytes);
+		CHECK(archive.Open(path.c_str()));
+		ship = archive.Find("ship");
+		CHECK(ship != nullptr && !archive.GetMesh(*ship, mesh));
+
+		archive.Close();
+		std::filesystem::remove(path);
+	}
+}
+
+int main()
+{
+	TestRoundTrip();
+	TestDuplicateName();
+	TestInvalid();
+	return Test::Result("AssetArchiveTests");
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdio>
+
+// Checks for the test executables.  A failed CHECK prints the expression and
+// where it is, and the test goes on; Test::Result, returned from main, makes
+// the executable fail under ctest if any CHECK did.
+namespace Test
+{
+	inline int& Failures()
+	{
+		static int failures = 0;
+		return failures;
+	}
+
+	inline int Result(const char* name)
+	{
+		if (Failures() == 0)
+			printf("%s: passed\n", name);
+		else
+			printf("%s: %d check(s) failed\n", name, Failures());
+		return Failures() == 0 ? 0 : 1;
+	}
+}
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			fprintf(stderr, "%s(%d): CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			Test::Failures()++; \
+		} \
+	} while (0)
@@ -0,0 +1,218 @@
+#include <set>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "Check.h"
+#include "../CreateGeometry.h"
+
+using namespace DirectX;
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using Mesh = CreateGeometry::BasicMeshData<VertexFormats::Position>;
+
+	// Twice the signed area vector of triangle t.
+	XMVECTOR TriangleNormal(const Mesh& mesh, uint32 t)
+	{
+		XMVECTOR p0 = XMLoadFloat3(&mesh.Vertices[mesh.Indices32[t * 3 + 0]].Position);
+		XMVECTOR p1 = XMLoadFloat3(&mesh.Vertices[mesh.Indices32[t * 3 + 1]].Position);
+		XMVECTOR p2 = XMLoadFloat3(&mesh.Vertices[mesh.Indices32[t * 3 + 2]].Position);
+		return XMVector3Cross(p1 - p0, p2 - p0);
+	}
+
+	uint32 CountEdges(const Mesh& mesh)
+	{
+		std::set<std::pair<uint32, uint32>> edges;
+		for (size_t i = 0; i < mesh.Indices32.size(); i += 3)
+		{
+			for (uint32 k = 0; k < 3; k++)
+			{
+				uint32 a = mesh.Indices32[i + k];
+				uint32 b = mesh.Indices32[i + (k + 1) % 3];
+				edges.insert(a < b ? std::make_pair(a, b) : std::make_pair(b, a));
+			}
+		}
+		return (uint32)edges.size();
+	}
+
+	// A box face is a 2-triangle square with its own 4 vertices.  Split n
+	// times it is a (2^n + 1)^2 vertex grid of 2 * 4^n triangles, and as a
+	// disc V - E + F = 1, so E = V + F - 1.
+	void TestBoxCounts()
+	{
+		CreateGeometry geometry;
+		for (uint32 level = 0; level <= 6; level++)
+		{
+			Mesh mesh = geometry.CreateBox(2.0f, 2.0f, 2.0f, level, VertexFormats::Position());
+			uint32 side = (1u << level) + 1;
+			uint32 faceVertices = side * side;
+			uint32 faceTriangles = 2u << (2 * level);
+
+			CHECK(mesh.Vertices.size() == 6 * faceVertices);
+			CHECK(mesh.Indices32.size() == 3 * 6 * faceTriangles);
+			CHECK(CountEdges(mesh) == 6 * (faceVertices + faceTriangles - 1));
+		}
+	}
+
+	// Six pyramid triangles with their own vertices (the base is a square of
+	// two): every triangle alone adds 3 vertices and 3 edges per edge split.
+	void TestPyramidCounts()
+	{
+		CreateGeometry geometry;
+		for (uint32 level = 0; level <= 4; level++)
+		{
+			Mesh mesh = geometry.CreatePyramide(2.0f, 2.0f, 2.0f, level, VertexFormats::Position());
+			uint32 parts = 1u << level;
+			// A triangle split n times: (2^n + 1)(2^n + 2) / 2 vertices,
+			// 4^n triangles, 3 * 4^n / 2 + 3 * 2^n / 2 edges.
+			uint32 triVertices = (parts + 1) * (parts + 2) / 2;
+			uint32 triTriangles = parts * parts;
+			uint32 triEdges = 3 * parts * (parts + 1) / 2;
+			uint32 squareVertices = (parts + 1) * (parts + 1);
+			uint32 squareTriangles = 2 * parts * parts;
+
+			CHECK(mesh.Vertices.size() == 4 * triVertices + squareVertices);
+			CHECK(mesh.Indices32.size() == 3 * (4 * triTriangles + squareTriangles));
+			CHECK(CountEdges(mesh) == 4 * triEdges + squareVertices + squareTriangles - 1);
+		}
+	}
+
+	// Every child triangle faces the way its level 0 parent does, and the
+	// children cover exactly the parent's area.  Subdivide writes the four
+	// children of triangle t at 4t..4t+3, so after n levels triangle t comes
+	// from t >> 2n.
+	void TestWindingPreserved()
+	{
+		CreateGeometry geometry;
+		Mesh shapes[2] =
+		{
+			geometry.CreateBox(2.0f, 3.0f, 4.0f, 0, VertexFormats::Position()),
+			geometry.CreatePyramide(2.0f, 3.0f, 4.0f, 0, VertexFormats::Position())
+		};
+		Mesh subdivided[2] =
+		{
+			geometry.CreateBox(2.0f, 3.0f, 4.0f, 4, VertexFormats::Position()),
+			geometry.CreatePyramide(2.0f, 3.0f, 4.0f, 4, VertexFormats::Position())
+		};
+		const uint32 shift = 2 * 4;
+
+		for (uint32 s = 0; s < 2; s++)
+		{
+			uint32 parentCount = (uint32)shapes[s].Indices32.size() / 3;
+			std::vector<XMFLOAT3> areaSums(parentCount, XMFLOAT3(0.0f, 0.0f, 0.0f));
+			uint32 flipped = 0;
+			for (uint32 t = 0; t < subdivided[s].Indices32.size() / 3; t++)
+			{
+				uint32 parent = t >> shift;
+				XMVECTOR child = TriangleNormal(subdivided[s], t);
+				if (XMVectorGetX(XMVector3Dot(child, TriangleNormal(shapes[s], parent))) <= 0.0f)
+					flipped++;
+				XMStoreFloat3(&areaSums[parent], XMLoadFloat3(&areaSums[parent]) + child);
+			}
+			CHECK(flipped == 0);
+
+			for (uint32 p = 0; p < parentCount; p++)
+			{
+				XMVECTOR expected = TriangleNormal(shapes[s], p);
+				XMVECTOR difference = XMLoadFloat3(&areaSums[p]) - expected;
+				CHECK(XMVectorGetX(XMVector3Length(difference)) < 1e-4f * XMVectorGetX(XMVector3Length(expected)));
+			}
+		}
+	}
+
+	// Welding: no two vertices of a box face share a position.
+	void TestNoDuplicateVertices()
+	{
+		CreateGeometry geometry;
+		Mesh mesh = geometry.CreateBox(2.0f, 2.0f, 2.0f, 3, VertexFormats::Position());
+
+		// Vertices are per face at level 0; the midpoints of one face only
+		// ever come from its own vertices, so position plus face is unique.
+		std::set<std::pair<uint32, std::tuple<float, float, float>>> seen;
+		std::vector<uint32> face(mesh.Vertices.size(), UINT32_MAX);
+		for (uint32 t = 0; t < mesh.Indices32.size() / 3; t++)
+		{
+			for (uint32 k = 0; k < 3; k++)
+				face[mesh.Indices32[t * 3 + k]] = t >> (2 * 3 + 1);
+		}
+		uint32 duplicates = 0;
+		for (uint32 v = 0; v < mesh.Vertices.size(); v++)
+		{
+			const XMFLOAT3& p = mesh.Vertices[v].Position;
+			if (!seen.insert({ face[v], std::make_tuple(p.x, p.y, p.z) }).second)
+				duplicates++;
+		}
+		CHECK(duplicates == 0);
+	}
+
+	// The full vertex format goes through the same path; its normals stay on
+	// the face and its counts match the position-only mesh.
+	void TestDefaultFormatMatches()
+	{
+		CreateGeometry geometry;
+		CreateGeometry::MeshData full = geometry.CreateBox(2.0f, 2.0f, 2.0f, 3);
+		Mesh positions = geometry.CreateBox(2.0f, 2.0f, 2.0f, 3, VertexFormats::Position());
+		CHECK(full.Vertices.size() == positions.Vertices.size());
+		CHECK(full.Indices32 == positions.Indices32);
+
+		uint32 offFace = 0;
+		for (const CreateGeometry::Vertex& v : full.Vertices)
+		{
+			float length = XMVectorGetX(XMVector3Length(XMLoadFloat3(&v.Normal)));
+			if (length < 0.999f || length > 1.001f)
+				offFace++;
+		}
+		CHECK(offFace == 0);
+	}
+
+	uint32 TriangleCount(const Mesh& mesh)
+	{
+		return (uint32)mesh.Indices32.size() / 3;
+	}
+
+	// Every level of a LOD chain has fewer triangles than the one before,
+	// level 0 is the mesh the plain generator builds, and a chain stops once
+	// it cannot get any coarser.
+	void TestLodChainsGetCoarser()
+	{
+		CreateGeometry geometry;
+		VertexFormats::Position format;
+		const uint32 levelCount = 5;
+		std::vector<std::vector<Mesh>> chains = {
+			geometry.CreateBoxLods(1.0f, 1.0f, 1.0f, 3, levelCount, format),
+			geometry.CreatePyramideLods(1.0f, 1.0f, 1.0f, 3, levelCount, format),
+			geometry.CreateSphereLods(1.0f, 40, 20, levelCount, format),
+			geometry.CreateCylinderLods(0.5f, 0.5f, 2.0f, 380, 250, levelCount, format),
+			geometry.CreateGridLods(10.0f, 10.0f, 64, 64, levelCount, format)
+		};
+		// Three subdivisions leave four levels, down to the plain box.
+		const size_t expectedLevels[] = { 4, 4, levelCount, levelCount, levelCount };
+		for (size_t c = 0; c < chains.size(); c++)
+		{
+			CHECK(chains[c].size() == expectedLevels[c]);
+			for (size_t level = 1; level < chains[c].size(); level++)
+				CHECK(TriangleCount(chains[c][level]) < TriangleCount(chains[c][level - 1]));
+		}
+		CHECK(TriangleCount(chains[2][0]) == TriangleCount(geometry.CreateSphere(1.0f, 40, 20, format)));
+		CHECK(TriangleCount(chains[3][0]) == TriangleCount(geometry.CreateCylinder(0.5f, 0.5f, 2.0f, 380, 250, format)));
+
+		// One subdivision has only one coarser level left; a 4x4 grid halves
+		// once to 2x2 and stops there.
+		CHECK(geometry.CreateBoxLods(1.0f, 1.0f, 1.0f, 1, levelCount, format).size() == 2);
+		std::vector<Mesh> grid = geometry.CreateGridLods(1.0f, 1.0f, 4, 4, levelCount, format);
+		CHECK(grid.size() == 2);
+		CHECK(TriangleCount(grid[1]) < TriangleCount(grid[0]));
+	}
+}
+
+int main()
+{
+	TestBoxCounts();
+	TestPyramidCounts();
+	TestWindingPreserved();
+	TestNoDuplicateVertices();
+	TestDefaultFormatMatches();
+	TestLodChainsGetCoarser();
+	return Test::Result("CreateGeometryTests");
+}
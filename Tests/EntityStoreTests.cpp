@@ -0,0 +1,134 @@
+#include "Check.h"
+#include "../EntityStore.h"
+
+using namespace DirectX;
+
+namespace
+{
+	const XMFLOAT4 NoRotation(0.0f, 0.0f, 0.0f, 1.0f);
+
+	EntityHandle AddAt(EntityStore& store, EntityKind kind, float z)
+	{
+		return store.Add(kind, 0, XMFLOAT3(0.0f, 0.0f, z), NoRotation);
+	}
+
+	void TestHandlesFollowSwapAndPop()
+	{
+		EntityStore store;
+		store.CreatePool(EntityKind::Asteroid, 4);
+		EntityHandle a = AddAt(store, EntityKind::Asteroid, 1.0f);
+		EntityHandle b = AddAt(store, EntityKind::Asteroid, 2.0f);
+		EntityHandle c = AddAt(store, EntityKind::Asteroid, 3.0f);
+
+		// c moves into the hole a leaves.
+		store.Remove(a);
+		CHECK(store.Size() == 2);
+		CHECK(!store.IsAlive(a));
+		CHECK(store.IsAlive(b) && store.IsAlive(c));
+		CHECK(store.IndexOf(c) == 0);
+		CHECK(store.Position[store.IndexOf(c)].z == 3.0f);
+		CHECK(store.Position[store.IndexOf(b)].z == 2.0f);
+		CHECK(store.HandleAt(store.IndexOf(b)).Index == b.Index);
+	}
+
+	void TestReusedSlotRejectsOldHandle()
+	{
+		EntityStore store;
+		store.CreatePool(EntityKind::Projectile, 1);
+		EntityHandle first = AddAt(store, EntityKind::Projectile, 1.0f);
+		store.Remove(first);
+		EntityHandle second = AddAt(store, EntityKind::Projectile, 2.0f);
+
+		CHECK(second.Index == first.Index);
+		CHECK(second.Generation != first.Generation);
+		CHECK(!store.IsAlive(first));
+		CHECK(store.IsAlive(second));
+		// Removing through the stale handle must not touch the new entity.
+		store.Remove(first);
+		CHECK(store.Size() == 1 && store.IsAlive(second));
+	}
+
+	void TestFreeSlotsAreNeverAlive()
+	{
+		EntityStore store;
+		store.CreatePool(EntityKind::Asteroid, 3);
+		EntityHandle a = AddAt(store, EntityKind::Asteroid, 1.0f);
+
+		CHECK(!store.IsAlive(EntityHandle()));
+		// Handles that were never issued, to slots that were never used or
+		// were freed, with the generation those slots currently have.
+		for (std::uint32_t slot = 0; slot < store.SlotCount(); slot++)
+		{
+			if (slot != a.Index)
+				CHECK(!store.IsAlive({ slot, 0 }));
+		}
+		store.Remove(a);
+		CHECK(!store.IsAlive({ a.Index, a.Generation + 1 }));
+		CHECK(!store.IsAlive({ store.SlotCount(), 0 }));
+	}
+
+	void TestPoolsAreSeparate()
+	{
+		EntityStore store;
+		store.CreatePool(EntityKind::Player, 1);
+		store.CreatePool(EntityKind::Asteroid, 2);
+
+		EntityHandle player = AddAt(store, EntityKind::Player, 0.0f);
+		CHECK(store.IsAlive(player));
+		CHECK(!store.IsAlive(AddAt(store, EntityKind::Player, 0.0f)));
+		CHECK(store.IsAlive(AddAt(store, EntityKind::Asteroid, 1.0f)));
+		CHECK(store.IsAlive(AddAt(store, EntityKind::Asteroid, 2.0f)));
+		CHECK(!store.IsAlive(AddAt(store, EntityKind::Asteroid, 3.0f)));
+		CHECK(store.Size() == 3);
+
+		// Clearing hands every slot back to its own pool.
+		store.Clear();
+		CHECK(store.Size() == 0 && !store.IsAlive(player));
+		CHECK(store.IsAlive(AddAt(store, EntityKind::Player, 0.0f)));
+		CHECK(store.IsAlive(AddAt(store, EntityKind::Asteroid, 1.0f)));
+		CHECK(store.IsAlive(AddAt(store, EntityKind::Asteroid, 2.0f)));
+		CHECK(!store.IsAlive(AddAt(store, EntityKind::Asteroid, 3.0f)));
+	}
+
+	// Counts follow Add, Remove, swap-and-pop and a full pool.
+	void TestCountsPerKind()
+	{
+		EntityStore store;
+		store.CreatePool(EntityKind::Player, 1);
+		store.CreatePool(EntityKind::Asteroid, 3);
+		store.CreatePool(EntityKind::Projectile, 2);
+		CHECK(store.Count(EntityKind::Asteroid) == 0);
+
+		AddAt(store, EntityKind::Player, 0.0f);
+		EntityHandle a = AddAt(store, EntityKind::Asteroid, 1.0f);
+		AddAt(store, EntityKind::Asteroid, 2.0f);
+		EntityHandle p = AddAt(store, EntityKind::Projectile, 3.0f);
+		AddAt(store, EntityKind::Asteroid, 4.0f);
+		AddAt(store, EntityKind::Asteroid, 5.0f);
+		CHECK(store.Count(EntityKind::Player) == 1);
+		CHECK(store.Count(EntityKind::Asteroid) == 3);
+		CHECK(store.Count(EntityKind::Projectile) == 1);
+
+		// The last entity, an asteroid, is swapped into the projectile's place.
+		store.Remove(p);
+		store.Remove(a);
+		store.Remove(a);
+		CHECK(store.Count(EntityKind::Asteroid) == 2);
+		CHECK(store.Count(EntityKind::Projectile) == 0);
+		CHECK(store.Count(EntityKind::Player) == 1);
+
+		store.Clear();
+		for (std::uint32_t kind = 0; kind < EntityKindCount; kind++)
+			CHECK(store.Count((EntityKind)kind) == 0);
+	}
+}
+
+int main()
+{
+	TestHandlesFollowSwapAndPop();
+	TestReusedSlotRejectsOldHandle();
+	TestFreeSlotsAreNeverAlive();
+	TestPoolsAreSeparate();
+	TestCountsPerKind();
+	return Test::Result("EntityStoreTests");
+}
@@ -0,0 +1,126 @@
+#include "Check.h"
+#include "../FrameScheduler.h"
+
+namespace
+{
+	// The GPU finishes every frame as soon as it is submitted.
+	void TestNoBlockWhileGpuKeepsUp()
+	{
+		MockGpuFence fence;
+		FrameScheduler scheduler(&fence, 3);
+		for (std::uint32_t frame = 0; frame < 10; frame++)
+		{
+			CHECK(scheduler.BeginFrame() == frame % 3);
+			fence.Complete(scheduler.EndFrame());
+		}
+		CHECK(fence.GetWaitCount() == 0);
+	}
+
+	// Resources that were never submitted are free, even with the GPU idle.
+	void TestFirstPassNeverBlocks()
+	{
+		MockGpuFence fence;
+		FrameScheduler scheduler(&fence, 3);
+		for (std::uint32_t frame = 0; frame < 3; frame++)
+		{
+			CHECK(scheduler.GetFrameFence(frame) == 0);
+			CHECK(scheduler.BeginFrame() == frame);
+			scheduler.EndFrame();
+		}
+		CHECK(fence.GetWaitCount() == 0);
+		CHECK(fence.GetCompletedValue() == 0);
+	}
+
+	// The GPU makes no progress on its own: reusing a resource waits for the
+	// frame that last used it, and for no later one.
+	void TestBlocksOnResourceInFlight()
+	{
+		MockGpuFence fence;
+		FrameScheduler scheduler(&fence, 3);
+		for (std::uint32_t frame = 0; frame < 3; frame++)
+		{
+			scheduler.BeginFrame();
+			CHECK(scheduler.EndFrame() == frame + 1);
+		}
+
+		CHECK(scheduler.BeginFrame() == 0);
+		CHECK(fence.GetWaitCount() == 1);
+		CHECK(fence.GetCompletedValue() == 1);
+		scheduler.EndFrame();
+
+		CHECK(scheduler.BeginFrame() == 1);
+		CHECK(fence.GetWaitCount() == 2);
+		CHECK(fence.GetCompletedValue() == 2);
+		scheduler.EndFrame();
+	}
+
+	// Only the resources the GPU has not released yet block.
+	void TestPartialProgress()
+	{
+		MockGpuFence fence;
+		FrameScheduler scheduler(&fence, 3);
+		for (std::uint32_t frame = 0; frame < 3; frame++)
+		{
+			scheduler.BeginFrame();
+			scheduler.EndFrame();
+		}
+		fence.Complete(1);
+
+		scheduler.BeginFrame();
+		CHECK(fence.GetWaitCount() == 0);
+		scheduler.EndFrame();
+		scheduler.BeginFrame();
+		CHECK(fence.GetWaitCount() == 1);
+		CHECK(fence.GetCompletedValue() == 2);
+	}
+
+	// A reused resource is guarded by the fence of its latest frame, not the
+	// one it had the first time around.
+	void TestFenceValueIsReplacedOnReuse()
+	{
+		MockGpuFence fence;
+		FrameScheduler scheduler(&fence, 3);
+		for (std::uint32_t frame = 0; frame < 6; frame++)
+		{
+			if (frame == 3)
+				fence.Complete(3);
+			scheduler.BeginFrame();
+			scheduler.EndFrame();
+		}
+		// Frames 4..6 went to resources 0..2 without waiting.
+		CHECK(fence.GetWaitCount() == 0);
+		CHECK(scheduler.GetFrameFence(0) == 4);
+		CHECK(scheduler.GetFrameFence(1) == 5);
+		CHECK(scheduler.GetFrameFence(2) == 6);
+
+		// Fence 1 of the first pass is long done, fence 4 is not.
+		CHECK(scheduler.BeginFrame() == 0);
+		CHECK(fence.GetWaitCount() == 1);
+		CHECK(fence.GetCompletedValue() == 4);
+	}
+
+	// One resource degenerates to a flush every frame.
+	void TestSingleResourceWaitsEveryFrame()
+	{
+		MockGpuFence fence;
+		FrameScheduler scheduler(&fence, 1);
+		for (std::uint32_t frame = 0; frame < 5; frame++)
+		{
+			CHECK(scheduler.BeginFrame() == 0);
+			CHECK(fence.GetWaitCount() == frame);
+			CHECK(fence.GetCompletedValue() == frame);
+			scheduler.EndFrame();
+		}
+	}
+}
+
+int main()
+{
+	TestNoBlockWhileGpuKeepsUp();
+	TestFirstPassNeverBlocks();
+	TestBlocksOnResourceInFlight();
+	TestPartialProgress();
+	TestFenceValueIsReplacedOnReuse();
+	TestSingleResourceWaitsEveryFrame();
+	return Test::Result("FrameSchedulerTests");
+}
@@ -0,0 +1,203 @@
+#include "Check.h"
+#include "../FrameStats.h"
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	FrameStats::Frame MakeFrame(FrameStats::Phase phase, float milliseconds)
+	{
+		FrameStats::Frame frame;
+		frame.Milliseconds[phase] = milliseconds;
+		return frame;
+	}
+
+	// Nearest rank: p is the smallest value with at least p of the frames at
+	// or below it, never an interpolation between two frames.
+	void TestPercentile()
+	{
+		FrameStats stats;
+		FrameStats::Summary empty = stats.Summarize(FrameStats::Sim);
+		CHECK(empty.FrameCount == 0 && empty.Max == 0.0f);
+
+		// 1..100 ms, shuffled so the sort matters.
+		for (uint32 i = 0; i < 100; i++)
+			stats.AddFrame(MakeFrame(FrameStats::Sim, (float)((i * 37) % 100 + 1)));
+		FrameStats::Summary summary = stats.Summarize(FrameStats::Sim);
+		CHECK(summary.FrameCount == 100);
+		CHECK(summary.Mean == 50.5f);
+		CHECK(summary.P50 == 50.0f);
+		CHECK(summary.P95 == 95.0f);
+		CHECK(summary.P99 == 99.0f);
+		CHECK(summary.Max == 100.0f);
+
+		// Over 10 frames, p95 and p99 round up to the slowest one.
+		FrameStats few;
+		for (uint32 i = 1; i <= 10; i++)
+			few.AddFrame(MakeFrame(FrameStats::Record, (float)i));
+		summary = few.Summarize(FrameStats::Record);
+		CHECK(summary.P50 == 5.0f);
+		CHECK(summary.P95 == 10.0f && summary.P99 == 10.0f);
+
+		// A single hitch in a hundred frames shows in p99 and max only.
+		FrameStats spike;
+		for (uint32 i = 0; i < 99; i++)
+			spike.AddFrame(MakeFrame(FrameStats::Total, 16.0f));
+		spike.AddFrame(MakeFrame(FrameStats::Total, 80.0f));
+		summary = spike.Summarize(FrameStats::Total);
+		CHECK(summary.P95 == 16.0f && summary.P99 == 16.0f && summary.Max == 80.0f);
+		// Over the last 99 frames it is the top percent.
+		CHECK(spike.Summarize(FrameStats::Total, 99).P99 == 80.0f);
+	}
+
+	// Past Capacity frames the ring drops the oldest ones, GetFrame(0) stays
+	// the oldest kept and Summarize sees only the kept frames.
+	void TestRingWraparound()
+	{
+		FrameStats stats;
+		const uint32 extra = 100;
+		for (uint32 i = 0; i < FrameStats::Capacity + extra; i++)
+			stats.AddFrame(MakeFrame(FrameStats::Sim, (float)i));
+
+		CHECK(stats.GetFrameCount() == FrameStats::Capacity);
+		CHECK(stats.GetTotalFrameCount() == FrameStats::Capacity + extra);
+		CHECK(stats.GetFrame(0).Milliseconds[FrameStats::Sim] == (float)extra);
+		CHECK(stats.GetFrame(FrameStats::Capacity - extra).Milliseconds[FrameStats::Sim] == (float)FrameStats::Capacity);
+		CHECK(stats.GetFrame(FrameStats::Capacity - 1).Milliseconds[FrameStats::Sim] == (float)(FrameStats::Capacity + extra - 1));
+
+		bool ordered = true;
+		for (uint32 i = 0; i < FrameStats::Capacity; i++)
+			ordered = ordered && stats.GetFrame(i).Milliseconds[FrameStats::Sim] == (float)(extra + i);
+		CHECK(ordered);
+
+		FrameStats::Summary summary = stats.Summarize(FrameStats::Sim);
+		CHECK(summary.FrameCount == FrameStats::Capacity);
+		CHECK(summary.Mean == (float)extra + (FrameStats::Capacity - 1) / 2.0f);
+		CHECK(summary.P50 == (float)(extra + FrameStats::Capacity / 2 - 1));
+		CHECK(summary.Max == (float)(FrameStats::Capacity + extra - 1));
+
+		// The last frames, across the point where the ring wrapped.
+		summary = stats.Summarize(FrameStats::Sim, 2 * extra);
+		CHECK(summary.FrameCount == 2 * extra);
+		CHECK(summary.P50 == (float)(FrameStats::Capacity - 1));
+		CHECK(summary.Max == (float)(FrameStats::Capacity + extra - 1));
+
+		// The histogram counts every frame since the start.
+		CHECK(stats.GetHistogram(FrameStats::Sim).GetCount() == FrameStats::Capacity + extra);
+	}
+
+	// Each bucket starts where the previous one ends, a value a quarter of
+	// the way into it falls back into it, and the buckets are within 1/SubBucketCount of their values
+	// from 1 us to a minute.  Longer values clamp to the last bucket.  The low
+	// end round trips too while a float holds it to the microsecond, below
+	// 2^24 us.
+	void TestHistogramBuckets()
+	{
+		using Histogram = FrameStats::Histogram;
+		Histogram ranges;
+		bool contiguous = true;
+		bool roundTrip = true;
+		bool precise = true;
+		for (uint32 bucket = 0; bucket < Histogram::BucketCount; bucket++)
+		{
+			float low = ranges.GetBucketLow(bucket);
+			float high = ranges.GetBucketHigh(bucket);
+			if (bucket > 0)
+				contiguous = contiguous && ranges.GetBucketHigh(bucket - 1) == low;
+			if (bucket >= Histogram::SubBucketCount)
+				precise = precise && (high - low) <= low / Histogram::SubBucketCount * 1.0001f;
+
+			Histogram inside;
+			inside.Add(low + (high - low) / 4.0f);
+			roundTrip = roundTrip && inside.GetBucketCount(bucket) == 1;
+			if (low < (float)(1 << 24) / 1000.0f)
+			{
+				Histogram lowEnd;
+				lowEnd.Add(low);
+				roundTrip = roundTrip && lowEnd.GetBucketCount(bucket) == 1;
+			}
+		}
+		CHECK(contiguous);
+		CHECK(roundTrip);
+		CHECK(precise);
+		CHECK(ranges.GetBucketLow(0) == 0.0f && ranges.GetBucketHigh(0) == 0.001f);
+		CHECK(ranges.GetBucketHigh(Histogram::BucketCount - 1) == (float)(1ull << 26) / 1000.0f);
+
+		// One value per magnitude, just under the next power of two of
+		// microseconds, lands in the last sub-bucket of its magnitude.
+		bool lastSubBucket = true;
+		for (uint32 magnitude = 0; magnitude < Histogram::MagnitudeCount; magnitude++)
+		{
+			uint64 microseconds = ((uint64)Histogram::SubBucketCount << (magnitude + 1)) - 1;
+			uint32 bucket = (magnitude + 2) * Histogram::SubBucketCount - 1;
+			Histogram histogram;
+			histogram.Add((float)(microseconds / 1000.0));
+			lastSubBucket = lastSubBucket && histogram.GetBucketCount(bucket) == 1;
+		}
+		CHECK(lastSubBucket);
+
+		Histogram clamp;
+		clamp.Add(0.0f);
+		clamp.Add(-5.0f);
+		clamp.Add(70000.0f);
+		clamp.Add(3600000.0f);
+		CHECK(clamp.GetBucketCount(0) == 2);
+		CHECK(clamp.GetBucketCount(Histogram::BucketCount - 1) == 2);
+		CHECK(clamp.GetCount() == 4);
+	}
+
+	// GetCountAbove counts the buckets that lie entirely above the value, so
+	// a value in the same bucket as the limit is not counted.
+	void TestCountAbove()
+	{
+		FrameStats::Histogram histogram;
+		for (float milliseconds : { 1.0f, 2.0f, 5.0f, 10.0f, 40.0f })
+			histogram.Add(milliseconds);
+
+		CHECK(histogram.GetCountAbove(0.0f) == 5);
+		CHECK(histogram.GetCountAbove(4.0f) == 3);
+		CHECK(histogram.GetCountAbove(20.0f) == 1);
+		CHECK(histogram.GetCountAbove(10.0f) == 1);
+		CHECK(histogram.GetCountAbove(100.0f) == 0);
+
+		// Percentiles give the upper bound of the bucket holding the rank.
+		CHECK(histogram.GetValueAtPercentile(0.5) >= 5.0f && histogram.GetValueAtPercentile(0.5) <= 5.0f * 17 / 16);
+		CHECK(histogram.GetValueAtPercentile(1.0) >= 40.0f && histogram.GetValueAtPercentile(1.0) <= 40.0f * 17 / 16);
+		CHECK(FrameStats::Histogram().GetValueAtPercentile(0.5) == 0.0f);
+	}
+
+	// A frame is a hitch when its Total goes over the threshold, not when it
+	// reaches it, and the count since the start outlives the ring.
+	void TestHitches()
+	{
+		FrameStats stats;
+		CHECK(stats.GetHitchThreshold() == 1000.0f / 30.0f);
+		stats.SetHitchThreshold(20.0f);
+		for (float milliseconds : { 10.0f, 19.9f, 20.0f, 20.5f, 45.0f })
+			stats.AddFrame(MakeFrame(FrameStats::Total, milliseconds));
+		CHECK(stats.GetHitchCount() == 2);
+		CHECK(stats.Summarize(FrameStats::Total).Hitches == 2);
+		CHECK(stats.Summarize(FrameStats::Total, 2).Hitches == 2);
+		CHECK(stats.Summarize(FrameStats::Total, 1).Hitches == 1);
+
+		// Only Total makes a hitch.
+		stats.AddFrame(MakeFrame(FrameStats::Sim, 100.0f));
+		CHECK(stats.GetHitchCount() == 2);
+
+		for (uint32 i = 0; i < FrameStats::Capacity; i++)
+			stats.AddFrame(MakeFrame(FrameStats::Total, 16.0f));
+		CHECK(stats.Summarize(FrameStats::Total).Hitches == 0);
+		CHECK(stats.GetHitchCount() == 2);
+	}
+}
+
+int main()
+{
+	TestPercentile();
+	TestRingWraparound();
+	TestHistogramBuckets();
+	TestCountAbove();
+	TestHitches();
+	return Test::Result("FrameStatsTests");
+}
@@ -0,0 +1,190 @@
+#include <random>
+#include "Check.h"
+#include "../FrustumCuller.h"
+
+using namespace DirectX;
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	// Camera 10 units back from the origin looking down +z, as BoxApp sets it
+	// up: 45 degree vertical field of view, 4:3, near 1 and far 1000.
+	XMMATRIX ViewProj()
+	{
+		XMMATRIX view = XMMatrixTranslation(0.0f, 0.0f, 10.0f);
+		XMMATRIX proj = XMMatrixPerspectiveFovLH(0.25f * 3.1415926535f, 4.0f / 3.0f, 1.0f, 1000.0f);
+		return XMMatrixMultiply(view, proj);
+	}
+
+	// One sphere at a time against the same planes, in plain floats.
+	std::vector<uint32> CullScalar(const FrustumCuller& culler, FXMMATRIX viewProj)
+	{
+		XMFLOAT4 planes[6];
+		FrustumCuller::ExtractPlanes(viewProj, planes);
+
+		std::vector<uint32> visible;
+		for (uint32 i = 0; i < culler.Size(); i++)
+		{
+			bool inside = true;
+			for (const XMFLOAT4& plane : planes)
+			{
+				float distance = culler.CenterX[i] * plane.x + culler.CenterY[i] * plane.y + culler.CenterZ[i] * plane.z + plane.w;
+				inside = inside && distance >= -culler.Radius[i];
+			}
+			if (inside)
+				visible.push_back(i);
+		}
+		return visible;
+	}
+
+	void FillRandom(FrustumCuller& culler, uint32 count, std::mt19937& rng)
+	{
+		std::uniform_real_distribution<float> position(-400.0f, 400.0f);
+		std::uniform_real_distribution<float> radius(0.1f, 20.0f);
+		culler.Resize(count);
+		for (uint32 i = 0; i < count; i++)
+		{
+			culler.CenterX[i] = position(rng);
+			culler.CenterY[i] = position(rng);
+			culler.CenterZ[i] = position(rng) + 400.0f;
+			culler.Radius[i] = radius(rng);
+		}
+	}
+
+	// The 4-wide path keeps exactly the spheres the scalar loop keeps, in the
+	// same order, for every remainder of the count modulo four.
+	void TestMatchesScalarReference()
+	{
+		std::mt19937 rng(3);
+		XMMATRIX viewProj = ViewProj();
+		for (uint32 count : { 0u, 1u, 2u, 3u, 4u, 5u, 7u, 8u, 13u, 1001u, 20000u })
+		{
+			FrustumCuller culler;
+			FillRandom(culler, count, rng);
+
+			std::vector<uint32> visible;
+			culler.Cull(viewProj, visible);
+			CHECK(visible == CullScalar(culler, viewProj));
+		}
+	}
+
+	// The random set does have spheres on both sides, so the comparison above
+	// is not trivially empty or full.
+	void TestReferenceSetIsMixed()
+	{
+		std::mt19937 rng(3);
+		FrustumCuller culler;
+		FillRandom(culler, 20000, rng);
+		std::vector<uint32> visible;
+		culler.Cull(ViewProj(), visible);
+		CHECK(visible.size() > 1000);
+		CHECK(visible.size() < 19000);
+	}
+
+	// Padding lanes are zero-radius spheres at the origin, which is inside the
+	// frustum, and still must not be reported.
+	void TestPaddingLanesNotReported()
+	{
+		FrustumCuller culler;
+		culler.Resize(5);
+		for (uint32 i = 0; i < 5; i++)
+		{
+			culler.CenterZ[i] = -100.0f;
+			culler.Radius[i] = 1.0f;
+		}
+		culler.CenterZ[4] = 0.0f;
+
+		std::vector<uint32> visible;
+		culler.Cull(ViewProj(), visible);
+		CHECK(visible.size() == 1 && visible[0] == 4);
+	}
+
+	void TestKnownSpheres()
+	{
+		FrustumCuller culler;
+		culler.Resize(6);
+		const float spheres[6][4] =
+		{
+			{ 0.0f, 0.0f, 0.0f, 1.0f },			// in front of the camera
+			{ 0.0f, 0.0f, -20.0f, 1.0f },		// behind it
+			{ 0.0f, 0.0f, -9.5f, 1.0f },		// across the near plane
+			{ 0.0f, 0.0f, 995.0f, 10.0f },		// across the far plane
+			{ 0.0f, 0.0f, 1200.0f, 10.0f },		// past the far plane
+			{ 0.0f, 0.0f, -10.0f, 5000.0f }		// around the whole frustum
+		};
+		for (uint32 i = 0; i < 6; i++)
+		{
+			culler.CenterX[i] = spheres[i][0];
+			culler.CenterY[i] = spheres[i][1];
+			culler.CenterZ[i] = spheres[i][2];
+			culler.Radius[i] = spheres[i][3];
+		}
+
+		std::vector<uint32> visible;
+		culler.Cull(ViewProj(), visible);
+		const std::vector<uint32> expected = { 0, 2, 3, 5 };
+		CHECK(visible == expected);
+	}
+
+	// A sphere just off a side plane is culled, and the same sphere touching
+	// it is kept.  At z = 100 from the camera the frustum is
+	// 100 * tan(22.5 deg) = 41.42 units high.
+	void TestSidePlaneBoundary()
+	{
+		FrustumCuller culler;
+		culler.Resize(2);
+		float halfHeight = 100.0f * 0.41421356f;
+		// Distance from the point (0, h + r / cos(22.5)) to the top plane is r.
+		culler.CenterY[0] = halfHeight + 2.0f / 0.92387953f + 0.05f;
+		culler.CenterY[1] = halfHeight + 2.0f / 0.92387953f - 0.05f;
+		for (uint32 i = 0; i < 2; i++)
+		{
+			culler.CenterZ[i] = 90.0f;
+			culler.Radius[i] = 2.0f;
+		}
+
+		std::vector<uint32> visible;
+		culler.Cull(ViewProj(), visible);
+		CHECK(visible.size() == 1 && visible[0] == 1);
+	}
+
+	// A point is inside every plane exactly when it is inside the clip volume.
+	void TestPlanesMatchClipSpace()
+	{
+		XMMATRIX viewProj = ViewProj();
+		XMFLOAT4 planes[6];
+		FrustumCuller::ExtractPlanes(viewProj, planes);
+
+		std::mt19937 rng(5);
+		std::uniform_real_distribution<float> position(-300.0f, 300.0f);
+		uint32 mismatches = 0;
+		for (uint32 i = 0; i < 10000; i++)
+		{
+			XMVECTOR point = XMVectorSet(position(rng), position(rng), position(rng) + 290.0f, 1.0f);
+			XMVECTOR clip = XMVector4Transform(point, viewProj);
+			float w = XMVectorGetW(clip);
+			bool inClip = XMVectorGetX(clip) >= -w && XMVectorGetX(clip) <= w
+				&& XMVectorGetY(clip) >= -w && XMVectorGetY(clip) <= w
+				&& XMVectorGetZ(clip) >= 0.0f && XMVectorGetZ(clip) <= w;
+
+			bool inPlanes = true;
+			for (const XMFLOAT4& plane : planes)
+				inPlanes = inPlanes && XMVectorGetX(point) * plane.x + XMVectorGetY(point) * plane.y + XMVectorGetZ(point) * plane.z + plane.w >= 0.0f;
+			if (inClip != inPlanes)
+				mismatches++;
+		}
+		CHECK(mismatches == 0);
+	}
+}
+
+int main()
+{
+	TestMatchesScalarReference();
+	TestReferenceSetIsMixed();
+	TestPaddingLanesNotReported();
+	TestKnownSpheres();
+	TestSidePlaneBoundary();
+	TestPlanesMatchClipSpace();
+	return Test::Result("FrustumCullerTests");
+}
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <random>
+#include "Check.h"
+#include "../InstanceBatcher.h"
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	const float NearZ = 1.0f;
+	const float FarZ = 1000.0f;
+
+	uint64 OpaqueKey(uint32 submesh, float depth)
+	{
+		return RenderQueue::MakeKey(RenderLayer::Opaque, 0, 0, submesh, depth, NearZ, FarZ);
+	}
+
+	uint64 TransparentKey(uint32 submesh, float depth)
+	{
+		return RenderQueue::MakeKey(RenderLayer::Transparent, 1, 0, submesh, depth, NearZ, FarZ);
+	}
+
+	// Entities spread over submeshes in no order come out as one batch per
+	// submesh, each covering exactly the slots of its entities.
+	void TestGroupsBySubmesh()
+	{
+		const uint32 submeshCount = 4;
+		const uint32 entityCount = 1000;
+		std::mt19937 rng(11);
+		std::vector<uint32> renderItems(entityCount);
+		std::vector<uint32> slots(entityCount);
+		std::vector<uint32> submeshes(entityCount);
+
+		RenderQueue queue;
+		for (uint32 entity = 0; entity < entityCount; entity++)
+		{
+			submeshes[entity] = rng() % submeshCount;
+			renderItems[entity] = submeshes[entity];
+			// Slots are sparse and in no particular order, as after removals.
+			slots[entity] = (entity * 7919u) % 4096u;
+			queue.Push(OpaqueKey(submeshes[entity], NearZ + (float)(rng() % 900)), entity);
+		}
+		queue.Sort();
+
+		InstanceBatcher batcher;
+		batcher.Build(queue, renderItems, slots);
+		const std::vector<InstanceBatcher::Batch>& batches = batcher.GetBatches();
+		const std::vector<uint32>& instanceSlots = batcher.GetInstanceSlots();
+
+		CHECK(batches.size() == submeshCount);
+		CHECK(instanceSlots.size() == entityCount);
+
+		uint32 next = 0;
+		for (uint32 b = 0; b < batches.size(); b++)
+		{
+			const InstanceBatcher::Batch& batch = batches[b];
+			CHECK(batch.Layer == RenderLayer::Opaque);
+			CHECK(batch.RenderItem == b);
+			CHECK(batch.StartInstance == next);
+
+			std::vector<uint32> expected;
+			for (uint32 entity = 0; entity < entityCount; entity++)
+			{
+				if (submeshes[entity] == b)
+					expected.push_back(slots[entity]);
+			}
+			std::vector<uint32> actual(instanceSlots.begin() + batch.StartInstance,
+				instanceSlots.begin() + batch.StartInstance + batch.InstanceCount);
+			std::sort(expected.begin(), expected.end());
+			std::sort(actual.begin(), actual.end());
+			CHECK(actual == expected);
+			next += batch.InstanceCount;
+		}
+		CHECK(next == entityCount);
+	}
+
+	// The slot list follows the sorted queue one for one, so the instances of
+	// a batch are drawn in the queue's depth order.
+	void TestSlotsPackedInQueueOrder()
+	{
+		std::vector<uint32> renderItems = { 0, 0, 1, 0, 1 };
+		std::vector<uint32> slots = { 40, 10, 30, 20, 50 };
+
+		RenderQueue queue;
+		queue.Push(OpaqueKey(0, 300.0f), 0);
+		queue.Push(OpaqueKey(0, 100.0f), 1);
+		queue.Push(OpaqueKey(1, 50.0f), 2);
+		queue.Push(OpaqueKey(0, 200.0f), 3);
+		queue.Push(OpaqueKey(1, 10.0f), 4);
+		queue.Sort();
+
+		InstanceBatcher batcher;
+		batcher.Build(queue, renderItems, slots);
+
+		const std::vector<uint32> expectedSlots = { 10, 20, 40, 50, 30 };
+		CHECK(batcher.GetInstanceSlots() == expectedSlots);
+		CHECK(batcher.GetBatches().size() == 2);
+		CHECK(batcher.GetBatches()[0].RenderItem == 0);
+		CHECK(batcher.GetBatches()[0].StartInstance == 0);
+		CHECK(batcher.GetBatches()[0].InstanceCount == 3);
+		CHECK(batcher.GetBatches()[1].RenderItem == 1);
+		CHECK(batcher.GetBatches()[1].StartInstance == 3);
+		CHECK(batcher.GetBatches()[1].InstanceCount == 2);
+	}
+
+	// The same submesh in two layers is two batches, one per PSO.
+	void TestLayersSplitBatches()
+	{
+		std::vector<uint32> renderItems = { 0, 0, 0 };
+		std::vector<uint32> slots = { 0, 1, 2 };
+
+		RenderQueue queue;
+		queue.Push(TransparentKey(0, 100.0f), 0);
+		queue.Push(OpaqueKey(0, 100.0f), 1);
+		queue.Push(OpaqueKey(0, 200.0f), 2);
+		queue.Sort();
+
+		InstanceBatcher batcher;
+		batcher.Build(queue, renderItems, slots);
+		CHECK(batcher.GetBatches().size() == 2);
+		CHECK(batcher.GetBatches()[0].Layer == RenderLayer::Opaque);
+		CHECK(batcher.GetBatches()[0].InstanceCount == 2);
+		CHECK(batcher.GetBatches()[1].Layer == RenderLayer::Transparent);
+		CHECK(batcher.GetBatches()[1].InstanceCount == 1);
+	}
+
+	// Building from an empty queue drops the previous frame's batches.
+	void TestEmptyQueue()
+	{
+		std::vector<uint32> renderItems = { 0 };
+		std::vector<uint32> slots = { 0 };
+		RenderQueue queue;
+		queue.Push(OpaqueKey(0, 10.0f), 0);
+		queue.Sort();
+
+		InstanceBatcher batcher;
+		batcher.Build(queue, renderItems, slots);
+		CHECK(batcher.GetBatches().size() == 1);
+
+		queue.Clear();
+		queue.Sort();
+		batcher.Build(queue, renderItems, slots);
+		CHECK(batcher.GetBatches().empty());
+		CHECK(batcher.GetInstanceSlots().empty());
+	}
+}
+
+int main()
+{
+	TestGroupsBySubmesh();
+	TestSlotsPackedInQueueOrder();
+	TestLayersSplitBatches();
+	TestEmptyQueue();
+	return Test::Result("InstanceBatcherTests");
+}
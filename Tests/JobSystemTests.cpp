@@ -0,0 +1,108 @@
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "Check.h"
+#include "../JobSystem.h"
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	// More continuations parked on one counter than the job pool of the
+	// submitting thread has slots: every one must still run, once.
+	void TestManyParkedContinuations()
+	{
+		const uint32 parkedCount = 5 * JobSystem::DequeCapacity;
+		JobSystem jobs(2);
+
+		std::atomic<bool> release{ false };
+		auto gate = [&]()
+		{
+			while (!release.load())
+				std::this_thread::yield();
+		};
+
+		std::vector<std::atomic<uint32>> runs(parkedCount);
+		std::vector<std::function<void()>> continuations;
+		continuations.reserve(parkedCount);
+		for (uint32 i = 0; i < parkedCount; i++)
+			continuations.push_back([&runs, i]() { runs[i].fetch_add(1); });
+
+		JobCounter dependency;
+		JobCounter counter;
+		jobs.Run(dependency, gate);
+		for (uint32 i = 0; i < parkedCount; i++)
+			jobs.RunAfter(dependency, counter, continuations[i]);
+
+		// Jobs submitted while the others are parked take slots of their own.
+		std::atomic<uint32> extra{ 0 };
+		auto work = [&](uint32 begin, uint32 end) { extra.fetch_add(end - begin); };
+		jobs.ParallelFor(0, 100000, 16, work);
+		CHECK(extra.load() == 100000);
+
+		release.store(true);
+		jobs.Wait(dependency);
+		jobs.Wait(counter);
+
+		uint32 wrong = 0;
+		for (uint32 i = 0; i < parkedCount; i++)
+			wrong += runs[i].load() != 1 ? 1 : 0;
+		CHECK(wrong == 0);
+	}
+
+	void TestParallelForCoversRange()
+	{
+		JobSystem jobs(4);
+		std::vector<std::atomic<uint32>> hits(100000);
+		auto visit = [&](uint32 begin, uint32 end)
+		{
+			for (uint32 i = begin; i < end; i++)
+				hits[i].fetch_add(1);
+		};
+		for (uint32 grain : { 1u, 7u, 64u, 100000u })
+		{
+			for (std::atomic<uint32>& hit : hits)
+				hit.store(0);
+			jobs.ParallelFor(0, (uint32)hits.size(), grain, visit);
+
+			uint32 wrong = 0;
+			for (std::atomic<uint32>& hit : hits)
+				wrong += hit.load() != 1 ? 1 : 0;
+			CHECK(wrong == 0);
+		}
+	}
+
+	// A continuation runs after every job of its dependency, and one parked
+	// on a finished counter runs right away.
+	void TestRunAfterOrder()
+	{
+		JobSystem jobs(4);
+		std::atomic<uint32> done{ 0 };
+		uint32 seenByContinuation = 0;
+		auto work = [&](uint32 begin, uint32 end) { done.fetch_add(end - begin); };
+		auto after = [&]() { seenByContinuation = done.load(); };
+
+		JobCounter dependency;
+		JobCounter counter;
+		jobs.ParallelFor(dependency, 0, 50000, 32, work);
+		jobs.RunAfter(dependency, counter, after);
+		jobs.Wait(counter);
+		CHECK(seenByContinuation == 50000);
+
+		bool ran = false;
+		auto mark = [&]() { ran = true; };
+		JobCounter again;
+		jobs.RunAfter(dependency, again, mark);
+		jobs.Wait(again);
+		CHECK(ran);
+	}
+}
+
+int main()
+{
+	TestManyParkedContinuations();
+	TestParallelForCoversRange();
+	TestRunAfterOrder();
+	return Test::Result("JobSystemTests");
+}
@@ -0,0 +1,138 @@
+#include <cmath>
+#include "Check.h"
+#include "../LodSelector.h"
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	// Thresholds 0.4, 0.2, 0.1, 0.05 and 0 with the default 15% hysteresis:
+	// a level refines at 1.15x the threshold above it and coarsens at 0.85x
+	// its own.
+	LodChain MakeTestChain()
+	{
+		return LodSelector::MakeChain(5, 0.4f, 0.5f);
+	}
+
+	// Anywhere within +-15% of a threshold, both neighbouring levels hold.
+	void TestNoFlipNearThreshold()
+	{
+		LodSelector selector;
+		LodChain chain = MakeTestChain();
+		for (uint32 level = 0; level + 1 < chain.LevelCount; level++)
+		{
+			float threshold = chain.MinScreenSize[level];
+			for (float f = 0.86f; f <= 1.14f; f += 0.01f)
+			{
+				CHECK(selector.Select(chain, threshold * f, level) == level);
+				CHECK(selector.Select(chain, threshold * f, level + 1) == level + 1);
+			}
+		}
+	}
+
+	// A size shrinking a little every frame walks down one level at each
+	// threshold, at 0.85x of it, and growing back walks up one level at
+	// 1.15x.
+	void TestOneLevelPerCrossing()
+	{
+		LodSelector selector;
+		LodChain chain = MakeTestChain();
+
+		uint32 lod = 0;
+		uint32 changes = 0;
+		for (float size = 1.0f; size > 0.001f; size *= 0.99f)
+		{
+			uint32 next = selector.Select(chain, size, lod);
+			if (next != lod)
+			{
+				CHECK(next == lod + 1);
+				CHECK(size < chain.MinScreenSize[lod] * 0.85f);
+				CHECK(size / 0.99f >= chain.MinScreenSize[lod] * 0.85f);
+				changes++;
+			}
+			lod = next;
+		}
+		CHECK(lod == chain.LevelCount - 1);
+		CHECK(changes == chain.LevelCount - 1);
+
+		changes = 0;
+		for (float size = 0.001f; size < 1.0f; size *= 1.01f)
+		{
+			uint32 next = selector.Select(chain, size, lod);
+			if (next != lod)
+			{
+				CHECK(next + 1 == lod);
+				CHECK(size >= chain.MinScreenSize[next] * 1.15f);
+				CHECK(size / 1.01f < chain.MinScreenSize[next] * 1.15f);
+				changes++;
+			}
+			lod = next;
+		}
+		CHECK(lod == 0);
+		CHECK(changes == chain.LevelCount - 1);
+	}
+
+	// A size far past several thresholds goes there in one call.
+	void TestJumpsSeveralLevels()
+	{
+		LodSelector selector;
+		LodChain chain = MakeTestChain();
+		CHECK(selector.Select(chain, 0.001f, 0) == 4);
+		CHECK(selector.Select(chain, 0.09f, 0) == 2);
+		CHECK(selector.Select(chain, 10.0f, 4) == 0);
+		CHECK(selector.Select(chain, 0.24f, 4) == 1);
+		// A level past the end of the chain is read as its last level.
+		CHECK(selector.Select(chain, 0.001f, 7) == 4);
+	}
+
+	void TestHysteresisParameter()
+	{
+		LodSelector selector(0.0f);
+		LodChain chain = MakeTestChain();
+		CHECK(selector.Select(chain, 0.4f, 1) == 0);
+		CHECK(selector.Select(chain, 0.399f, 0) == 1);
+	}
+
+	void TestMakeChain()
+	{
+		LodChain chain = MakeTestChain();
+		CHECK(chain.LevelCount == 5);
+		CHECK(chain.MinScreenSize[0] == 0.4f);
+		CHECK(chain.MinScreenSize[1] == 0.2f);
+		CHECK(chain.MinScreenSize[3] == 0.05f);
+		CHECK(chain.MinScreenSize[4] == 0.0f);
+
+		LodChain clamped = LodSelector::MakeChain(MaxLodLevels + 3, 0.4f, 0.5f);
+		CHECK(clamped.LevelCount == MaxLodLevels);
+		CHECK(clamped.MinScreenSize[MaxLodLevels - 1] == 0.0f);
+		for (uint32 i = 0; i + 2 < MaxLodLevels; i++)
+			CHECK(clamped.MinScreenSize[i] > clamped.MinScreenSize[i + 1]);
+
+		LodChain single = LodSelector::MakeChain(0, 0.4f, 0.5f);
+		CHECK(single.LevelCount == 1);
+		CHECK(single.MinScreenSize[0] == 0.0f);
+		CHECK(LodSelector().Select(single, 100.0f, 0) == 0);
+		CHECK(LodSelector().Select(single, 0.0f, 0) == 0);
+	}
+
+	void TestScreenSize()
+	{
+		CHECK(std::fabs(LodSelector::ScreenSize(1.0f, 10.0f, 2.0f) - 0.2f) < 1e-6f);
+		CHECK(LodSelector::ScreenSize(1.0f, 20.0f, 2.0f) < LodSelector::ScreenSize(1.0f, 10.0f, 2.0f));
+		// At or behind the eye the size stays finite and as large as it gets.
+		CHECK(std::isfinite(LodSelector::ScreenSize(1.0f, -5.0f, 2.0f)));
+		CHECK(LodSelector::ScreenSize(1.0f, -5.0f, 2.0f) == LodSelector::ScreenSize(1.0f, 0.0f, 2.0f));
+		CHECK(LodSelector::ScreenSize(1.0f, 0.0f, 2.0f) > LodSelector::ScreenSize(1.0f, 0.01f, 2.0f));
+	}
+}
+
+int main()
+{
+	TestNoFlipNearThreshold();
+	TestOneLevelPerCrossing();
+	TestJumpsSeveralLevels();
+	TestHysteresisParameter();
+	TestMakeChain();
+	TestScreenSize();
+	return Test::Result("LodSelectorTests");
+}
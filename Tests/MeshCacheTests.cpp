@@ -0,0 +1,282 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include "Check.h"
+#include "../MeshCache.h"
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	// Layout of the file, as written by MeshCache::Write.
+	const std::size_t ChecksumOffset = 16;
+	const std::size_t ChecksumStart = 24;
+	const std::size_t HeaderSize = 40;
+	const std::size_t PageRecordSize = 32;
+	const std::size_t VertexOffsetInRecord = 16;
+	const std::size_t IndexCountInSubmesh = 12;
+
+	const uint64 Key = 0x1234567890abcdefull;
+
+	std::string TempPath(const char* name)
+	{
+		return (std::filesystem::temp_directory_path() / name).string();
+	}
+
+	std::vector<std::uint8_t> ReadBytes(const std::string& path)
+	{
+		std::ifstream fin(path, std::ios::binary);
+		return std::vector<std::uint8_t>(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+	}
+
+	void WriteBytes(const std::string& path, const std::vector<std::uint8_t>& bytes)
+	{
+		std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+		fout.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize)bytes.size());
+	}
+
+	// Signs bytes again, so a test can hand Open a file that passes the
+	// checksum but holds bad tables.
+	void Resign(std::vector<std::uint8_t>& bytes)
+	{
+		uint64 checksum = MeshCache::Checksum(bytes.data() + ChecksumStart, bytes.size() - ChecksumStart);
+		std::memcpy(&bytes[ChecksumOffset], &checksum, sizeof(checksum));
+	}
+
+	// Two pages: a 16-bit one with two submeshes and a 32-bit one with one.
+	// Sizes are odd on purpose, so the blobs need padding to stay aligned.
+	struct TestMeshes
+	{
+		std::vector<float> Vertices0 = std::vector<float>(3 * 7);
+		std::vector<std::uint16_t> Indices0 = std::vector<std::uint16_t>(9);
+		std::vector<float> Vertices1 = std::vector<float>(5 * 5);
+		std::vector<uint32> Indices1 = std::vector<uint32>(6);
+		std::vector<MeshCache::Page> Pages;
+		std::vector<MeshCache::Submesh> Submeshes;
+
+		TestMeshes()
+		{
+			for (size_t i = 0; i < Vertices0.size(); i++)
+				Vertices0[i] = (float)i;
+			for (size_t i = 0; i < Indices0.size(); i++)
+				Indices0[i] = (std::uint16_t)(i % 4);
+			for (size_t i = 0; i < Vertices1.size(); i++)
+				Vertices1[i] = -(float)i;
+			for (size_t i = 0; i < Indices1.size(); i++)
+				Indices1[i] = (uint32)(i % 5);
+
+			MeshCache::Page page0;
+			page0.VertexByteStride = 12;
+			page0.VertexByteSize = (uint32)(Vertices0.size() * sizeof(float));
+			page0.IndexByteSize = (uint32)(Indices0.size() * sizeof(std::uint16_t));
+			page0.Vertices = Vertices0.data();
+			page0.Indices = Indices0.data();
+			MeshCache::Page page1;
+			page1.Use32BitIndices = 1;
+			page1.VertexByteStride = 20;
+			page1.VertexByteSize = (uint32)(Vertices1.size() * sizeof(float));
+			page1.IndexByteSize = (uint32)(Indices1.size() * sizeof(uint32));
+			page1.Vertices = Vertices1.data();
+			page1.Indices = Indices1.data();
+			Pages = { page0, page1 };
+
+			MeshCache::Submesh a;
+			a.DrawArg = 0;
+			a.IndexCount = 6;
+			a.BoundsExtents[0] = 1.0f;
+			MeshCache::Submesh b;
+			b.DrawArg = 1;
+			b.Lod = 1;
+			b.IndexCount = 3;
+			b.StartIndexLocation = 6;
+			b.BaseVertexLocation = 4;
+			b.BoundsCenter[1] = 2.5f;
+			MeshCache::Submesh c;
+			c.DrawArg = 2;
+			c.Page = 1;
+			c.IndexCount = 6;
+			Submeshes = { a, b, c };
+		}
+	};
+
+	void TestMappedFile()
+	{
+		std::string path = TempPath("MeshCacheTests.mapped");
+		WriteBytes(path, { 1, 2, 3, 4, 5 });
+
+		MappedFile file;
+		CHECK(!file.IsOpen());
+		CHECK(file.Open(path.c_str()));
+		CHECK(file.IsOpen());
+		CHECK(file.Size() == 5);
+		CHECK(file.Data() != nullptr && file.Data()[4] == 5);
+
+		MappedFile moved(std::move(file));
+		CHECK(!file.IsOpen());
+		CHECK(moved.IsOpen() && moved.Data()[0] == 1);
+		moved.Close();
+		CHECK(!moved.IsOpen() && moved.Data() == nullptr && moved.Size() == 0);
+
+		WriteBytes(path, {});
+		CHECK(moved.Open(path.c_str()));
+		CHECK(moved.Size() == 0 && moved.Data() == nullptr);
+		moved.Close();
+
+		std::filesystem::remove(path);
+		CHECK(!moved.Open(path.c_str()));
+		CHECK(!moved.IsOpen());
+	}
+
+	// A written file reads back as a hit, with the page bytes in place in
+	// the mapping, 16-byte aligned, and the submeshes unchanged.
+	void TestHit()
+	{
+		TestMeshes meshes;
+		std::string path = TempPath("MeshCacheTests.cache");
+		CHECK(MeshCache::Write(path.c_str(), Key, meshes.Pages, meshes.Submeshes));
+		CHECK(!std::filesystem::exists(path + ".tmp"));
+
+		MeshCache cache;
+		CHECK(cache.Open(path.c_str(), Key) == MeshCache::Status::Hit);
+		const std::vector<MeshCache::Page>& pages = cache.GetPages();
+		CHECK(pages.size() == 2);
+		for (size_t p = 0; p < pages.size() && p < 2; p++)
+		{
+			CHECK(pages[p].Use32BitIndices == meshes.Pages[p].Use32BitIndices);
+			CHECK(pages[p].VertexByteStride == meshes.Pages[p].VertexByteStride);
+			CHECK(pages[p].VertexByteSize == meshes.Pages[p].VertexByteSize);
+			CHECK(pages[p].IndexByteSize == meshes.Pages[p].IndexByteSize);
+			CHECK(std::memcmp(pages[p].Vertices, meshes.Pages[p].Vertices, pages[p].VertexByteSize) == 0);
+			CHECK(std::memcmp(pages[p].Indices, meshes.Pages[p].Indices, pages[p].IndexByteSize) == 0);
+			CHECK(reinterpret_cast<std::uintptr_t>(pages[p].Vertices) % 16 == 0);
+			CHECK(reinterpret_cast<std::uintptr_t>(pages[p].Indices) % 16 == 0);
+		}
+
+		const std::vector<MeshCache::Submesh>& submeshes = cache.GetSubmeshes();
+		CHECK(submeshes.size() == 3);
+		CHECK(std::memcmp(submeshes.data(), meshes.Submeshes.data(), sizeof(MeshCache::Submesh) * 3) == 0);
+
+		// Writing over a cache that is open elsewhere does not change what is
+		// mapped, and the new file reads back too.
+		CHECK(MeshCache::Write(path.c_str(), Key + 1, meshes.Pages, {}));
+		CHECK(std::memcmp(pages[0].Vertices, meshes.Vertices0.data(), pages[0].VertexByteSize) == 0);
+		cache.Close();
+		CHECK(cache.GetPages().empty() && cache.GetSubmeshes().empty());
+		CHECK(cache.Open(path.c_str(), Key + 1) == MeshCache::Status::Hit);
+		CHECK(cache.GetSubmeshes().empty());
+		cache.Close();
+		std::filesystem::remove(path);
+	}
+
+	void TestMissingAndStale()
+	{
+		TestMeshes meshes;
+		std::string path = TempPath("MeshCacheTests.cache");
+		std::filesystem::remove(path);
+
+		MeshCache cache;
+		CHECK(cache.Open(path.c_str(), Key) == MeshCache::Status::Missing);
+
+		CHECK(MeshCache::Write(path.c_str(), Key, meshes.Pages, meshes.Submeshes));
+		CHECK(cache.Open(path.c_str(), Key ^ 1) == MeshCache::Status::Stale);
+		CHECK(cache.GetPages().empty());
+
+		// Another file version reads as stale before the checksum is looked at.
+		std::vector<std::uint8_t> bytes = ReadBytes(path);
+		bytes[4]++;
+		WriteBytes(path, bytes);
+		CHECK(cache.Open(path.c_str(), Key) == MeshCache::Status::Stale);
+		std::filesystem::remove(path);
+
+		CHECK(MeshCacheKey().Add("ab").Add("c").Get() != MeshCacheKey().Add("a").Add("bc").Get());
+		CHECK(MeshCacheKey().Add(1u).Get() == MeshCacheKey().Add(1u).Get());
+		CHECK(MeshCacheKey().Add(1u).Get() != MeshCacheKey().Add(2u).Get());
+	}
+
+	// Any flipped byte after the checksum, a truncated file and an empty one
+	// read as corrupt.
+	void TestCorrupt()
+	{
+		TestMeshes meshes;
+		std::string path = TempPath("MeshCacheTests.cache");
+		CHECK(MeshCache::Write(path.c_str(), Key, meshes.Pages, meshes.Submeshes));
+		const std::vector<std::uint8_t> original = ReadBytes(path);
+
+		MeshCache cache;
+		bool allCorrupt = true;
+		for (size_t i = ChecksumStart; i < original.size(); i += 7)
+		{
+			std::vector<std::uint8_t> bytes = original;
+			bytes[i] ^= 0x10;
+			WriteBytes(path, bytes);
+			allCorrupt = allCorrupt && cache.Open(path.c_str(), Key) == MeshCache::Status::Corrupt;
+		}
+		CHECK(allCorrupt);
+
+		WriteBytes(path, std::vector<std::uint8_t>(original.begin(), original.end() - 1));
+		CHECK(cache.Open(path.c_str(), Key) == MeshCache::Status::Corrupt);
+		WriteBytes(path, std::vector<std::uint8_t>(original.begin(), original.begin() + HeaderSize - 1));
+		CHECK(cache.Open(path.c_str(), Key) == MeshCache::Status::Corrupt);
+		WriteBytes(path, {});
+		CHECK(cache.Open(path.c_str(), Key) == MeshCache::Status::Corrupt);
+		std::filesystem::remove(path);
+	}
+
+	// Tables that pass the checksum but point outside the file or the page
+	// are rejected.
+	void TestBadRanges()
+	{
+		TestMeshes meshes;
+		std::string path = TempPath("MeshCacheTests.cache");
+		CHECK(MeshCache::Write(path.c_str(), Key, meshes.Pages, meshes.Submeshes));
+		const std::vector<std::uint8_t> original = ReadBytes(path);
+		MeshCache cache;
+
+		// An offset near 2^64 wraps offset + size back into range.
+		std::vector<std::uint8_t> bytes = original;
+		uint64 wrapping = ~0ull - 8;
+		std::memcpy(&bytes[HeaderSize + VertexOffsetInRecord], &wrapping, sizeof(wrapping));
+		Resign(bytes);
+		WriteBytes(path, bytes);
+		CHECK(cache.Open(path.c_str(), Key) == MeshCache::Status::Corrupt);
+
+		// The second submesh ends one index past its 9-index page.
+		bytes = original;
+		const std::size_t submeshes = HeaderSize + 2 * PageRecordSize;
+		uint32 indexCount = 4;
+		std::memcpy(&bytes[submeshes + sizeof(MeshCache::Submesh) + IndexCountInSubmesh], &indexCount, sizeof(indexCount));
+		Resign(bytes);
+		WriteBytes(path, bytes);
+		CHECK(cache.Open(path.c_str(), Key) == MeshCache::Status::Corrupt);
+
+		// Start and count that only fit once their sum wraps.
+		bytes = original;
+		uint32 hugeCount = 0xfffffffcu;
+		std::memcpy(&bytes[submeshes + sizeof(MeshCache::Submesh) + IndexCountInSubmesh], &hugeCount, sizeof(hugeCount));
+		Resign(bytes);
+		WriteBytes(path, bytes);
+		CHECK(cache.Open(path.c_str(), Key) == MeshCache::Status::Corrupt);
+
+		// Resigning the unchanged file still gives a hit, so the failures
+		// above come from the ranges.
+		bytes = original;
+		Resign(bytes);
+		WriteBytes(path, bytes);
+		CHECK(cache.Open(path.c_str(), Key) == MeshCache::Status::Hit);
+		cache.Close();
+		std::filesystem::remove(path);
+	}
+}
+
+int main()
+{
+	TestMappedFile();
+	TestHit();
+	TestMissingAndStale();
+	TestCorrupt();
+	TestBadRanges();
+	return Test::Result("MeshCacheTests");
+}
@@ -0,0 +1,146 @@
+#include <cstring>
+#include "Check.h"
+#include "../MeshPacker.h"
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	// Submeshes of a page follow each other in both streams, in order of
+	// addition, starting at 0.
+	void TestOffsetsFollowEachOther()
+	{
+		MeshPacker packer;
+		uint32 box = packer.AddSubmesh(24, 36);
+		uint32 sphere = packer.AddSubmesh(441, 2400);
+		uint32 pyramid = packer.AddSubmesh(500, 1000);
+		packer.Pack();
+
+		CHECK(box == 0 && sphere == 1 && pyramid == 2);
+		CHECK(packer.GetPages().size() == 1);
+
+		const std::vector<MeshPacker::Submesh>& submeshes = packer.GetSubmeshes();
+		CHECK(submeshes[0].BaseVertexLocation == 0 && submeshes[0].StartIndexLocation == 0);
+		CHECK(submeshes[1].BaseVertexLocation == 24 && submeshes[1].StartIndexLocation == 36);
+		// Offsets are counted in vertices and indices respectively, not mixed.
+		CHECK(submeshes[2].BaseVertexLocation == 24 + 441 && submeshes[2].StartIndexLocation == 36 + 2400);
+
+		const MeshPacker::Page& page = packer.GetPages()[0];
+		CHECK(page.VertexCount == 24 + 441 + 500);
+		CHECK(page.IndexCount == 36 + 2400 + 1000);
+		CHECK(!page.Use32BitIndices);
+		CHECK(packer.GetIndexStride(0) == 2);
+	}
+
+	// 65536 vertices still fit 16-bit relative indices, one more does not,
+	// and 16 and 32-bit submeshes never share a page.
+	void TestIndexFormatBoundary()
+	{
+		MeshPacker packer;
+		packer.AddSubmesh(0x10000, 6);
+		packer.AddSubmesh(0x10001, 6);
+		packer.AddSubmesh(10, 6);
+		packer.AddSubmesh(0x20000, 6);
+		packer.Pack();
+
+		const std::vector<MeshPacker::Submesh>& submeshes = packer.GetSubmeshes();
+		const std::vector<MeshPacker::Page>& pages = packer.GetPages();
+		CHECK(pages.size() == 2);
+		CHECK(submeshes[0].Page == 0 && submeshes[2].Page == 0);
+		CHECK(submeshes[1].Page == 1 && submeshes[3].Page == 1);
+		CHECK(!pages[0].Use32BitIndices && packer.GetIndexStride(0) == 2);
+		CHECK(pages[1].Use32BitIndices && packer.GetIndexStride(1) == 4);
+		CHECK(submeshes[3].BaseVertexLocation == 0x10001);
+	}
+
+	// First fit: a submesh goes to the first page with room in both streams,
+	// so a later small one can fill an earlier page.
+	void TestFirstFit()
+	{
+		MeshPacker packer(1000, 1000);
+		packer.AddSubmesh(600, 100);
+		packer.AddSubmesh(600, 100);
+		packer.AddSubmesh(300, 100);
+		packer.AddSubmesh(100, 900);
+		packer.AddSubmesh(100, 800);
+		packer.Pack();
+
+		const std::vector<MeshPacker::Submesh>& submeshes = packer.GetSubmeshes();
+		CHECK(packer.GetPages().size() == 2);
+		CHECK(submeshes[0].Page == 0);
+		CHECK(submeshes[1].Page == 1);
+		CHECK(submeshes[2].Page == 0 && submeshes[2].BaseVertexLocation == 600 && submeshes[2].StartIndexLocation == 100);
+		// Its vertices fit page 0 but its indices do not.
+		CHECK(submeshes[3].Page == 1 && submeshes[3].BaseVertexLocation == 600 && submeshes[3].StartIndexLocation == 100);
+		// Fills page 0 exactly.
+		CHECK(submeshes[4].Page == 0 && submeshes[4].BaseVertexLocation == 900 && submeshes[4].StartIndexLocation == 200);
+		CHECK(packer.GetPages()[0].VertexCount == 1000 && packer.GetPages()[0].IndexCount == 1000);
+	}
+
+	// A submesh over the capacity gets a page of its own instead of failing.
+	void TestOversizedSubmesh()
+	{
+		MeshPacker packer(100, 100);
+		packer.AddSubmesh(50, 50);
+		packer.AddSubmesh(500, 500);
+		packer.AddSubmesh(50, 50);
+		packer.Pack();
+
+		const std::vector<MeshPacker::Submesh>& submeshes = packer.GetSubmeshes();
+		CHECK(packer.GetPages().size() == 2);
+		CHECK(submeshes[1].Page == 1 && submeshes[1].BaseVertexLocation == 0);
+		CHECK(packer.GetPages()[1].VertexCount == 500);
+		CHECK(submeshes[2].Page == 0 && submeshes[2].BaseVertexLocation == 50);
+	}
+
+	// Packing again starts over rather than appending pages.
+	void TestRepack()
+	{
+		MeshPacker packer;
+		packer.AddSubmesh(10, 30);
+		packer.Pack();
+		packer.AddSubmesh(20, 60);
+		packer.Pack();
+
+		CHECK(packer.GetPages().size() == 1);
+		CHECK(packer.GetPages()[0].VertexCount == 30);
+		CHECK(packer.GetSubmeshes()[1].BaseVertexLocation == 10);
+	}
+
+	void TestCopyIndices()
+	{
+		const uint32 src[4] = { 0, 1, 0xffff, 0x10000 };
+
+		std::uint16_t narrow[3] = {};
+		MeshPacker::CopyIndices(src, 3, false, narrow);
+		CHECK(narrow[0] == 0 && narrow[1] == 1 && narrow[2] == 0xffff);
+
+		uint32 wide[4] = {};
+		MeshPacker::CopyIndices(src, 4, true, wide);
+		CHECK(std::memcmp(wide, src, sizeof(src)) == 0);
+	}
+
+	void TestOccupancyReport()
+	{
+		MeshPacker packer(1000, 2000);
+		packer.AddSubmesh(250, 500);
+		packer.AddSubmesh(70000, 100);
+		packer.Pack();
+
+		std::string report = packer.GetOccupancyReport();
+		CHECK(report.find("page 0: R16_UINT, 250/1000 vertices (25.0%), 500/2000 indices (25.0%)\n") != std::string::npos);
+		CHECK(report.find("page 1: R32_UINT") != std::string::npos);
+	}
+}
+
+int main()
+{
+	TestOffsetsFollowEachOther();
+	TestIndexFormatBoundary();
+	TestFirstFit();
+	TestOversizedSubmesh();
+	TestRepack();
+	TestCopyIndices();
+	TestOccupancyReport();
+	return Test::Result("MeshPackerTests");
+}
@@ -0,0 +1,315 @@
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include "Check.h"
+#include "../ObjImporter.h"
+
+using namespace DirectX;
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using Format = VertexFormats::PositionNormalTangentUV;
+	using Model = ObjModel<Format>;
+
+	bool LoadText(const std::string& text, ThreadPool& pool, Model& model, ObjImporter::Stats* stats = nullptr)
+	{
+		return ObjImporter::LoadFromMemory(text.data(), text.size(), pool, model, Format(), stats);
+	}
+
+	bool SameFloat3(const XMFLOAT3& a, const XMFLOAT3& b)
+	{
+		return a.x == b.x && a.y == b.y && a.z == b.z;
+	}
+
+	bool SameVertex(const Format::Vertex& a, const Format::Vertex& b)
+	{
+		return SameFloat3(a.Position, b.Position) && SameFloat3(a.Normal, b.Normal) &&
+			a.TexC.x == b.TexC.x && a.TexC.y == b.TexC.y;
+	}
+
+	bool SameModel(const Model& a, const Model& b)
+	{
+		if (a.Mesh.Vertices.size() != b.Mesh.Vertices.size() || a.Mesh.Indices32 != b.Mesh.Indices32 ||
+			a.Submeshes.size() != b.Submeshes.size() || a.MaterialLibraries != b.MaterialLibraries)
+			return false;
+		for (size_t i = 0; i < a.Mesh.Vertices.size(); i++)
+		{
+			if (!SameVertex(a.Mesh.Vertices[i], b.Mesh.Vertices[i]))
+				return false;
+		}
+		for (size_t s = 0; s < a.Submeshes.size(); s++)
+		{
+			const ObjSubmesh& sa = a.Submeshes[s];
+			const ObjSubmesh& sb = b.Submeshes[s];
+			if (sa.Group != sb.Group || sa.Material != sb.Material ||
+				sa.StartIndexLocation != sb.StartIndexLocation || sa.IndexCount != sb.IndexCount)
+				return false;
+		}
+		return true;
+	}
+
+	// Position of the corner of triangle t, for checks that do not depend on
+	// how vertices were deduplicated.
+	const XMFLOAT3& CornerPosition(const Model& model, uint32 t, uint32 corner)
+	{
+		return model.Mesh.Vertices[model.Mesh.Indices32[3 * t + corner]].Position;
+	}
+
+	// One OBJ of several megabytes, so it is cut into several chunks.  Every
+	// unit adds a position, a texture coordinate and a normal, then a face
+	// that cycles through the v, v/t, v//n and v/t/n forms, every fifth one a
+	// quad.  Its last corner reaches about 60000 units back, further than
+	// any chunk is long, so with relative indices every late face crosses at
+	// least one chunk boundary.  Groups and materials change every 1000
+	// units and pairs come back, so submeshes gather faces from many chunks.
+	std::string GenerateObj(uint32 unitCount, bool relative)
+	{
+		std::string text = "mtllib first.mtl\n";
+		text.reserve((std::size_t)unitCount * 72);
+		char line[128];
+		for (uint32 i = 0; i < unitCount; i++)
+		{
+			if (i % 1000 == 0)
+			{
+				snprintf(line, sizeof(line), "g part%u\nusemtl mat%u\n", (i / 1000) % 3, (i / 1000) % 2);
+				text += line;
+			}
+			snprintf(line, sizeof(line), "v %u.5 %u %u.25\nvt %u.5 0.25\nvn 0 %u 1\n", i % 1000, i / 1000, i % 7, i % 3, i % 2);
+			text += line;
+			if (i < 3)
+				continue;
+
+			uint32 corners[4] = { i, i - 1, i >= 60000 ? i - 60000 : i - 2, i - 3 };
+			uint32 cornerCount = i % 5 == 0 ? 4 : 3;
+			text += "f";
+			for (uint32 c = 0; c < cornerCount; c++)
+			{
+				// Relative -1 is the last element read, absolute 1 the first.
+				long long index = relative ? (long long)corners[c] - (long long)(i + 1) : (long long)corners[c] + 1;
+				switch (i % 4)
+				{
+				case 0: snprintf(line, sizeof(line), " %lld", index); break;
+				case 1: snprintf(line, sizeof(line), " %lld/%lld", index, index); break;
+				case 2: snprintf(line, sizeof(line), " %lld//%lld", index, index); break;
+				default: snprintf(line, sizeof(line), " %lld/%lld/%lld", index, index, index); break;
+				}
+				text += line;
+			}
+			text += "\n";
+		}
+		text += "mtllib second.mtl\n";
+		return text;
+	}
+
+	void TestCornerForms()
+	{
+		ThreadPool pool(1);
+		Model model;
+		std::string text =
+			"v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+			"vt 0 0\nvt 1 0\nvt 0 1\n"
+			"vn 0 0 1\n"
+			"f 1 2 3\n"
+			"f 1/1 2/2 3/3\n"
+			"f 1//1 2//1 3//1\n"
+			"f 1/1/1 2/2/1 3/3/1\n";
+		ObjImporter::Stats stats;
+		CHECK(LoadText(text, pool, model, &stats));
+		CHECK(stats.SkippedLines == 0);
+		CHECK(stats.Triangles == 4);
+		// Each form gives other tuples, so nothing is shared between faces.
+		CHECK(model.Mesh.Vertices.size() == 12);
+		CHECK(model.Mesh.Indices32.size() == 12);
+		CHECK(model.Submeshes.size() == 1);
+
+		const Format::Vertex& plain = model.Mesh.Vertices[model.Mesh.Indices32[2]];
+		CHECK(SameFloat3(plain.Position, XMFLOAT3(0.0f, 1.0f, 0.0f)));
+		CHECK(SameFloat3(plain.Normal, XMFLOAT3(0.0f, 0.0f, 0.0f)));
+		CHECK(plain.TexC.x == 0.0f && plain.TexC.y == 0.0f);
+
+		// Texture v is flipped.
+		const Format::Vertex& textured = model.Mesh.Vertices[model.Mesh.Indices32[5]];
+		CHECK(textured.TexC.x == 0.0f && textured.TexC.y == 0.0f);
+		CHECK(SameFloat3(textured.Normal, XMFLOAT3(0.0f, 0.0f, 0.0f)));
+		CHECK(model.Mesh.Vertices[model.Mesh.Indices32[4]].TexC.x == 1.0f);
+		CHECK(model.Mesh.Vertices[model.Mesh.Indices32[4]].TexC.y == 1.0f);
+
+		const Format::Vertex& normal = model.Mesh.Vertices[model.Mesh.Indices32[8]];
+		CHECK(SameFloat3(normal.Normal, XMFLOAT3(0.0f, 0.0f, 1.0f)));
+		CHECK(normal.TexC.x == 0.0f && normal.TexC.y == 0.0f);
+
+		const Format::Vertex& full = model.Mesh.Vertices[model.Mesh.Indices32[11]];
+		CHECK(SameFloat3(full.Normal, XMFLOAT3(0.0f, 0.0f, 1.0f)));
+		CHECK(full.TexC.x == 0.0f && full.TexC.y == 0.0f);
+		CHECK(model.Mesh.Vertices[model.Mesh.Indices32[10]].TexC.y == 1.0f);
+
+		// Repeated tuples are one vertex.
+		Model shared;
+		CHECK(LoadText("v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nf 1 2 3\nf 3 2 4\n", pool, shared));
+		CHECK(shared.Mesh.Vertices.size() == 4);
+		CHECK(shared.Mesh.Indices32[3] == shared.Mesh.Indices32[2]);
+		CHECK(shared.Mesh.Indices32[4] == shared.Mesh.Indices32[1]);
+	}
+
+	// An n-gon becomes the fan 0 1 2, 0 2 3, ..., in the winding of the face.
+	void TestFanTriangulation()
+	{
+		ThreadPool pool(1);
+		Model model;
+		CHECK(LoadText("v 0 0 0\nv 1 0 0\nv 2 1 0\nv 1 2 0\nv 0 1 0\nf 1 2 3 4 5\nf 1 2 3 4\n", pool, model));
+		CHECK(model.Mesh.Indices32.size() == 3 * (3 + 2));
+		const uint32 expected[5][3] = { { 0, 1, 2 }, { 0, 2, 3 }, { 0, 3, 4 }, { 0, 1, 2 }, { 0, 2, 3 } };
+		bool fan = true;
+		for (uint32 t = 0; t < 5; t++)
+		{
+			for (uint32 c = 0; c < 3; c++)
+			{
+				XMFLOAT3 p = CornerPosition(model, t, c);
+				const float xs[5] = { 0, 1, 2, 1, 0 };
+				const float ys[5] = { 0, 0, 1, 2, 1 };
+				fan = fan && p.x == xs[expected[t][c]] && p.y == ys[expected[t][c]];
+			}
+		}
+		CHECK(fan);
+	}
+
+	// A group/material pair that comes back later is one submesh, with all
+	// of its faces in file order, and submeshes follow first appearance.
+	void TestRepeatedPairIsOneSubmesh()
+	{
+		ThreadPool pool(1);
+		Model model;
+		std::string text =
+			"mtllib a.mtl\n"
+			"v 0 0 0\nv 1 0 0\nv 0 1 0\nv 2 0 0\nv 3 0 0\nv 4 0 0\n"
+			"f 1 2 3\n"
+			"g hull\nusemtl steel\n"
+			"f 4 2 3\n"
+			"g wing\n"
+			"f 5 2 3\n"
+			"usemtl glass\n"
+			"f 6 2 3\n"
+			"g hull\nusemtl steel\n"
+			"f 2 3 4 5\n"
+			"g\n"
+			"mtllib b.mtl\n";
+		CHECK(LoadText(text, pool, model));
+		CHECK(model.Submeshes.size() == 4);
+		CHECK(model.MaterialLibraries.size() == 2 && model.MaterialLibraries[1] == "b.mtl");
+		if (model.Submeshes.size() != 4)
+			return;
+
+		CHECK(model.Submeshes[0].Group == "default" && model.Submeshes[0].Material.empty());
+		CHECK(model.Submeshes[1].Group == "hull" && model.Submeshes[1].Material == "steel");
+		// A group alone keeps the current material.
+		CHECK(model.Submeshes[2].Group == "wing" && model.Submeshes[2].Material == "steel");
+		CHECK(model.Submeshes[3].Group == "wing" && model.Submeshes[3].Material == "glass");
+
+		const ObjSubmesh& hull = model.Submeshes[1];
+		CHECK(hull.StartIndexLocation == 3);
+		CHECK(hull.IndexCount == 9);
+		CHECK(CornerPosition(model, 1, 0).x == 2.0f);
+		CHECK(CornerPosition(model, 2, 0).x == 1.0f);
+		CHECK(CornerPosition(model, 3, 0).x == 1.0f && CornerPosition(model, 3, 2).x == 3.0f);
+		CHECK(model.Submeshes[2].StartIndexLocation == 12 && model.Submeshes[2].IndexCount == 3);
+		CHECK(model.Submeshes[3].StartIndexLocation == 15 && model.Submeshes[3].IndexCount == 3);
+	}
+
+	void TestNegativeIndices()
+	{
+		ThreadPool pool(1);
+		Model relative;
+		Model absolute;
+		CHECK(LoadText("v 0 0 0\nv 1 0 0\nv 0 1 0\nf -3 -2 -1\nv 5 5 5\nf -4 -1 -2\n", pool, relative));
+		CHECK(LoadText("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\nv 5 5 5\nf 1 4 3\n", pool, absolute));
+		CHECK(SameModel(relative, absolute));
+	}
+
+	// A face that references a missing element makes the whole load fail,
+	// as does a file that can not be opened.  Malformed lines are skipped.
+	void TestInvalid()
+	{
+		ThreadPool pool(1);
+		Model model;
+		CHECK(!LoadText("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 4\n", pool, model));
+		CHECK(!LoadText("v 0 0 0\nv 1 0 0\nv 0 1 0\nf -4 -2 -1\n", pool, model));
+		CHECK(!LoadText("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1/1 2/1 3/1\n", pool, model));
+		CHECK(!LoadText("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1//2 2//2 3//2\nvn 0 0 1\n", pool, model));
+
+		ObjImporter::Stats stats;
+		CHECK(LoadText("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2\nf 1 x 3\nv 1 2\nf 1 2 3\n", pool, model, &stats));
+		CHECK(stats.SkippedLines == 3);
+		CHECK(model.Mesh.Indices32.size() == 3);
+
+		std::string path = (std::filesystem::temp_directory_path() / "ObjImporterTests.obj").string();
+		{
+			std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+			fout << "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\nf 3 2 9\n";
+		}
+		CHECK(!ObjImporter::Load(path.c_str(), pool, model));
+		{
+			std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+			fout << "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+		}
+		CHECK(ObjImporter::Load(path.c_str(), pool, model));
+		CHECK(model.Mesh.Indices32.size() == 3);
+		std::filesystem::remove(path);
+		CHECK(!ObjImporter::Load(path.c_str(), pool, model));
+	}
+
+	// Relative indices resolved across chunk boundaries give the same model
+	// as absolute ones, and the model does not depend on the worker count,
+	// which changes how the file is cut into chunks.
+	void TestChunksAndWorkers()
+	{
+		const uint32 unitCount = 200000;
+		std::string relativeText = GenerateObj(unitCount, true);
+		std::string absoluteText = GenerateObj(unitCount, false);
+		CHECK(relativeText.size() > 8 * ObjImporter::MinChunkBytes);
+
+		ThreadPool onePool(1);
+		ThreadPool fourPool(4);
+		Model relativeOne;
+		Model absoluteOne;
+		Model relativeFour;
+		ObjImporter::Stats oneStats;
+		ObjImporter::Stats fourStats;
+		CHECK(LoadText(relativeText, onePool, relativeOne, &oneStats));
+		CHECK(LoadText(absoluteText, onePool, absoluteOne));
+		CHECK(LoadText(relativeText, fourPool, relativeFour, &fourStats));
+
+		CHECK(oneStats.Chunks > 1);
+		CHECK(fourStats.Chunks != oneStats.Chunks);
+		CHECK(oneStats.SkippedLines == 0);
+		uint32 quads = (unitCount - 1) / 5;
+		CHECK(oneStats.Triangles == unitCount - 3 + quads);
+		CHECK(SameModel(relativeOne, absoluteOne));
+		CHECK(SameModel(relativeOne, relativeFour));
+
+		// Three groups by two materials, with faces of every pair spread
+		// over the whole file.
+		CHECK(relativeOne.Submeshes.size() == 6);
+		uint32 next = 0;
+		for (const ObjSubmesh& submesh : relativeOne.Submeshes)
+		{
+			CHECK(submesh.StartIndexLocation == next);
+			next += submesh.IndexCount;
+		}
+		CHECK(next == relativeOne.Mesh.Indices32.size());
+		CHECK(relativeOne.MaterialLibraries.size() == 2);
+	}
+}
+
+int main()
+{
+	TestCornerForms();
+	TestFanTriangulation();
+	TestRepeatedPairIsOneSubmesh();
+	TestNegativeIndices();
+	TestInvalid();
+	TestChunksAndWorkers();
+	return Test::Result("ObjImporterTests");
+}
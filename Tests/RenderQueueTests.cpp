@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <random>
+#include "Check.h"
+#include "../RenderQueue.h"
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	const float NearZ = 1.0f;
+	const float FarZ = 1000.0f;
+
+	uint64 OpaqueKey(uint32 submesh, float depth)
+	{
+		return RenderQueue::MakeKey(RenderLayer::Opaque, 0, 0, submesh, depth, NearZ, FarZ);
+	}
+
+	uint64 TransparentKey(uint32 submesh, float depth)
+	{
+		return RenderQueue::MakeKey(RenderLayer::Transparent, 1, 0, submesh, depth, NearZ, FarZ);
+	}
+
+	// Radix sort gives the same key order as a comparison sort, with every
+	// value still attached to its key.
+	void TestSortMatchesStdSort()
+	{
+		std::mt19937_64 rng(7);
+		RenderQueue queue;
+		std::vector<std::pair<uint64, uint32>> expected;
+		for (uint32 i = 0; i < 5000; i++)
+		{
+			uint64 key = rng();
+			queue.Push(key, i);
+			expected.push_back({ key, i });
+		}
+		queue.Sort();
+		std::sort(expected.begin(), expected.end());
+
+		CHECK(queue.Size() == expected.size());
+		bool same = true;
+		for (uint32 i = 0; i < queue.Size(); i++)
+			same = same && queue.GetKeys()[i] == expected[i].first && queue.GetValues()[i] == expected[i].second;
+		CHECK(same);
+	}
+
+	// Opaque comes first and goes front to back, transparent goes back to front.
+	void TestLayerAndDepthOrder()
+	{
+		RenderQueue queue;
+		queue.Push(TransparentKey(0, 10.0f), 0);
+		queue.Push(OpaqueKey(0, 500.0f), 1);
+		queue.Push(TransparentKey(0, 900.0f), 2);
+		queue.Push(OpaqueKey(0, 20.0f), 3);
+		queue.Push(TransparentKey(0, 300.0f), 4);
+		queue.Push(OpaqueKey(0, 200.0f), 5);
+		queue.Sort();
+
+		const std::vector<uint32> expected = { 3, 5, 1, 2, 4, 0 };
+		CHECK(queue.GetValues() == expected);
+		CHECK(RenderQueue::GetLayer(queue.GetKeys()[2]) == RenderLayer::Opaque);
+		CHECK(RenderQueue::GetLayer(queue.GetKeys()[3]) == RenderLayer::Transparent);
+	}
+
+	// Depth does not take part in the state key.
+	void TestStateKeyIgnoresDepth()
+	{
+		CHECK(RenderQueue::GetStateKey(OpaqueKey(3, 10.0f)) == RenderQueue::GetStateKey(OpaqueKey(3, 900.0f)));
+		CHECK(RenderQueue::GetStateKey(OpaqueKey(3, 10.0f)) != RenderQueue::GetStateKey(OpaqueKey(4, 10.0f)));
+		CHECK(RenderQueue::GetStateKey(TransparentKey(3, 10.0f)) == RenderQueue::GetStateKey(TransparentKey(3, 900.0f)));
+		CHECK(RenderQueue::GetStateKey(TransparentKey(3, 10.0f)) != RenderQueue::GetStateKey(OpaqueKey(3, 10.0f)));
+	}
+}
+
+int main()
+{
+	TestSortMatchesStdSort();
+	TestLayerAndDepthOrder();
+	TestStateKeyIgnoresDepth();
+	return Test::Result("RenderQueueTests");
+}
@@ -0,0 +1,179 @@
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "Check.h"
+#include "../RingAllocator.h"
+
+namespace
+{
+	using uint64 = std::uint64_t;
+
+	const uint64 Invalid = RingAllocator::InvalidOffset;
+
+	void TestAlignment()
+	{
+		RingAllocator ring(4096);
+		CHECK(ring.Allocate(10, 1) == 0);
+		CHECK(ring.Allocate(64, 256) == 256);
+		CHECK(ring.Allocate(1, 16) == 320);
+		// Padding counts as used.
+		CHECK(ring.UsedSize() == 321);
+	}
+
+	void TestWrapAround()
+	{
+		RingAllocator ring(1000);
+		CHECK(ring.Allocate(400, 1) == 0);
+		ring.FinishFrame(1);
+		CHECK(ring.Allocate(400, 1) == 400);
+		ring.FinishFrame(2);
+		CHECK(ring.UsedSize() == 800);
+
+		ring.Retire(1);
+		CHECK(ring.UsedSize() == 400);
+
+		// 300 bytes do not fit in the 200 left at the end: the tail is skipped
+		// and charged to this frame, and the slice starts over at 0.
+		CHECK(ring.Allocate(300, 1) == 0);
+		CHECK(ring.UsedSize() == 900);
+		ring.FinishFrame(3);
+
+		ring.Retire(2);
+		CHECK(ring.UsedSize() == 500);
+		ring.Retire(3);
+		CHECK(ring.UsedSize() == 0);
+	}
+
+	void TestRetireInOrder()
+	{
+		RingAllocator ring(1024);
+		for (uint64 fence = 1; fence <= 3; fence++)
+		{
+			CHECK(ring.Allocate(100, 1) != Invalid);
+			ring.FinishFrame(fence);
+		}
+		CHECK(ring.UsedSize() == 300);
+
+		ring.Retire(0);
+		CHECK(ring.UsedSize() == 300);
+		// Frames are released up to the completed fence, not past it...
+		ring.Retire(2);
+		CHECK(ring.UsedSize() == 100);
+		// ...and at most once.
+		ring.Retire(2);
+		CHECK(ring.UsedSize() == 100);
+		ring.Retire(10);
+		CHECK(ring.UsedSize() == 0);
+	}
+
+	void TestOutOfSpace()
+	{
+		RingAllocator ring(1000);
+		CHECK(ring.Allocate(1001, 1) == Invalid);
+		CHECK(ring.UsedSize() == 0);
+
+		CHECK(ring.Allocate(400, 1) == 0);
+		ring.FinishFrame(1);
+		CHECK(ring.Allocate(400, 1) == 400);
+		ring.FinishFrame(2);
+		ring.Retire(1);
+		CHECK(ring.Allocate(300, 1) == 0);
+
+		// [300, 500) would overlap frame 2, still in flight at [400, 800).
+		CHECK(ring.Allocate(200, 1) == Invalid);
+		CHECK(ring.UsedSize() == 900);
+		CHECK(ring.Allocate(100, 1) == 300);
+		ring.FinishFrame(3);
+
+		// Once the GPU is done with frame 2 the space comes back.
+		ring.Retire(2);
+		CHECK(ring.Allocate(200, 1) == 400);
+	}
+
+	void TestEmptyRingRestartsAtZero()
+	{
+		RingAllocator ring(1000);
+		CHECK(ring.Allocate(700, 1) == 0);
+		ring.FinishFrame(1);
+		ring.Retire(1);
+		// Nothing in flight: no need to skip the tail to fit 600 bytes.
+		CHECK(ring.Allocate(600, 1) == 0);
+	}
+
+	// Frames in flight write a tag into plain host memory standing in for the
+	// mapped upload buffer; when the "GPU" retires a frame, every byte it owned
+	// must still hold its tag.
+	void TestFramesInFlightAreNotOverwritten()
+	{
+		const uint64 capacity = 64 * 1024;
+		const std::uint32_t framesInFlight = 3;
+
+		struct Slice
+		{
+			uint64 Offset;
+			uint64 Size;
+		};
+
+		RingAllocator ring(capacity, framesInFlight + 1);
+		std::vector<std::uint8_t> memory(capacity, 0);
+		std::vector<std::vector<Slice>> frames;
+		std::mt19937 random(7);
+		uint64 completed = 0;
+		uint64 outOfSpace = 0;
+		bool intact = true;
+		bool inBounds = true;
+
+		for (uint64 fence = 1; fence <= 2000; fence++)
+		{
+			// Like FrameScheduler: wait until at most framesInFlight - 1 frames
+			// are queued before recording the next one.
+			uint64 target = fence > framesInFlight ? fence - framesInFlight : 0;
+			for (; completed < target; completed++)
+			{
+				std::uint8_t tag = (std::uint8_t)(completed + 1);
+				for (const Slice& slice : frames[completed])
+				{
+					for (uint64 b = 0; b < slice.Size; b++)
+						intact = intact && memory[slice.Offset + b] == tag;
+				}
+			}
+			ring.Retire(completed);
+
+			frames.emplace_back();
+			std::uint32_t count = random() % 64;
+			for (std::uint32_t i = 0; i < count; i++)
+			{
+				uint64 size = 1 + random() % 600;
+				uint64 alignment = (random() & 1) ? 256 : 16;
+				uint64 offset = ring.Allocate(size, alignment);
+				if (offset == Invalid)
+				{
+					outOfSpace++;
+					continue;
+				}
+				inBounds = inBounds && offset % alignment == 0 && offset + size <= capacity;
+				memset(&memory[offset], (std::uint8_t)fence, size);
+				frames.back().push_back({ offset, size });
+			}
+			ring.FinishFrame(fence);
+		}
+
+		CHECK(intact);
+		CHECK(inBounds);
+		// Three frames of up to 64 slices of up to 855 bytes do not always fit
+		// in 64 KB, so the full ring was hit along the way.
+		CHECK(outOfSpace > 0);
+	}
+}
+
+int main()
+{
+	TestAlignment();
+	TestWrapAround();
+	TestRetireInOrder();
+	TestOutOfSpace();
+	TestEmptyRingRestartsAtZero();
+	TestFramesInFlightAreNotOverwritten();
+	return Test::Result("RingAllocatorTests");
+}
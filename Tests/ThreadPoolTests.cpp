@@ -0,0 +1,155 @@
+#include <memory>
+#include <stdexcept>
+#include "Check.h"
+#include "../ThreadPool.h"
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	// Every submitted task has run once Wait returns, whatever the worker
+	// count, including none but the waiting thread helping.
+	void TestSubmitWait()
+	{
+		for (uint32 workers : { 1u, 2u, 4u })
+		{
+			ThreadPool pool(workers);
+			CHECK(pool.GetWorkerCount() == workers);
+
+			const uint32 taskCount = 1000;
+			std::vector<uint32> done(taskCount, 0);
+			TaskGroup group;
+			for (uint32 i = 0; i < taskCount; i++)
+				pool.Submit(group, [&done, i] { done[i]++; });
+			pool.Wait(group);
+
+			bool all = true;
+			for (uint32 i = 0; i < taskCount; i++)
+				all = all && done[i] == 1;
+			CHECK(all);
+
+			// A group can be reused once waited on, and waiting on an empty
+			// group returns at once.
+			std::atomic<uint32> count{ 0 };
+			pool.Submit(group, [&count] { count++; });
+			pool.Wait(group);
+			CHECK(count == 1);
+			TaskGroup empty;
+			pool.Wait(empty);
+		}
+	}
+
+	// A task may submit to its own group or to a new one and wait on it from
+	// inside the pool.  With a single worker this only finishes because Wait
+	// runs queued tasks itself.
+	void TestNestedSubmit()
+	{
+		ThreadPool pool(1);
+		std::atomic<uint32> leaves{ 0 };
+		TaskGroup outer;
+		for (uint32 i = 0; i < 8; i++)
+		{
+			pool.Submit(outer, [&pool, &leaves]
+			{
+				TaskGroup inner;
+				for (uint32 j = 0; j < 16; j++)
+				{
+					pool.Submit(inner, [&pool, &leaves]
+					{
+						TaskGroup innermost;
+						pool.Submit(innermost, [&leaves] { leaves++; });
+						pool.Wait(innermost);
+					});
+				}
+				pool.Wait(inner);
+			});
+		}
+		pool.Wait(outer);
+		CHECK(leaves == 8 * 16);
+
+		// Submitting to the group being waited on extends the wait.
+		std::atomic<uint32> chained{ 0 };
+		TaskGroup group;
+		pool.Submit(group, [&pool, &group, &chained]
+		{
+			chained++;
+			pool.Submit(group, [&chained] { chained++; });
+		});
+		pool.Wait(group);
+		CHECK(chained == 2);
+	}
+
+	// Destroying the pool runs every task still queued before the workers
+	// join, so nothing is dropped even when nobody waited.
+	void TestDrainOnDestruction()
+	{
+		const uint32 taskCount = 500;
+		std::atomic<uint32> count{ 0 };
+		TaskGroup group;
+		{
+			ThreadPool pool(2);
+			for (uint32 i = 0; i < taskCount; i++)
+			{
+				pool.Submit(group, [&count]
+				{
+					std::this_thread::yield();
+					count++;
+				});
+			}
+		}
+		CHECK(count == taskCount);
+
+		// The tasks still see the group and the objects declared before the
+		// pool.
+		auto owned = std::make_unique<std::vector<uint32>>();
+		{
+			TaskGroup writes;
+			ThreadPool pool(1);
+			for (uint32 i = 0; i < 100; i++)
+				pool.Submit(writes, [&owned, i] { owned->push_back(i); });
+		}
+		CHECK(owned->size() == 100);
+	}
+
+	// The first exception of a group comes out of Wait, once, after every
+	// task of the group has run.
+	void TestException()
+	{
+		ThreadPool pool(2);
+		std::atomic<uint32> count{ 0 };
+		TaskGroup group;
+		for (uint32 i = 0; i < 10; i++)
+		{
+			pool.Submit(group, [&count, i]
+			{
+				count++;
+				if (i % 3 == 0)
+					throw std::runtime_error("task failed");
+			});
+		}
+
+		bool thrown = false;
+		try
+		{
+			pool.Wait(group);
+		}
+		catch (const std::runtime_error&)
+		{
+			thrown = true;
+		}
+		CHECK(thrown);
+		CHECK(count == 10);
+
+		pool.Submit(group, [] {});
+		pool.Wait(group);
+	}
+}
+
+int main()
+{
+	TestSubmitWait();
+	TestNestedSubmit();
+	TestDrainOnDestruction();
+	TestException();
+	return Test::Result("ThreadPoolTests");
+}
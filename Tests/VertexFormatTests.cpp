@@ -0,0 +1,100 @@
+#include <cmath>
+#include <cstring>
+#include "Check.h"
+#include "../VertexFormat.h"
+
+using namespace DirectX;
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	const XMFLOAT3 P(1.0f, 2.0f, 3.0f);
+	const XMFLOAT3 N(0.0f, 1.0f, 0.0f);
+	const XMFLOAT3 T(1.0f, 0.0f, 0.0f);
+	const XMFLOAT2 UV(0.25f, 0.75f);
+
+	bool Near(float a, float b)
+	{
+		return std::fabs(a - b) < 1e-5f;
+	}
+
+	// The elements describe every member in order, without gaps, so the
+	// input layout covers the whole vertex.
+	template<typename Format>
+	void CheckElementsCoverVertex(uint32 expectedSize)
+	{
+		const uint32 sizes[] = { 8, 12, 16 };
+		const VertexElement* elements = Format::Elements();
+		uint32 offset = 0;
+		for (uint32 i = 0; i < Format::ElementCount; i++)
+		{
+			CHECK(elements[i].AlignedByteOffset == offset);
+			offset += sizes[(uint32)elements[i].Format];
+		}
+		CHECK(offset == sizeof(typename Format::Vertex));
+		CHECK(sizeof(typename Format::Vertex) == expectedSize);
+		CHECK(std::strcmp(elements[0].SemanticName, "POSITION") == 0);
+	}
+
+	void TestElements()
+	{
+		CheckElementsCoverVertex<VertexFormats::Position>(12);
+		CheckElementsCoverVertex<VertexFormats::PositionColor>(28);
+		CheckElementsCoverVertex<VertexFormats::PositionNormalTangentUV>(44);
+		CHECK(std::strcmp(VertexFormats::PositionNormalTangentUV::Elements()[3].SemanticName, "TEXCOORD") == 0);
+	}
+
+	// Make keeps the attributes a format stores and drops the others.
+	void TestMake()
+	{
+		VertexFormats::Position::Vertex p = VertexFormats::Position().Make(P, N, T, UV);
+		CHECK(p.Position.x == 1.0f && p.Position.y == 2.0f && p.Position.z == 3.0f);
+
+		VertexFormats::PositionColor colored(XMFLOAT4(0.5f, 0.25f, 1.0f, 1.0f));
+		VertexFormats::PositionColor::Vertex c = colored.Make(P, N, T, UV);
+		CHECK(c.Position.z == 3.0f);
+		CHECK(c.Color.x == 0.5f && c.Color.y == 0.25f && c.Color.z == 1.0f && c.Color.w == 1.0f);
+		CHECK(VertexFormats::PositionColor().Make(P, N, T, UV).Color.x == 1.0f);
+
+		VertexFormats::PositionNormalTangentUV::Vertex full = VertexFormats::PositionNormalTangentUV().Make(P, N, T, UV);
+		CHECK(full.Position.y == 2.0f);
+		CHECK(full.Normal.y == 1.0f);
+		CHECK(full.TangentU.x == 1.0f);
+		CHECK(full.TexC.x == 0.25f && full.TexC.y == 0.75f);
+	}
+
+	// Positions, colors and texture coordinates average; normals and
+	// tangents average and are normalized again.
+	void TestMidPoint()
+	{
+		VertexFormats::Position position;
+		VertexFormats::Position::Vertex p = position.MidPoint(
+			position.Make(XMFLOAT3(0.0f, 0.0f, 0.0f), N, T, UV),
+			position.Make(XMFLOAT3(2.0f, 4.0f, -6.0f), N, T, UV));
+		CHECK(p.Position.x == 1.0f && p.Position.y == 2.0f && p.Position.z == -3.0f);
+
+		VertexFormats::PositionColor::Vertex c0 = VertexFormats::PositionColor(XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f)).Make(P, N, T, UV);
+		VertexFormats::PositionColor::Vertex c1 = VertexFormats::PositionColor(XMFLOAT4(1.0f, 0.5f, 0.0f, 1.0f)).Make(P, N, T, UV);
+		VertexFormats::PositionColor::Vertex c = VertexFormats::PositionColor().MidPoint(c0, c1);
+		CHECK(c.Color.x == 0.5f && c.Color.y == 0.25f && c.Color.w == 1.0f);
+
+		VertexFormats::PositionNormalTangentUV full;
+		VertexFormats::PositionNormalTangentUV::Vertex f = full.MidPoint(
+			full.Make(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 1.0f), XMFLOAT2(0.0f, 0.0f)),
+			full.Make(XMFLOAT3(2.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 1.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 1.0f), XMFLOAT2(1.0f, 0.5f)));
+		const float h = std::sqrt(0.5f);
+		CHECK(f.Position.x == 1.0f);
+		CHECK(Near(f.Normal.x, h) && Near(f.Normal.y, h) && Near(f.Normal.z, 0.0f));
+		CHECK(Near(f.TangentU.z, 1.0f));
+		CHECK(f.TexC.x == 0.5f && f.TexC.y == 0.25f);
+	}
+}
+
+int main()
+{
+	TestElements();
+	TestMake();
+	TestMidPoint();
+	return Test::Result("VertexFormatTests");
+}
@@ -0,0 +1,106 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(uint32 workerCount)
+{
+	if (workerCount == 0)
+	{
+		uint32 hardwareThreads = std::thread::hardware_concurrency();
+		workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	mWorkers.reserve(workerCount);
+	for (uint32 i = 0; i < workerCount; i++)
+		mWorkers.emplace_back(&ThreadPool::WorkerMain, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQuit = true;
+	}
+	mWake.notify_all();
+
+	for (std::thread& worker : mWorkers)
+		worker.join();
+}
+
+ThreadPool::uint32 ThreadPool::GetWorkerCount() const
+{
+	return (uint32)mWorkers.size();
+}
+
+void ThreadPool::Submit(TaskGroup& group, std::function<void()> task)
+{
+	group.mPending.fetch_add(1, std::memory_order_relaxed);
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQueue.push_back(Task{ &group, std::move(task) });
+	}
+	mWake.notify_one();
+}
+
+void ThreadPool::Wait(TaskGroup& group)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	while (group.mPending.load(std::memory_order_acquire) != 0)
+	{
+		if (mQueue.empty())
+		{
+			mWake.wait(lock);
+			continue;
+		}
+
+		Task task = std::move(mQueue.front());
+		mQueue.pop_front();
+		lock.unlock();
+		Run(task);
+		lock.lock();
+	}
+
+	if (group.mException)
+	{
+		std::exception_ptr exception = group.mException;
+		group.mException = nullptr;
+		std::rethrow_exception(exception);
+	}
+}
+
+void ThreadPool::WorkerMain()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	for (;;)
+	{
+		mWake.wait(lock, [this] { return mQuit || !mQueue.empty(); });
+		if (mQueue.empty())
+			return;
+
+		Task task = std::move(mQueue.front());
+		mQueue.pop_front();
+		lock.unlock();
+		Run(task);
+		lock.lock();
+	}
+}
+
+void ThreadPool::Run(Task& task)
+{
+	try
+	{
+		task.Function();
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (!task.Group->mException)
+			task.Group->mException = std::current_exception();
+	}
+
+	// The last task of a group wakes its waiters.  Taking the lock orders the
+	// notify after a waiter's check of mPending, so the wake-up is not lost.
+	if (task.Group->mPending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mWake.notify_all();
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A batch of tasks submitted to a ThreadPool.  Wait on it to know when all of
+// them have run.  The first exception thrown by a task of the group is kept
+// and rethrown by Wait.
+class TaskGroup
+{
+public:
+	TaskGroup() = default;
+	TaskGroup(const TaskGroup& rhs) = delete;
+	TaskGroup& operator=(const TaskGroup& rhs) = delete;
+
+private:
+	friend class ThreadPool;
+
+	std::atomic<std::uint32_t>				mPending{ 0 };
+	std::exception_ptr						mException;
+};
+
+// Fixed set of worker threads pulling tasks from one shared queue.  Meant for
+// a handful of coarse tasks (mesh builds, shader compilation), not for
+// fine-grained per-entity work.
+//
+// Wait runs queued tasks on the calling thread until its group is done, so a
+// task may submit more tasks and wait on them without starving the pool, and
+// the caller of Wait is one more worker rather than an idle thread.
+class ThreadPool
+{
+public:
+	using uint32 = std::uint32_t;
+
+	// 0 picks one worker per hardware thread, minus the thread that waits.
+	explicit ThreadPool(uint32 workerCount = 0);
+	ThreadPool(const ThreadPool& rhs) = delete;
+	ThreadPool& operator=(const ThreadPool& rhs) = delete;
+	~ThreadPool();
+
+	uint32									GetWorkerCount() const;
+
+	void									Submit(TaskGroup& group, std::function<void()> task);
+	// Blocks until every task submitted to group has run, helping meanwhile.
+	void									Wait(TaskGroup& group);
+
+private:
+	struct Task
+	{
+		TaskGroup* Group;
+		std::function<void()> Function;
+	};
+
+	void									WorkerMain();
+	void									Run(Task& task);
+
+	std::vector<std::thread>				mWorkers;
+	std::deque<Task>						mQueue;
+	std::mutex								mMutex;
+	// Signaled when a task is queued, when a group completes and on shutdown.
+	std::condition_variable					mWake;
+	bool									mQuit = false;
+};
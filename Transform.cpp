@@ -1,4 +1,5 @@
 ﻿#include "Transform.h"
+#include <cmath>
 
 /*qx,α=cosα2+(sinα2)i
 qy,β=cosβ2+(sinβ2)j
@@ -10,9 +11,9 @@ qz,γ=cosγ2+(sinγ2)k*/
 
 void Transform::Identity(TRANSFORM* mat)
 {
-	mat->mSca = MathHelper::Identity4x4();
-	mat->mRot = MathHelper::Identity4x4();
-	mat->mPos = MathHelper::Identity4x4();
+	XMStoreFloat4x4(&mat->mSca, XMMatrixIdentity());
+	XMStoreFloat4x4(&mat->mRot, XMMatrixIdentity());
+	XMStoreFloat4x4(&mat->mPos, XMMatrixIdentity());
 }
 
 //void Transform::UpdateMatrix()
@@ -1,11 +1,8 @@
 #pragma once
 
-#include "d3dApp.h"
-#include "MathHelper.h"
+#include <DirectXMath.h>
 
-using Microsoft::WRL::ComPtr;
 using namespace DirectX;
-using namespace DirectX::PackedVector;
 
 struct TRANSFORM
 {
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "RingAllocator.h"
+
+// One large, persistently mapped upload buffer that per-frame transient data
+// is suballocated from, instead of one committed resource per use.  A slice
+// lives for the frame it was allocated in, until the GPU retires that frame.
+// Slices can be aligned on D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT
+// (256 bytes) so their GPU address can go straight to
+// SetGraphicsRootConstantBufferView.
+//
+// Object constants no longer come from here: with dirty tracking they persist
+// from frame to frame in FrameResource::InstanceBuffer and an unchanged entity
+// costs no write at all, which a slice rewritten every frame cannot do.  The
+// ring carries what is rebuilt every frame anyway, the batch slot lists.
+class UploadRing
+{
+public:
+    struct Allocation
+    {
+        BYTE* CPU = nullptr;
+        D3D12_GPU_VIRTUAL_ADDRESS GPU = 0;
+    };
+
+    UploadRing(ID3D12Device* device, UINT64 byteSize) :
+        mAllocator(byteSize)
+    {
+        ThrowIfFailed(device->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(byteSize),
+            D3D12_RESOURCE_STATE_GENERIC_READ,
+            nullptr,
+            IID_PPV_ARGS(&mUploadBuffer)));
+
+        ThrowIfFailed(mUploadBuffer->Map(0, nullptr, reinterpret_cast<void**>(&mMappedData)));
+        mBaseAddress = mUploadBuffer->GetGPUVirtualAddress();
+    }
+
+    UploadRing(const UploadRing& rhs) = delete;
+    UploadRing& operator=(const UploadRing& rhs) = delete;
+    ~UploadRing()
+    {
+        if(mUploadBuffer != nullptr)
+            mUploadBuffer->Unmap(0, nullptr);
+
+        mMappedData = nullptr;
+    }
+
+    ID3D12Resource* Resource()const
+    {
+        return mUploadBuffer.Get();
+    }
+
+    Allocation Allocate(UINT64 byteSize, UINT64 alignment)
+    {
+        UINT64 offset = mAllocator.Allocate(byteSize, alignment);
+        if(offset == RingAllocator::InvalidOffset)
+            throw DxException(E_OUTOFMEMORY, L"UploadRing::Allocate", AnsiToWString(__FILE__), __LINE__);
+
+        Allocation allocation;
+        allocation.CPU = mMappedData + offset;
+        allocation.GPU = mBaseAddress + offset;
+        return allocation;
+    }
+
+    // Copies data into a fresh constant buffer slice and returns its GPU address.
+    template<typename T>
+    D3D12_GPU_VIRTUAL_ADDRESS PushConstants(const T& data)
+    {
+        Allocation allocation = Allocate(d3dUtil::CalcConstantBufferByteSize(sizeof(T)),
+            D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+        memcpy(allocation.CPU, &data, sizeof(T));
+        return allocation.GPU;
+    }
+
+    // Everything allocated since the previous call belongs to the frame that
+    // signals fenceValue.
+    void FinishFrame(UINT64 fenceValue)
+    {
+        mAllocator.FinishFrame(fenceValue);
+    }
+
+    void Retire(UINT64 completedFenceValue)
+    {
+        mAllocator.Retire(completedFenceValue);
+    }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12Resource> mUploadBuffer;
+    BYTE* mMappedData = nullptr;
+    D3D12_GPU_VIRTUAL_ADDRESS mBaseAddress = 0;
+
+    RingAllocator mAllocator;
+};
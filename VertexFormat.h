@@ -0,0 +1,195 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <DirectXMath.h>
+
+// Compile-time vertex formats.  The shape generators of CreateGeometry are
+// templated on one of these and write vertices of the final layout directly,
+// and the input layout of the pipeline is built from the same Elements, so
+// the C++ struct and the shader input can not drift apart.
+//
+// A format is a small policy object:
+//  - Vertex: the vertex struct.  Every format has a Position member, which
+//    bounds, simplification and overdraw ordering read.
+//  - Make: builds a vertex from every attribute a generator knows about and
+//    keeps the ones the format stores.
+//  - MidPoint: the vertex halfway along an edge, used by subdivision.
+//  - Elements / ElementCount: semantic, component type and byte offset of
+//    each member, in declaration order.
+// Formats may carry state, such as the color of PositionColor, which Make
+// applies to every vertex.
+
+enum class VertexElementFormat : std::uint8_t
+{
+	Float2,
+	Float3,
+	Float4
+};
+
+struct VertexElement
+{
+	const char* SemanticName;
+	VertexElementFormat Format;
+	std::uint32_t AlignedByteOffset;
+};
+
+namespace VertexFormats
+{
+	struct Position
+	{
+		struct Vertex
+		{
+			DirectX::XMFLOAT3 Position;
+		};
+
+		static constexpr std::uint32_t ElementCount = 1;
+		static const VertexElement* Elements()
+		{
+			static const VertexElement elements[ElementCount] =
+			{
+				{ "POSITION", VertexElementFormat::Float3, offsetof(Vertex, Position) }
+			};
+			return elements;
+		}
+
+		Vertex Make(const DirectX::XMFLOAT3& p, const DirectX::XMFLOAT3& /*n*/, const DirectX::XMFLOAT3& /*t*/, const DirectX::XMFLOAT2& /*uv*/) const
+		{
+			Vertex v;
+			v.Position = p;
+			return v;
+		}
+
+		Vertex MidPoint(const Vertex& v0, const Vertex& v1) const
+		{
+			Vertex v;
+			DirectX::XMStoreFloat3(&v.Position, 0.5f * (DirectX::XMLoadFloat3(&v0.Position) + DirectX::XMLoadFloat3(&v1.Position)));
+			return v;
+		}
+	};
+
+	// Flat colored vertices; Color is applied to every vertex Make builds.
+	struct PositionColor
+	{
+		struct Vertex
+		{
+			DirectX::XMFLOAT3 Position;
+			DirectX::XMFLOAT4 Color;
+		};
+
+		static constexpr std::uint32_t ElementCount = 2;
+		static const VertexElement* Elements()
+		{
+			static const VertexElement elements[ElementCount] =
+			{
+				{ "POSITION", VertexElementFormat::Float3, offsetof(Vertex, Position) },
+				{ "COLOR", VertexElementFormat::Float4, offsetof(Vertex, Color) }
+			};
+			return elements;
+		}
+
+		PositionColor() :
+			Color(1.0f, 1.0f, 1.0f, 1.0f) {}
+		explicit PositionColor(const DirectX::XMFLOAT4& color) :
+			Color(color) {}
+
+		Vertex Make(const DirectX::XMFLOAT3& p, const DirectX::XMFLOAT3& /*n*/, const DirectX::XMFLOAT3& /*t*/, const DirectX::XMFLOAT2& /*uv*/) const
+		{
+			Vertex v;
+			v.Position = p;
+			v.Color = Color;
+			return v;
+		}
+
+		Vertex MidPoint(const Vertex& v0, const Vertex& v1) const
+		{
+			Vertex v;
+			DirectX::XMStoreFloat3(&v.Position, 0.5f * (DirectX::XMLoadFloat3(&v0.Position) + DirectX::XMLoadFloat3(&v1.Position)));
+			DirectX::XMStoreFloat4(&v.Color, 0.5f * (DirectX::XMLoadFloat4(&v0.Color) + DirectX::XMLoadFloat4(&v1.Color)));
+			return v;
+		}
+
+		DirectX::XMFLOAT4 Color;
+	};
+
+	// Full layout for lit and textured meshes.
+	struct PositionNormalTangentUV
+	{
+		struct Vertex
+		{
+			Vertex() {}
+			Vertex(
+				const DirectX::XMFLOAT3& p,
+				const DirectX::XMFLOAT3& n,
+				const DirectX::XMFLOAT3& t,
+				const DirectX::XMFLOAT2& uv) :
+				Position(p),
+				Normal(n),
+				TangentU(t),
+				TexC(uv) {}
+			Vertex(
+				float px, float py, float pz,
+				float nx, float ny, float nz,
+				float tx, float ty, float tz,
+				float u, float v) :
+				Position(px, py, pz),
+				Normal(nx, ny, nz),
+				TangentU(tx, ty, tz),
+				TexC(u, v) {}
+
+			DirectX::XMFLOAT3 Position;
+			DirectX::XMFLOAT3 Normal;
+			DirectX::XMFLOAT3 TangentU;
+			DirectX::XMFLOAT2 TexC;
+		};
+
+		static constexpr std::uint32_t ElementCount = 4;
+		static const VertexElement* Elements()
+		{
+			static const VertexElement elements[ElementCount] =
+			{
+				{ "POSITION", VertexElementFormat::Float3, offsetof(Vertex, Position) },
+				{ "NORMAL", VertexElementFormat::Float3, offsetof(Vertex, Normal) },
+				{ "TANGENT", VertexElementFormat::Float3, offsetof(Vertex, TangentU) },
+				{ "TEXCOORD", VertexElementFormat::Float2, offsetof(Vertex, TexC) }
+			};
+			return elements;
+		}
+
+		Vertex Make(const DirectX::XMFLOAT3& p, const DirectX::XMFLOAT3& n, const DirectX::XMFLOAT3& t, const DirectX::XMFLOAT2& uv) const
+		{
+			return Vertex(p, n, t, uv);
+		}
+
+		Vertex MidPoint(const Vertex& v0, const Vertex& v1) const
+		{
+			using namespace DirectX;
+
+			XMVECTOR p0 = XMLoadFloat3(&v0.Position);
+			XMVECTOR p1 = XMLoadFloat3(&v1.Position);
+
+			XMVECTOR n0 = XMLoadFloat3(&v0.Normal);
+			XMVECTOR n1 = XMLoadFloat3(&v1.Normal);
+
+			XMVECTOR tan0 = XMLoadFloat3(&v0.TangentU);
+			XMVECTOR tan1 = XMLoadFloat3(&v1.TangentU);
+
+			XMVECTOR tex0 = XMLoadFloat2(&v0.TexC);
+			XMVECTOR tex1 = XMLoadFloat2(&v1.TexC);
+
+			// Compute the midpoints of all the attributes.  Vectors need to be normalized
+			// since linear interpolating can make them not unit length.
+			XMVECTOR pos = 0.5f * (p0 + p1);
+			XMVECTOR normal = XMVector3Normalize(0.5f * (n0 + n1));
+			XMVECTOR tangent = XMVector3Normalize(0.5f * (tan0 + tan1));
+			XMVECTOR tex = 0.5f * (tex0 + tex1);
+
+			Vertex v;
+			XMStoreFloat3(&v.Position, pos);
+			XMStoreFloat3(&v.Normal, normal);
+			XMStoreFloat3(&v.TangentU, tangent);
+			XMStoreFloat2(&v.TexC, tex);
+
+			return v;
+		}
+	};
+}
@@ -4,6 +4,8 @@
 
 #include "d3dApp.h"
 #include <WindowsX.h>
+#include <chrono>
+#include <cmath>
 
 using Microsoft::WRL::ComPtr;
 using namespace std;
@@ -33,7 +35,7 @@ D3DApp::D3DApp(HINSTANCE hInstance)
 
 D3DApp::~D3DApp()
 {
-	if(md3dDevice != nullptr)
+	if(mFence != nullptr)
 		FlushCommandQueue();
 }
 
@@ -74,6 +76,7 @@ int D3DApp::Run()
 	MSG msg = {0};
  
 	mTimer.Reset();
+	Profiler::SetThreadName("main");
 
 	while(msg.message != WM_QUIT)
 	{
@@ -91,8 +94,23 @@ int D3DApp::Run()
 			if( !mAppPaused )
 			{
 				CalculateFrameStats();
+
+				chrono::steady_clock::time_point frameBegin = chrono::steady_clock::now();
+				AdvanceSimulation(mTimer.DeltaTime());
+				chrono::steady_clock::time_point simEnd = chrono::steady_clock::now();
+				mPresentWaitSeconds = 0.0;
 				Update(mTimer);	
                 Draw(mTimer);
+				chrono::steady_clock::time_point frameEnd = chrono::steady_clock::now();
+
+				FrameStats::Frame frame;
+				frame.Milliseconds[FrameStats::Sim] = chrono::duration<float, milli>(simEnd - frameBegin).count();
+				frame.Milliseconds[FrameStats::PresentWait] = (float)(mPresentWaitSeconds * 1000.0);
+				frame.Milliseconds[FrameStats::Record] = chrono::duration<float, milli>(frameEnd - simEnd).count() - frame.Milliseconds[FrameStats::PresentWait];
+				frame.Milliseconds[FrameStats::Total] = mTimer.DeltaTime() * 1000.0f;
+				mFrameStats.AddFrame(frame);
+				// Once a frame, so the per-thread rings never fill up.
+				Profiler::Collect();
 			}
 			else
 			{
@@ -101,6 +119,13 @@ int D3DApp::Run()
         }
     }
 
+	if(mFrameStats.GetTotalFrameCount() > 0)
+	{
+		mFrameStats.WriteCsv("frame_stats.csv");
+		mFrameStats.WriteHistogramCsv("frame_histogram.csv");
+		mFrameStats.WriteSummaryCsv("frame_summary.csv");
+	}
+
 	return (int)msg.wParam;
 }
 
@@ -365,6 +390,12 @@ LRESULT D3DApp::MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         }
         else if((int)wParam == VK_F2)
             Set4xMsaaState(!m4xMsaaState);
+        else if((int)wParam == VK_F9)
+        {
+            // The most recent scopes, for chrome://tracing.
+            if(Profiler::WriteChromeTrace("profile.json"))
+                OutputDebugStringA("profiler: trace written to profile.json\n");
+        }
 
         return 0;
 	}
@@ -443,9 +474,6 @@ bool D3DApp::InitDirect3D()
 			IID_PPV_ARGS(&md3dDevice)));
 	}
 
-	ThrowIfFailed(md3dDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE,
-		IID_PPV_ARGS(&mFence)));
-
 	mRtvDescriptorSize = md3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
 	mDsvDescriptorSize = md3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
 	mCbvSrvUavDescriptorSize = md3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
@@ -472,6 +500,7 @@ bool D3DApp::InitDirect3D()
 #endif
 
 	CreateCommandObjects();
+	mFence = std::make_unique<D3D12GpuFence>(md3dDevice.Get(), mCommandQueue.Get());
     CreateSwapChain();
     CreateRtvAndDsvDescriptorHeaps();
 
@@ -533,26 +562,10 @@ void D3DApp::CreateSwapChain()
 
 void D3DApp::FlushCommandQueue()
 {
-	// Advance the fence value to mark commands up to this fence point.
-    mCurrentFence++;
-
-    // Add an instruction to the command queue to set a new fence point.  Because we 
-	// are on the GPU timeline, the new fence point won't be set until the GPU finishes
-	// processing all the commands prior to this Signal().
-    ThrowIfFailed(mCommandQueue->Signal(mFence.Get(), mCurrentFence));
-
-	// Wait until the GPU has completed commands up to this fence point.
-    if(mFence->GetCompletedValue() < mCurrentFence)
-	{
-		HANDLE eventHandle = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
-
-        // Fire event when GPU hits current fence.  
-        ThrowIfFailed(mFence->SetEventOnCompletion(mCurrentFence, eventHandle));
-
-        // Wait until the GPU hits current fence event is fired.
-		WaitForSingleObject(eventHandle, INFINITE);
-        CloseHandle(eventHandle);
-	}
+	PROFILE_SCOPE("D3DApp::FlushCommandQueue");
+	// Signal a new fence point behind everything submitted so far and wait
+	// until the GPU reaches it.
+	mFence->Wait(mFence->Signal());
 }
 
 ID3D12Resource* D3DApp::CurrentBackBuffer()const
@@ -573,35 +586,60 @@ D3D12_CPU_DESCRIPTOR_HANDLE D3DApp::DepthStencilView()const
 	return mDsvHeap->GetCPUDescriptorHandleForHeapStart();
 }
 
-void D3DApp::CalculateFrameStats()
+void D3DApp::SetTickRate(float ticksPerSecond, UINT maxTicksPerFrame)
 {
-	// Code computes the average frames per second, and also the 
-	// average time it takes to render one frame.  These stats 
-	// are appended to the window caption bar.
-    
-	static int frameCnt = 0;
-	static float timeElapsed = 0.0f;
+	mTickSeconds = 1.0f / ticksPerSecond;
+	mMaxTicksPerFrame = maxTicksPerFrame;
+}
 
-	frameCnt++;
+void D3DApp::AdvanceSimulation(float frameSeconds)
+{
+	mTickAccumulator += frameSeconds;
 
-	// Compute averages over one second period.
-	if( (mTimer.TotalTime() - timeElapsed) >= 1.0f )
+	UINT ticks = 0;
+	while (mTickAccumulator >= mTickSeconds && ticks < mMaxTicksPerFrame)
 	{
-		float fps = (float)frameCnt; // fps = frameCnt / 1
-		float mspf = 1000.0f / fps;
+		FixedUpdate(mTickSeconds);
+		mTickAccumulator -= mTickSeconds;
+		mTickCount++;
+		ticks++;
+	}
+
+	// Too far behind (a hitch, a breakpoint): keep the fraction of a tick and
+	// forget the rest, the simulation runs slow for this frame.
+	if (mTickAccumulator >= mTickSeconds)
+		mTickAccumulator = std::fmod(mTickAccumulator, (double)mTickSeconds);
+
+	mTickAlpha = (float)(mTickAccumulator / mTickSeconds);
+}
 
-        wstring fpsStr = to_wstring(fps);
-        wstring mspfStr = to_wstring(mspf);
+void D3DApp::CalculateFrameStats()
+{
+	// Once a second, the frame rate and the spread of the frame times over
+	// that second are appended to the window caption bar.  The average alone
+	// hides a hitch; p99 and max show it.
+
+	if( (mTimer.TotalTime() - mCaptionTime) >= 1.0f )
+	{
+		UINT64 frameCount = mFrameStats.GetTotalFrameCount();
+		UINT frameCnt = (UINT)(frameCount - mCaptionFrameCount);
+		FrameStats::Summary total = mFrameStats.Summarize(FrameStats::Total, frameCnt);
+
+		float fps = (float)frameCnt; // fps = frameCnt / 1
 
         wstring windowText = mMainWndCaption +
-            L"    fps: " + fpsStr +
-            L"   mspf: " + mspfStr;
+            L"    fps: " + to_wstring(fps) +
+            L"   mspf: " + to_wstring(total.Mean) +
+            L"   p99: " + to_wstring(total.P99) +
+            L"   max: " + to_wstring(total.Max) +
+            L"   hitches: " + to_wstring(mFrameStats.GetHitchCount()) +
+            GetFrameStatsText();
 
         SetWindowText(mhMainWnd, windowText.c_str());
 		
-		// Reset for next average.
-		frameCnt = 0;
-		timeElapsed += 1.0f;
+		// Reset for next second.
+		mCaptionFrameCount = frameCount;
+		mCaptionTime += 1.0f;
 	}
 }
 
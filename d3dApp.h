@@ -11,6 +11,9 @@
 
 #include "d3dUtil.h"
 #include "GameTimer.h"
+#include "D3D12GpuFence.h"
+#include "Profiler.h"
+#include "FrameStats.h"
 
 // Link necessary d3d12 libraries.
 #pragma comment(lib,"d3dcompiler.lib")
@@ -45,6 +48,9 @@ public:
 protected:
     virtual void CreateRtvAndDsvDescriptorHeaps();
 	virtual void OnResize(); 
+	// Advances the simulation by one tick of dt seconds.  Run calls it as
+	// many times per frame as real time requires, before Update and Draw.
+	virtual void FixedUpdate(float dt) { }
 	virtual void Update(const GameTimer& gt)=0;
     virtual void Draw(const GameTimer& gt)=0;
 
@@ -53,6 +59,9 @@ protected:
 	virtual void OnMouseUp(WPARAM btnState, int x, int y)  { }
 	virtual void OnMouseMove(WPARAM btnState, int x, int y){ }
 
+	// Extra text appended to the frame stats in the window caption.
+	virtual std::wstring GetFrameStatsText()const { return std::wstring(); }
+
 protected:
 
 	bool InitMainWindow();
@@ -68,6 +77,11 @@ protected:
 
 	void CalculateFrameStats();
 
+	// maxTicksPerFrame bounds the catch-up after a long frame: past it the
+	// simulation drops the time it is late by rather than spiral.
+	void SetTickRate(float ticksPerSecond, UINT maxTicksPerFrame = 5);
+	void AdvanceSimulation(float frameSeconds);
+
     void LogAdapters();
     void LogAdapterOutputs(IDXGIAdapter* adapter);
     void LogOutputDisplayModes(IDXGIOutput* output, DXGI_FORMAT format);
@@ -90,13 +104,32 @@ protected:
 
 	// Used to keep track of the delta-time and game time (4.4).
 	GameTimer mTimer;
+
+	// Fixed timestep: FixedUpdate runs every mTickSeconds of real time,
+	// whatever the frame rate.
+	float     mTickSeconds = 1.0f / 60.0f;
+	UINT      mMaxTicksPerFrame = 5;
+	double    mTickAccumulator = 0.0;
+	UINT64    mTickCount = 0;
+	// Fraction of a tick elapsed since the last FixedUpdate, in [0, 1): how far
+	// a frame is from the previous simulation state to the current one.
+	float     mTickAlpha = 0.0f;
+
+	// Per-frame times, split into simulation, recording and GPU waits; Run
+	// writes them to CSV when it returns.
+	FrameStats mFrameStats;
+	// Part of the current frame spent blocked on the GPU, on the frame
+	// resource fence or in Present.  Run clears it, Update and Draw add to it.
+	double    mPresentWaitSeconds = 0.0;
+	// Frame count and time of the last caption update.
+	UINT64    mCaptionFrameCount = 0;
+	float     mCaptionTime = 0.0f;
 	
     Microsoft::WRL::ComPtr<IDXGIFactory4> mdxgiFactory;
     Microsoft::WRL::ComPtr<IDXGISwapChain> mSwapChain;
     Microsoft::WRL::ComPtr<ID3D12Device> md3dDevice;
 
-    Microsoft::WRL::ComPtr<ID3D12Fence> mFence;
-    UINT64 mCurrentFence = 0;
+    std::unique_ptr<D3D12GpuFence> mFence;
 	
     Microsoft::WRL::ComPtr<ID3D12CommandQueue> mCommandQueue;
     Microsoft::WRL::ComPtr<ID3D12CommandAllocator> mDirectCmdListAlloc;